@@ -0,0 +1,134 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/types/cell_marker.h>
+
+#include <cgogn/io/surface/surface_import.h>
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <string>
+
+using namespace cgogn;
+
+using Vertex = CMap2::Vertex;
+using Edge = CMap2::Edge;
+using Face = CMap2::Face;
+
+// triangulated n x n grid (2 n^2 faces)
+void build_grid(CMap2& m, uint32 n)
+{
+	io::SurfaceImportData surface_data;
+	surface_data.reserve((n + 1) * (n + 1), 2 * n * n);
+	for (uint32 j = 0u; j <= n; ++j)
+		for (uint32 i = 0u; i <= n; ++i)
+			surface_data.vertex_position_.push_back({float64(i), float64(j), 0.0});
+	for (uint32 j = 0u; j < n; ++j)
+	{
+		for (uint32 i = 0u; i < n; ++i)
+		{
+			const uint32 v = j * (n + 1) + i;
+			surface_data.faces_nb_vertices_.insert(surface_data.faces_nb_vertices_.end(), {3u, 3u});
+			surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(),
+													  {v, v + 1, v + n + 2, v, v + n + 2, v + n + 1});
+		}
+	}
+	io::import_surface_data(m, surface_data);
+}
+
+template <typename FUNC>
+float64 best_time(uint32 nb_runs, const FUNC& f)
+{
+	float64 best = std::numeric_limits<float64>::max();
+	for (uint32 i = 0u; i < nb_runs; ++i)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		f();
+		auto end = std::chrono::high_resolution_clock::now();
+		best = std::min(best, std::chrono::duration<float64>(end - start).count());
+	}
+	return best;
+}
+
+// sweeps the cells of the given type and sums the indices of their incident vertices with the 3 forms of the query
+template <uint32 N, typename CELL>
+bool benchmark(const CMap2& m, const std::string& name, uint32 nb_runs)
+{
+	uint64 vector_sum = 0u, small_vector_sum = 0u, into_sum = 0u;
+
+	const float64 vector_time = best_time(nb_runs, [&]() {
+		vector_sum = 0u;
+		foreach_cell(m, [&](CELL c) -> bool {
+			for (Vertex v : incident_vertices(m, c))
+				vector_sum += index_of(m, v);
+			return true;
+		});
+	});
+	const float64 small_vector_time = best_time(nb_runs, [&]() {
+		small_vector_sum = 0u;
+		foreach_cell(m, [&](CELL c) -> bool {
+			for (Vertex v : incident_vertices<N>(m, c))
+				small_vector_sum += index_of(m, v);
+			return true;
+		});
+	});
+	const float64 into_time = best_time(nb_runs, [&]() {
+		into_sum = 0u;
+		foreach_cell(m, [&](CELL c) -> bool {
+			Vertex vertices[N];
+			const uint32 nb = incident_vertices_into(m, c, vertices, N);
+			for (uint32 i = 0u; i < nb; ++i)
+				into_sum += index_of(m, vertices[i]);
+			return true;
+		});
+	});
+
+	std::cout << name << " (std::vector): " << vector_time << " s" << std::endl;
+	std::cout << name << " (incident_vertices<" << N << ">): " << small_vector_time << " s" << std::endl;
+	std::cout << name << " (incident_vertices_into): " << into_time << " s" << std::endl;
+
+	return vector_sum == small_vector_sum && vector_sum == into_sum;
+}
+
+int main(int argc, char** argv)
+{
+	const uint32 n = argc < 2 ? 708u : uint32(std::stoul(argv[1]));
+	const uint32 nb_runs = argc < 3 ? 5u : uint32(std::stoul(argv[2]));
+
+	CMap2 m;
+	build_grid(m, n);
+	std::cout << "grid " << n << "x" << n << ": " << nb_cells<Face>(m) << " faces, " << nb_cells<Edge>(m)
+			  << " edges" << std::endl;
+
+	const bool faces_same = benchmark<3, Face>(m, "faces", nb_runs);
+	const bool edges_same = benchmark<2, Edge>(m, "edges", nb_runs);
+	if (!faces_same || !edges_same)
+		std::cerr << "results differ!" << std::endl;
+
+	return faces_same && edges_same ? 0 : 1;
+}
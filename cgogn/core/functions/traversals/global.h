@@ -0,0 +1,68 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+
+#ifndef CGOGN_CORE_FUNCTIONS_TRAVERSALS_GLOBAL_H_
+#define CGOGN_CORE_FUNCTIONS_TRAVERSALS_GLOBAL_H_
+
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/utils/numerics.h>
+#include <cgogn/core/utils/type_traits.h>
+
+#include <vector>
+
+namespace cgogn
+{
+
+template <typename MESH>
+struct mesh_traits;
+
+// parallel map-reduce over the cells of the given MESH
+// the CELL type is deduced from the map function parameter type
+// - map_func(CELL) computes the value of a cell
+// - combine_func(T, T) is an associative operation of which init is the identity element
+// each chunk of cells (see parallel_foreach_cell_by_chunk) accumulates its own partial result and the partial results
+// are then combined in chunk order: the result does not depend on the number of workers nor on the scheduling
+template <typename T, typename MESH, typename MAP_FUNC, typename COMBINE_FUNC>
+T parallel_reduce_cell(const MESH& m, const T& init, const MAP_FUNC& map_func, const COMBINE_FUNC& combine_func)
+{
+	using CELL = func_parameter_type<MAP_FUNC>;
+	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
+	static_assert(std::is_convertible_v<func_return_type<MAP_FUNC>, T>, "Map function should return a T");
+
+	std::vector<T> partial_results(nb_cell_chunks<CELL>(m), init);
+	parallel_foreach_cell_by_chunk(m, [&](CELL c, uint32 chunk) -> bool {
+		T& partial_result = partial_results[chunk];
+		partial_result = combine_func(partial_result, map_func(c));
+		return true;
+	});
+
+	T result = init;
+	for (const T& partial_result : partial_results)
+		result = combine_func(result, partial_result);
+	return result;
+}
+
+} // namespace cgogn
+
+#endif // CGOGN_CORE_FUNCTIONS_TRAVERSALS_GLOBAL_H_
@@ -24,6 +24,9 @@
 #ifndef CGOGN_CORE_FUNCTIONS_TRAVERSALS_VERTEX_H_
 #define CGOGN_CORE_FUNCTIONS_TRAVERSALS_VERTEX_H_
 
+#include <cgogn/core/utils/numerics.h>
+#include <cgogn/core/utils/small_vector.h>
+
 #include <vector>
 
 namespace cgogn
@@ -47,6 +50,35 @@ std::vector<typename mesh_traits<MESH>::Vertex> incident_vertices(const MESH& m,
 	return vertices;
 }
 
+// same as above, but the vertices are stored inline (no allocation) as long as there are at most N of them
+template <uint32 N, typename MESH, typename CELL>
+SmallVector<typename mesh_traits<MESH>::Vertex, N> incident_vertices(const MESH& m, CELL c)
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	SmallVector<Vertex, N> vertices;
+	foreach_incident_vertex(m, c, [&](Vertex v) -> bool {
+		vertices.push_back(v);
+		return true;
+	});
+	return vertices;
+}
+
+// writes the (at most capacity) first incident vertices of c in the given buffer
+// returns the number of incident vertices of c (that may be greater than capacity)
+template <typename MESH, typename CELL>
+uint32 incident_vertices_into(const MESH& m, CELL c, typename mesh_traits<MESH>::Vertex* vertices, uint32 capacity)
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	uint32 nb = 0u;
+	foreach_incident_vertex(m, c, [&](Vertex v) -> bool {
+		if (nb < capacity)
+			vertices[nb] = v;
+		++nb;
+		return true;
+	});
+	return nb;
+}
+
 template <typename MESH, typename CELL>
 void append_incident_vertices(const MESH& m, CELL c, std::vector<typename mesh_traits<MESH>::Vertex>& vertices)
 {
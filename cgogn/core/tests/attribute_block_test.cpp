@@ -0,0 +1,132 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/types/cell_marker.h>
+#include <cgogn/geometry/functions/bounding_box.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+// this file is compiled without optimizations (see CMakeLists.txt) so that the constants used by the blocks access
+// are odr-used as in the debug builds
+
+namespace cgogn
+{
+
+using Vec3 = geometry::Vec3;
+using Vertex = CMap2::Vertex;
+
+class AttributeBlockTest : public ::testing::Test
+{
+protected:
+	AttributeBlockTest()
+	{
+		position_ = add_attribute<Vec3, Vertex>(map_, "position");
+		// a few thousands of vertices, with unused indices all over the container
+		std::vector<CMap2::Volume> volumes;
+		for (uint32 i = 0u; i < 1000u; ++i)
+			volumes.push_back(add_prism(map_, 3u + i % 4u));
+		for (uint32 i = 0u; i < uint32(volumes.size()); i += 3u)
+			remove_volume(map_, volumes[i]);
+		foreach_cell(map_, [&](Vertex v) -> bool {
+			const uint32 i = index_of(map_, v);
+			value<Vec3>(map_, position_, v) = Vec3(i % 7u, -double(i % 13u), double(i) / 10.0);
+			return true;
+		});
+	}
+
+	CMap2 map_;
+	std::shared_ptr<CMap2::Attribute<Vec3>> position_;
+};
+
+TEST_F(AttributeBlockTest, UsedIndices)
+{
+	const auto& container = map_.attribute_containers_[Vertex::ORBIT];
+	ASSERT_GT(position_->nb_blocks(), 1u);
+	std::vector<uint32> indices;
+	for (uint32 b = 0u, nb = position_->nb_blocks(); b < nb; ++b)
+	{
+		auto block = position_->block(b);
+		EXPECT_LE(block.size(), CMap2::Attribute<Vec3>::CHUNK_SIZE);
+		block.foreach_value([&](Vec3& v) { indices.push_back(block.first_index_ + uint32(&v - block.data_)); });
+	}
+	std::vector<uint32> expected;
+	foreach_cell(map_, [&](Vertex v) -> bool {
+		expected.push_back(index_of(map_, v));
+		return true;
+	});
+	std::sort(expected.begin(), expected.end());
+	EXPECT_EQ(indices, expected);
+	EXPECT_EQ(uint32(indices.size()), container.nb_elements());
+}
+
+TEST_F(AttributeBlockTest, FlattenScatter)
+{
+	std::vector<Vec3> buffer;
+	position_->flatten(buffer);
+	foreach_cell(map_, [&](Vertex v) -> bool {
+		EXPECT_EQ(buffer[index_of(map_, v)], value<Vec3>(map_, position_, v));
+		return true;
+	});
+	for (Vec3& p : buffer)
+		p *= 2.0;
+	auto expected = add_attribute<Vec3, Vertex>(map_, "expected");
+	foreach_cell(map_, [&](Vertex v) -> bool {
+		value<Vec3>(map_, expected, v) = 2.0 * value<Vec3>(map_, position_, v);
+		return true;
+	});
+	position_->scatter(buffer);
+	foreach_cell(map_, [&](Vertex v) -> bool {
+		EXPECT_EQ(value<Vec3>(map_, position_, v), value<Vec3>(map_, expected, v));
+		return true;
+	});
+}
+
+TEST_F(AttributeBlockTest, BoundingBox)
+{
+	Vec3 bb_min = Vec3::Constant(std::numeric_limits<double>::max());
+	Vec3 bb_max = Vec3::Constant(std::numeric_limits<double>::lowest());
+	foreach_cell(map_, [&](Vertex v) -> bool {
+		bb_min = bb_min.cwiseMin(value<Vec3>(map_, position_, v));
+		bb_max = bb_max.cwiseMax(value<Vec3>(map_, position_, v));
+		return true;
+	});
+	auto [block_min, block_max] = geometry::bounding_box(*position_);
+	EXPECT_EQ(block_min, bb_min);
+	EXPECT_EQ(block_max, bb_max);
+
+	geometry::rescale(*position_, 1.0);
+	std::tie(block_min, block_max) = geometry::bounding_box(*position_);
+	EXPECT_NEAR(block_min.minCoeff(), 0.0, 1e-12);
+	EXPECT_NEAR((block_max - block_min).maxCoeff(), 1.0, 1e-12);
+}
+
+} // namespace cgogn
@@ -0,0 +1,181 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/types/cell_marker.h>
+#include <cgogn/core/types/maps/dart_marker.h>
+
+#include <gtest/gtest.h>
+
+namespace cgogn
+{
+
+class CellMarkerTest : public ::testing::Test
+{
+protected:
+	// more than the 255 generation values of a mark attribute
+	static const uint32 NB_CYCLES = 600u;
+
+	CellMarkerTest()
+	{
+		add_attribute<uint32, CMap2::Vertex>(map_, "vertex");
+		for (uint32 i = 0u; i < 100u; ++i)
+			add_prism(map_, 3u + i % 5u);
+	}
+
+	// the cells marked on a given cycle: the period is longer than the 255 generation values so that a mark that was
+	// not cleared when the generation value wrapped would be seen again
+	static bool selected(uint32 index, uint32 cycle)
+	{
+		return index % 300u == cycle % 300u;
+	}
+
+	template <typename MARKER>
+	uint32 nb_marked_vertices(const MARKER& marker)
+	{
+		uint32 nb = 0u;
+		foreach_cell(map_, [&](CMap2::Vertex v) -> bool {
+			if (marker.is_marked(v))
+				++nb;
+			return true;
+		});
+		return nb;
+	}
+
+	template <typename MARKER>
+	uint32 nb_marked_darts(const MARKER& marker)
+	{
+		uint32 nb = 0u;
+		for (Dart d = map_.begin(), end = map_.end(); d != end; d = map_.next(d))
+		{
+			if (marker.is_marked(d))
+				++nb;
+		}
+		return nb;
+	}
+
+	// marks the selected vertices and checks that exactly these vertices are marked
+	template <typename MARKER>
+	void mark_vertices(MARKER& marker, uint32 cycle)
+	{
+		uint32 nb = 0u;
+		foreach_cell(map_, [&](CMap2::Vertex v) -> bool {
+			if (selected(index_of(map_, v), cycle))
+			{
+				marker.mark(v);
+				++nb;
+			}
+			return true;
+		});
+		foreach_cell(map_, [&](CMap2::Vertex v) -> bool {
+			EXPECT_EQ(marker.is_marked(v), selected(index_of(map_, v), cycle));
+			return true;
+		});
+		EXPECT_EQ(nb_marked_vertices(marker), nb);
+	}
+
+	template <typename MARKER>
+	void mark_darts(MARKER& marker, uint32 cycle)
+	{
+		for (Dart d = map_.begin(), end = map_.end(); d != end; d = map_.next(d))
+		{
+			if (selected(d.index_, cycle))
+				marker.mark(d);
+		}
+		for (Dart d = map_.begin(), end = map_.end(); d != end; d = map_.next(d))
+			EXPECT_EQ(marker.is_marked(d), selected(d.index_, cycle));
+	}
+
+	CMap2 map_;
+};
+
+TEST_F(CellMarkerTest, UnmarkAll)
+{
+	CellMarker<CMap2, CMap2::Vertex> cm(map_);
+	DartMarker<CMap2> dm(map_);
+	for (uint32 cycle = 0u; cycle < NB_CYCLES; ++cycle)
+	{
+		mark_vertices(cm, cycle);
+		mark_darts(dm, cycle);
+		cm.unmark_all();
+		dm.unmark_all();
+		ASSERT_EQ(nb_marked_vertices(cm), 0u) << "cycle " << cycle;
+		ASSERT_EQ(nb_marked_darts(dm), 0u) << "cycle " << cycle;
+	}
+}
+
+TEST_F(CellMarkerTest, PooledAttributes)
+{
+	for (uint32 cycle = 0u; cycle < NB_CYCLES; ++cycle)
+	{
+		// two markers at once, so that several pooled attributes are used
+		CellMarker<CMap2, CMap2::Vertex> cm1(map_);
+		ASSERT_EQ(nb_marked_vertices(cm1), 0u) << "cycle " << cycle;
+		mark_vertices(cm1, cycle);
+		{
+			CellMarker<CMap2, CMap2::Vertex> cm2(map_);
+			ASSERT_EQ(nb_marked_vertices(cm2), 0u) << "cycle " << cycle;
+			mark_vertices(cm2, cycle + 1u);
+		}
+		DartMarker<CMap2> dm(map_);
+		ASSERT_EQ(nb_marked_darts(dm), 0u) << "cycle " << cycle;
+		mark_darts(dm, cycle);
+	}
+}
+
+TEST_F(CellMarkerTest, MarkerStores)
+{
+	for (uint32 cycle = 0u; cycle < NB_CYCLES; ++cycle)
+	{
+		// the stores release their attribute with the previous generation value, interleave them with markers
+		if (cycle % 2u == 0u)
+		{
+			CellMarkerStore<CMap2, CMap2::Vertex> cms(map_);
+			ASSERT_EQ(nb_marked_vertices(cms), 0u) << "cycle " << cycle;
+			mark_vertices(cms, cycle);
+			DartMarkerStore<CMap2> dms(map_);
+			ASSERT_EQ(nb_marked_darts(dms), 0u) << "cycle " << cycle;
+			mark_darts(dms, cycle);
+		}
+		else
+		{
+			CellMarker<CMap2, CMap2::Vertex> cm(map_);
+			ASSERT_EQ(nb_marked_vertices(cm), 0u) << "cycle " << cycle;
+			mark_vertices(cm, cycle);
+			DartMarker<CMap2> dm(map_);
+			ASSERT_EQ(nb_marked_darts(dm), 0u) << "cycle " << cycle;
+			mark_darts(dm, cycle);
+		}
+	}
+
+	CellMarkerStore<CMap2, CMap2::Vertex> cms(map_);
+	mark_vertices(cms, 0u);
+	cms.unmark_all();
+	EXPECT_EQ(nb_marked_vertices(cms), 0u);
+	EXPECT_TRUE(cms.marked_cells().empty());
+}
+
+} // namespace cgogn
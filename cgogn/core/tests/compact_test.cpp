@@ -0,0 +1,167 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/types/cell_marker.h>
+
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+namespace cgogn
+{
+
+using Vertex = CMap2::Vertex;
+using Edge = CMap2::Edge;
+using Face = CMap2::Face;
+using Volume = CMap2::Volume;
+
+class CompactTest : public ::testing::Test
+{
+protected:
+	CompactTest()
+	{
+		vertex_tag_ = add_attribute<uint32, Vertex>(map_, "tag");
+		face_tag_ = add_attribute<uint32, Face>(map_, "tag");
+		for (uint32 i = 0u; i < 600u; ++i)
+		{
+			add_prism(map_, 4u);
+			if (i % 10u == 0u)
+				add_face(map_, 5u);
+		}
+		uint32 tag = 0u;
+		foreach_cell(map_, [&](Vertex v) -> bool {
+			value<uint32>(map_, vertex_tag_, v) = tag++;
+			return true;
+		});
+		foreach_cell(map_, [&](Face f) -> bool {
+			value<uint32>(map_, face_tag_, f) = tag++;
+			return true;
+		});
+
+		// free darts, vertex & face indices all over the containers
+		std::vector<Volume> volumes;
+		foreach_cell(map_, [&](Volume v) -> bool {
+			volumes.push_back(v);
+			return true;
+		});
+		for (uint32 i = 0u; i < uint32(volumes.size()); i += 3u)
+			remove_volume(map_, volumes[i]);
+		std::vector<Edge> edges;
+		foreach_cell(map_, [&](Edge e) -> bool {
+			if (!is_incident_to_boundary(map_, e))
+				edges.push_back(e);
+			return true;
+		});
+		for (uint32 i = 0u; i < uint32(edges.size()); i += 17u)
+			merge_incident_faces(map_, edges[i]);
+	}
+
+	template <typename CELL>
+	uint32 nb_elements() const
+	{
+		return map_.attribute_containers_[CELL::ORBIT].nb_elements();
+	}
+
+	template <typename CELL>
+	uint32 maximum_index() const
+	{
+		return map_.attribute_containers_[CELL::ORBIT].maximum_index();
+	}
+
+	template <typename CELL>
+	std::vector<std::pair<CELL, uint32>> tagged_cells(const std::shared_ptr<CMap2::Attribute<uint32>>& tag)
+	{
+		std::vector<std::pair<CELL, uint32>> cells;
+		foreach_cell(map_, [&](CELL c) -> bool {
+			cells.emplace_back(c, value<uint32>(map_, tag, c));
+			return true;
+		});
+		return cells;
+	}
+
+	CMap2 map_;
+	std::shared_ptr<CMap2::Attribute<uint32>> vertex_tag_;
+	std::shared_ptr<CMap2::Attribute<uint32>> face_tag_;
+};
+
+TEST_F(CompactTest, Compact)
+{
+	ASSERT_LT(nb_elements<Vertex>(), maximum_index<Vertex>());
+	ASSERT_LT(nb_elements<Face>(), maximum_index<Face>());
+	ASSERT_LT(map_.darts_.nb_elements(), map_.darts_.maximum_index());
+
+	const uint32 nbv = nb_cells<Vertex>(map_);
+	const uint32 nbe = nb_cells<Edge>(map_);
+	const uint32 nbf = nb_cells<Face>(map_);
+	const uint32 nbvol = nb_cells<Volume>(map_);
+	uint32 nb_boundary_darts = 0u;
+	for (Dart d = map_.begin(), end = map_.end(); d != end; d = map_.next(d))
+		nb_boundary_darts += is_boundary(map_, d) ? 1u : 0u;
+	ASSERT_GT(nb_boundary_darts, 0u);
+
+	const auto vertices = tagged_cells<Vertex>(vertex_tag_);
+	const auto faces = tagged_cells<Face>(face_tag_);
+	std::vector<uint32> vertices_indices;
+	for (const auto& [v, tag] : vertices)
+		vertices_indices.push_back(index_of(map_, v));
+
+	// a marker held across the compaction
+	CellMarker<CMap2, Vertex> marker(map_);
+	for (uint32 i = 0u; i < uint32(vertices.size()); i += 2u)
+		marker.mark(vertices[i].first);
+
+	const MapCompaction mc = compact(map_);
+
+	EXPECT_TRUE(check_integrity(map_, false));
+	EXPECT_EQ(nb_cells<Vertex>(map_), nbv);
+	EXPECT_EQ(nb_cells<Edge>(map_), nbe);
+	EXPECT_EQ(nb_cells<Face>(map_), nbf);
+	EXPECT_EQ(nb_cells<Volume>(map_), nbvol);
+	uint32 nb_boundary_darts_after = 0u;
+	for (Dart d = map_.begin(), end = map_.end(); d != end; d = map_.next(d))
+		nb_boundary_darts_after += is_boundary(map_, d) ? 1u : 0u;
+	EXPECT_EQ(nb_boundary_darts_after, nb_boundary_darts);
+
+	EXPECT_EQ(maximum_index<Vertex>(), nb_elements<Vertex>());
+	EXPECT_EQ(maximum_index<Face>(), nb_elements<Face>());
+	EXPECT_EQ(map_.darts_.maximum_index(), map_.darts_.nb_elements());
+
+	// the attributes, the marks and the cells indices follow the cells
+	for (uint32 i = 0u; i < uint32(vertices.size()); ++i)
+	{
+		const Vertex v = compacted_cell(mc, vertices[i].first);
+		EXPECT_EQ(value<uint32>(map_, vertex_tag_, v), vertices[i].second);
+		EXPECT_EQ(index_of(map_, v), mc.cells_indices_[Vertex::ORBIT][vertices_indices[i]]);
+		EXPECT_EQ(marker.is_marked(v), i % 2u == 0u);
+	}
+	for (const auto& [f, tag] : faces)
+		EXPECT_EQ(value<uint32>(map_, face_tag_, compacted_cell(mc, f)), tag);
+}
+
+} // namespace cgogn
@@ -0,0 +1,125 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/types/cell_marker.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace cgogn
+{
+
+class ParallelTraversalTest : public ::testing::Test
+{
+protected:
+	static const uint32 NB_WORKERS = 4u;
+
+	ParallelTraversalTest() : pool_(NB_WORKERS), scope_(&pool_)
+	{
+		add_attribute<uint32, CMap2::Vertex>(map_, "vertex");
+		add_attribute<uint32, CMap2::Face>(map_, "face");
+		// closed volumes and faces with boundary, over several chunks of darts
+		for (uint32 i = 0u; i < 2000u; ++i)
+		{
+			add_prism(map_, 3u + i % 5u);
+			add_face(map_, 3u + i % 4u);
+		}
+	}
+
+	template <typename CELL>
+	std::vector<Dart> sequential_cells()
+	{
+		std::vector<Dart> darts;
+		foreach_cell(map_, [&](CELL c) -> bool {
+			darts.push_back(c.dart_);
+			return true;
+		});
+		return darts;
+	}
+
+	template <typename CELL>
+	std::vector<Dart> parallel_cells()
+	{
+		std::mutex mutex;
+		std::vector<Dart> darts;
+		parallel_foreach_cell(map_, [&](CELL c) -> bool {
+			std::lock_guard<std::mutex> lock(mutex);
+			darts.push_back(c.dart_);
+			return true;
+		});
+		std::sort(darts.begin(), darts.end(), [](Dart a, Dart b) { return a.index_ < b.index_; });
+		return darts;
+	}
+
+	template <typename CELL>
+	std::vector<Dart> chunked_cells()
+	{
+		std::vector<std::vector<Dart>> chunks(nb_cell_chunks<CELL>(map_));
+		parallel_foreach_cell_by_chunk(map_, [&](CELL c, uint32 chunk) -> bool {
+			chunks[chunk].push_back(c.dart_);
+			return true;
+		});
+		std::vector<Dart> darts;
+		for (const std::vector<Dart>& chunk : chunks)
+			darts.insert(darts.end(), chunk.begin(), chunk.end());
+		return darts;
+	}
+
+	CMap2 map_;
+	ThreadPool pool_;
+	ThreadPoolScope scope_;
+};
+
+TEST_F(ParallelTraversalTest, IndexedCells)
+{
+	EXPECT_EQ(parallel_cells<CMap2::Vertex>(), sequential_cells<CMap2::Vertex>());
+	EXPECT_EQ(chunked_cells<CMap2::Vertex>(), sequential_cells<CMap2::Vertex>());
+	EXPECT_EQ(parallel_cells<CMap2::Face>(), sequential_cells<CMap2::Face>());
+	EXPECT_EQ(chunked_cells<CMap2::Face>(), sequential_cells<CMap2::Face>());
+}
+
+TEST_F(ParallelTraversalTest, NonIndexedCells)
+{
+	EXPECT_EQ(parallel_cells<CMap2::Edge>(), sequential_cells<CMap2::Edge>());
+	EXPECT_EQ(chunked_cells<CMap2::Edge>(), sequential_cells<CMap2::Edge>());
+	EXPECT_EQ(parallel_cells<CMap2::Volume>(), sequential_cells<CMap2::Volume>());
+	EXPECT_EQ(chunked_cells<CMap2::Volume>(), sequential_cells<CMap2::Volume>());
+}
+
+TEST_F(ParallelTraversalTest, Stop)
+{
+	std::atomic<uint32> nb_calls(0u);
+	parallel_foreach_cell(map_, [&](CMap2::Edge) -> bool { return ++nb_calls < 10u; });
+	EXPECT_GE(nb_calls.load(), 10u);
+	EXPECT_LT(nb_calls.load(), uint32(sequential_cells<CMap2::Edge>().size()));
+}
+
+} // namespace cgogn
@@ -0,0 +1,132 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/types/cell_marker.h>
+#include <cgogn/core/utils/thread.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace cgogn
+{
+
+// thread indices of the workers that run the calls of a fork_join on the given pool
+std::set<uint32> worker_thread_indices(ThreadPool& pool)
+{
+	std::mutex mutex;
+	std::set<uint32> indices;
+	pool.fork_join(64u * pool.nb_workers(), [&](uint32) {
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+		std::lock_guard<std::mutex> lock(mutex);
+		indices.insert(current_thread_index());
+	});
+	return indices;
+}
+
+TEST(ThreadPoolTest, UniqueThreadIndices)
+{
+	ThreadPool& global_pool = *thread_pool();
+	ThreadPool pool(global_pool.max_nb_workers() + 4u);
+
+	const std::set<uint32> global_indices = worker_thread_indices(global_pool);
+	const std::set<uint32> indices = worker_thread_indices(pool);
+	EXPECT_EQ(indices.count(0u), 0u);
+	EXPECT_EQ(global_indices.count(0u), 0u);
+	for (uint32 i : indices)
+	{
+		EXPECT_EQ(global_indices.count(i), 0u);
+		EXPECT_LT(i, max_nb_threads());
+	}
+}
+
+TEST(ThreadPoolTest, NoWorker)
+{
+	// (the default pool of a single core machine)
+	ThreadPool pool(0u);
+	ThreadPoolScope scope(&pool);
+
+	bool done = false;
+	std::future<void> future = pool.enqueue([&]() { done = true; });
+	EXPECT_TRUE(done);
+	EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+
+	uint32 sum = 0u;
+	pool.fork_join(100u, [&](uint32 i) { sum += i; });
+	EXPECT_EQ(sum, 4950u);
+
+	CMap2 m;
+	for (uint32 i = 0u; i < 100u; ++i)
+		add_prism(m, 3u + i % 5u);
+	uint32 nb_volumes = 0u;
+	parallel_foreach_cell(m, [&](CMap2::Volume) -> bool {
+		++nb_volumes;
+		return true;
+	});
+	EXPECT_EQ(nb_volumes, 100u);
+}
+
+TEST(ThreadPoolTest, MarkersInAnotherPool)
+{
+	// the map is created before the pool: the workers of the pool are not covered by its per-thread mark attributes
+	CMap2 m;
+	for (uint32 i = 0u; i < 2000u; ++i)
+		add_prism(m, 3u + i % 5u);
+
+	ThreadPool pool(thread_pool()->max_nb_workers() + 4u);
+	ThreadPoolScope scope(&pool);
+
+	// each volume counts its faces with a marker
+	std::atomic<uint32> nb_faces(0u);
+	parallel_foreach_cell(m, [&](CMap2::Volume v) -> bool {
+		DartMarker dm(m);
+		foreach_dart_of_orbit(m, v, [&](Dart d) -> bool {
+			if (!dm.is_marked(d))
+			{
+				foreach_dart_of_orbit(m, CMap2::Face(d), [&](Dart fd) -> bool {
+					dm.mark(fd);
+					return true;
+				});
+				++nb_faces;
+			}
+			return true;
+		});
+		return true;
+	});
+
+	uint32 expected = 0u;
+	for (uint32 i = 0u; i < 2000u; ++i)
+		expected += 5u + i % 5u;
+	EXPECT_EQ(nb_faces.load(), expected);
+}
+
+} // namespace cgogn
@@ -0,0 +1,183 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/traversals/edge.h>
+#include <cgogn/core/functions/traversals/face.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/types/cell_marker.h>
+#include <cgogn/core/types/mesh_views/topology_snapshot.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <cgogn/geometry/algos/normal.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace cgogn
+{
+
+using Vec3 = geometry::Vec3;
+using Vertex = CMap2::Vertex;
+using Edge = CMap2::Edge;
+using Face = CMap2::Face;
+
+class TopologySnapshotTest : public ::testing::Test
+{
+protected:
+	TopologySnapshotTest() : pool_(4u), scope_(&pool_), snapshot_(map_)
+	{
+		position_ = add_attribute<Vec3, Vertex>(map_, "position");
+		add_attribute<uint32, Edge>(map_, "edge");
+		add_attribute<uint32, Face>(map_, "face");
+		// closed volumes, faces with boundary and unused indices, over several chunks of cells
+		std::vector<CMap2::Volume> volumes;
+		for (uint32 i = 0u; i < 1500u; ++i)
+		{
+			volumes.push_back(add_prism(map_, 3u + i % 5u));
+			if (i % 10u == 0u)
+				add_face(map_, 4u);
+		}
+		for (uint32 i = 0u; i < uint32(volumes.size()); i += 7u)
+			remove_volume(map_, volumes[i]);
+		foreach_cell(map_, [&](Vertex v) -> bool {
+			const uint32 i = index_of(map_, v);
+			value<Vec3>(map_, position_, v) = Vec3(std::cos(i * 0.37), std::sin(i * 1.13), double(i % 11u));
+			return true;
+		});
+	}
+
+	// the indices of the cells given by the local traversals of the map or of the snapshot
+
+	template <typename MESH>
+	std::vector<uint32> adjacent_vertices(const MESH& m, Vertex v)
+	{
+		std::vector<uint32> indices;
+		foreach_adjacent_vertex_through_edge(m, v, [&](Vertex av) -> bool {
+			indices.push_back(index_of(map_, av));
+			return true;
+		});
+		return indices;
+	}
+
+	template <typename MESH>
+	std::vector<uint32> incident_faces(const MESH& m, Vertex v)
+	{
+		std::vector<uint32> indices;
+		foreach_incident_face(m, v, [&](Face f) -> bool {
+			indices.push_back(index_of(map_, f));
+			return true;
+		});
+		return indices;
+	}
+
+	template <typename MESH, typename CELL>
+	std::vector<uint32> incident_vertices(const MESH& m, CELL c)
+	{
+		std::vector<uint32> indices;
+		foreach_incident_vertex(m, c, [&](Vertex v) -> bool {
+			indices.push_back(index_of(map_, v));
+			return true;
+		});
+		return indices;
+	}
+
+	CMap2 map_;
+	ThreadPool pool_;
+	ThreadPoolScope scope_;
+	TopologySnapshot<CMap2> snapshot_;
+	std::shared_ptr<CMap2::Attribute<Vec3>> position_;
+};
+
+TEST_F(TopologySnapshotTest, Validity)
+{
+	EXPECT_FALSE(snapshot_.is_valid());
+	snapshot_.build();
+	EXPECT_TRUE(snapshot_.is_valid());
+	EXPECT_TRUE(snapshot_.has_edges());
+	EXPECT_TRUE(snapshot_.has_faces());
+
+	Edge e;
+	foreach_cell(map_, [&](Edge ee) -> bool {
+		e = ee;
+		return false;
+	});
+	cut_edge(map_, e);
+	EXPECT_FALSE(snapshot_.is_valid());
+	snapshot_.build();
+	EXPECT_TRUE(snapshot_.is_valid());
+
+	// the indices of the cells change
+	compact(map_);
+	EXPECT_FALSE(snapshot_.is_valid());
+}
+
+TEST_F(TopologySnapshotTest, Relations)
+{
+	snapshot_.build();
+	ASSERT_TRUE(snapshot_.is_valid());
+
+	foreach_cell(map_, [&](Vertex v) -> bool {
+		EXPECT_EQ(adjacent_vertices(snapshot_, v), adjacent_vertices(map_, v));
+		EXPECT_EQ(incident_faces(snapshot_, v), incident_faces(map_, v));
+		return true;
+	});
+	foreach_cell(map_, [&](Edge e) -> bool {
+		EXPECT_EQ(incident_vertices(snapshot_, e), incident_vertices(map_, e));
+		return true;
+	});
+	foreach_cell(map_, [&](Face f) -> bool {
+		EXPECT_EQ(incident_vertices(snapshot_, f), incident_vertices(map_, f));
+		return true;
+	});
+}
+
+TEST_F(TopologySnapshotTest, Normals)
+{
+	snapshot_.build();
+	ASSERT_TRUE(snapshot_.is_valid());
+
+	auto ts_vertex_normal = add_attribute<Vec3, Vertex>(map_, "ts_vertex_normal");
+	auto vertex_normal = add_attribute<Vec3, Vertex>(map_, "vertex_normal");
+	geometry::compute_normal<Vertex>(snapshot_, position_.get(), ts_vertex_normal.get());
+	geometry::compute_normal<Vertex>(map_, position_.get(), vertex_normal.get());
+	foreach_cell(map_, [&](Vertex v) -> bool {
+		EXPECT_NEAR((value<Vec3>(map_, ts_vertex_normal, v) - value<Vec3>(map_, vertex_normal, v)).norm(), 0.0, 1e-12);
+		return true;
+	});
+
+	auto ts_face_normal = add_attribute<Vec3, Face>(map_, "ts_face_normal");
+	auto face_normal = add_attribute<Vec3, Face>(map_, "face_normal");
+	geometry::compute_normal<Face>(snapshot_, position_.get(), ts_face_normal.get());
+	geometry::compute_normal<Face>(map_, position_.get(), face_normal.get());
+	foreach_cell(map_, [&](Face f) -> bool {
+		EXPECT_NEAR((value<Vec3>(map_, ts_face_normal, f) - value<Vec3>(map_, face_normal, f)).norm(), 0.0, 1e-12);
+		return true;
+	});
+}
+
+} // namespace cgogn
@@ -41,24 +41,24 @@ class CellMarker
 private:
 	const MESH& mesh_;
 	typename mesh_traits<MESH>::MarkAttribute* mark_attribute_;
+	uint8 generation_;
 
 public:
 	CellMarker(const MESH& mesh) : mesh_(mesh)
 	{
-		mark_attribute_ = get_mark_attribute<CELL>(mesh_);
+		mark_attribute_ = get_mark_attribute<CELL>(mesh_, generation_);
 	}
 
 	~CellMarker()
 	{
-		unmark_all();
-		release_mark_attribute<CELL>(mesh_, mark_attribute_);
+		release_mark_attribute<CELL>(mesh_, mark_attribute_, generation_);
 	}
 
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(CellMarker);
 
 	inline void mark(CELL c)
 	{
-		(*mark_attribute_)[index_of(mesh_, c)] = 1u;
+		(*mark_attribute_)[index_of(mesh_, c)] = generation_;
 	}
 	inline void unmark(CELL c)
 	{
@@ -67,12 +67,17 @@ public:
 
 	inline bool is_marked(CELL c) const
 	{
-		return (*mark_attribute_)[index_of(mesh_, c)] != 0u;
+		return (*mark_attribute_)[index_of(mesh_, c)] == generation_;
 	}
 
+	// O(1): the marks of the previous generation are not considered anymore
 	inline void unmark_all()
 	{
-		mark_attribute_->fill(0u);
+		if (++generation_ == 0u) // the generation value wrapped: actually clear the marks
+		{
+			mark_attribute_->fill(0u);
+			generation_ = 1u;
+		}
 	}
 };
 
@@ -82,19 +87,21 @@ class CellMarkerStore
 private:
 	const MESH& mesh_;
 	typename mesh_traits<MESH>::MarkAttribute* mark_attribute_;
+	uint8 generation_;
 	std::vector<uint32> marked_cells_;
 
 public:
 	inline CellMarkerStore(const MESH& mesh) : mesh_(mesh)
 	{
-		mark_attribute_ = get_mark_attribute<CELL>(mesh_);
+		mark_attribute_ = get_mark_attribute<CELL>(mesh_, generation_);
 		marked_cells_.reserve(512u);
 	}
 
 	~CellMarkerStore()
 	{
 		unmark_all();
-		release_mark_attribute<CELL>(mesh_, mark_attribute_);
+		// all the marks have been removed: the current generation value can be reused
+		release_mark_attribute<CELL>(mesh_, mark_attribute_, uint8(generation_ - 1u));
 	}
 
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(CellMarkerStore);
@@ -104,7 +111,7 @@ public:
 		if (!is_marked(c))
 		{
 			uint32 index = index_of(mesh_, c);
-			(*mark_attribute_)[index] = 1u;
+			(*mark_attribute_)[index] = generation_;
 			marked_cells_.push_back(index);
 		}
 	}
@@ -123,7 +130,7 @@ public:
 
 	inline bool is_marked(CELL c) const
 	{
-		return (*mark_attribute_)[index_of(mesh_, c)] != 0u;
+		return (*mark_attribute_)[index_of(mesh_, c)] == generation_;
 	}
 
 	inline void unmark_all()
@@ -67,13 +67,16 @@ AttributeContainerGen::AttributeContainerGen() : nb_elements_(0), maximum_index_
 	attributes_.reserve(32);
 	attributes_shared_ptr_.reserve(32);
 
-	uint32 max = max_nb_threads();
+	// + 1 slot shared by the threads whose index is not covered
+	uint32 max = max_nb_threads() + 1;
 
 	mark_attributes_.resize(max);
+	mark_attributes_generation_.resize(max);
 	available_mark_attributes_.resize(max);
 	for (uint32 i = 0; i < max; ++i)
 	{
 		mark_attributes_[i].reserve(32);
+		mark_attributes_generation_[i].reserve(32);
 		available_mark_attributes_[i].reserve(32);
 	}
 
@@ -114,6 +117,7 @@ uint32 AttributeContainerGen::new_index()
 	}
 
 	init_ref_counter(index);
+	set_live(index, true);
 
 	++nb_elements_;
 	return index;
@@ -124,9 +128,35 @@ void AttributeContainerGen::release_index(uint32 index)
 	cgogn_message_assert(nb_refs(index) > 0, "Trying to release an unused index");
 	available_indices_.push_back(index);
 	reset_ref_counter(index);
+	set_live(index, false);
 	--nb_elements_;
 }
 
+void AttributeContainerGen::restore_indices(uint32 nb_elements, uint32 maximum_index,
+											const std::vector<uint32>& available_indices,
+											const std::vector<uint64>& live)
+{
+	nb_elements_ = nb_elements;
+	maximum_index_ = maximum_index;
+	available_indices_ = available_indices;
+	live_ = live;
+
+	if (maximum_index_ == 0u)
+		return;
+
+	for (AttributeGenT* ag : attributes_)
+		ag->manage_index(maximum_index_);
+	{
+		std::lock_guard<std::mutex> lock(mark_attributes_mutex_);
+		for (uint32 i = 0, nb = uint32(mark_attributes_.size()); i < nb; ++i)
+		{
+			for (AttributeGenT* ag : mark_attributes_[i])
+				ag->manage_index(maximum_index_);
+		}
+	}
+	manage_ref_counter(maximum_index_);
+}
+
 void AttributeContainerGen::remove_attribute(const std::shared_ptr<AttributeGenT>& attribute)
 {
 	auto it = std::find(attributes_shared_ptr_.begin(), attributes_shared_ptr_.end(), attribute);
@@ -158,6 +188,7 @@ void AttributeContainerGen::clear_attributes()
 			mark_attribute->clear();
 	}
 	available_indices_.clear();
+	live_.clear();
 	nb_elements_ = 0;
 	maximum_index_ = 0;
 }
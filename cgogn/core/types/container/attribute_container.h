@@ -41,6 +41,71 @@ class AttributeContainerGen;
 template <template <typename> class AttributeT>
 class AttributeContainerT;
 
+//////////////////////////
+// AttributeBlock class //
+//////////////////////////
+
+// contiguous storage of the values of the indices [first_index_, first_index_ + size_) of an attribute
+// bit i of the occupancy mask tells if the index first_index_ + i is used (nullptr mask means that all are used)
+template <typename T>
+struct AttributeBlock
+{
+	T* data_;
+	uint32 first_index_;
+	uint32 size_;
+	const uint64* mask_;
+
+	inline T* begin() const
+	{
+		return data_;
+	}
+	inline T* end() const
+	{
+		return data_ + size_;
+	}
+	inline uint32 size() const
+	{
+		return size_;
+	}
+
+	inline bool is_used(uint32 i) const
+	{
+		return mask_ == nullptr || (mask_[i / 64u] & (uint64(1u) << (i % 64u))) != 0u;
+	}
+
+	// calls f on the value of each used index (runs of 64 used indices are processed as plain loops)
+	template <typename FUNC>
+	inline void foreach_value(const FUNC& f) const
+	{
+		if (mask_ == nullptr)
+		{
+			for (uint32 i = 0; i < size_; ++i)
+				f(data_[i]);
+			return;
+		}
+		for (uint32 w = 0, nb_words = (size_ + 63u) / 64u; w < nb_words; ++w)
+		{
+			uint64 bits = mask_[w];
+			if (bits == ~uint64(0u) && (w + 1u) * 64u <= size_)
+			{
+				for (T* v = data_ + w * 64u, *end = v + 64u; v != end; ++v)
+					f(*v);
+			}
+			else
+			{
+				while (bits != 0u)
+				{
+					uint32 i = w * 64u + count_trailing_zeros(bits);
+					if (i >= size_)
+						break;
+					f(data_[i]);
+					bits &= bits - 1u;
+				}
+			}
+		}
+	}
+};
+
 /////////////////////////
 // AttributeGenT class //
 /////////////////////////
@@ -72,6 +137,8 @@ private:
 	virtual void clear() = 0;
 	virtual std::shared_ptr<AttributeGenT> create_in(AttributeContainerGen& container) const = 0;
 	virtual void copy(const AttributeGenT& src) = 0;
+	// moves the value of each index i to old_new_indices[i] (always <= i) and releases the storage beyond size
+	virtual void compact(const std::vector<uint32>& old_new_indices, uint32 size) = 0;
 };
 
 /////////////////////////////////
@@ -116,10 +183,7 @@ public:
 
 	inline uint32 first_index() const
 	{
-		uint32 index = 0u;
-		while (index < maximum_index_ && nb_refs(index) == 0)
-			++index;
-		return index;
+		return live_index_from(0u);
 	}
 
 	inline uint32 last_index() const
@@ -129,23 +193,66 @@ public:
 
 	inline uint32 next_index(uint32 index) const
 	{
-		do
-		{
-			++index;
-		} while (index < maximum_index_ && nb_refs(index) == 0);
-		return index;
+		++index;
+		if (is_live(index)) // dense case
+			return index;
+		return live_index_from(index);
+	}
+
+	// occupancy mask of the indices starting at the given index (which must be a multiple of 64)
+	inline const uint64* live_mask(uint32 index) const
+	{
+		cgogn_message_assert(index % 64u == 0u, "live_mask: index must be a multiple of 64");
+		return live_.data() + index / 64u;
+	}
+
+	inline bool is_live(uint32 index) const
+	{
+		return index < maximum_index_ && (live_[index / 64u] & (uint64(1u) << (index % 64u))) != 0u;
+	}
+
+	// state of the indices management (used to save a container, see io/binary/cgb.h)
+	inline const std::vector<uint32>& available_indices() const
+	{
+		return available_indices_;
+	}
+	inline const std::vector<uint64>& live_indices() const
+	{
+		return live_;
 	}
 
+	// restores a saved state of the indices management (the attributes values have to be restored afterwards)
+	// all the attributes, mark attributes and ref counters are resized to cover the restored indices
+	void restore_indices(uint32 nb_elements, uint32 maximum_index, const std::vector<uint32>& available_indices,
+						 const std::vector<uint64>& live);
+
 protected:
 	std::vector<AttributeGenT*> attributes_;
 	std::vector<std::shared_ptr<AttributeGenT>> attributes_shared_ptr_;
 
+	// the mark attributes are pooled per thread index (no locking needed), except the last slot that is shared by the
+	// threads whose index was not covered when the container was created (guarded by mark_attributes_mutex_)
 	std::mutex mark_attributes_mutex_;
 	std::vector<std::vector<AttributeGenT*>> mark_attributes_;
+	// last generation value that may still be stored in each mark attribute
+	std::vector<std::vector<uint8>> mark_attributes_generation_;
 	std::vector<std::vector<uint32>> available_mark_attributes_;
 
+	inline uint32 shared_mark_attributes_slot() const
+	{
+		return uint32(mark_attributes_.size()) - 1u;
+	}
+	inline uint32 mark_attributes_slot() const
+	{
+		return std::min(current_thread_index(), shared_mark_attributes_slot());
+	}
+
 	std::vector<uint32> available_indices_;
 
+	// one bit per index, set for the used indices (never set beyond maximum_index_)
+	// used to traverse the indices without looking at the ref counters
+	std::vector<uint64> live_;
+
 	uint32 nb_elements_;
 	uint32 maximum_index_;
 
@@ -153,7 +260,37 @@ protected:
 
 	void delete_attribute(AttributeGenT* attribute);
 
+	// returns the first used index >= index (maximum_index_ if there is none)
+	inline uint32 live_index_from(uint32 index) const
+	{
+		if (index >= maximum_index_)
+			return maximum_index_;
+		uint32 word = index / 64u;
+		uint64 bits = live_[word] & (~uint64(0u) << (index % 64u));
+		const uint32 nb_words = uint32(live_.size());
+		while (bits == 0u)
+		{
+			if (++word == nb_words)
+				return maximum_index_;
+			bits = live_[word];
+		}
+		// no bit is set beyond maximum_index_
+		return word * 64u + count_trailing_zeros(bits);
+	}
+
+	inline void set_live(uint32 index, bool b)
+	{
+		uint32 word = index / 64u;
+		if (word >= uint32(live_.size()))
+			live_.resize(word + 1u, 0u);
+		if (b)
+			live_[word] |= uint64(1u) << (index % 64u);
+		else
+			live_[word] &= ~(uint64(1u) << (index % 64u));
+	}
+
 	virtual void init_ref_counter(uint32 index) = 0;
+	virtual void manage_ref_counter(uint32 index) = 0;
 	virtual void reset_ref_counter(uint32 index) = 0;
 	virtual uint32 nb_refs(uint32 index) const = 0;
 	virtual void init_mark_attributes(uint32 index) = 0;
@@ -182,6 +319,11 @@ protected:
 		(*ref_counter_)[index] = 1u;
 	}
 
+	inline void manage_ref_counter(uint32 index) override
+	{
+		static_cast<AttributeGenT*>(ref_counter_.get())->manage_index(index);
+	}
+
 	inline void reset_ref_counter(uint32 index) override
 	{
 		(*ref_counter_)[index] = 0u;
@@ -208,15 +350,23 @@ public:
 	AttributeContainerT() : AttributeContainerGen()
 	{
 		ref_counter_ = std::make_unique<Attribute<uint32>>(nullptr, "__refs");
+		// the counter of an index is set when it is created
+		ref_counter_->set_zero_initialization(false);
 	}
 
 	~AttributeContainerT()
 	{
 	}
 
+	inline Attribute<uint32>* ref_counter() const
+	{
+		return ref_counter_.get();
+	}
+
 	void copy(const AttributeContainerT<AttributeT>& src)
 	{
 		available_indices_ = src.available_indices_;
+		live_ = src.live_;
 
 		nb_elements_ = src.nb_elements_;
 		maximum_index_ = src.maximum_index_;
@@ -277,14 +427,28 @@ public:
 		return std::shared_ptr<Attribute<T>>();
 	}
 
-	MarkAttribute* get_mark_attribute()
-	{	
-		uint32 thread_index = current_thread_index();
+	// Mark attributes are not cleared when released to the pool: a marker marks the elements with its
+	// generation value and the pool hands out the next generation value on each acquisition, so that
+	// the marks left by previous users are seen as unmarked. The values are only actually cleared when
+	// the generation value wraps.
+	MarkAttribute* get_mark_attribute(uint8& generation)
+	{
+		uint32 thread_index = mark_attributes_slot();
+		std::unique_lock<std::mutex> lock(mark_attributes_mutex_, std::defer_lock);
+		if (thread_index == shared_mark_attributes_slot())
+			lock.lock();
 		if (available_mark_attributes_[thread_index].size() > 0)
 		{
 			uint32 index = available_mark_attributes_[thread_index].back();
 			available_mark_attributes_[thread_index].pop_back();
-			return static_cast<MarkAttribute*>(mark_attributes_[thread_index][index]);
+			MarkAttribute* ap = static_cast<MarkAttribute*>(mark_attributes_[thread_index][index]);
+			generation = mark_attributes_generation_[thread_index][index] + 1u;
+			if (generation == 0u)
+			{
+				ap->fill(0u);
+				generation = 1u;
+			}
+			return ap;
 		}
 		else
 		{
@@ -292,17 +456,64 @@ public:
 			// AttributeContainerT is friend of AttributeGenT
 			static_cast<AttributeGenT*>(ap)->manage_index(maximum_index_);
 			mark_attributes_[thread_index].push_back(ap);
+			mark_attributes_generation_[thread_index].push_back(0u);
+			generation = 1u;
 			return ap;
 		}
 	}
 
-	void release_mark_attribute(MarkAttribute* attribute)
+	// returns a mark attribute filled with 0 (for marks that are set to 0/1 and never released)
+	MarkAttribute* get_mark_attribute()
+	{
+		uint8 generation;
+		MarkAttribute* ap = get_mark_attribute(generation);
+		if (generation > 1u)
+			ap->fill(0u);
+		return ap;
+	}
+
+	// generation is the last generation value that may still be stored in the released attribute
+	void release_mark_attribute(MarkAttribute* attribute, uint8 generation)
 	{
-		uint32 thread_index = current_thread_index();
+		uint32 thread_index = mark_attributes_slot();
+		std::unique_lock<std::mutex> lock(mark_attributes_mutex_, std::defer_lock);
+		if (thread_index == shared_mark_attributes_slot())
+			lock.lock();
 		auto it = std::find(mark_attributes_[thread_index].begin(), mark_attributes_[thread_index].end(), attribute);
 		cgogn_message_assert(it != mark_attributes_[thread_index].end(), "Mark Attribute not found on release");
-		available_mark_attributes_[thread_index].push_back(
-			int32(std::distance(mark_attributes_[thread_index].begin(), it)));
+		uint32 index = uint32(std::distance(mark_attributes_[thread_index].begin(), it));
+		mark_attributes_generation_[thread_index][index] = generation;
+		available_mark_attributes_[thread_index].push_back(index);
+	}
+
+	// renumbers the used indices so that they are contiguous (their relative order is preserved)
+	// returns the old to new indices map (INVALID_INDEX for the indices that were not used)
+	std::vector<uint32> compact()
+	{
+		std::vector<uint32> old_new_indices(maximum_index_, INVALID_INDEX);
+		uint32 new_index = 0u;
+		for (uint32 i = first_index(); i < maximum_index_; i = next_index(i))
+			old_new_indices[i] = new_index++;
+
+		for (AttributeGenT* attribute : attributes_)
+			attribute->compact(old_new_indices, nb_elements_);
+		{
+			std::lock_guard<std::mutex> lock(mark_attributes_mutex_);
+			for (uint32 i = 0, nb = uint32(mark_attributes_.size()); i < nb; ++i)
+			{
+				for (AttributeGenT* mark_attribute : mark_attributes_[i])
+					mark_attribute->compact(old_new_indices, nb_elements_);
+			}
+		}
+		static_cast<AttributeGenT*>(ref_counter_.get())->compact(old_new_indices, nb_elements_);
+
+		available_indices_.clear();
+		maximum_index_ = nb_elements_;
+		live_.assign((maximum_index_ + 63u) / 64u, ~uint64(0u));
+		if (maximum_index_ % 64u != 0u)
+			live_.back() = (uint64(1u) << (maximum_index_ % 64u)) - 1u;
+
+		return old_new_indices;
 	}
 
 	inline void ref_index(uint32 index)
@@ -29,11 +29,18 @@
 #include <cgogn/core/utils/numerics.h>
 
 #include <cgogn/core/types/container/attribute_container.h>
+#include <cgogn/core/types/container/chunk_pool.h>
 
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+// number of elements of the chunks (can be set at configuration time, must be a power of 2)
+#ifndef CGOGN_CHUNK_SIZE
+#define CGOGN_CHUNK_SIZE 1024
+#endif
+
 namespace cgogn
 {
 
@@ -45,24 +52,70 @@ template <typename T>
 class CGOGN_CORE_EXPORT ChunkArray : public AttributeGenT
 {
 public:
-	static const uint32 CHUNK_SIZE = 1024u;
+	static constexpr uint32 CHUNK_SIZE = CGOGN_CHUNK_SIZE;
+	static_assert(CHUNK_SIZE >= 64u && (CHUNK_SIZE & (CHUNK_SIZE - 1u)) == 0u,
+				  "CHUNK_SIZE must be a power of 2 greater or equal to 64");
+	static_assert(alignof(T) <= ChunkPool::ALIGNMENT, "Type alignment not supported by the chunks allocator");
 
 private:
 	std::vector<T*> chunks_;
 	uint32 capacity_;
+	bool zero_initialization_;
+
+	// chunks may be borrowed from an external storage (e.g. a memory mapped file) instead of allocated by the pool:
+	// the chunks that lie in [external_begin_, external_end_) are neither destroyed nor released to the pool and the
+	// storage is kept alive as long as the array uses it
+	std::shared_ptr<const void> external_storage_;
+	const char* external_begin_;
+	const char* external_end_;
+
+	inline T* new_chunk() const
+	{
+		T* chunk = static_cast<T*>(ChunkPool::allocate(sizeof(T) * CHUNK_SIZE));
+		if (zero_initialization_)
+			std::uninitialized_value_construct_n(chunk, CHUNK_SIZE);
+		else
+			std::uninitialized_default_construct_n(chunk, CHUNK_SIZE);
+		return chunk;
+	}
+
+	inline bool is_external(const T* chunk) const
+	{
+		const char* c = reinterpret_cast<const char*>(chunk);
+		return c >= external_begin_ && c < external_end_;
+	}
+
+	inline void delete_chunk(T* chunk) const
+	{
+		if (is_external(chunk))
+			return;
+		std::destroy_n(chunk, CHUNK_SIZE);
+		ChunkPool::release(chunk, sizeof(T) * CHUNK_SIZE);
+	}
+
+	// attributes that do not belong to a container (mark attributes, ref counters) are entirely covered
+	inline uint32 block_last_index() const
+	{
+		return container_ ? container_->last_index() : capacity_;
+	}
+
+	inline const uint64* block_mask(uint32 first_index) const
+	{
+		return container_ ? container_->live_mask(first_index) : nullptr;
+	}
 
 	inline void manage_index(uint32 index) override
 	{
 		while (index >= capacity_)
 		{
-			chunks_.push_back(new T[CHUNK_SIZE]());
+			chunks_.push_back(new_chunk());
 			capacity_ = uint32(chunks_.size()) * CHUNK_SIZE;
 		}
 	}
 
 public:
 	ChunkArray(AttributeContainerGen* container, const std::string& name)
-		: AttributeGenT(container, name)
+		: AttributeGenT(container, name), zero_initialization_(true), external_begin_(nullptr), external_end_(nullptr)
 	{
 		chunks_.reserve(512u);
 		capacity_ = 0u;
@@ -71,7 +124,14 @@ public:
 	~ChunkArray() override
 	{
 		for (auto chunk : chunks_)
-			delete[] chunk;
+			delete_chunk(chunk);
+	}
+
+	// when disabled, the elements of the chunks allocated afterwards are default-initialized (i.e. left uninitialized
+	// for fundamental types): only for attributes whose values are always written before being read
+	inline void set_zero_initialization(bool b)
+	{
+		zero_initialization_ = b;
 	}
 
 	inline T& operator[](uint32 index)
@@ -95,7 +155,34 @@ public:
 	inline void swap(ChunkArray<T>* ca)
 	{
 		if (ca->container_ == this->container_) // only swap from same container
+		{
 			chunks_.swap(ca->chunks_);
+			external_storage_.swap(ca->external_storage_);
+			std::swap(external_begin_, ca->external_begin_);
+			std::swap(external_end_, ca->external_end_);
+		}
+	}
+
+	/**
+	 * @brief replace the chunks of the array by chunks that lie in an external storage
+	 * The storage is kept alive as long as the array uses it. The borrowed chunks are neither destroyed nor released
+	 * to the pool (only for trivially destructible types). Chunks allocated afterwards come from the pool.
+	 * @param chunks pointers to the chunks (of CHUNK_SIZE elements) in the storage
+	 * @param storage owner of the storage
+	 * @param storage_begin, storage_end range of the storage
+	 */
+	inline void adopt_chunks(const std::vector<T*>& chunks, std::shared_ptr<const void> storage,
+							 const char* storage_begin, const char* storage_end)
+	{
+		static_assert(std::is_trivially_destructible_v<T>,
+					  "Only chunks of trivially destructible types can be adopted");
+		for (auto chunk : chunks_)
+			delete_chunk(chunk);
+		chunks_ = chunks;
+		capacity_ = uint32(chunks_.size()) * CHUNK_SIZE;
+		external_storage_ = std::move(storage);
+		external_begin_ = storage_begin;
+		external_end_ = storage_end;
 	}
 
 	inline void copy(ChunkArray<T>* ca)
@@ -108,9 +195,12 @@ public:
 	inline void clear() override
 	{
 		for (auto chunk : chunks_)
-			delete[] chunk;
+			delete_chunk(chunk);
 		chunks_.clear();
 		capacity_ = 0;
+		external_storage_.reset();
+		external_begin_ = nullptr;
+		external_end_ = nullptr;
 	}
 
 	inline std::shared_ptr<AttributeGenT> create_in(AttributeContainerGen& dst) const override
@@ -138,6 +228,71 @@ public:
 		}
 	}
 
+	inline void compact(const std::vector<uint32>& old_new_indices, uint32 size) override
+	{
+		for (uint32 i = 0, end = uint32(old_new_indices.size()); i < end; ++i)
+		{
+			uint32 new_index = old_new_indices[i];
+			if (new_index != INVALID_INDEX && new_index != i)
+				(*this)[new_index] = std::move((*this)[i]);
+		}
+		uint32 nb_chunks = (size + CHUNK_SIZE - 1u) / CHUNK_SIZE;
+		while (uint32(chunks_.size()) > nb_chunks)
+		{
+			delete_chunk(chunks_.back());
+			chunks_.pop_back();
+		}
+		capacity_ = uint32(chunks_.size()) * CHUNK_SIZE;
+	}
+
+	/*************************************************************************/
+	// Contiguous blocks access (one block per chunk)
+	/*************************************************************************/
+
+	using Block = AttributeBlock<T>;
+	using ConstBlock = AttributeBlock<const T>;
+
+	// the blocks cover the indices [0, last_index) of the container
+	inline uint32 nb_blocks() const
+	{
+		return (block_last_index() + CHUNK_SIZE - 1u) / CHUNK_SIZE;
+	}
+
+	inline Block block(uint32 i)
+	{
+		const uint32 first = i * CHUNK_SIZE;
+		return {chunks_[i], first, std::min(CHUNK_SIZE, block_last_index() - first), block_mask(first)};
+	}
+
+	inline ConstBlock block(uint32 i) const
+	{
+		const uint32 first = i * CHUNK_SIZE;
+		return {chunks_[i], first, std::min(CHUNK_SIZE, block_last_index() - first), block_mask(first)};
+	}
+
+	// copies the values of the indices [0, last_index) into a contiguous buffer indexed by the attribute indices
+	inline void flatten(std::vector<T>& buffer) const
+	{
+		buffer.resize(block_last_index());
+		for (uint32 i = 0, nb = nb_blocks(); i < nb; ++i)
+		{
+			ConstBlock b = block(i);
+			std::copy(b.begin(), b.end(), buffer.begin() + b.first_index_);
+		}
+	}
+
+	// copies back the values of the used indices from a buffer filled by flatten
+	inline void scatter(const std::vector<T>& buffer)
+	{
+		cgogn_message_assert(uint32(buffer.size()) >= block_last_index(), "scatter: buffer is too small");
+		for (uint32 i = 0, nb = nb_blocks(); i < nb; ++i)
+		{
+			Block b = block(i);
+			const T* src = buffer.data() + b.first_index_;
+			b.foreach_value([&](T& v) { v = src[&v - b.data_]; });
+		}
+	}
+
 	inline uint32 nb_chunks() const
 	{
 		return uint32(chunks_.size());
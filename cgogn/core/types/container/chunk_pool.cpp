@@ -0,0 +1,172 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/container/chunk_pool.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace cgogn
+{
+
+namespace
+{
+
+struct Arena
+{
+	std::size_t size_;
+	std::size_t alignment_;
+	std::size_t nb_used_chunks_;
+};
+
+struct Pool
+{
+	std::mutex mutex_;
+	std::unordered_map<std::size_t, std::vector<void*>> free_chunks_;
+	// allocated blocks by address
+	std::map<char*, Arena> arenas_;
+	char* current_ = nullptr;
+	std::size_t remaining_ = 0u;
+	bool huge_pages_ = false;
+
+	void* new_arena(std::size_t size)
+	{
+		const std::size_t alignment = huge_pages_ ? ChunkPool::ARENA_SIZE : ChunkPool::ALIGNMENT;
+		void* p = ::operator new(size, std::align_val_t(alignment));
+#if defined(__linux__)
+		if (huge_pages_)
+			madvise(p, size, MADV_HUGEPAGE);
+#endif
+		arenas_.emplace(static_cast<char*>(p), Arena{size, alignment, 0u});
+		return p;
+	}
+
+	Arena& arena_of(void* chunk)
+	{
+		auto it = arenas_.upper_bound(static_cast<char*>(chunk));
+		return (--it)->second;
+	}
+
+	void* use(void* chunk)
+	{
+		++arena_of(chunk).nb_used_chunks_;
+		return chunk;
+	}
+};
+
+// never destroyed: the ChunkArrays with static storage duration may release their chunks after the end of main
+Pool& pool()
+{
+	static Pool* p = new Pool();
+	return *p;
+}
+
+} // namespace
+
+/////////////////////
+// ChunkPool class //
+/////////////////////
+
+void* ChunkPool::allocate(std::size_t size)
+{
+	size = (size + ALIGNMENT - 1u) / ALIGNMENT * ALIGNMENT;
+
+	Pool& p = pool();
+	std::lock_guard<std::mutex> lock(p.mutex_);
+
+	std::vector<void*>& free_chunks = p.free_chunks_[size];
+	if (!free_chunks.empty())
+	{
+		void* chunk = free_chunks.back();
+		free_chunks.pop_back();
+		return p.use(chunk);
+	}
+
+	// large chunks get their own block
+	if (size > ARENA_SIZE / 8u)
+		return p.use(p.new_arena(size));
+
+	if (p.remaining_ < size)
+	{
+		p.current_ = static_cast<char*>(p.new_arena(ARENA_SIZE));
+		p.remaining_ = ARENA_SIZE;
+	}
+	void* chunk = p.current_;
+	p.current_ += size;
+	p.remaining_ -= size;
+	return p.use(chunk);
+}
+
+void ChunkPool::release(void* chunk, std::size_t size)
+{
+	size = (size + ALIGNMENT - 1u) / ALIGNMENT * ALIGNMENT;
+
+	Pool& p = pool();
+	std::lock_guard<std::mutex> lock(p.mutex_);
+	--p.arena_of(chunk).nb_used_chunks_;
+	p.free_chunks_[size].push_back(chunk);
+}
+
+void ChunkPool::trim()
+{
+	Pool& p = pool();
+	std::lock_guard<std::mutex> lock(p.mutex_);
+
+	for (auto& [size, free_chunks] : p.free_chunks_)
+		free_chunks.erase(std::remove_if(free_chunks.begin(), free_chunks.end(),
+										 [&](void* chunk) { return p.arena_of(chunk).nb_used_chunks_ == 0u; }),
+						  free_chunks.end());
+
+	for (auto it = p.arenas_.begin(); it != p.arenas_.end();)
+	{
+		if (it->second.nb_used_chunks_ == 0u)
+		{
+			if (p.current_ >= it->first && p.current_ <= it->first + it->second.size_)
+			{
+				p.current_ = nullptr;
+				p.remaining_ = 0u;
+			}
+			::operator delete(it->first, std::align_val_t(it->second.alignment_));
+			it = p.arenas_.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+void ChunkPool::set_huge_pages(bool b)
+{
+	Pool& p = pool();
+	std::lock_guard<std::mutex> lock(p.mutex_);
+	p.huge_pages_ = b;
+}
+
+} // namespace cgogn
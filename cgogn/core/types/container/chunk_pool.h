@@ -0,0 +1,61 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_CORE_CONTAINER_CHUNK_POOL_H_
+#define CGOGN_CORE_CONTAINER_CHUNK_POOL_H_
+
+#include <cgogn/core/cgogn_core_export.h>
+
+#include <cstddef>
+
+namespace cgogn
+{
+
+/////////////////////
+// ChunkPool class //
+/////////////////////
+
+// Memory of the attributes chunks: chunks are carved out of large arenas and released chunks are kept in free lists
+// (one per chunk byte size) to be reused by the next allocations. The memory is kept by the pool (even when no
+// attribute uses it anymore) until trim is called. The pool itself is never destroyed.
+class CGOGN_CORE_EXPORT ChunkPool
+{
+public:
+	static const std::size_t ALIGNMENT = 64u;
+	static const std::size_t ARENA_SIZE = std::size_t(2u) << 20u; // size of a huge page
+
+	// returns a block of size bytes aligned on ALIGNMENT bytes
+	static void* allocate(std::size_t size);
+	// gives back a block returned by allocate with the same size
+	static void release(void* chunk, std::size_t size);
+	// gives back to the system the arenas of which no chunk is in use
+	static void trim();
+
+	// when enabled, the arenas allocated afterwards are aligned on ARENA_SIZE and advised to be backed by
+	// transparent huge pages (only effective on Linux)
+	static void set_huge_pages(bool b);
+};
+
+} // namespace cgogn
+
+#endif // CGOGN_CORE_CONTAINER_CHUNK_POOL_H_
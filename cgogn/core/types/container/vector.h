@@ -49,6 +49,17 @@ class CGOGN_CORE_EXPORT Vector : public AttributeGenT
 private:
 	std::vector<T> data_;
 
+	// attributes that do not belong to a container (mark attributes, ref counters) are entirely covered
+	inline uint32 block_last_index() const
+	{
+		return container_ ? container_->last_index() : uint32(data_.size());
+	}
+
+	inline const uint64* block_mask() const
+	{
+		return container_ ? container_->live_mask(0u) : nullptr;
+	}
+
 	inline void manage_index(uint32 index) override
 	{
 		while (index >= uint32(data_.size()))
@@ -65,6 +76,11 @@ public:
 	{
 	}
 
+	// the elements are always value-initialized (same interface as ChunkArray)
+	inline void set_zero_initialization(bool)
+	{
+	}
+
 	inline T& operator[](uint32 index)
 	{
 		cgogn_message_assert(index < uint32(data_.size()), "index out of bounds");
@@ -124,6 +140,51 @@ public:
 		}
 	}
 
+	inline void compact(const std::vector<uint32>& old_new_indices, uint32 size) override
+	{
+		for (uint32 i = 0, end = uint32(old_new_indices.size()); i < end; ++i)
+		{
+			uint32 new_index = old_new_indices[i];
+			if (new_index != INVALID_INDEX && new_index != i)
+				data_[new_index] = std::move(data_[i]);
+		}
+		data_.resize(size);
+	}
+
+	/*************************************************************************/
+	// Contiguous blocks access (a single block)
+	/*************************************************************************/
+
+	using Block = AttributeBlock<T>;
+	using ConstBlock = AttributeBlock<const T>;
+
+	// the block covers the indices [0, last_index) of the container
+	inline uint32 nb_blocks() const
+	{
+		return block_last_index() > 0u ? 1u : 0u;
+	}
+
+	inline Block block(uint32)
+	{
+		return {data_.data(), 0u, block_last_index(), block_mask()};
+	}
+
+	inline ConstBlock block(uint32) const
+	{
+		return {data_.data(), 0u, block_last_index(), block_mask()};
+	}
+
+	inline void flatten(std::vector<T>& buffer) const
+	{
+		buffer.assign(data_.begin(), data_.begin() + block_last_index());
+	}
+
+	inline void scatter(const std::vector<T>& buffer)
+	{
+		Block b = block(0u);
+		b.foreach_value([&](T& v) { v = buffer[&v - b.data_]; });
+	}
+
 	inline const void* data_pointer() const
 	{
 		return &data_[0];
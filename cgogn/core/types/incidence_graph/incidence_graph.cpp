@@ -30,6 +30,16 @@
 namespace cgogn
 {
 
+/*************************************************************************/
+// Clear mesh
+/*************************************************************************/
+
+void clear(IncidenceGraph& ig)
+{
+	for (IncidenceGraph::AttributeContainer& container : ig.attribute_containers_)
+		container.clear_attributes();
+}
+
 /*************************************************************************/
 // Operators
 /*************************************************************************/
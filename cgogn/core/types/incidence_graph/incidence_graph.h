@@ -289,6 +289,13 @@ auto foreach_adjacent_face_through_edge(const MESH& ig, typename mesh_traits<MES
 	}
 }
 
+/*************************************************************************/
+// Clear mesh
+/*************************************************************************/
+
+// remove all the cells (the attributes, including the incidence relations, are kept)
+void clear(IncidenceGraph& ig);
+
 /*************************************************************************/
 // Operators
 /*************************************************************************/
@@ -39,6 +39,7 @@
 
 #include <any>
 #include <array>
+#include <atomic>
 #include <unordered_map>
 
 namespace cgogn
@@ -315,19 +316,19 @@ T& get_attribute(IncidenceGraphBase& ig, const std::string& name)
 }
 
 template <typename CELL, typename MESH>
-auto get_mark_attribute(const MESH& m)
+auto get_mark_attribute(const MESH& m, uint8& generation)
 	-> std::enable_if_t<std::is_convertible_v<MESH&, IncidenceGraphBase&>, typename mesh_traits<MESH>::MarkAttribute*>
 {
 	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
-	return m.attribute_containers_[CELL::CELL_INDEX].get_mark_attribute();
+	return m.attribute_containers_[CELL::CELL_INDEX].get_mark_attribute(generation);
 }
 
 template <typename CELL, typename MESH>
-auto release_mark_attribute(const MESH& m, typename mesh_traits<MESH>::MarkAttribute* attribute)
+auto release_mark_attribute(const MESH& m, typename mesh_traits<MESH>::MarkAttribute* attribute, uint8 generation)
 	-> std::enable_if_t<std::is_convertible_v<MESH&, IncidenceGraphBase&>>
 {
 	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
-	return m.attribute_containers_[CELL::CELL_INDEX].release_mark_attribute(attribute);
+	return m.attribute_containers_[CELL::CELL_INDEX].release_mark_attribute(attribute, generation);
 }
 
 /*************************************************************************/
@@ -351,6 +352,48 @@ auto foreach_cell(const MESH& ig, const FUNC& f) -> std::enable_if_t<std::is_con
 	}
 }
 
+// returns the number of chunks used by parallel_foreach_cell_by_chunk for the given CELL type
+template <typename CELL, typename MESH>
+auto nb_cell_chunks(const MESH& m) -> std::enable_if_t<std::is_convertible_v<MESH&, IncidenceGraphBase&>, uint32>
+{
+	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
+	return (m.attribute_containers_[CELL::CELL_INDEX].last_index() + PARALLEL_BUFFER_SIZE - 1u) / PARALLEL_BUFFER_SIZE;
+}
+
+// call the given function on each cell of the given MESH using the workers of the thread pool
+// the function also receives the index of the chunk (in [0, nb_cell_chunks<CELL>(m))) the cell belongs to
+// each chunk is a range of PARALLEL_BUFFER_SIZE indices processed by a single worker
+template <typename MESH, typename FUNC>
+auto parallel_foreach_cell_by_chunk(const MESH& m, const FUNC& f)
+	-> std::enable_if_t<std::is_convertible_v<MESH&, IncidenceGraphBase&>>
+{
+	using CELL = func_parameter_type<FUNC>;
+	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
+	static_assert(is_ith_func_parameter_same<FUNC, 1, uint32>::value, "Wrong function chunk parameter type");
+	static_assert(is_func_return_same<FUNC, bool>::value, "Given function should return a bool");
+
+	const IncidenceGraphBase::AttributeContainer& container = m.attribute_containers_[CELL::CELL_INDEX];
+	const uint32 last = container.last_index();
+
+	std::atomic<bool> stop(false);
+	parallel_foreach_chunk(nb_cell_chunks<CELL>(m), [&](uint32 chunk) -> bool {
+		const uint32 chunk_begin = chunk * PARALLEL_BUFFER_SIZE;
+		const uint32 chunk_end = std::min(last, chunk_begin + PARALLEL_BUFFER_SIZE);
+		for (uint32 i = chunk_begin == 0u ? container.first_index() : container.next_index(chunk_begin - 1u);
+			 i < chunk_end; i = container.next_index(i))
+		{
+			if (stop.load(std::memory_order_relaxed))
+				return false;
+			if (!f(CELL(i), chunk))
+			{
+				stop.store(true, std::memory_order_relaxed);
+				return false;
+			}
+		}
+		return true;
+	});
+}
+
 template <typename MESH, typename FUNC>
 auto parallel_foreach_cell(const MESH& m, const FUNC& f)
 	-> std::enable_if_t<std::is_convertible_v<MESH&, IncidenceGraphBase&>>
@@ -364,63 +407,61 @@ auto parallel_foreach_cell(const MESH& m, const FUNC& f)
 	if (nb_workers == 0)
 		return foreach_cell(m, f);
 
-	using VecCell = std::vector<uint32>;
-	using Future = std::future<void>;
+	parallel_foreach_cell_by_chunk(m, [&](CELL c, uint32) -> bool { return f(c); });
+}
 
-	std::array<std::vector<VecCell*>, 2> cells_buffers;
-	std::array<std::vector<Future>, 2> futures;
-	cells_buffers[0].reserve(nb_workers);
-	cells_buffers[1].reserve(nb_workers);
-	futures[0].reserve(nb_workers);
-	futures[1].reserve(nb_workers);
+/*************************************************************************/
+// Compact incidence graph
+/*************************************************************************/
 
-	Buffers<uint32>* buffers = uint32_buffers();
+// old to new indices maps computed by compact (INVALID_INDEX for the indices that were not used)
+struct IncidenceGraphCompaction
+{
+	// indexed by CELL::CELL_INDEX
+	std::array<std::vector<uint32>, 3> cells_indices_;
+};
 
-	uint32 it = m.attribute_containers_[CELL::CELL_INDEX].first_index();
-	uint32 last = m.attribute_containers_[CELL::CELL_INDEX].last_index();
+// renumbers the vertices, edges & faces so that their indices are contiguous
+// the attributes of the graph follow their elements, the returned maps allow to update the cells held elsewhere
+inline IncidenceGraphCompaction compact(IncidenceGraphBase& ig)
+{
+	using Vertex = IncidenceGraphBase::Vertex;
+	using Edge = IncidenceGraphBase::Edge;
+	using Face = IncidenceGraphBase::Face;
 
-	uint32 i = 0u; // buffer id (0/1)
-	uint32 j = 0u; // thread id (0..nb_workers)
+	IncidenceGraphCompaction igc;
+	for (uint32 i = 0; i < 3; ++i)
+		igc.cells_indices_[i] = ig.attribute_containers_[i].compact();
 
-	while (it < last)
+	const std::vector<uint32>& vertex_indices = igc.cells_indices_[Vertex::CELL_INDEX];
+	const std::vector<uint32>& edge_indices = igc.cells_indices_[Edge::CELL_INDEX];
+	const std::vector<uint32>& face_indices = igc.cells_indices_[Face::CELL_INDEX];
+
+	for (uint32 v = 0, end = ig.attribute_containers_[Vertex::CELL_INDEX].nb_elements(); v < end; ++v)
 	{
-		// fill buffer
-		cells_buffers[i].push_back(buffers->buffer());
-		VecCell& cells = *cells_buffers[i].back();
-		cells.reserve(PARALLEL_BUFFER_SIZE);
-		for (uint32 k = 0u; k < PARALLEL_BUFFER_SIZE && it < last; ++k)
-		{
-			cells.push_back(it);
-			it = m.attribute_containers_[CELL::CELL_INDEX].next_index(it);
-		}
-		// launch thread
-		futures[i].push_back(pool->enqueue([&cells, &f]() {
-			for (uint32 index : cells)
-				f(CELL(index));
-		}));
-		// next thread
-		if (++j == nb_workers)
-		{ // again from 0 & change buffer
-			j = 0u;
-			i = (i + 1u) % 2u;
-			for (auto& fu : futures[i])
-				fu.wait();
-			for (auto& b : cells_buffers[i])
-				buffers->release_buffer(b);
-			futures[i].clear();
-			cells_buffers[i].clear();
-		}
+		for (Edge& e : (*ig.vertex_incident_edges_)[v])
+			e = Edge(edge_indices[e.index_]);
+	}
+	for (uint32 e = 0, end = ig.attribute_containers_[Edge::CELL_INDEX].nb_elements(); e < end; ++e)
+	{
+		std::pair<Vertex, Vertex>& evs = (*ig.edge_incident_vertices_)[e];
+		evs = {Vertex(vertex_indices[evs.first.index_]), Vertex(vertex_indices[evs.second.index_])};
+		for (Face& f : (*ig.edge_incident_faces_)[e])
+			f = Face(face_indices[f.index_]);
+	}
+	for (uint32 f = 0, end = ig.attribute_containers_[Face::CELL_INDEX].nb_elements(); f < end; ++f)
+	{
+		for (Edge& e : (*ig.face_incident_edges_)[f])
+			e = Edge(edge_indices[e.index_]);
 	}
 
-	// clean all at the end
-	for (auto& fu : futures[0u])
-		fu.wait();
-	for (auto& b : cells_buffers[0u])
-		buffers->release_buffer(b);
-	for (auto& fu : futures[1u])
-		fu.wait();
-	for (auto& b : cells_buffers[1u])
-		buffers->release_buffer(b);
+	return igc;
+}
+
+template <typename CELL>
+inline CELL compacted_cell(const IncidenceGraphCompaction& igc, CELL c)
+{
+	return CELL(igc.cells_indices_[CELL::CELL_INDEX][c.index_]);
 }
 
 /*************************************************************************/
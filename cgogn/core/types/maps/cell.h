@@ -170,7 +170,6 @@ struct Cell
 
 	/**
 	 * \brief Converts a cell to an uint32 (dart index, not the index of the cell in the map)
-	 * (used in cell_cache parallel_foreach_cell in order to be able to use a std::vector<uint32> from managed buffers)
 	 */
 	inline operator uint32() const
 	{
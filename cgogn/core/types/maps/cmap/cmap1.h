@@ -88,6 +88,7 @@ inline Dart phi_1(const CMap1& m, Dart d)
 
 inline void phi1_sew(CMap1& m, Dart d, Dart e)
 {
+	++m.topology_version_;
 	Dart f = phi1(m, d);
 	Dart g = phi1(m, e);
 	(*(m.phi1_))[d.index_] = g;
@@ -98,6 +99,7 @@ inline void phi1_sew(CMap1& m, Dart d, Dart e)
 
 inline void phi1_unsew(CMap1& m, Dart d)
 {
+	++m.topology_version_;
 	Dart e = phi1(m, d);
 	Dart f = phi1(m, e);
 	(*(m.phi1_))[d.index_] = f;
@@ -90,6 +90,7 @@ inline Dart phi2(const CMap2& m, Dart d)
 
 inline void phi2_sew(CMap2& m, Dart d, Dart e)
 {
+	++m.topology_version_;
 	cgogn_assert(phi2(m, d) == d);
 	cgogn_assert(phi2(m, e) == e);
 	(*(m.phi2_))[d.index_] = e;
@@ -98,6 +99,7 @@ inline void phi2_sew(CMap2& m, Dart d, Dart e)
 
 inline void phi2_unsew(CMap2& m, Dart d)
 {
+	++m.topology_version_;
 	Dart e = phi2(m, d);
 	(*(m.phi2_))[d.index_] = d;
 	(*(m.phi2_))[e.index_] = e;
@@ -96,6 +96,7 @@ inline Dart phi3(const CMap3& m, Dart d)
 
 inline void phi3_sew(CMap3& m, Dart d, Dart e)
 {
+	++m.topology_version_;
 	cgogn_assert(phi3(m, d) == d);
 	cgogn_assert(phi3(m, e) == e);
 	(*(m.phi3_))[d.index_] = e;
@@ -104,6 +105,7 @@ inline void phi3_sew(CMap3& m, Dart d, Dart e)
 
 inline void phi3_unsew(CMap3& m, Dart d)
 {
+	++m.topology_version_;
 	Dart e = phi3(m, d);
 	(*(m.phi3_))[d.index_] = d;
 	(*(m.phi3_))[e.index_] = e;
@@ -91,12 +91,14 @@ inline Dart alpha_1(const Graph& m, Dart d)
 
 inline void alpha0_sew(Graph& m, Dart d, Dart e)
 {
+	++m.topology_version_;
 	(*m.alpha0_)[d.index_] = e;
 	(*m.alpha0_)[e.index_] = d;
 }
 
 inline void alpha0_unsew(Graph& m, Dart d)
 {
+	++m.topology_version_;
 	Dart e = alpha0(m, d);
 	(*m.alpha0_)[d.index_] = d;
 	(*m.alpha0_)[e.index_] = e;
@@ -104,6 +106,7 @@ inline void alpha0_unsew(Graph& m, Dart d)
 
 inline void alpha1_sew(Graph& m, Dart d, Dart e)
 {
+	++m.topology_version_;
 	Dart f = alpha1(m, d);
 	Dart g = alpha1(m, e);
 	(*m.alpha1_)[d.index_] = g;
@@ -114,6 +117,7 @@ inline void alpha1_sew(Graph& m, Dart d, Dart e)
 
 inline void alpha1_unsew(Graph& m, Dart d)
 {
+	++m.topology_version_;
 	Dart e = alpha1(m, d);
 	Dart f = alpha_1(m, d);
 	(*m.alpha1_)[f.index_] = e;
@@ -40,24 +40,24 @@ class DartMarker
 private:
 	const MAP& map_;
 	typename mesh_traits<MAP>::MarkAttribute* mark_attribute_;
+	uint8 generation_;
 
 public:
 	DartMarker(const MAP& map) : map_(map)
 	{
-		mark_attribute_ = get_dart_mark_attribute(map_);
+		mark_attribute_ = get_dart_mark_attribute(map_, generation_);
 	}
 
 	~DartMarker()
 	{
-		unmark_all();
-		release_dart_mark_attribute(map_, mark_attribute_);
+		release_dart_mark_attribute(map_, mark_attribute_, generation_);
 	}
 
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(DartMarker);
 
 	inline void mark(Dart d)
 	{
-		(*mark_attribute_)[d.index_] = 1u;
+		(*mark_attribute_)[d.index_] = generation_;
 	}
 	inline void unmark(Dart d)
 	{
@@ -66,12 +66,17 @@ public:
 
 	inline bool is_marked(Dart d) const
 	{
-		return (*mark_attribute_)[d.index_] != 0u;
+		return (*mark_attribute_)[d.index_] == generation_;
 	}
 
+	// O(1): the marks of the previous generation are not considered anymore
 	inline void unmark_all()
 	{
-		mark_attribute_->fill(0u);
+		if (++generation_ == 0u) // the generation value wrapped: actually clear the marks
+		{
+			mark_attribute_->fill(0u);
+			generation_ = 1u;
+		}
 	}
 };
 
@@ -81,19 +86,21 @@ class DartMarkerStore
 private:
 	const MAP& map_;
 	typename mesh_traits<MAP>::MarkAttribute* mark_attribute_;
+	uint8 generation_;
 	std::vector<Dart> marked_darts_;
 
 public:
 	DartMarkerStore(const MAP& map) : map_(map)
 	{
-		mark_attribute_ = get_dart_mark_attribute(map_);
+		mark_attribute_ = get_dart_mark_attribute(map_, generation_);
 		marked_darts_.reserve(512u);
 	}
 
 	~DartMarkerStore()
 	{
 		unmark_all();
-		release_dart_mark_attribute(map_, mark_attribute_);
+		// all the marks have been removed: the current generation value can be reused
+		release_dart_mark_attribute(map_, mark_attribute_, uint8(generation_ - 1u));
 	}
 
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(DartMarkerStore);
@@ -102,7 +109,7 @@ public:
 	{
 		if (!is_marked(d))
 		{
-			(*mark_attribute_)[d.index_] = 1u;
+			(*mark_attribute_)[d.index_] = generation_;
 			marked_darts_.push_back(d);
 		}
 	}
@@ -120,7 +127,7 @@ public:
 
 	inline bool is_marked(Dart d) const
 	{
-		return (*mark_attribute_)[d.index_] != 0u;
+		return (*mark_attribute_)[d.index_] == generation_;
 	}
 
 	inline void unmark_all()
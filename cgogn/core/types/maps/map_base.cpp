@@ -28,7 +28,7 @@
 namespace cgogn
 {
 
-MapBase::MapBase()
+MapBase::MapBase() : topology_version_(0u), embedding_version_{}
 {
 	boundary_marker_ = darts_.get_mark_attribute();
 }
@@ -41,6 +41,7 @@ Dart add_dart(MapBase& m)
 {
 	uint32 index = m.darts_.new_index();
 	Dart d(index);
+	++m.topology_version_;
 	for (auto& rel : m.relations_)
 		(*rel)[d.index_] = d;
 	for (auto& emb : m.cells_indices_)
@@ -61,12 +62,14 @@ void remove_dart(MapBase& m, Dart d)
 		}
 	}
 	m.darts_.release_index(d.index_);
+	++m.topology_version_;
 }
 
 void clear(MapBase& m, bool keep_attributes)
 {
 	// clear darts and keep attributes (phi relations)
 	m.darts_.clear_attributes();
+	++m.topology_version_;
 	if (!keep_attributes)
 	{
 		// remove cells indices attributes
@@ -92,6 +95,41 @@ void clear(MapBase& m, bool keep_attributes)
 	}
 }
 
+MapCompaction compact(MapBase& m)
+{
+	MapCompaction mc;
+	++m.topology_version_;
+
+	for (uint32 orbit = 0; orbit < NB_ORBITS; ++orbit)
+	{
+		if (m.cells_indices_[orbit])
+		{
+			mc.cells_indices_[orbit] = m.attribute_containers_[orbit].compact();
+			const std::vector<uint32>& old_new_indices = mc.cells_indices_[orbit];
+			MapBase::Attribute<uint32>& cells_indices = *m.cells_indices_[orbit];
+			for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+			{
+				uint32& index = cells_indices[d.index_];
+				if (index != INVALID_INDEX)
+					index = old_new_indices[index];
+			}
+		}
+	}
+
+	mc.darts_ = m.darts_.compact();
+	for (auto& rel : m.relations_)
+	{
+		for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+		{
+			Dart& e = (*rel)[d.index_];
+			if (!e.is_nil())
+				e = Dart(mc.darts_[e.index_]);
+		}
+	}
+
+	return mc;
+}
+
 void dump_map_darts(const MapBase& m)
 {
 	for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
@@ -42,6 +42,7 @@
 
 #include <any>
 #include <array>
+#include <atomic>
 #include <iostream>
 #include <sstream>
 #include <unordered_map>
@@ -76,6 +77,11 @@ struct MapBase
 	// shortcut to boundary marker attribute
 	MarkAttribute* boundary_marker_;
 
+	// incremented by each topological modification (used to detect outdated topology snapshots)
+	mutable uint32 topology_version_;
+	// incremented by each modification of the cells indices of the orbit (idem)
+	std::array<uint32, NB_ORBITS> embedding_version_;
+
 	/*************************************************************************/
 	// Cells attributes containers
 	/*************************************************************************/
@@ -170,6 +176,7 @@ auto nb_darts_of_orbit(const MESH& m, CELL c) -> std::enable_if_t<std::is_conver
 
 inline void set_boundary(const MapBase& m, Dart d, bool b)
 {
+	++m.topology_version_;
 	(*m.boundary_marker_)[d.index_] = b ? 1u : 0u;
 }
 
@@ -252,6 +259,7 @@ void set_index(MapBase& m, Dart d, uint32 index)
 	if (old != INVALID_INDEX)
 		m.attribute_containers_[orbit].unref_index(old); // unref the old index
 	(*m.cells_indices_[orbit])[d.index_] = index;		 // affect the index to the dart
+	++m.embedding_version_[orbit];
 }
 
 // copy the index of the given CELL type from the src dart to the dest dart
@@ -320,6 +328,7 @@ void init_cells_indexing(MapBase& m)
 		std::ostringstream oss;
 		oss << "__index_" << orbit_name(orbit);
 		m.cells_indices_[orbit] = m.darts_.add_attribute<uint32>(oss.str());
+		m.cells_indices_[orbit]->set_zero_initialization(false); // the indices of new darts are set in add_dart
 		m.cells_indices_[orbit]->fill(INVALID_INDEX);
 	}
 }
@@ -333,6 +342,7 @@ inline void init_cells_indexing(MapBase& m, Orbit orbit)
 		std::ostringstream oss;
 		oss << "__index_" << orbit_name(orbit);
 		m.cells_indices_[orbit] = m.darts_.add_attribute<uint32>(oss.str());
+		m.cells_indices_[orbit]->set_zero_initialization(false); // the indices of new darts are set in add_dart
 		m.cells_indices_[orbit]->fill(INVALID_INDEX);
 	}
 }
@@ -445,33 +455,33 @@ T& get_attribute(MapBase& m, const std::string& name)
 }
 
 template <typename CELL, typename MESH>
-auto get_mark_attribute(const MESH& m)
+auto get_mark_attribute(const MESH& m, uint8& generation)
 	-> std::enable_if_t<std::is_convertible_v<MESH&, MapBase&>, typename mesh_traits<MESH>::MarkAttribute*>
 {
 	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
 	if (!is_indexed<CELL>(m))
 		index_cells<CELL>(const_cast<MESH&>(m));
 	const MapBase& mb = static_cast<const MapBase&>(m);
-	return mb.attribute_containers_[CELL::ORBIT].get_mark_attribute();
+	return mb.attribute_containers_[CELL::ORBIT].get_mark_attribute(generation);
 }
 
 template <typename CELL, typename MESH>
-auto release_mark_attribute(const MESH& m, typename mesh_traits<MESH>::MarkAttribute* attribute)
+auto release_mark_attribute(const MESH& m, typename mesh_traits<MESH>::MarkAttribute* attribute, uint8 generation)
 	-> std::enable_if_t<std::is_convertible_v<MESH&, MapBase&>>
 {
 	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
 	const MapBase& mb = static_cast<const MapBase&>(m);
-	return mb.attribute_containers_[CELL::ORBIT].release_mark_attribute(attribute);
+	return mb.attribute_containers_[CELL::ORBIT].release_mark_attribute(attribute, generation);
 }
 
-inline typename MapBase::MarkAttribute* get_dart_mark_attribute(const MapBase& m)
+inline typename MapBase::MarkAttribute* get_dart_mark_attribute(const MapBase& m, uint8& generation)
 {
-	return m.darts_.get_mark_attribute();
+	return m.darts_.get_mark_attribute(generation);
 }
 
-inline void release_dart_mark_attribute(const MapBase& m, MapBase::MarkAttribute* attribute)
+inline void release_dart_mark_attribute(const MapBase& m, MapBase::MarkAttribute* attribute, uint8 generation)
 {
-	return m.darts_.release_mark_attribute(attribute);
+	return m.darts_.release_mark_attribute(attribute, generation);
 }
 
 /*************************************************************************/
@@ -529,6 +539,103 @@ auto foreach_cell(const MESH& m, const FUNC& f, MapBase::TraversalPolicy travers
 	}
 }
 
+namespace internal
+{
+
+inline uint32 nb_dart_chunks(const MapBase& m)
+{
+	return (m.darts_.last_index() + PARALLEL_BUFFER_SIZE - 1u) / PARALLEL_BUFFER_SIZE;
+}
+
+// call the given function on each dart of the given chunk of darts (stops as soon as the function returns false)
+template <typename FUNC>
+bool foreach_dart_of_chunk(const MapBase& m, uint32 chunk, const FUNC& f)
+{
+	const uint32 chunk_begin = chunk * PARALLEL_BUFFER_SIZE;
+	const uint32 chunk_end = std::min(m.darts_.last_index(), chunk_begin + PARALLEL_BUFFER_SIZE);
+	for (uint32 i = chunk_begin == 0u ? m.darts_.first_index() : m.darts_.next_index(chunk_begin - 1u); i < chunk_end;
+		 i = m.darts_.next_index(i))
+	{
+		if (!f(Dart(i)))
+			return false;
+	}
+	return true;
+}
+
+// for each cell of the given CELL type, stores in owner the index of its non-boundary dart of lowest index
+// (owner must have one element per cell index, initialized to INVALID_INDEX)
+template <typename CELL, typename MESH>
+void find_lowest_dart_of_indexed_cells(const MESH& m, std::vector<std::atomic<uint32>>& owner)
+{
+	parallel_foreach_chunk(nb_dart_chunks(m), [&](uint32 chunk) -> bool {
+		return foreach_dart_of_chunk(m, chunk, [&](Dart d) -> bool {
+			if (!is_boundary(m, d))
+			{
+				std::atomic<uint32>& o = owner[index_of(m, CELL(d))];
+				uint32 current = o.load(std::memory_order_relaxed);
+				while (d.index_ < current && !o.compare_exchange_weak(current, d.index_, std::memory_order_relaxed))
+					;
+			}
+			return true;
+		});
+	});
+}
+
+// flags of the darts used by claim_lowest_dart_of_orbit
+enum OrbitFlag : uint8
+{
+	ORBIT_VISITED = 1u,
+	ORBIT_OWNER = 2u
+};
+
+// if the orbit of the given non-boundary dart has not been visited yet, flags its darts as visited and returns its
+// non-boundary dart of lowest index if the caller is the first to claim it (INVALID_INDEX otherwise)
+// (each orbit is walked once, or a few times if several threads reach it at the same time)
+template <typename CELL, typename MESH>
+uint32 claim_lowest_dart_of_orbit(const MESH& m, Dart d, std::vector<std::atomic<uint8>>& flags)
+{
+	if (flags[d.index_].load(std::memory_order_relaxed) != 0u)
+		return INVALID_INDEX;
+	uint32 lowest = d.index_;
+	foreach_dart_of_orbit(m, CELL(d), [&](Dart dd) -> bool {
+		flags[dd.index_].fetch_or(ORBIT_VISITED, std::memory_order_relaxed);
+		if (dd.index_ < lowest && !is_boundary(m, dd))
+			lowest = dd.index_;
+		return true;
+	});
+	if ((flags[lowest].fetch_or(ORBIT_OWNER, std::memory_order_relaxed) & ORBIT_OWNER) != 0u)
+		return INVALID_INDEX;
+	return lowest;
+}
+
+// call f(c, chunk) on each cell c of the given MESH, in parallel over the chunks of darts
+// each cell is given to the chunk of its owner dart
+// (is_owner must be true for exactly one non-boundary dart of each cell)
+template <typename CELL, typename MESH, typename OWNER, typename FUNC>
+void parallel_foreach_owned_cell(const MESH& m, const OWNER& is_owner, const FUNC& f)
+{
+	std::atomic<bool> stop(false);
+	parallel_foreach_chunk(nb_dart_chunks(m), [&](uint32 chunk) -> bool {
+		return foreach_dart_of_chunk(m, chunk, [&](Dart d) -> bool {
+			if (stop.load(std::memory_order_relaxed))
+				return false;
+			if (!is_boundary(m, d) && is_owner(d) && !f(CELL(d), chunk))
+			{
+				stop.store(true, std::memory_order_relaxed);
+				return false;
+			}
+			return true;
+		});
+	});
+}
+
+} // namespace internal
+
+// call the given function on each cell of the given MESH using the workers of the thread pool
+// the range of darts is split into chunks that are claimed by the workers (with work stealing), so that both the
+// discovery of the cells and the calls to the given function are done in parallel
+// the traversal stops as soon as the function returns false
+// do not downgrade the concrete MESH type to MapBase because several function are specialized for derived MESH types
 template <typename MESH, typename FUNC>
 auto parallel_foreach_cell(const MESH& m, const FUNC& f) -> std::enable_if_t<std::is_convertible_v<MESH&, MapBase&>>
 {
@@ -542,115 +649,95 @@ auto parallel_foreach_cell(const MESH& m, const FUNC& f) -> std::enable_if_t<std
 	if (nb_workers == 0)
 		return foreach_cell(m, f);
 
-	using VecCell = std::vector<uint32>;
-	using Future = std::future<void>;
-
-	std::array<std::vector<VecCell*>, 2> cells_buffers;
-	std::array<std::vector<Future>, 2> futures;
-	cells_buffers[0].reserve(nb_workers);
-	cells_buffers[1].reserve(nb_workers);
-	futures[0].reserve(nb_workers);
-	futures[1].reserve(nb_workers);
+	if (is_indexed<CELL>(m))
+	{
+		// a cell is processed from its non-boundary dart of lowest index (like in foreach_cell)
+		std::vector<std::atomic<uint32>> owner(m.attribute_containers_[CELL::ORBIT].maximum_index());
+		for (std::atomic<uint32>& o : owner)
+			o.store(INVALID_INDEX, std::memory_order_relaxed);
+		internal::find_lowest_dart_of_indexed_cells<CELL>(m, owner);
+		internal::parallel_foreach_owned_cell<CELL>(
+			m,
+			[&](Dart d) -> bool { return owner[index_of(m, CELL(d))].load(std::memory_order_relaxed) == d.index_; },
+			[&](CELL c, uint32) -> bool { return f(c); });
+	}
+	else
+	{
+		// a cell is processed by the worker that claims its non-boundary dart of lowest index
+		std::vector<std::atomic<uint8>> flags(m.darts_.maximum_index());
+		std::atomic<bool> stop(false);
+		parallel_foreach_chunk(internal::nb_dart_chunks(m), [&](uint32 chunk) -> bool {
+			return internal::foreach_dart_of_chunk(m, chunk, [&](Dart d) -> bool {
+				if (stop.load(std::memory_order_relaxed))
+					return false;
+				if (is_boundary(m, d))
+					return true;
+				const uint32 lowest = internal::claim_lowest_dart_of_orbit<CELL>(m, d, flags);
+				if (lowest != INVALID_INDEX && !f(CELL(Dart(lowest))))
+				{
+					stop.store(true, std::memory_order_relaxed);
+					return false;
+				}
+				return true;
+			});
+		});
+	}
+}
 
-	Buffers<uint32>* buffers = uint32_buffers();
+// returns the number of chunks used by parallel_foreach_cell_by_chunk for the given CELL type
+template <typename CELL, typename MESH>
+auto nb_cell_chunks(const MESH& m) -> std::enable_if_t<std::is_convertible_v<MESH&, MapBase&>, uint32>
+{
+	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
+	return internal::nb_dart_chunks(m);
+}
 
-	Dart it = m.begin();
-	Dart last = m.end();
+// call the given function on each cell of the given MESH using the workers of the thread pool
+// the function also receives the index of the chunk (in [0, nb_cell_chunks<CELL>(m))) the cell belongs to
+// each chunk is processed by a single worker and the distribution of the cells into the chunks (and their order in
+// the chunks) only depends on the mesh, not on the number of workers nor on the scheduling
+template <typename MESH, typename FUNC>
+auto parallel_foreach_cell_by_chunk(const MESH& m, const FUNC& f)
+	-> std::enable_if_t<std::is_convertible_v<MESH&, MapBase&>>
+{
+	using CELL = func_parameter_type<FUNC>;
 
-	uint32 i = 0u; // buffer id (0/1)
-	uint32 j = 0u; // thread id (0..nb_workers)
+	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
+	static_assert(is_ith_func_parameter_same<FUNC, 1, uint32>::value, "Wrong function chunk parameter type");
+	static_assert(is_func_return_same<FUNC, bool>::value, "Given function should return a bool");
 
 	if (is_indexed<CELL>(m))
 	{
-		CellMarker<MESH, CELL> cm(m);
-		while (it.index_ < last.index_)
-		{
-			// fill buffer
-			cells_buffers[i].push_back(buffers->buffer());
-			VecCell& cells = *cells_buffers[i].back();
-			cells.reserve(PARALLEL_BUFFER_SIZE);
-			for (uint32 k = 0u; k < PARALLEL_BUFFER_SIZE && it.index_ < last.index_;)
-			{
-				CELL c(it);
-				if (!is_boundary(m, it) && !cm.is_marked(c))
-				{
-					cm.mark(c);
-					cells.push_back(c.dart_.index_);
-					++k;
-				}
-				it = m.next(it);
-			}
-			// launch thread
-			futures[i].push_back(pool->enqueue([&cells, &f]() {
-				for (uint32 index : cells)
-					f(CELL(Dart(index)));
-			}));
-			// next thread
-			if (++j == nb_workers)
-			{ // again from 0 & change buffer
-				j = 0u;
-				i = (i + 1u) % 2u;
-				for (auto& fu : futures[i])
-					fu.wait();
-				for (auto& b : cells_buffers[i])
-					buffers->release_buffer(b);
-				futures[i].clear();
-				cells_buffers[i].clear();
-			}
-		}
+		// first pass: find the non-boundary dart of lowest index of each cell
+		std::vector<std::atomic<uint32>> owner(m.attribute_containers_[CELL::ORBIT].maximum_index());
+		for (std::atomic<uint32>& o : owner)
+			o.store(INVALID_INDEX, std::memory_order_relaxed);
+		internal::find_lowest_dart_of_indexed_cells<CELL>(m, owner);
+		// second pass: process each cell from this dart
+		internal::parallel_foreach_owned_cell<CELL>(
+			m,
+			[&](Dart d) -> bool { return owner[index_of(m, CELL(d))].load(std::memory_order_relaxed) == d.index_; },
+			f);
 	}
 	else
 	{
-		DartMarker dm(m);
-		while (it.index_ < last.index_)
-		{
-			// fill buffer
-			cells_buffers[i].push_back(buffers->buffer());
-			VecCell& cells = *cells_buffers[i].back();
-			cells.reserve(PARALLEL_BUFFER_SIZE);
-			for (uint32 k = 0u; k < PARALLEL_BUFFER_SIZE && it.index_ < last.index_;)
-			{
-				if (!is_boundary(m, it) && !dm.is_marked(it))
-				{
-					CELL c(it);
-					foreach_dart_of_orbit(m, c, [&](Dart d) -> bool {
-						dm.mark(d);
-						return true;
-					});
-					cells.push_back(c.dart_.index_);
-					++k;
-				}
-				it = m.next(it);
-			}
-			// launch thread
-			futures[i].push_back(pool->enqueue([&cells, &f]() {
-				for (uint32 index : cells)
-					f(CELL(Dart(index)));
-			}));
-			// next thread
-			if (++j == nb_workers)
-			{ // again from 0 & change buffer
-				j = 0u;
-				i = (i + 1u) % 2u;
-				for (auto& fu : futures[i])
-					fu.wait();
-				for (auto& b : cells_buffers[i])
-					buffers->release_buffer(b);
-				futures[i].clear();
-				cells_buffers[i].clear();
-			}
-		}
+		// first pass: walk each orbit once to flag its non-boundary dart of lowest index
+		std::vector<std::atomic<uint8>> flags(m.darts_.maximum_index());
+		parallel_foreach_chunk(internal::nb_dart_chunks(m), [&](uint32 chunk) -> bool {
+			return internal::foreach_dart_of_chunk(m, chunk, [&](Dart d) -> bool {
+				if (!is_boundary(m, d))
+					internal::claim_lowest_dart_of_orbit<CELL>(m, d, flags);
+				return true;
+			});
+		});
+		// second pass: process each cell from this dart
+		internal::parallel_foreach_owned_cell<CELL>(
+			m,
+			[&](Dart d) -> bool {
+				return (flags[d.index_].load(std::memory_order_relaxed) & internal::ORBIT_OWNER) != 0u;
+			},
+			f);
 	}
-
-	// clean all at the end
-	for (auto& fu : futures[0u])
-		fu.wait();
-	for (auto& b : cells_buffers[0u])
-		buffers->release_buffer(b);
-	for (auto& fu : futures[1u])
-		fu.wait();
-	for (auto& b : cells_buffers[1u])
-		buffers->release_buffer(b);
 }
 
 /*************************************************************************/
@@ -659,6 +746,28 @@ auto parallel_foreach_cell(const MESH& m, const FUNC& f) -> std::enable_if_t<std
 
 void clear(MapBase& m, bool keep_attributes = true);
 
+/*************************************************************************/
+// Compact map
+/*************************************************************************/
+
+// old to new indices maps computed by compact (INVALID_INDEX for the indices that were not used)
+struct MapCompaction
+{
+	std::vector<uint32> darts_;
+	// empty for the orbits that are not indexed
+	std::array<std::vector<uint32>, NB_ORBITS> cells_indices_;
+};
+
+// renumbers the darts and the cells indices so that they are contiguous
+// the attributes of the map follow their elements, the returned maps allow to update the darts & cells held elsewhere
+MapCompaction compact(MapBase& m);
+
+template <typename CELL>
+inline CELL compacted_cell(const MapCompaction& mc, CELL c)
+{
+	return CELL(Dart(mc.darts_[c.dart_.index_]));
+}
+
 /*************************************************************************/
 // Copy map
 /*************************************************************************/
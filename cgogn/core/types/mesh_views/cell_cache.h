@@ -31,7 +31,9 @@
 
 #include <cgogn/core/functions/mesh_info.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <vector>
 
 namespace cgogn
@@ -133,6 +135,17 @@ public:
 		});
 	}
 
+	// updates the cached cells after a compaction of the mesh (compaction is the result of compact(mesh))
+	template <typename COMPACTION>
+	void update(const COMPACTION& compaction)
+	{
+		std::apply(
+			[&](auto&... cells) {
+				(std::for_each(cells.begin(), cells.end(), [&](auto& c) { c = compacted_cell(compaction, c); }), ...);
+			},
+			cells_);
+	}
+
 	template <typename CELL>
 	void add(CELL c)
 	{
@@ -166,6 +179,40 @@ void foreach_cell(const CellCache<MESH>& cc, const FUNC& f)
 			break;
 }
 
+template <typename CELL, typename MESH>
+uint32 nb_cell_chunks(const CellCache<MESH>& cc)
+{
+	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
+	return (cc.template size<CELL>() + PARALLEL_BUFFER_SIZE - 1u) / PARALLEL_BUFFER_SIZE;
+}
+
+template <typename MESH, typename FUNC>
+void parallel_foreach_cell_by_chunk(const CellCache<MESH>& cc, const FUNC& f)
+{
+	using CELL = func_parameter_type<FUNC>;
+	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
+	static_assert(is_ith_func_parameter_same<FUNC, 1, uint32>::value, "Wrong function chunk parameter type");
+	static_assert(is_func_return_same<FUNC, bool>::value, "Given function should return a bool");
+
+	const std::vector<CELL>& cells = cc.template cell_vector<CELL>();
+	const uint32 nb_cells = uint32(cells.size());
+
+	std::atomic<bool> stop(false);
+	parallel_foreach_chunk(nb_cell_chunks<CELL>(cc), [&](uint32 chunk) -> bool {
+		for (uint32 i = chunk * PARALLEL_BUFFER_SIZE, end = std::min(nb_cells, i + PARALLEL_BUFFER_SIZE); i < end; ++i)
+		{
+			if (stop.load(std::memory_order_relaxed))
+				return false;
+			if (!f(cells[i], chunk))
+			{
+				stop.store(true, std::memory_order_relaxed);
+				return false;
+			}
+		}
+		return true;
+	});
+}
+
 template <typename MESH, typename FUNC>
 void parallel_foreach_cell(const CellCache<MESH>& cc, const FUNC& f)
 {
@@ -179,65 +226,7 @@ void parallel_foreach_cell(const CellCache<MESH>& cc, const FUNC& f)
 	if (nb_workers == 0)
 		return foreach_cell(cc, f);
 
-	// CELL type should be able to fallback to uint32
-	// TODO: may be too restrictive?
-	using VecCell = std::vector<uint32>;
-	using Future = std::future<void>;
-
-	std::array<std::vector<VecCell*>, 2> cells_buffers;
-	std::array<std::vector<Future>, 2> futures;
-	cells_buffers[0].reserve(nb_workers);
-	cells_buffers[1].reserve(nb_workers);
-	futures[0].reserve(nb_workers);
-	futures[1].reserve(nb_workers);
-
-	Buffers<uint32>* buffers = uint32_buffers();
-
-	auto it = cc.template begin<CELL>();
-	auto last = cc.template end<CELL>();
-
-	uint32 i = 0u; // buffer id (0/1)
-	uint32 j = 0u; // thread id (0..nb_workers)
-
-	while (it != last)
-	{
-		// fill buffer
-		cells_buffers[i].push_back(buffers->buffer());
-		VecCell& cells = *cells_buffers[i].back();
-		cells.reserve(PARALLEL_BUFFER_SIZE);
-		for (uint32 k = 0u; k < PARALLEL_BUFFER_SIZE && it != last; ++k)
-		{
-			cells.push_back(*it);
-			it++;
-		}
-		// launch thread
-		futures[i].push_back(pool->enqueue([&cells, &f]() {
-			for (uint32 c : cells)
-				f(CELL(c));
-		}));
-		// next thread
-		if (++j == nb_workers)
-		{ // again from 0 & change buffer
-			j = 0;
-			i = (i + 1u) % 2u;
-			for (auto& fu : futures[i])
-				fu.wait();
-			for (auto& b : cells_buffers[i])
-				buffers->release_buffer(b);
-			futures[i].clear();
-			cells_buffers[i].clear();
-		}
-	}
-
-	// clean all at the end
-	for (auto& fu : futures[0u])
-		fu.wait();
-	for (auto& b : cells_buffers[0u])
-		buffers->release_buffer(b);
-	for (auto& fu : futures[1u])
-		fu.wait();
-	for (auto& b : cells_buffers[1u])
-		buffers->release_buffer(b);
+	parallel_foreach_cell_by_chunk(cc, [&](CELL c, uint32) -> bool { return f(c); });
 }
 
 } // namespace cgogn
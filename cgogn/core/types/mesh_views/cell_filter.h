@@ -130,6 +130,29 @@ void parallel_foreach_cell(const CellFilter<MESH>& cf, const FUNC& f)
 	});
 }
 
+template <typename CELL, typename MESH>
+uint32 nb_cell_chunks(const CellFilter<MESH>& cf)
+{
+	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
+	return nb_cell_chunks<CELL>(static_cast<const MESH&>(cf));
+}
+
+template <typename MESH, typename FUNC>
+void parallel_foreach_cell_by_chunk(const CellFilter<MESH>& cf, const FUNC& f)
+{
+	using CELL = func_parameter_type<FUNC>;
+	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
+	static_assert(is_ith_func_parameter_same<FUNC, 1, uint32>::value, "Wrong function chunk parameter type");
+	static_assert(is_func_return_same<FUNC, bool>::value, "Given function should return a bool");
+
+	const MESH& m = static_cast<const MESH&>(cf);
+	parallel_foreach_cell_by_chunk(m, [&](CELL c, uint32 chunk) -> bool {
+		if (cf.filter(c))
+			return f(c, chunk);
+		return true;
+	});
+}
+
 } // namespace cgogn
 
 #endif // CGOGN_CORE_TYPES_MESH_VIEWS_CELL_FILTER_H_
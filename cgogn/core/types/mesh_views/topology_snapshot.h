@@ -0,0 +1,442 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_CORE_TYPES_MESH_VIEWS_TOPOLOGY_SNAPSHOT_H_
+#define CGOGN_CORE_TYPES_MESH_VIEWS_TOPOLOGY_SNAPSHOT_H_
+
+#include <cgogn/core/utils/assert.h>
+#include <cgogn/core/utils/numerics.h>
+#include <cgogn/core/utils/thread.h>
+#include <cgogn/core/utils/thread_pool.h>
+#include <cgogn/core/utils/type_traits.h>
+
+#include <cgogn/core/functions/mesh_info.h>
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <vector>
+
+namespace cgogn
+{
+
+template <typename MESH>
+struct mesh_traits;
+
+////////////////////////////
+// TopologySnapshot class //
+////////////////////////////
+
+// flat (CSR) copy of the vertex->vertex, vertex->face, face->vertex & edge->vertex relations of a map
+// the relations are stored by cell index (the indexed cell types of the map determine the built relations)
+// the snapshot is outdated by any topological modification of the map, or modification of the indices of its cells,
+// and has to be built again
+// the local traversal functions called on the snapshot use the stored relations
+
+template <typename MESH>
+class TopologySnapshot
+{
+	static_assert(mesh_traits<MESH>::dimension >= 2, "MESH dimension should be >= 2");
+
+public:
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Edge = typename mesh_traits<MESH>::Edge;
+	using Face = typename mesh_traits<MESH>::Face;
+
+	// range of cell indices
+	class Range
+	{
+		const uint32* begin_;
+		const uint32* end_;
+
+	public:
+		Range(const uint32* begin, const uint32* end) : begin_(begin), end_(end)
+		{
+		}
+		inline const uint32* begin() const
+		{
+			return begin_;
+		}
+		inline const uint32* end() const
+		{
+			return end_;
+		}
+		inline uint32 size() const
+		{
+			return uint32(end_ - begin_);
+		}
+	};
+
+private:
+	struct Relation
+	{
+		std::vector<uint32> offsets_;
+		std::vector<uint32> indices_;
+
+		inline Range range(uint32 index) const
+		{
+			return Range(indices_.data() + offsets_[index], indices_.data() + offsets_[index + 1]);
+		}
+	};
+
+	// indices gathered by one chunk of cells: the cells, and for each relation the number of values of each cell
+	template <uint32 N>
+	struct ChunkBuffer
+	{
+		std::vector<uint32> cells_;
+		std::array<std::vector<uint32>, N> counts_;
+		std::array<std::vector<uint32>, N> values_;
+	};
+
+	const MESH& m_;
+	bool built_;
+	uint32 topology_version_;
+	std::array<uint32, 3> embedding_version_; // of the Vertex, Edge & Face orbits
+
+	std::vector<Vertex> vertices_;
+	std::vector<Edge> edges_;
+	std::vector<Face> faces_;
+
+	Relation vertex_adjacent_vertices_;
+	Relation vertex_incident_faces_;
+	Relation face_incident_vertices_;
+	std::vector<uint32> edge_incident_vertices_;
+
+	template <uint32 N>
+	static void merge(const std::vector<ChunkBuffer<N>>& buffers, uint32 nb_indices,
+					  const std::array<Relation*, N>& relations)
+	{
+		for (uint32 r = 0; r < N; ++r)
+		{
+			std::vector<uint32>& offsets = relations[r]->offsets_;
+			offsets.assign(nb_indices + 1, 0u);
+			for (const ChunkBuffer<N>& b : buffers)
+				for (uint32 k = 0, nb = uint32(b.cells_.size()); k < nb; ++k)
+					offsets[b.cells_[k] + 1] = b.counts_[r][k];
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+			relations[r]->indices_.resize(offsets.back());
+		}
+		parallel_foreach_chunk(uint32(buffers.size()), [&](uint32 chunk) -> bool {
+			const ChunkBuffer<N>& b = buffers[chunk];
+			for (uint32 r = 0; r < N; ++r)
+			{
+				Relation& relation = *relations[r];
+				auto values = b.values_[r].begin();
+				for (uint32 k = 0, nb = uint32(b.cells_.size()); k < nb; ++k)
+				{
+					const uint32 count = b.counts_[r][k];
+					std::copy_n(values, count, relation.indices_.begin() + relation.offsets_[b.cells_[k]]);
+					values += count;
+				}
+			}
+			return true;
+		});
+	}
+
+public:
+	TopologySnapshot(const MESH& m) : m_(m), built_(false), topology_version_(0u), embedding_version_{}
+	{
+	}
+
+	operator MESH&()
+	{
+		return const_cast<MESH&>(m_);
+	}
+	operator const MESH&() const
+	{
+		return m_;
+	}
+
+	// the Vertex cells have to be indexed, the Edge & Face relations are built if these cells are indexed
+	void build()
+	{
+		cgogn_message_assert(is_indexed<Vertex>(m_), "TopologySnapshot needs the vertices to be indexed");
+
+		const bool with_edges = is_indexed<Edge>(m_);
+		const bool with_faces = is_indexed<Face>(m_);
+
+		const uint32 nb_vertex_indices = m_.attribute_containers_[Vertex::ORBIT].maximum_index();
+		vertices_.assign(nb_vertex_indices, Vertex());
+		std::vector<ChunkBuffer<2>> vertex_buffers(nb_cell_chunks<Vertex>(m_));
+		parallel_foreach_cell_by_chunk(m_, [&](Vertex v, uint32 chunk) -> bool {
+			ChunkBuffer<2>& b = vertex_buffers[chunk];
+			const uint32 vi = index_of(m_, v);
+			vertices_[vi] = v;
+			b.cells_.push_back(vi);
+			uint32 nb = 0;
+			foreach_adjacent_vertex_through_edge(m_, v, [&](Vertex av) -> bool {
+				b.values_[0].push_back(index_of(m_, av));
+				++nb;
+				return true;
+			});
+			b.counts_[0].push_back(nb);
+			nb = 0;
+			if (with_faces)
+			{
+				foreach_incident_face(m_, v, [&](Face f) -> bool {
+					b.values_[1].push_back(index_of(m_, f));
+					++nb;
+					return true;
+				});
+			}
+			b.counts_[1].push_back(nb);
+			return true;
+		});
+		merge(vertex_buffers, nb_vertex_indices, {&vertex_adjacent_vertices_, &vertex_incident_faces_});
+
+		if (with_edges)
+		{
+			const uint32 nb_edge_indices = m_.attribute_containers_[Edge::ORBIT].maximum_index();
+			edges_.assign(nb_edge_indices, Edge());
+			edge_incident_vertices_.assign(2 * nb_edge_indices, INVALID_INDEX);
+			// (by chunk: the representative dart of each edge, and so the order of its vertices, is deterministic)
+			parallel_foreach_cell_by_chunk(m_, [&](Edge e, uint32) -> bool {
+				const uint32 ei = index_of(m_, e);
+				edges_[ei] = e;
+				uint32 k = 2 * ei;
+				foreach_incident_vertex(m_, e, [&](Vertex v) -> bool {
+					edge_incident_vertices_[k++] = index_of(m_, v);
+					return true;
+				});
+				return true;
+			});
+		}
+		else
+		{
+			edges_.clear();
+			edge_incident_vertices_.clear();
+		}
+
+		if (with_faces)
+		{
+			const uint32 nb_face_indices = m_.attribute_containers_[Face::ORBIT].maximum_index();
+			faces_.assign(nb_face_indices, Face());
+			std::vector<ChunkBuffer<1>> face_buffers(nb_cell_chunks<Face>(m_));
+			parallel_foreach_cell_by_chunk(m_, [&](Face f, uint32 chunk) -> bool {
+				ChunkBuffer<1>& b = face_buffers[chunk];
+				const uint32 fi = index_of(m_, f);
+				faces_[fi] = f;
+				b.cells_.push_back(fi);
+				uint32 nb = 0;
+				foreach_incident_vertex(m_, f, [&](Vertex v) -> bool {
+					b.values_[0].push_back(index_of(m_, v));
+					++nb;
+					return true;
+				});
+				b.counts_[0].push_back(nb);
+				return true;
+			});
+			merge(face_buffers, nb_face_indices, {&face_incident_vertices_});
+		}
+		else
+		{
+			faces_.clear();
+			face_incident_vertices_ = Relation();
+		}
+
+		built_ = true;
+		topology_version_ = m_.topology_version_;
+		embedding_version_ = {m_.embedding_version_[Vertex::ORBIT], m_.embedding_version_[Edge::ORBIT],
+							  m_.embedding_version_[Face::ORBIT]};
+	}
+
+	// indicates if the snapshot is built and, since then, the map has not been topologically modified and the indices
+	// of the cells of the built relations have not changed
+	inline bool is_valid() const
+	{
+		return built_ && topology_version_ == m_.topology_version_ &&
+			   embedding_version_[0] == m_.embedding_version_[Vertex::ORBIT] &&
+			   (!has_edges() || embedding_version_[1] == m_.embedding_version_[Edge::ORBIT]) &&
+			   (!has_faces() || embedding_version_[2] == m_.embedding_version_[Face::ORBIT]);
+	}
+
+	inline bool has_edges() const
+	{
+		return !edges_.empty();
+	}
+
+	inline bool has_faces() const
+	{
+		return !faces_.empty();
+	}
+
+	// the cells of the snapshot are designated by their index (unused indices lead to empty ranges)
+
+	inline uint32 nb_vertex_indices() const
+	{
+		return uint32(vertices_.size());
+	}
+	inline uint32 nb_edge_indices() const
+	{
+		return uint32(edges_.size());
+	}
+	inline uint32 nb_face_indices() const
+	{
+		return uint32(faces_.size());
+	}
+
+	inline Vertex vertex(uint32 index) const
+	{
+		return vertices_[index];
+	}
+	inline Edge edge(uint32 index) const
+	{
+		return edges_[index];
+	}
+	inline Face face(uint32 index) const
+	{
+		return faces_[index];
+	}
+
+	inline Range vertex_adjacent_vertices(uint32 vertex_index) const
+	{
+		return vertex_adjacent_vertices_.range(vertex_index);
+	}
+	inline Range vertex_incident_faces(uint32 vertex_index) const
+	{
+		return vertex_incident_faces_.range(vertex_index);
+	}
+	inline Range face_incident_vertices(uint32 face_index) const
+	{
+		return face_incident_vertices_.range(face_index);
+	}
+	inline Range edge_incident_vertices(uint32 edge_index) const
+	{
+		const uint32* begin = edge_incident_vertices_.data() + 2 * edge_index;
+		return Range(begin, begin + 2);
+	}
+};
+
+template <typename MESH>
+struct mesh_traits<TopologySnapshot<MESH>> : public mesh_traits<MESH>
+{
+};
+
+/*************************************************************************/
+// Global traversals (the cells are those of the map)
+/*************************************************************************/
+
+template <typename MESH, typename FUNC>
+void foreach_cell(const TopologySnapshot<MESH>& ts, const FUNC& f)
+{
+	foreach_cell(static_cast<const MESH&>(ts), f);
+}
+
+template <typename MESH, typename FUNC>
+void parallel_foreach_cell(const TopologySnapshot<MESH>& ts, const FUNC& f)
+{
+	parallel_foreach_cell(static_cast<const MESH&>(ts), f);
+}
+
+template <typename CELL, typename MESH>
+uint32 nb_cell_chunks(const TopologySnapshot<MESH>& ts)
+{
+	return nb_cell_chunks<CELL>(static_cast<const MESH&>(ts));
+}
+
+template <typename MESH, typename FUNC>
+void parallel_foreach_cell_by_chunk(const TopologySnapshot<MESH>& ts, const FUNC& f)
+{
+	parallel_foreach_cell_by_chunk(static_cast<const MESH&>(ts), f);
+}
+
+/*************************************************************************/
+// Local traversals (the relations that are not stored are traversed in the map)
+/*************************************************************************/
+
+template <typename MESH, typename CELL, typename FUNC>
+void foreach_incident_vertex(const TopologySnapshot<MESH>& ts, CELL c, const FUNC& func)
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+
+	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
+	static_assert(is_func_parameter_same<FUNC, Vertex>::value, "Wrong function cell parameter type");
+	static_assert(is_func_return_same<FUNC, bool>::value, "Given function should return a bool");
+	cgogn_message_assert(ts.is_valid(), "Using an outdated topology snapshot");
+
+	const MESH& m = static_cast<const MESH&>(ts);
+	if constexpr (std::is_same_v<CELL, typename mesh_traits<MESH>::Edge>)
+	{
+		if (ts.has_edges())
+		{
+			for (uint32 vi : ts.edge_incident_vertices(index_of(m, c)))
+				if (!func(ts.vertex(vi)))
+					break;
+			return;
+		}
+	}
+	if constexpr (std::is_same_v<CELL, typename mesh_traits<MESH>::Face>)
+	{
+		if (ts.has_faces())
+		{
+			for (uint32 vi : ts.face_incident_vertices(index_of(m, c)))
+				if (!func(ts.vertex(vi)))
+					break;
+			return;
+		}
+	}
+	foreach_incident_vertex(m, c, func);
+}
+
+template <typename MESH, typename CELL, typename FUNC>
+void foreach_incident_face(const TopologySnapshot<MESH>& ts, CELL c, const FUNC& func)
+{
+	using Face = typename mesh_traits<MESH>::Face;
+
+	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
+	static_assert(is_func_parameter_same<FUNC, Face>::value, "Wrong function cell parameter type");
+	static_assert(is_func_return_same<FUNC, bool>::value, "Given function should return a bool");
+	cgogn_message_assert(ts.is_valid(), "Using an outdated topology snapshot");
+
+	const MESH& m = static_cast<const MESH&>(ts);
+	if constexpr (std::is_same_v<CELL, typename mesh_traits<MESH>::Vertex>)
+	{
+		if (ts.has_faces())
+		{
+			for (uint32 fi : ts.vertex_incident_faces(index_of(m, c)))
+				if (!func(ts.face(fi)))
+					break;
+			return;
+		}
+	}
+	foreach_incident_face(m, c, func);
+}
+
+template <typename MESH, typename FUNC>
+void foreach_adjacent_vertex_through_edge(const TopologySnapshot<MESH>& ts, typename mesh_traits<MESH>::Vertex v,
+										  const FUNC& func)
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+
+	static_assert(is_func_parameter_same<FUNC, Vertex>::value, "Wrong function cell parameter type");
+	static_assert(is_func_return_same<FUNC, bool>::value, "Given function should return a bool");
+	cgogn_message_assert(ts.is_valid(), "Using an outdated topology snapshot");
+
+	for (uint32 vi : ts.vertex_adjacent_vertices(index_of(static_cast<const MESH&>(ts), v)))
+		if (!func(ts.vertex(vi)))
+			break;
+}
+
+} // namespace cgogn
+
+#endif // CGOGN_CORE_TYPES_MESH_VIEWS_TOPOLOGY_SNAPSHOT_H_
@@ -38,6 +38,7 @@
 #include <cgogn/core/utils/numerics.h>
 
 #include <array>
+#include <atomic>
 
 namespace cgogn
 {
@@ -253,17 +254,17 @@ void foreach_attribute(const TriangleSoup& m, const FUNC& f)
 }
 
 template <typename CELL>
-TriangleSoup::MarkAttribute* get_mark_attribute(const TriangleSoup& m)
+TriangleSoup::MarkAttribute* get_mark_attribute(const TriangleSoup& m, uint8& generation)
 {
 	constexpr uint32 container_index = TriangleSoup::cell_container_index<CELL>();
-	return m.attribute_containers_[container_index].get_mark_attribute();
+	return m.attribute_containers_[container_index].get_mark_attribute(generation);
 }
 
 template <typename CELL>
-void release_mark_attribute(const TriangleSoup& m, TriangleSoup::MarkAttribute* attribute)
+void release_mark_attribute(const TriangleSoup& m, TriangleSoup::MarkAttribute* attribute, uint8 generation)
 {
 	constexpr uint32 container_index = TriangleSoup::cell_container_index<CELL>();
-	return m.attribute_containers_[container_index].release_mark_attribute(attribute);
+	return m.attribute_containers_[container_index].release_mark_attribute(attribute, generation);
 }
 
 /*************************************************************************/
@@ -288,6 +289,50 @@ auto foreach_cell(const MESH& m, const FUNC& f) -> std::enable_if_t<std::is_conv
 	}
 }
 
+// returns the number of chunks used by parallel_foreach_cell_by_chunk for the given CELL type
+template <typename CELL, typename MESH>
+auto nb_cell_chunks(const MESH& m) -> std::enable_if_t<std::is_convertible_v<MESH&, TriangleSoup&>, uint32>
+{
+	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
+	constexpr uint32 container_index = TriangleSoup::cell_container_index<CELL>();
+	return (m.attribute_containers_[container_index].last_index() + PARALLEL_BUFFER_SIZE - 1u) / PARALLEL_BUFFER_SIZE;
+}
+
+// call the given function on each cell of the given MESH using the workers of the thread pool
+// the function also receives the index of the chunk (in [0, nb_cell_chunks<CELL>(m))) the cell belongs to
+// each chunk is a range of PARALLEL_BUFFER_SIZE indices processed by a single worker
+template <typename MESH, typename FUNC>
+auto parallel_foreach_cell_by_chunk(const MESH& m, const FUNC& f)
+	-> std::enable_if_t<std::is_convertible_v<MESH&, TriangleSoup&>>
+{
+	using CELL = func_parameter_type<FUNC>;
+	static_assert(has_cell_type_v<MESH, CELL>, "CELL not supported in this MESH");
+	static_assert(is_ith_func_parameter_same<FUNC, 1, uint32>::value, "Wrong function chunk parameter type");
+	static_assert(is_func_return_same<FUNC, bool>::value, "Given function should return a bool");
+
+	constexpr uint32 container_index = TriangleSoup::cell_container_index<CELL>();
+	const TriangleSoup::AttributeContainer& container = m.attribute_containers_[container_index];
+	const uint32 last = container.last_index();
+
+	std::atomic<bool> stop(false);
+	parallel_foreach_chunk(nb_cell_chunks<CELL>(m), [&](uint32 chunk) -> bool {
+		const uint32 chunk_begin = chunk * PARALLEL_BUFFER_SIZE;
+		const uint32 chunk_end = std::min(last, chunk_begin + PARALLEL_BUFFER_SIZE);
+		for (uint32 i = chunk_begin == 0u ? container.first_index() : container.next_index(chunk_begin - 1u);
+			 i < chunk_end; i = container.next_index(i))
+		{
+			if (stop.load(std::memory_order_relaxed))
+				return false;
+			if (!f(CELL(i), chunk))
+			{
+				stop.store(true, std::memory_order_relaxed);
+				return false;
+			}
+		}
+		return true;
+	});
+}
+
 template <typename MESH, typename FUNC>
 auto parallel_foreach_cell(const MESH& m, const FUNC& f)
 	-> std::enable_if_t<std::is_convertible_v<MESH&, TriangleSoup&>>
@@ -301,65 +346,7 @@ auto parallel_foreach_cell(const MESH& m, const FUNC& f)
 	if (nb_workers == 0)
 		return foreach_cell(m, f);
 
-	using VecCell = std::vector<uint32>;
-	using Future = std::future<void>;
-
-	std::array<std::vector<VecCell*>, 2> cells_buffers;
-	std::array<std::vector<Future>, 2> futures;
-	cells_buffers[0].reserve(nb_workers);
-	cells_buffers[1].reserve(nb_workers);
-	futures[0].reserve(nb_workers);
-	futures[1].reserve(nb_workers);
-
-	Buffers<uint32>* buffers = uint32_buffers();
-
-	constexpr uint32 container_index = TriangleSoup::cell_container_index<CELL>();
-
-	uint32 it = m.attribute_containers_[container_index].first_index();
-	uint32 last = m.attribute_containers_[container_index].last_index();
-
-	uint32 i = 0u; // buffer id (0/1)
-	uint32 j = 0u; // thread id (0..nb_workers)
-
-	while (it < last)
-	{
-		// fill buffer
-		cells_buffers[i].push_back(buffers->buffer());
-		VecCell& cells = *cells_buffers[i].back();
-		cells.reserve(PARALLEL_BUFFER_SIZE);
-		for (uint32 k = 0u; k < PARALLEL_BUFFER_SIZE && it < last; ++k)
-		{
-			cells.push_back(it);
-			it = m.attribute_containers_[container_index].next_index(it);
-		}
-		// launch thread
-		futures[i].push_back(pool->enqueue([&cells, &f]() {
-			for (uint32 index : cells)
-				f(CELL(index));
-		}));
-		// next thread
-		if (++j == nb_workers)
-		{ // again from 0 & change buffer
-			j = 0u;
-			i = (i + 1u) % 2u;
-			for (auto& fu : futures[i])
-				fu.wait();
-			for (auto& b : cells_buffers[i])
-				buffers->release_buffer(b);
-			futures[i].clear();
-			cells_buffers[i].clear();
-		}
-	}
-
-	// clean all at the end
-	for (auto& fu : futures[0u])
-		fu.wait();
-	for (auto& b : cells_buffers[0u])
-		buffers->release_buffer(b);
-	for (auto& fu : futures[1u])
-		fu.wait();
-	for (auto& b : cells_buffers[1u])
-		buffers->release_buffer(b);
+	parallel_foreach_cell_by_chunk(m, [&](CELL c, uint32) -> bool { return f(c); });
 }
 
 /*************************************************************************/
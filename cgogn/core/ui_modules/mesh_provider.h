@@ -34,6 +34,7 @@
 #include <cgogn/geometry/functions/bounding_box.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <cgogn/io/async_import.h>
 #include <cgogn/io/graph/cg.h>
 #include <cgogn/io/graph/cgr.h>
 #include <cgogn/io/graph/skel.h>
@@ -48,8 +49,10 @@
 
 #include <boost/synapse/emit.hpp>
 
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace cgogn
 {
@@ -72,6 +75,8 @@ class MeshProvider : public ProviderModule
 	using Vertex = typename mesh_traits<MESH>::Vertex;
 
 public:
+	using MeshImport = io::AsyncImport<MESH>;
+
 	MeshProvider(const App& app)
 		: ProviderModule(app, "MeshProvider (" + std::string{mesh_traits<MESH>::name} + ")"), selected_mesh_(nullptr),
 		  bb_min_(0, 0, 0), bb_max_(0, 0, 0)
@@ -161,55 +166,49 @@ public:
 		return meshes_.count(name) == 1;
 	}
 
-	MESH* load_graph_from_file(const std::string& filename)
+	static bool import_graph(MESH& m, const std::string& filename)
 	{
-		std::string name = filename_from_path(filename);
-		if (has_mesh(name))
-			name = remove_extension(name) + "_" + std::to_string(number_of_meshes()) + "." + extension(name);
-		const auto [it, inserted] = meshes_.emplace(name, std::make_unique<MESH>());
-		MESH* m = it->second.get();
-
 		std::string ext = extension(filename);
-		bool imported;
+		bool imported = false;
 
 		if constexpr (mesh_traits<MESH>::dimension == 1 && std::is_default_constructible_v<MESH>)
 		{
 			if (ext.compare("cg") == 0)
-				imported = io::import_CG(*m, filename);
+				imported = io::import_CG(m, filename);
 			else if (ext.compare("cgr") == 0)
-				imported = io::import_CGR(*m, filename);
+				imported = io::import_CGR(m, filename);
 			else if (ext.compare("ig") == 0)
-				imported = io::import_IG(*m, filename);
+				imported = io::import_IG(m, filename);
 			else if (ext.compare("skel") == 0)
-				imported = io::import_SKEL(*m, filename);
-			else
-				imported = false;
+				imported = io::import_SKEL(m, filename);
 		}
 		else if constexpr (std::is_same_v<MESH, IncidenceGraph>)
 		{
 			if (ext.compare("cg") == 0)
-				imported = io::import_CG(*m, filename);
+				imported = io::import_CG(m, filename);
 			else if (ext.compare("ig") == 0)
-				imported = io::import_IG(*m, filename);
-			else
-				imported = false;
+				imported = io::import_IG(m, filename);
 		}
 
-		if (imported)
+		return imported;
+	}
+
+	MESH* load_graph_from_file(const std::string& filename)
+	{
+		if constexpr (std::is_default_constructible_v<MESH>)
 		{
-			MeshData<MESH>& md = mesh_data(*m);
-			md.init(m);
-			std::shared_ptr<Attribute<Vec3>> vertex_position = get_attribute<Vec3, Vertex>(*m, "position");
-			if (vertex_position)
-				set_mesh_bb_vertex_position(*m, vertex_position);
-			boost::synapse::emit<mesh_added>(this, m);
-			return m;
+			std::unique_ptr<MESH> m = std::make_unique<MESH>();
+			if (!import_graph(*m, filename))
+				return nullptr;
+			return register_imported_mesh(std::move(m), filename, false);
 		}
 		else
-		{
-			meshes_.erase(name);
 			return nullptr;
-		}
+	}
+
+	std::shared_ptr<MeshImport> load_graph_from_file_async(const std::string& filename)
+	{
+		return load_from_file_async(filename, &MeshProvider::import_graph, false);
 	}
 
 	void save_graph_to_file(MESH& m, const Attribute<Vec3>* vertex_position, const std::string& filetype,
@@ -228,54 +227,47 @@ public:
 		}
 	}
 
-	MESH* load_surface_from_file(const std::string& filename, bool normalized = true)
+	static bool import_surface(MESH& m, const std::string& filename)
 	{
+		std::string ext = extension(filename);
+		bool imported = false;
+
 		if constexpr (mesh_traits<MESH>::dimension == 2 && std::is_default_constructible_v<MESH>)
 		{
-			std::string name = filename_from_path(filename);
-			if (has_mesh(name))
-				name = remove_extension(name) + "_" + std::to_string(number_of_meshes()) + "." + extension(name);
-			const auto [it, inserted] = meshes_.emplace(name, std::make_unique<MESH>());
-			MESH* m = it->second.get();
-
-			std::string ext = extension(filename);
-			bool imported = false;
 			if (ext.compare("off") == 0)
-				imported = io::import_OFF(*m, filename);
+				imported = io::import_OFF(m, filename);
 			else if (ext.compare("obj") == 0)
-				imported = io::import_OBJ(*m, filename);
+				imported = io::import_OBJ(m, filename);
 			else if (ext.compare("ply") == 0)
-				imported = io::import_PLY(*m, filename);
+				imported = io::import_PLY(m, filename);
 			else if (ext.compare("ig") == 0)
 			{
 				if constexpr (std::is_same_v<MESH, IncidenceGraph>)
-					imported = io::import_IG(*m, filename);
+					imported = io::import_IG(m, filename);
 			}
+		}
 
-			if (imported)
-			{
-				MeshData<MESH>& md = mesh_data(*m);
-				md.init(m);
-				std::shared_ptr<Attribute<Vec3>> vertex_position = get_attribute<Vec3, Vertex>(*m, "position");
-				if (vertex_position)
-				{
-					if (normalized)
-						geometry::rescale(*vertex_position, 1);
-					set_mesh_bb_vertex_position(*m, vertex_position);
-				}
-				boost::synapse::emit<mesh_added>(this, m);
-				return m;
-			}
-			else
-			{
-				meshes_.erase(name);
+		return imported;
+	}
+
+	MESH* load_surface_from_file(const std::string& filename, bool normalized = true)
+	{
+		if constexpr (mesh_traits<MESH>::dimension == 2 && std::is_default_constructible_v<MESH>)
+		{
+			std::unique_ptr<MESH> m = std::make_unique<MESH>();
+			if (!import_surface(*m, filename))
 				return nullptr;
-			}
+			return register_imported_mesh(std::move(m), filename, normalized);
 		}
 		else
 			return nullptr;
 	}
 
+	std::shared_ptr<MeshImport> load_surface_from_file_async(const std::string& filename, bool normalized = true)
+	{
+		return load_from_file_async(filename, &MeshProvider::import_surface, normalized);
+	}
+
 	void save_surface_to_file(MESH& m, const Attribute<Vec3>* vertex_position, const std::string& filetype,
 							  const std::string& filename)
 	{
@@ -283,6 +275,10 @@ public:
 		{
 			if (filetype.compare("off") == 0)
 				io::export_OFF(m, vertex_position, filename + ".off");
+			else if (filetype.compare("obj") == 0)
+				io::export_OBJ(m, vertex_position, filename + ".obj", true);
+			else if (filetype.compare("ply") == 0)
+				io::export_PLY(m, vertex_position, filename + ".ply", true);
 			else if (filetype.compare("ig") == 0)
 			{
 				if constexpr (has_edge_v<MESH>)
@@ -291,45 +287,40 @@ public:
 		}
 	}
 
-	MESH* load_volume_from_file(const std::string& filename)
+	static bool import_volume(MESH& m, const std::string& filename)
 	{
+		std::string ext = extension(filename);
+		bool imported = false;
+
 		if constexpr (mesh_traits<MESH>::dimension == 3 && std::is_default_constructible_v<MESH>)
 		{
-			std::string name = filename_from_path(filename);
-			if (has_mesh(name))
-				name = remove_extension(name) + "_" + std::to_string(number_of_meshes()) + "." + extension(name);
-			const auto [it, inserted] = meshes_.emplace(name, std::make_unique<MESH>());
-			MESH* m = it->second.get();
-
-			std::string ext = extension(filename);
-			bool imported;
 			if (ext.compare("tet") == 0)
-				imported = io::import_TET(*m, filename);
+				imported = io::import_TET(m, filename);
 			else if (ext.compare("mesh") == 0 || ext.compare("meshb") == 0)
-				imported = io::import_MESHB(*m, filename);
-			else
-				imported = false;
+				imported = io::import_MESHB(m, filename);
+		}
 
-			if (imported)
-			{
-				MeshData<MESH>& md = mesh_data(*m);
-				md.init(m);
-				std::shared_ptr<Attribute<Vec3>> vertex_position = get_attribute<Vec3, Vertex>(*m, "position");
-				if (vertex_position)
-					set_mesh_bb_vertex_position(*m, vertex_position);
-				boost::synapse::emit<mesh_added>(this, m);
-				return m;
-			}
-			else
-			{
-				meshes_.erase(name);
+		return imported;
+	}
+
+	MESH* load_volume_from_file(const std::string& filename)
+	{
+		if constexpr (mesh_traits<MESH>::dimension == 3 && std::is_default_constructible_v<MESH>)
+		{
+			std::unique_ptr<MESH> m = std::make_unique<MESH>();
+			if (!import_volume(*m, filename))
 				return nullptr;
-			}
+			return register_imported_mesh(std::move(m), filename, false);
 		}
 		else
 			return nullptr;
 	}
 
+	std::shared_ptr<MeshImport> load_volume_from_file_async(const std::string& filename)
+	{
+		return load_from_file_async(filename, &MeshProvider::import_volume, false);
+	}
+
 	void save_volume_to_file(MESH& m, const Attribute<Vec3>* vertex_position, const std::string& filetype,
 							 const std::string& filename)
 	{
@@ -347,6 +338,41 @@ public:
 		}
 	}
 
+	/**
+	 * @brief wait for the end of the given asynchronous load and register the loaded mesh
+	 * @return the loaded mesh or nullptr if the load failed or has been cancelled
+	 */
+	MESH* finish_load(const std::shared_ptr<MeshImport>& load)
+	{
+		auto it = std::find_if(pending_loads_.begin(), pending_loads_.end(),
+							   [&](const PendingLoad& pl) { return pl.import_ == load; });
+		if (it == pending_loads_.end())
+			return nullptr;
+		const bool normalized = it->normalized_;
+		pending_loads_.erase(it);
+		std::unique_ptr<MESH> m = load->get();
+		if (!m)
+			return nullptr;
+		return register_imported_mesh(std::move(m), load->filename(), normalized);
+	}
+
+	/**
+	 * @brief register the meshes of the asynchronous loads that are complete (called at each frame)
+	 * @return the number of loads that are still running
+	 */
+	uint32 update_pending_loads()
+	{
+		std::vector<std::shared_ptr<MeshImport>> complete_loads;
+		for (const PendingLoad& pl : pending_loads_)
+		{
+			if (pl.import_->is_ready())
+				complete_loads.push_back(pl.import_);
+		}
+		for (const std::shared_ptr<MeshImport>& load : complete_loads)
+			finish_load(load);
+		return uint32(pending_loads_.size());
+	}
+
 	template <typename FUNC>
 	void foreach_mesh(const FUNC& f)
 	{
@@ -382,6 +408,40 @@ public:
 	}
 
 private:
+	std::shared_ptr<MeshImport> load_from_file_async(const std::string& filename,
+													 bool (*import)(MESH&, const std::string&), bool normalized)
+	{
+		if constexpr (std::is_default_constructible_v<MESH>)
+		{
+			std::shared_ptr<MeshImport> load = io::import_async<MESH>(filename, import);
+			pending_loads_.push_back({load, normalized});
+			return load;
+		}
+		else
+			return nullptr;
+	}
+
+	MESH* register_imported_mesh(std::unique_ptr<MESH> mesh, const std::string& filename, bool normalized)
+	{
+		std::string name = filename_from_path(filename);
+		if (has_mesh(name))
+			name = remove_extension(name) + "_" + std::to_string(number_of_meshes()) + "." + extension(name);
+		const auto [it, inserted] = meshes_.emplace(name, std::move(mesh));
+		MESH* m = it->second.get();
+
+		MeshData<MESH>& md = mesh_data(*m);
+		md.init(m);
+		std::shared_ptr<Attribute<Vec3>> vertex_position = get_attribute<Vec3, Vertex>(*m, "position");
+		if (vertex_position)
+		{
+			if (normalized)
+				geometry::rescale(*vertex_position, 1);
+			set_mesh_bb_vertex_position(*m, vertex_position);
+		}
+		boost::synapse::emit<mesh_added>(this, m);
+		return m;
+	}
+
 	void update_meshes_bb()
 	{
 		for (uint32 i = 0; i < 3; ++i)
@@ -478,22 +538,24 @@ protected:
 				if constexpr (mesh_traits<MESH>::dimension == 1)
 				{
 					for (auto file : result)
-						load_graph_from_file(file);
+						load_graph_from_file_async(file);
 				}
 				if constexpr (mesh_traits<MESH>::dimension == 2)
 				{
 					for (auto file : result)
-						load_surface_from_file(file);
+						load_surface_from_file_async(file);
 				}
 				if constexpr (mesh_traits<MESH>::dimension == 3)
 				{
 					for (auto file : result)
-						load_volume_from_file(file);
+						load_volume_from_file_async(file);
 				}
 			}
 			open_file_dialog = nullptr;
 		}
 
+		update_pending_loads();
+
 		open_save_popup_ = false;
 		if (ImGui::BeginMenu(name_.c_str()))
 		{
@@ -585,6 +647,19 @@ protected:
 
 	void left_panel() override
 	{
+		for (const PendingLoad& pl : pending_loads_)
+		{
+			const io::ImportProgress& progress = pl.import_->progress();
+			ImGui::PushID(pl.import_.get());
+			ImGui::TextUnformatted(filename_from_path(pl.import_->filename()).c_str());
+			const std::string phase = io::import_phase_name(progress.phase());
+			ImGui::ProgressBar(progress.fraction(), ImVec2(-80, 0), phase.c_str());
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel"))
+				pl.import_->cancel();
+			ImGui::PopID();
+		}
+
 		imgui_mesh_selector(this, selected_mesh_, "Mesh", [&](MESH& m) {
 			selected_mesh_ = &m;
 			mesh_data(m).outlined_until_ = App::frame_time_ + 1.0;
@@ -680,6 +755,13 @@ private:
 
 	std::unordered_map<std::string, std::unique_ptr<MESH>> meshes_;
 	std::unordered_map<const MESH*, MeshData<MESH>> mesh_data_;
+
+	struct PendingLoad
+	{
+		std::shared_ptr<MeshImport> import_;
+		bool normalized_;
+	};
+	std::vector<PendingLoad> pending_loads_;
 	Vec3 bb_min_, bb_max_;
 };
 
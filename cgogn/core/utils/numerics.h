@@ -32,6 +32,10 @@
 
 #include <cgogn/core/utils/assert.h>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace cgogn
 {
 
@@ -145,6 +149,19 @@ inline Scalar clamp(const Scalar x, const Scalar min, const Scalar max)
 	return std::min(max, std::max(min, x));
 }
 
+// position of the lowest set bit of x (x must not be 0)
+inline uint32 count_trailing_zeros(uint64 x)
+{
+	cgogn_assert(x != 0u);
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, x);
+	return uint32(index);
+#else
+	return uint32(__builtin_ctzll(x));
+#endif
+}
+
 template <typename T, std::size_t bytes, typename enable = void>
 struct fixed_precision
 {
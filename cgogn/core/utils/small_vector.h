@@ -0,0 +1,196 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_CORE_UTILS_SMALL_VECTOR_H_
+#define CGOGN_CORE_UTILS_SMALL_VECTOR_H_
+
+#include <cgogn/core/utils/assert.h>
+#include <cgogn/core/utils/numerics.h>
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace cgogn
+{
+
+// vector that stores its first N elements inline (no heap allocation unless more than N elements are pushed)
+// (meant for small value types like cells)
+template <typename T, uint32 N>
+class SmallVector
+{
+	static_assert(N > 0u, "SmallVector inline capacity should be > 0");
+	static_assert(std::is_trivially_destructible_v<T>, "SmallVector only holds trivially destructible elements");
+
+	alignas(T) unsigned char inline_[N * sizeof(T)];
+	std::vector<T> heap_; // holds all the elements once the inline capacity is exceeded
+	uint32 size_;
+
+	inline T* inline_data()
+	{
+		return reinterpret_cast<T*>(inline_);
+	}
+	inline const T* inline_data() const
+	{
+		return reinterpret_cast<const T*>(inline_);
+	}
+
+public:
+	using value_type = T;
+	using iterator = T*;
+	using const_iterator = const T*;
+
+	SmallVector() : size_(0u)
+	{
+	}
+
+	SmallVector(const SmallVector& other) : heap_(other.heap_), size_(other.size_)
+	{
+		if (heap_.empty())
+			std::uninitialized_copy_n(other.inline_data(), size_, inline_data());
+	}
+
+	SmallVector(SmallVector&& other) : heap_(std::move(other.heap_)), size_(other.size_)
+	{
+		if (heap_.empty())
+			std::uninitialized_copy_n(other.inline_data(), size_, inline_data());
+		other.clear();
+	}
+
+	SmallVector& operator=(const SmallVector& other)
+	{
+		if (this != &other)
+		{
+			heap_ = other.heap_;
+			size_ = other.size_;
+			if (heap_.empty())
+				std::uninitialized_copy_n(other.inline_data(), size_, inline_data());
+		}
+		return *this;
+	}
+
+	SmallVector& operator=(SmallVector&& other)
+	{
+		if (this != &other)
+		{
+			heap_ = std::move(other.heap_);
+			size_ = other.size_;
+			if (heap_.empty())
+				std::uninitialized_copy_n(other.inline_data(), size_, inline_data());
+			other.clear();
+		}
+		return *this;
+	}
+
+	inline uint32 size() const
+	{
+		return size_;
+	}
+
+	inline bool empty() const
+	{
+		return size_ == 0u;
+	}
+
+	inline T* data()
+	{
+		return heap_.empty() ? inline_data() : heap_.data();
+	}
+	inline const T* data() const
+	{
+		return heap_.empty() ? inline_data() : heap_.data();
+	}
+
+	inline T& operator[](uint32 i)
+	{
+		cgogn_assert(i < size_);
+		return data()[i];
+	}
+	inline const T& operator[](uint32 i) const
+	{
+		cgogn_assert(i < size_);
+		return data()[i];
+	}
+
+	inline T& front()
+	{
+		return (*this)[0];
+	}
+	inline const T& front() const
+	{
+		return (*this)[0];
+	}
+	inline T& back()
+	{
+		return (*this)[size_ - 1u];
+	}
+	inline const T& back() const
+	{
+		return (*this)[size_ - 1u];
+	}
+
+	inline iterator begin()
+	{
+		return data();
+	}
+	inline iterator end()
+	{
+		return data() + size_;
+	}
+	inline const_iterator begin() const
+	{
+		return data();
+	}
+	inline const_iterator end() const
+	{
+		return data() + size_;
+	}
+
+	inline void push_back(const T& x)
+	{
+		if (heap_.empty())
+		{
+			if (size_ < N)
+			{
+				new (inline_ + size_ * sizeof(T)) T(x);
+				++size_;
+				return;
+			}
+			heap_.reserve(2u * N);
+			heap_.assign(inline_data(), inline_data() + N);
+		}
+		heap_.push_back(x);
+		++size_;
+	}
+
+	inline void clear()
+	{
+		heap_.clear();
+		size_ = 0u;
+	}
+};
+
+} // namespace cgogn
+
+#endif // CGOGN_CORE_UTILS_SMALL_VECTOR_H_
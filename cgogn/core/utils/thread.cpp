@@ -24,12 +24,25 @@
 #include <cgogn/core/utils/thread.h>
 #include <cgogn/core/utils/thread_pool.h>
 
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
 namespace cgogn
 {
 
 CGOGN_TLS uint32 thread_index_;
 CGOGN_TLS Buffers<uint32>* uint32_buffers_thread_ = nullptr;
 
+namespace
+{
+
+std::mutex thread_indices_mutex_;
+// used thread indices (the index 0 is the one of the main thread)
+std::vector<bool> used_thread_indices_ = {true};
+
+} // namespace
+
 CGOGN_TLS uint32 uint32_value_ = 0;
 CGOGN_TLS float64 float64_value_ = 0.0;
 
@@ -55,21 +68,34 @@ CGOGN_CORE_EXPORT void thread_stop()
 	uint32_buffers_thread_ = nullptr;
 }
 
-CGOGN_CORE_EXPORT uint32 max_nb_threads()
+CGOGN_CORE_EXPORT uint32 acquire_thread_index()
 {
-	return uint32(thread_pool()->max_nb_workers()) + 1 // account for the main thread
-		   + 1										   // account for 1 external thread
-		;
+	std::lock_guard<std::mutex> lock(thread_indices_mutex_);
+	auto it = std::find(used_thread_indices_.begin(), used_thread_indices_.end(), false);
+	const uint32 index = uint32(std::distance(used_thread_indices_.begin(), it));
+	if (it == used_thread_indices_.end())
+		used_thread_indices_.push_back(true);
+	else
+		*it = true;
+	return index;
 }
 
-CGOGN_CORE_EXPORT uint32 current_thread_index()
+CGOGN_CORE_EXPORT void release_thread_index(uint32 index)
 {
-	return thread_index_;
+	std::lock_guard<std::mutex> lock(thread_indices_mutex_);
+	used_thread_indices_[index] = false;
 }
 
-CGOGN_CORE_EXPORT uint32 current_worker_index()
+CGOGN_CORE_EXPORT uint32 max_nb_threads()
 {
-	return thread_index_ - 1; // account for the main thread
+	thread_pool(); // the workers of the global pool get their indices when it is created
+	std::lock_guard<std::mutex> lock(thread_indices_mutex_);
+	return uint32(used_thread_indices_.size()) + 1; // account for 1 external thread
+}
+
+CGOGN_CORE_EXPORT uint32 current_thread_index()
+{
+	return thread_index_;
 }
 
 CGOGN_CORE_EXPORT Buffers<uint32>* uint32_buffers()
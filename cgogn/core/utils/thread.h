@@ -59,9 +59,21 @@ CGOGN_CORE_EXPORT void thread_start(uint32 index = 0);
  */
 CGOGN_CORE_EXPORT void thread_stop();
 
+/**
+ * @brief get a thread index that is not used by any other thread (0 is the index of the main thread)
+ * The index has to be given back with release_thread_index when the thread stops.
+ */
+CGOGN_CORE_EXPORT uint32 acquire_thread_index();
+CGOGN_CORE_EXPORT void release_thread_index(uint32 index);
+
+/**
+ * @brief get the number of thread indices the per-thread data have to be sized for
+ * (the indices acquired so far + 1 for an additional thread started afterwards)
+ */
 CGOGN_CORE_EXPORT uint32 max_nb_threads();
 
 CGOGN_CORE_EXPORT uint32 current_thread_index();
+// index of the current thread in the pool of which it is a worker
 CGOGN_CORE_EXPORT uint32 current_worker_index();
 
 CGOGN_CORE_EXPORT Buffers<uint32>* uint32_buffers();
@@ -74,8 +86,11 @@ void launch_thread(F f)
 	{
 		std::thread t([f]() {
 			launched = true;
-			thread_start(max_nb_threads() - 1); // additional thread gets the max id
+			const uint32 index = acquire_thread_index();
+			thread_start(index);
 			f();
+			thread_stop();
+			release_thread_index(index);
 			launched = false;
 		});
 		t.detach();
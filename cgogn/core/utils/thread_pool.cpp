@@ -27,91 +27,246 @@
 namespace cgogn
 {
 
-ThreadPool::ThreadPool() : stop_(false)
-{
-	nb_working_workers_ = std::thread::hardware_concurrency() - 1;
-
-	for (uint32 i = 0u; i < nb_working_workers_; ++i)
-	{
-		workers_.emplace_back([this, i]() -> void {
-			thread_start(i + 1);
-			for (;;)
-			{
-				while (i >= nb_working_workers_)
-				{
-					std::unique_lock<std::mutex> lock(running_mutex_);
-					condition_running_.wait(lock);
-				}
-
-				std::unique_lock<std::mutex> lock(queue_mutex_);
-				condition_task_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
-
-				if (stop_ && tasks_.empty())
-				{
-					thread_stop();
-					return;
-				}
-
-				if (i < nb_working_workers_)
-				{
-					PackagedTask task = std::move(tasks_.front());
-					tasks_.pop();
-					lock.unlock();
-#if defined(_MSC_VER) && _MSC_VER < 1900
-					(*task)();
-#else
-					task();
-#endif
-				}
-				else
-				{
-					lock.unlock();
-					condition_task_.notify_one();
-				}
-			}
-		});
-	}
-
-	std::cout << "ThreadPool launched with " << nb_working_workers_ << " workers" << std::endl;
+namespace
+{
+
+// pool used by the parallel algorithms called from the current thread (set by ThreadPoolScope)
+CGOGN_TLS ThreadPool* scope_pool_ = nullptr;
+// pool of which the current thread is a worker & index of the worker in this pool
+CGOGN_TLS ThreadPool* worker_pool_ = nullptr;
+CGOGN_TLS uint32 worker_index_ = 0u;
+
+ThreadPool* global_thread_pool()
+{
+	// thread safe according to
+	// http://stackoverflow.com/questions/8102125/is-local-static-variable-initialization-thread-safe-in-c11
+	static ThreadPool pool;
+	return &pool;
 }
 
-ThreadPool::~ThreadPool()
+} // namespace
+
+// ring buffer of task entries (it only grows, so that the submissions do not allocate once it is large enough)
+struct ThreadPool::WorkerQueue
 {
-	nb_working_workers_ = uint32(workers_.size());
-	condition_running_.notify_all();
+	std::mutex mutex_;
+	std::vector<TaskEntry> entries_ = std::vector<TaskEntry>(64u);
+	uint32 first_ = 0u;
+	uint32 size_ = 0u;
 
+	inline bool empty() const
 	{
-		std::unique_lock<std::mutex> lock(queue_mutex_);
-		stop_ = true;
+		return size_ == 0u;
 	}
 
-#if !(defined(CGOGN_WIN_VER) && (CGOGN_WIN_VER <= 61))
-	condition_running_.notify_all();
+	void push_back(const TaskEntry& entry)
+	{
+		const uint32 capacity = uint32(entries_.size());
+		if (size_ == capacity)
+		{
+			std::vector<TaskEntry> entries(2u * capacity);
+			for (uint32 i = 0u; i < size_; ++i)
+				entries[i] = entries_[(first_ + i) % capacity];
+			entries_.swap(entries);
+			first_ = 0u;
+		}
+		entries_[(first_ + size_) % uint32(entries_.size())] = entry;
+		++size_;
+	}
+
+	TaskEntry pop_back()
+	{
+		--size_;
+		return entries_[(first_ + size_) % uint32(entries_.size())];
+	}
+
+	TaskEntry pop_front()
+	{
+		TaskEntry entry = entries_[first_];
+		first_ = (first_ + 1u) % uint32(entries_.size());
+		--size_;
+		return entry;
+	}
+};
+
+ThreadPool::ThreadPool() : ThreadPool(std::max(1u, std::thread::hardware_concurrency()) - 1u)
+{
+}
+
+ThreadPool::ThreadPool(uint32 nb_workers) : nb_queued_tasks_(0u), stop_(false), nb_working_workers_(nb_workers)
+{
+	for (uint32 i = 0u; i < nb_workers; ++i)
+		queues_.push_back(std::make_unique<WorkerQueue>());
+	for (uint32 i = 0u; i < nb_workers; ++i)
+	{
+		// (the indices are acquired before the threads start, so that max_nb_threads covers them on return)
+		const uint32 thread_index = acquire_thread_index();
+		workers_.emplace_back([this, i, thread_index]() -> void { worker_loop(i, thread_index); });
+	}
+
+	std::cout << "ThreadPool launched with " << nb_workers << " workers" << std::endl;
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::unique_lock<std::mutex> lock(sleep_mutex_);
+		nb_working_workers_ = uint32(workers_.size());
+		stop_ = true;
+	}
 	condition_task_.notify_all();
-#endif
 
 	for (std::thread& worker : workers_)
 		worker.join();
 }
 
-void ThreadPool::set_nb_workers(uint32 nb)
+void ThreadPool::worker_loop(uint32 worker, uint32 thread_index)
 {
-	if (nb == 0xffffffff)
-		nb_working_workers_ = uint32(workers_.size());
+	worker_pool_ = this;
+	worker_index_ = worker;
+	thread_start(thread_index);
+
+	TaskEntry entry;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(sleep_mutex_);
+			condition_task_.wait(lock, [&]() {
+				return stop_ || (worker < nb_working_workers_ && nb_queued_tasks_.load() > 0u);
+			});
+			if (stop_ && nb_queued_tasks_.load() == 0u)
+				break;
+		}
+		while (worker < nb_working_workers_ && take(worker, entry))
+			execute(entry);
+	}
+
+	thread_stop();
+	release_thread_index(thread_index);
+	worker_pool_ = nullptr;
+}
+
+void ThreadPool::submit(Task& task, uint32 n)
+{
+	task.nb_pending_.store(n);
+	if (queues_.empty())
+	{
+		// a pool without worker: the calls are run by the submitting thread
+		for (uint32 i = 0u; i < n; ++i)
+			execute({&task, i});
+		return;
+	}
+	nb_queued_tasks_ += n;
+	// the i-th call goes to the queue of the i-th working worker (the other workers steal it if needed)
+	const uint32 nb_queues = std::max(1u, std::min(nb_working_workers_.load(), uint32(queues_.size())));
+	for (uint32 i = 0u; i < n; ++i)
+	{
+		WorkerQueue& queue = *queues_[i % nb_queues];
+		std::lock_guard<std::mutex> lock(queue.mutex_);
+		queue.push_back({&task, i});
+	}
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex_);
+	}
+	// (notify_one could wake a worker that is not working)
+	condition_task_.notify_all();
+}
+
+void ThreadPool::wait(Task& task)
+{
+	if (worker_pool_ == this)
+	{
+		// a worker of the pool executes the pending tasks while waiting (nested parallelism)
+		TaskEntry entry;
+		while (task.nb_pending_.load(std::memory_order_acquire) > 0u)
+		{
+			if (take(worker_index_, entry))
+				execute(entry);
+			else
+				std::this_thread::yield();
+		}
+	}
 	else
-		nb_working_workers_ = std::min(uint32(workers_.size()), nb);
+	{
+		std::unique_lock<std::mutex> lock(done_mutex_);
+		condition_done_.wait(lock, [&]() { return task.nb_pending_.load(std::memory_order_acquire) == 0u; });
+	}
+}
 
-	condition_running_.notify_all();
+bool ThreadPool::take(uint32 worker, TaskEntry& entry)
+{
+	if (nb_queued_tasks_.load() == 0u)
+		return false;
+
+	// the last entry of the own queue first (most recently submitted), then the first entry of the other queues
+	const uint32 nb_queues = uint32(queues_.size());
+	for (uint32 k = 0u; k < nb_queues; ++k)
+	{
+		WorkerQueue& queue = *queues_[(worker + k) % nb_queues];
+		std::lock_guard<std::mutex> lock(queue.mutex_);
+		if (!queue.empty())
+		{
+			entry = k == 0u ? queue.pop_back() : queue.pop_front();
+			--nb_queued_tasks_;
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::execute(const TaskEntry& entry)
+{
+	Task* task = entry.task_;
+	if (task->detached_)
+	{
+		task->run_(task, entry.index_);
+		return;
+	}
+	task->run_(task, entry.index_);
+	if (task->nb_pending_.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+	{
+		// the task may be destroyed by its submitter from here
+		std::lock_guard<std::mutex> lock(done_mutex_);
+		condition_done_.notify_all();
+	}
+}
+
+void ThreadPool::set_nb_workers(uint32 nb)
+{
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex_);
+		if (nb == 0xffffffff)
+			nb_working_workers_ = uint32(workers_.size());
+		else
+			nb_working_workers_ = std::min(uint32(workers_.size()), nb);
+	}
+	condition_task_.notify_all();
 
 	std::cout << "ThreadPool now using " << nb_working_workers_ << " workers" << std::endl;
 }
 
+uint32 current_worker_index()
+{
+	return worker_index_;
+}
+
 ThreadPool* thread_pool()
 {
-	// thread safe according to
-	// http://stackoverflow.com/questions/8102125/is-local-static-variable-initialization-thread-safe-in-c11
-	static ThreadPool pool;
-	return &pool;
+	if (scope_pool_)
+		return scope_pool_;
+	if (worker_pool_)
+		return worker_pool_;
+	return global_thread_pool();
+}
+
+ThreadPoolScope::ThreadPoolScope(ThreadPool* pool) : previous_(scope_pool_)
+{
+	scope_pool_ = pool;
+}
+
+ThreadPoolScope::~ThreadPoolScope()
+{
+	scope_pool_ = previous_;
 }
 
 std::unique_ptr<ThreadPool> temp_thread_pool()
@@ -61,13 +61,14 @@
 #include <cgogn/core/utils/definitions.h>
 #include <cgogn/core/utils/numerics.h>
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <future>
 #include <iostream>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 
@@ -103,57 +104,111 @@ private:
 	std::ptrdiff_t count_ = 0;
 };
 
+/**
+ * Pool of worker threads with one task queue per worker.
+ * Each worker takes the last task of its own queue and, when it is empty, steals the first task of another queue.
+ * A worker that waits for the completion of a task it has submitted (nested parallelism) executes the pending tasks
+ * meanwhile, so that nested parallel traversals do not deadlock the pool.
+ * Several pools can coexist: the parallel algorithms use the pool returned by thread_pool() that can be selected
+ * for the current thread with a ThreadPoolScope (the workers of a pool use their own pool).
+ */
 class CGOGN_CORE_EXPORT ThreadPool final
 {
 public:
+	/**
+	 * @brief unit of work of the pool: run_(task, i) is called for each index i the task has been submitted with
+	 * The task is owned by the submitter (the submission does not allocate).
+	 */
+	struct Task
+	{
+		explicit Task(void (*run)(Task*, uint32), bool detached = false)
+			: run_(run), nb_pending_(0u), detached_(detached)
+		{
+		}
+
+		void (*run_)(Task*, uint32);
+		std::atomic<uint32> nb_pending_;
+		bool detached_; // a detached task is deleted by its run_ function and is not waited for
+	};
+
 	ThreadPool();
+	explicit ThreadPool(uint32 nb_workers);
 	~ThreadPool();
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(ThreadPool);
 
-#if defined(_MSC_VER) && _MSC_VER < 1900
-	using PackagedTask = std::shared_ptr<std::packaged_task<void()>>; // avoiding a MSVC 2013 Bug
-#else
 	using PackagedTask = std::packaged_task<void()>;
-#endif
 
+	// the task is run by the calling thread if the pool has no worker
 	template <class F, class... Args>
 	std::future<void> enqueue(const F& f, Args&&... args)
 	{
 		static_assert(std::is_same_v<typename std::invoke_result_t<F, Args...>, void>,
 					  "The thread pool only accepts non-returning functions.");
 
-#if defined(_MSC_VER) && _MSC_VER < 1900
-		PackagedTask task = std::make_shared<std::packaged_task<void()>>(std::bind(f, std::forward<Args>(args)...));
-		std::future<void> res = task->get_future();
-#else
+		struct PackagedTaskHolder : public Task
+		{
+			PackagedTaskHolder(PackagedTask&& task) : Task(&PackagedTaskHolder::run, true), task_(std::move(task))
+			{
+			}
+			static void run(Task* t, uint32)
+			{
+				PackagedTaskHolder* holder = static_cast<PackagedTaskHolder*>(t);
+				holder->task_();
+				delete holder;
+			}
+			PackagedTask task_;
+		};
+
 		PackagedTask task([&, f]() -> void { f(std::forward<Args>(args)...); });
 		std::future<void> res = task.get_future();
-#endif
 
+		// don't allow enqueueing after stopping the pool
+		if (stop_)
 		{
-			std::unique_lock<std::mutex> lock(queue_mutex_);
-			// don't allow enqueueing after stopping the pool
-			if (stop_)
-			{
-				std::cout << "ThreadPool::enqueue : Enqueue on stopped ThreadPool." << std::endl;
-				cgogn_assert_not_reached("Enqueue on stopped ThreadPool");
-			}
-			// Push work back on the queue
-			tasks_.push(std::move(task));
+			std::cout << "ThreadPool::enqueue : Enqueue on stopped ThreadPool." << std::endl;
+			cgogn_assert_not_reached("Enqueue on stopped ThreadPool");
 		}
-
-		// Notify a thread that there is new work to perform
-		condition_task_.notify_one();
+		submit(*new PackagedTaskHolder(std::move(task)), 1u);
 
 		return res;
 	}
 
+	/**
+	 * @brief call f(i) for each i in [0, n) on the working workers and return when all the calls are done
+	 * The calls are run sequentially by the calling thread if there is no working worker.
+	 */
+	template <typename FUNC>
+	void fork_join(uint32 n, const FUNC& f)
+	{
+		if (n == 0u)
+			return;
+		if (nb_working_workers_.load() == 0u)
+		{
+			for (uint32 i = 0u; i < n; ++i)
+				f(i);
+			return;
+		}
+
+		struct ForkJoinTask : public Task
+		{
+			ForkJoinTask(const FUNC& f) : Task(&ForkJoinTask::run), f_(f)
+			{
+			}
+			static void run(Task* t, uint32 i)
+			{
+				static_cast<ForkJoinTask*>(t)->f_(i);
+			}
+			const FUNC& f_;
+		};
+
+		ForkJoinTask task(f);
+		submit(task, n);
+		wait(task);
+	}
+
 	template <class FUNC>
 	void execute_all(const FUNC&& f)
 	{
-		// nb_working_workers_ = uint32(workers_.size());
-		// condition_running_.notify_all();
-
 		std::vector<std::future<void>> futures;
 		futures.reserve(nb_working_workers_);
 		counting_barrier barrier(nb_working_workers_);
@@ -171,7 +226,7 @@ public:
 	 */
 	inline uint32 nb_workers() const
 	{
-		return nb_working_workers_;
+		return nb_working_workers_.load();
 	}
 
 	/**
@@ -189,31 +244,113 @@ public:
 	void set_nb_workers(uint32 nb = 0xffffffff);
 
 private:
+	struct TaskEntry
+	{
+		Task* task_;
+		uint32 index_;
+	};
+	struct WorkerQueue;
+
+	void worker_loop(uint32 worker, uint32 thread_index);
+	void submit(Task& task, uint32 n);
+	void wait(Task& task);
+	bool take(uint32 worker, TaskEntry& entry);
+	void execute(const TaskEntry& entry);
+
 #pragma warning(push)
 #pragma warning(disable : 4251)
 
 	// need to keep track of threads so we can join them
 	std::vector<std::thread> workers_;
-	// the task queue
-	std::queue<PackagedTask> tasks_;
-
-	std::vector<std::thread> additional_threads_;
+	// the task queues (one per worker)
+	std::vector<std::unique_ptr<WorkerQueue>> queues_;
+	std::atomic<uint32> nb_queued_tasks_;
 
 	// synchronization
-	std::mutex queue_mutex_;
+	std::mutex sleep_mutex_;
 	std::condition_variable condition_task_;
-	bool stop_;
+	std::mutex done_mutex_;
+	std::condition_variable condition_done_;
+	std::atomic<bool> stop_;
 
 	// limit usage to the n-th first workers
-	uint32 nb_working_workers_;
-	std::mutex running_mutex_;
-	std::condition_variable condition_running_;
+	std::atomic<uint32> nb_working_workers_;
 
 #pragma warning(pop)
 };
 
+/**
+ * @brief get the pool used by the parallel algorithms called from the current thread
+ * (the pool of the innermost ThreadPoolScope of the thread, or the pool of the worker, or the global pool)
+ */
 CGOGN_CORE_EXPORT ThreadPool* thread_pool();
 
+/**
+ * @brief use the given pool for the parallel algorithms called from the current thread during the lifetime of the scope
+ * (e.g. to run a background computation on its own pool without starving the global pool)
+ */
+class CGOGN_CORE_EXPORT ThreadPoolScope final
+{
+	ThreadPool* previous_;
+
+public:
+	explicit ThreadPoolScope(ThreadPool* pool);
+	~ThreadPoolScope();
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(ThreadPoolScope);
+};
+
+/**
+ * @brief call the given function on each chunk index in [0, nb_chunks) using the working workers of the pool
+ * Each worker first processes its own contiguous range of chunks and then steals the remaining chunks of the other
+ * workers. The traversal stops as soon as the function returns false.
+ * @param nb_chunks number of chunks
+ * @param f function taking the chunk index and returning a bool
+ */
+template <typename FUNC>
+void parallel_foreach_chunk(uint32 nb_chunks, const FUNC& f)
+{
+	ThreadPool* pool = thread_pool();
+	uint32 nb_workers = std::min(pool->nb_workers(), nb_chunks);
+	if (nb_workers == 0)
+	{
+		for (uint32 c = 0u; c < nb_chunks; ++c)
+		{
+			if (!f(c))
+				break;
+		}
+		return;
+	}
+
+	// [next_chunk[w], last_chunk[w]) is the range of chunks that remain to be processed in the range of worker w
+	std::vector<std::atomic<uint32>> next_chunk(nb_workers);
+	std::vector<uint32> last_chunk(nb_workers);
+	for (uint32 w = 0u; w < nb_workers; ++w)
+	{
+		next_chunk[w].store(uint32(uint64(nb_chunks) * w / nb_workers));
+		last_chunk[w] = uint32(uint64(nb_chunks) * (w + 1u) / nb_workers);
+	}
+
+	std::atomic<bool> stop(false);
+
+	pool->fork_join(nb_workers, [&](uint32 w) {
+		// own range first (k == 0), then the ranges of the other workers
+		for (uint32 k = 0u; k < nb_workers && !stop.load(std::memory_order_relaxed); ++k)
+		{
+			const uint32 r = (w + k) % nb_workers;
+			for (uint32 c = next_chunk[r].fetch_add(1u); c < last_chunk[r]; c = next_chunk[r].fetch_add(1u))
+			{
+				if (stop.load(std::memory_order_relaxed))
+					break;
+				if (!f(c))
+				{
+					stop.store(true, std::memory_order_relaxed);
+					break;
+				}
+			}
+		}
+	});
+}
+
 } // namespace cgogn
 
 #endif // CGOGN_CORE_UTILS_THREADPOOL_H_
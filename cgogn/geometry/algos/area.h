@@ -26,6 +26,7 @@
 
 #include <cgogn/core/functions/attributes.h>
 #include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/functions/traversals/global.h>
 
 #include <cgogn/geometry/functions/area.h>
 #include <cgogn/geometry/types/vector_traits.h>
@@ -197,12 +198,9 @@ Scalar area(const MESH& m, const typename mesh_traits<MESH>::template Attribute<
 {
 	using Face = typename mesh_traits<MESH>::Face;
 
-	Scalar result = 0;
-	foreach_cell(m, [&](Face f) -> bool {
-		result += area(m, f, vertex_position);
-		return true;
-	});
-	return result;
+	return parallel_reduce_cell(
+		m, Scalar(0), [&](Face f) -> Scalar { return area(m, f, vertex_position); },
+		[](Scalar a, Scalar b) -> Scalar { return a + b; });
 }
 
 /**
@@ -211,28 +209,13 @@ Scalar area(const MESH& m, const typename mesh_traits<MESH>::template Attribute<
 template <typename CELL, typename MESH>
 Scalar mean_cell_area(const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position)
 {
-	thread_pool()->execute_all([]() {
-		float64_value() = 0.0;
-		uint32_value() = 0;
-	});
+	using SumCount = std::pair<Scalar, uint32>;
 
-	parallel_foreach_cell(m, [&](CELL c) -> bool {
-		float64_value() += area(m, c, vertex_position);
-		++uint32_value();
-		return true;
-	});
-
-	Scalar area_sum = 0.0;
-	uint32 nbc = 0;
-
-	std::mutex mutex;
-	thread_pool()->execute_all([&]() {
-		std::lock_guard<std::mutex> lock(mutex);
-		area_sum += float64_value();
-		nbc += uint32_value();
-	});
+	SumCount sum_count = parallel_reduce_cell(
+		m, SumCount{0.0, 0}, [&](CELL c) -> SumCount { return {area(m, c, vertex_position), 1}; },
+		[](const SumCount& a, const SumCount& b) -> SumCount { return {a.first + b.first, a.second + b.second}; });
 
-	return area_sum / Scalar(nbc);
+	return sum_count.first / Scalar(sum_count.second);
 }
 
 } // namespace geometry
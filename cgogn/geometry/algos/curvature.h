@@ -33,6 +33,7 @@
 #include <cgogn/geometry/algos/selection.h>
 #include <cgogn/geometry/functions/inclusion.h>
 #include <cgogn/geometry/functions/intersection.h>
+#include <cgogn/geometry/types/vertex_neighborhoods.h>
 
 #include <cgogn/geometry/types/vector_traits.h>
 
@@ -42,9 +43,14 @@ namespace cgogn
 namespace geometry
 {
 
-template <typename MESH>
+namespace internal
+{
+
+// curvature tensor of the vertex v estimated on the given neighborhood of v (the vertices within the sphere of given
+// radius, see within_sphere): NEIGHBORHOOD is a CellCache or a VertexNeighborhood of the mesh
+template <typename MESH, typename NEIGHBORHOOD>
 std::tuple<Scalar, Scalar, Vec3, Vec3, Vec3> curvature(
-	const MESH& m, typename mesh_traits<MESH>::Vertex v, Scalar radius,
+	const MESH& m, typename mesh_traits<MESH>::Vertex v, Scalar radius, const NEIGHBORHOOD& neighborhood,
 	const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
 	const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_normal,
 	const typename mesh_traits<MESH>::template Attribute<Scalar>* edge_angle)
@@ -54,13 +60,11 @@ std::tuple<Scalar, Scalar, Vec3, Vec3, Vec3> curvature(
 	using Edge = typename mesh_traits<MESH>::Edge;
 	using Face = typename mesh_traits<MESH>::Face;
 
-	CellCache<MESH> neighborhood = within_sphere(m, v, radius, vertex_position);
-
 	Mat3 tensor;
 	tensor.setZero();
 
 	foreach_cell(neighborhood, [&](Edge e) -> bool {
-		std::vector<Vertex> vv = incident_vertices(m, e);
+		auto vv = incident_vertices<2>(m, e);
 		Vec3 ev = value<Vec3>(m, vertex_position, vv[1]) - value<Vec3>(m, vertex_position, vv[0]);
 		tensor += (ev * ev.transpose()) * value<Scalar>(m, edge_angle, e) * (Scalar(1) / ev.norm());
 		return true;
@@ -68,8 +72,12 @@ std::tuple<Scalar, Scalar, Vec3, Vec3, Vec3> curvature(
 
 	const Vec3& p = value<Vec3>(m, vertex_position, v);
 	foreach_cell(neighborhood, [&](HalfEdge h) -> bool {
-		Edge e = incident_edges(m, h)[0];
-		std::vector<Vertex> vv = incident_vertices(m, e);
+		Edge e;
+		foreach_incident_edge(m, h, [&](Edge ie) -> bool {
+			e = ie;
+			return false;
+		});
+		auto vv = incident_vertices<2>(m, e);
 		const Vec3& p1 = value<Vec3>(m, vertex_position, vv[0]);
 		const Vec3& p2 = value<Vec3>(m, vertex_position, vv[1]);
 		Vec3 ev = p2 - p1;
@@ -79,10 +87,20 @@ std::tuple<Scalar, Scalar, Vec3, Vec3, Vec3> curvature(
 		return true;
 	});
 
-	Scalar neighborhood_area = area(neighborhood, vertex_position);
+	Scalar neighborhood_area = 0;
+	foreach_cell(neighborhood, [&](Face f) -> bool {
+		neighborhood_area += area(m, f, vertex_position);
+		return true;
+	});
 	foreach_cell(neighborhood, [&](HalfEdge h) -> bool {
-		Face f = incident_faces(m, h)[0];
-		std::vector<Vertex> vv = incident_vertices(m, f);
+		Face f;
+		foreach_incident_face(m, h, [&](Face iface) -> bool {
+			f = iface;
+			return false;
+		});
+		if (!f.is_valid()) // boundary halfedge
+			return true;
+		auto vv = incident_vertices<3>(m, f);
 		const Vec3& p1 = value<Vec3>(m, vertex_position, vv[0]);
 		const Vec3& p2 = value<Vec3>(m, vertex_position, vv[1]);
 		const Vec3& p3 = value<Vec3>(m, vertex_position, vv[2]);
@@ -161,6 +179,46 @@ std::tuple<Scalar, Scalar, Vec3, Vec3, Vec3> curvature(
 	return {kmax, kmin, Kmax, Kmin, Knormal};
 }
 
+} // namespace internal
+
+template <typename MESH>
+std::tuple<Scalar, Scalar, Vec3, Vec3, Vec3> curvature(
+	const MESH& m, typename mesh_traits<MESH>::Vertex v, Scalar radius,
+	const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
+	const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_normal,
+	const typename mesh_traits<MESH>::template Attribute<Scalar>* edge_angle)
+{
+	CellCache<MESH> neighborhood = within_sphere(m, v, radius, vertex_position);
+	return internal::curvature(m, v, radius, neighborhood, vertex_position, vertex_normal, edge_angle);
+}
+
+// the sphere neighborhoods of the vertices are streamed by the given VertexNeighborhoods
+// (its flat adjacency and traversal buffers are reused by successive calls)
+template <typename MESH>
+void compute_curvature(VertexNeighborhoods<MESH>& neighborhoods, Scalar radius,
+					   const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
+					   const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_normal,
+					   const typename mesh_traits<MESH>::template Attribute<Scalar>* edge_angle,
+					   typename mesh_traits<MESH>::template Attribute<Scalar>* vertex_kmax,
+					   typename mesh_traits<MESH>::template Attribute<Scalar>* vertex_kmin,
+					   typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_Kmax,
+					   typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_Kmin,
+					   typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_Knormal)
+{
+	const MESH& m = neighborhoods.mesh();
+	neighborhoods.parallel_foreach_within_sphere(
+		vertex_position, radius, [&](const VertexNeighborhood<MESH>& neighborhood) {
+			auto v = neighborhood.center();
+			auto [kmax, kmin, Kmax, Kmin, Knormal] =
+				internal::curvature(m, v, radius, neighborhood, vertex_position, vertex_normal, edge_angle);
+			value<Scalar>(m, vertex_kmax, v) = kmax;
+			value<Scalar>(m, vertex_kmin, v) = kmin;
+			value<Vec3>(m, vertex_Kmax, v) = Kmax;
+			value<Vec3>(m, vertex_Kmin, v) = Kmin;
+			value<Vec3>(m, vertex_Knormal, v) = Knormal;
+		});
+}
+
 template <typename MESH>
 void compute_curvature(const MESH& m, Scalar radius,
 					   const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
@@ -172,16 +230,9 @@ void compute_curvature(const MESH& m, Scalar radius,
 					   typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_Kmin,
 					   typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_Knormal)
 {
-	using Vertex = typename mesh_traits<MESH>::Vertex;
-	parallel_foreach_cell(m, [&](Vertex v) -> bool {
-		auto [kmax, kmin, Kmax, Kmin, Knormal] = curvature(m, v, radius, vertex_position, vertex_normal, edge_angle);
-		value<Scalar>(m, vertex_kmax, v) = kmax;
-		value<Scalar>(m, vertex_kmin, v) = kmin;
-		value<Vec3>(m, vertex_Kmax, v) = Kmax;
-		value<Vec3>(m, vertex_Kmin, v) = Kmin;
-		value<Vec3>(m, vertex_Knormal, v) = Knormal;
-		return true;
-	});
+	VertexNeighborhoods<MESH> neighborhoods(m);
+	compute_curvature(neighborhoods, radius, vertex_position, vertex_normal, edge_angle, vertex_kmax, vertex_kmin,
+					  vertex_Kmax, vertex_Kmin, vertex_Knormal);
 }
 
 /**
@@ -0,0 +1,219 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_GEOMETRY_ALGOS_DIFFERENTIAL_PROPERTIES_H_
+#define CGOGN_GEOMETRY_ALGOS_DIFFERENTIAL_PROPERTIES_H_
+
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/functions/traversals/edge.h>
+#include <cgogn/core/functions/traversals/face.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/functions/traversals/vertex.h>
+
+#include <cgogn/geometry/algos/normal.h>
+#include <cgogn/geometry/functions/angle.h>
+#include <cgogn/geometry/functions/area.h>
+#include <cgogn/geometry/types/vector_traits.h>
+
+#include <array>
+#include <cmath>
+
+namespace cgogn
+{
+
+namespace geometry
+{
+
+// output attributes of compute_differential_properties (the null attributes are not computed)
+template <typename MESH>
+struct DifferentialProperties
+{
+	template <typename T>
+	using Attribute = typename mesh_traits<MESH>::template Attribute<T>;
+
+	Attribute<Vec3>* face_normal_ = nullptr;
+	Attribute<Scalar>* face_area_ = nullptr;
+	Attribute<Vec3>* vertex_normal_ = nullptr;
+	Attribute<Scalar>* vertex_area_ = nullptr; // mixed Voronoi area
+	Attribute<Scalar>* edge_angle_ = nullptr;  // signed dihedral angle
+	Attribute<Scalar>* vertex_gaussian_curvature_ = nullptr;
+	Attribute<Scalar>* vertex_mean_curvature_ = nullptr;
+};
+
+/**
+ * @brief compute the first and second order differential properties of a surface mesh in one parallel vertex sweep
+ * Each vertex gathers the corners of its incident faces and computes its normal (normalized sum of the face normals),
+ * mixed Voronoi area, angle defect (Gaussian curvature) and cotan Laplacian (mean curvature, positive on a convex
+ * surface with outward normals). The faces (resp. edges) are written by their incident vertex of lowest index, so
+ * that no per-face or per-edge sweep nor any temporary attribute is needed. The face & vertex normals and the edge
+ * angles are the same as those of compute_normal and compute_angle. The curvatures and the vertex area are defined
+ * on the corner triangles (exact on triangle meshes).
+ */
+template <typename MESH>
+void compute_differential_properties(const MESH& m,
+									 const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
+									 const DifferentialProperties<MESH>& properties)
+{
+	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
+
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Edge = typename mesh_traits<MESH>::Edge;
+	using Face = typename mesh_traits<MESH>::Face;
+
+	const DifferentialProperties<MESH>& p = properties;
+	const bool with_faces = p.face_normal_ || p.face_area_;
+	const bool with_vertex_normal = p.vertex_normal_ || p.vertex_mean_curvature_;
+	const bool with_vertex_area = p.vertex_area_ || p.vertex_gaussian_curvature_ || p.vertex_mean_curvature_;
+	const bool with_corners = with_vertex_area || p.vertex_gaussian_curvature_;
+
+	auto face_normal = [&](const auto& vertices) -> Vec3 {
+		return internal::polygon_normal(uint32(vertices.size()), [&](uint32 i) -> const Vec3& {
+			return value<Vec3>(m, vertex_position, vertices[i]);
+		});
+	};
+
+	parallel_foreach_cell(m, [&](Vertex v) -> bool {
+		const uint32 vi = index_of(m, v);
+		const Vec3& pv = value<Vec3>(m, vertex_position, v);
+
+		Vec3 normal{0.0, 0.0, 0.0};
+		Vec3 laplacian{0.0, 0.0, 0.0};
+		Scalar area{0};
+		Scalar angle_sum{0};
+
+		foreach_incident_face(m, v, [&](Face f) -> bool {
+			auto vertices = incident_vertices<8>(m, f);
+			const uint32 size = uint32(vertices.size());
+			uint32 corner = 0;
+			uint32 min_index = vi;
+			for (uint32 i = 0; i < size; ++i)
+			{
+				const uint32 index = index_of(m, vertices[i]);
+				if (index == vi)
+					corner = i;
+				min_index = std::min(min_index, index);
+			}
+
+			Vec3 fn{0.0, 0.0, 0.0};
+			if (with_vertex_normal || (with_faces && min_index == vi))
+			{
+				fn = face_normal(vertices);
+				normal += fn;
+			}
+			if (with_faces && min_index == vi)
+			{
+				if (p.face_normal_)
+					value<Vec3>(m, p.face_normal_, f) = fn;
+				if (p.face_area_)
+				{
+					Scalar face_area{0};
+					for (uint32 i = 1; i < size - 1; ++i)
+						face_area += geometry::area(value<Vec3>(m, vertex_position, vertices[0]),
+													value<Vec3>(m, vertex_position, vertices[i]),
+													value<Vec3>(m, vertex_position, vertices[i + 1]));
+					value<Scalar>(m, p.face_area_, f) = face_area;
+				}
+			}
+
+			if (with_corners)
+			{
+				// corner triangle (pv, pn, pp)
+				const Vec3& pn = value<Vec3>(m, vertex_position, vertices[(corner + 1) % size]);
+				const Vec3& pp = value<Vec3>(m, vertex_position, vertices[(corner + size - 1) % size]);
+				const Vec3 a = pn - pv;
+				const Vec3 b = pp - pv;
+				const Vec3 c = pp - pn;
+
+				const Scalar twice_area = a.cross(b).norm();
+				angle_sum += angle(a, b);
+				if (twice_area > 0)
+				{
+					const Scalar cot_n = (-a).dot(c) / twice_area; // at pn, opposite to (pv, pp)
+					const Scalar cot_p = b.dot(c) / twice_area;	   // at pp, opposite to (pv, pn)
+					laplacian += cot_p * a + cot_n * b;
+					if (a.dot(b) < 0)
+						area += twice_area / 4.0; // obtuse at pv
+					else if (cot_n < 0 || cot_p < 0)
+						area += twice_area / 8.0; // obtuse at pn or pp
+					else
+						area += (a.squaredNorm() * cot_p + b.squaredNorm() * cot_n) / 8.0;
+				}
+			}
+			return true;
+		});
+
+		if (with_vertex_normal)
+		{
+			normal.normalize();
+			if (p.vertex_normal_)
+				value<Vec3>(m, p.vertex_normal_, v) = normal;
+		}
+		if (p.vertex_area_)
+			value<Scalar>(m, p.vertex_area_, v) = area;
+		if (p.vertex_gaussian_curvature_)
+		{
+			const Scalar defect = (is_incident_to_boundary(m, v) ? M_PI : 2 * M_PI) - angle_sum;
+			value<Scalar>(m, p.vertex_gaussian_curvature_, v) = area > 0 ? defect / area : 0;
+		}
+		if (p.vertex_mean_curvature_)
+			value<Scalar>(m, p.vertex_mean_curvature_, v) = area > 0 ? -laplacian.dot(normal) / (4 * area) : 0;
+
+		if (p.edge_angle_)
+		{
+			foreach_incident_edge(m, v, [&](Edge e) -> bool {
+				auto vertices = incident_vertices<2>(m, e);
+				const uint32 i0 = index_of(m, vertices[0]);
+				if ((i0 == vi ? index_of(m, vertices[1]) : i0) < vi)
+					return true; // written by the other vertex
+				std::array<Face, 2> faces;
+				uint32 nb_faces = 0;
+				foreach_incident_face(m, e, [&](Face f) -> bool {
+					if (nb_faces < 2)
+						faces[nb_faces] = f;
+					++nb_faces;
+					return true;
+				});
+				Scalar a{0};
+				if (nb_faces >= 2)
+				{
+					const Vec3 n1 = face_normal(incident_vertices<8>(m, faces[0]));
+					const Vec3 n2 = face_normal(incident_vertices<8>(m, faces[1]));
+					Vec3 edge = value<Vec3>(m, vertex_position, vertices[1]) -
+								value<Vec3>(m, vertex_position, vertices[0]);
+					edge.normalize();
+					a = std::atan2(edge.dot(n1.cross(n2)), n1.dot(n2));
+				}
+				value<Scalar>(m, p.edge_angle_, e) = a;
+				return true;
+			});
+		}
+
+		return true;
+	});
+}
+
+} // namespace geometry
+
+} // namespace cgogn
+
+#endif // CGOGN_GEOMETRY_ALGOS_DIFFERENTIAL_PROPERTIES_H_
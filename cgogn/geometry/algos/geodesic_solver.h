@@ -0,0 +1,391 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_GEOMETRY_ALGOS_GEODESIC_SOLVER_H_
+#define CGOGN_GEOMETRY_ALGOS_GEODESIC_SOLVER_H_
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/types/cells_set.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <cgogn/geometry/algos/area.h>
+#include <cgogn/geometry/algos/laplacian.h>
+#include <cgogn/geometry/algos/length.h>
+#include <cgogn/geometry/algos/normal.h>
+#include <cgogn/geometry/algos/sparse_assembler.h>
+#include <cgogn/geometry/types/vector_traits.h>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace cgogn
+{
+
+namespace geometry
+{
+
+//////////////////////////
+// GeodesicSolver class //
+//////////////////////////
+
+/**
+ * Heat method geodesic distances with cached factorizations.
+ * The cotan Laplacian, the vertex areas, the gradient & divergence operators and the LDLT factorizations of the heat
+ * and Poisson systems are computed once and reused by all the queries: a query only costs back substitutions and
+ * sparse products. Several source sets are solved at once as the columns of a multi-column right-hand side.
+ * After a motion of the vertices, update_geometry recomputes the numerical factorizations (the symbolic analysis
+ * is kept), after a change of the connectivity, rebuild recomputes everything. The invalidate functions defer these
+ * updates to the next query.
+ */
+template <typename MESH>
+class GeodesicSolver
+{
+	static_assert(mesh_traits<MESH>::dimension == 2, "GeodesicSolver can only be used with meshes of dimension 2");
+
+	template <typename T>
+	using Attribute = typename mesh_traits<MESH>::template Attribute<T>;
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Edge = typename mesh_traits<MESH>::Edge;
+	using Face = typename mesh_traits<MESH>::Face;
+
+	using SparseMatrix = Eigen::SparseMatrix<Scalar, Eigen::ColMajor>;
+	using Solver = Eigen::SimplicialLDLT<SparseMatrix>;
+
+	static const uint32 FACES_CHUNK_SIZE = 4096u;
+
+public:
+	// the vertex position attribute is referenced (not copied) and must outlive the solver
+	GeodesicSolver(const MESH& m, const Attribute<Vec3>* vertex_position, Scalar t_multiplier = 1.0)
+		: mesh_(m), vertex_position_(vertex_position), t_multiplier_(t_multiplier)
+	{
+		rebuild();
+	}
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(GeodesicSolver);
+
+	inline uint32 nb_vertices() const
+	{
+		return uint32(vertices_.size());
+	}
+
+	// vertices in the order of the rows of the solutions
+	inline const std::vector<Vertex>& vertices() const
+	{
+		return vertices_;
+	}
+
+	inline uint32 row(Vertex v) const
+	{
+		return vertex_row_[index_of(mesh_, v)];
+	}
+
+	inline bool is_valid() const
+	{
+		return valid_;
+	}
+
+	inline Scalar t_multiplier() const
+	{
+		return t_multiplier_;
+	}
+
+	/**
+	 * @brief set the multiplier of the time step of the heat diffusion (t = t_multiplier * h^2, h: mean edge length)
+	 */
+	void set_t_multiplier(Scalar t_multiplier)
+	{
+		if (t_multiplier != t_multiplier_)
+		{
+			t_multiplier_ = t_multiplier;
+			geometry_dirty_ = true;
+		}
+	}
+
+	// the connectivity of the mesh has changed: rebuild before the next query
+	inline void invalidate_topology()
+	{
+		topology_dirty_ = true;
+	}
+
+	// the vertices have moved: refactorize before the next query
+	inline void invalidate_geometry()
+	{
+		geometry_dirty_ = true;
+	}
+
+	/**
+	 * @brief recompute the vertex indexing, the sparsity patterns and their symbolic analysis, then the factorizations
+	 */
+	void rebuild()
+	{
+		// the Laplacian & the heat operator share the vertex-edge pattern of the assembler
+		assembler_ = std::make_unique<SparseAssembler<MESH>>(mesh_);
+		vertices_ = assembler_->vertices();
+		uint32 max_index = 0u;
+		for (Vertex v : vertices_)
+			max_index = std::max(max_index, index_of(mesh_, v));
+		vertex_row_.assign(max_index + 1u, INVALID_INDEX);
+		for (uint32 i = 0u, n = uint32(vertices_.size()); i < n; ++i)
+			vertex_row_[index_of(mesh_, vertices_[i])] = i;
+
+		faces_.clear();
+		faces_offsets_.assign(1u, 0u);
+		faces_rows_.clear();
+		foreach_cell(mesh_, [&](Face f) -> bool {
+			faces_.push_back(f);
+			foreach_incident_vertex(mesh_, f, [&](Vertex v) -> bool {
+				faces_rows_.push_back(row(v));
+				return true;
+			});
+			faces_offsets_.push_back(uint32(faces_rows_.size()));
+			return true;
+		});
+
+		compute_operators();
+		heat_solver_.analyzePattern(heat_);
+		poisson_solver_.analyzePattern(laplacian_);
+		topology_dirty_ = false;
+		factorize();
+	}
+
+	/**
+	 * @brief recompute the operators and the numerical factorizations after a motion of the vertices
+	 */
+	void update_geometry()
+	{
+		if (topology_dirty_)
+		{
+			rebuild();
+			return;
+		}
+		compute_operators();
+		factorize();
+	}
+
+	/**
+	 * @brief compute the geodesic distances to the given source sets
+	 * @param sources nb_vertices x k matrix: column j is the initial heat distribution of the j-th query
+	 * (1 on the source vertices, 0 elsewhere)
+	 * @return nb_vertices x k matrix of the distances (rows in the order of the vertices())
+	 */
+	Eigen::MatrixXd solve(const Eigen::MatrixXd& sources)
+	{
+		update();
+		if (!valid_)
+			return Eigen::MatrixXd::Zero(sources.rows(), sources.cols());
+
+		const uint32 nb_columns = uint32(sources.cols());
+		const uint32 nb_faces = uint32(faces_.size());
+
+		Eigen::MatrixXd heat = solve_columns(heat_solver_, sources);
+
+		// normalized (opposite) heat gradient of each face & column
+		Eigen::MatrixXd gradient = gradient_ * heat;
+		parallel_foreach_chunk((nb_faces + FACES_CHUNK_SIZE - 1u) / FACES_CHUNK_SIZE, [&](uint32 c) -> bool {
+			for (uint32 i = c * FACES_CHUNK_SIZE, end = std::min(nb_faces, i + FACES_CHUNK_SIZE); i < end; ++i)
+			{
+				for (uint32 j = 0u; j < nb_columns; ++j)
+				{
+					auto g = gradient.block<3, 1>(3 * i, j);
+					Scalar n = g.norm();
+					if (n > 0.0)
+						g /= -n;
+				}
+			}
+			return true;
+		});
+
+		Eigen::MatrixXd distance = solve_columns(poisson_solver_, divergence_ * gradient);
+		for (uint32 j = 0u; j < nb_columns; ++j)
+			distance.col(j).array() -= distance.col(j).minCoeff();
+
+		return distance;
+	}
+
+	/**
+	 * @brief compute the geodesic distances to each of the given source sets (one batched solve)
+	 * @param source_sets source vertices of each query
+	 * @param vertex_geodesic_distance attributes receiving the distances of each query
+	 */
+	void compute(const std::vector<std::vector<Vertex>>& source_sets,
+				 const std::vector<Attribute<Scalar>*>& vertex_geodesic_distance)
+	{
+		update();
+		Eigen::MatrixXd sources = Eigen::MatrixXd::Zero(nb_vertices(), source_sets.size());
+		for (uint32 j = 0u, n = uint32(source_sets.size()); j < n; ++j)
+		{
+			for (Vertex v : source_sets[j])
+				sources(row(v), j) = 1.0;
+		}
+		Eigen::MatrixXd distance = solve(sources);
+		for (uint32 j = 0u, n = uint32(source_sets.size()); j < n; ++j)
+			store(distance.col(j), vertex_geodesic_distance[j]);
+	}
+
+	void compute(const std::vector<Vertex>& source_vertices, Attribute<Scalar>* vertex_geodesic_distance)
+	{
+		compute(std::vector<std::vector<Vertex>>{source_vertices}, {vertex_geodesic_distance});
+	}
+
+	void compute(const CellsSet<MESH, Vertex>* source_vertices, Attribute<Scalar>* vertex_geodesic_distance)
+	{
+		std::vector<Vertex> sources;
+		sources.reserve(source_vertices->size());
+		source_vertices->foreach_cell([&](Vertex v) { sources.push_back(v); });
+		compute(sources, vertex_geodesic_distance);
+	}
+
+private:
+	void update()
+	{
+		if (topology_dirty_)
+			rebuild();
+		else if (geometry_dirty_)
+			update_geometry();
+	}
+
+	// the back substitutions of the columns are independent: they are distributed over the thread pool
+	static Eigen::MatrixXd solve_columns(const Solver& solver, const Eigen::MatrixXd& rhs)
+	{
+		if (rhs.cols() == 1)
+			return solver.solve(rhs);
+		Eigen::MatrixXd result(rhs.rows(), rhs.cols());
+		parallel_foreach_chunk(uint32(rhs.cols()), [&](uint32 j) -> bool {
+			result.col(j) = solver.solve(rhs.col(j));
+			return true;
+		});
+		return result;
+	}
+
+	void store(const Eigen::Ref<const Eigen::VectorXd>& distance, Attribute<Scalar>* vertex_geodesic_distance) const
+	{
+		parallel_foreach_cell(mesh_, [&](Vertex v) -> bool {
+			value<Scalar>(mesh_, vertex_geodesic_distance, v) = distance(row(v));
+			return true;
+		});
+	}
+
+	// cotan Laplacian, heat operator, per face gradient (3 rows per face) and divergence (3 columns per face)
+	void compute_operators()
+	{
+		const Attribute<Vec3>* vertex_position = vertex_position_;
+		const uint32 nb_vertices = uint32(vertices_.size());
+		const uint32 nb_faces = uint32(faces_.size());
+
+		// the values are refilled in place: the patterns (and their symbolic analysis) are unchanged
+		assembler_->fill(laplacian_, [&](Edge e) -> Scalar { return edge_cotan_weight(mesh_, e, vertex_position); });
+		const Scalar h = mean_edge_length(mesh_, vertex_position);
+		const Scalar t = t_multiplier_ * h * h;
+		assembler_->fill(
+			heat_, [&](Edge e) -> Scalar { return -t * edge_cotan_weight(mesh_, e, vertex_position); },
+			[&](Vertex v) -> Scalar { return area(mesh_, v, vertex_position); });
+
+		// gradient: g(f) = sum_i u_i (n x e_i) / 2a, e_i being the edge opposite to the i-th vertex of f
+		// divergence at the i-th vertex of f: 1/2 (cot(a_{i-1}) e_{i,i+1} + cot(a_{i+1}) e_{i,i-1}) . X(f)
+		std::vector<Eigen::Triplet<Scalar>> gradient_coeffs(3u * faces_rows_.size());
+		std::vector<Eigen::Triplet<Scalar>> divergence_coeffs(3u * faces_rows_.size());
+		parallel_foreach_chunk((nb_faces + FACES_CHUNK_SIZE - 1u) / FACES_CHUNK_SIZE, [&](uint32 c) -> bool {
+			for (uint32 i = c * FACES_CHUNK_SIZE, end = std::min(nb_faces, i + FACES_CHUNK_SIZE); i < end; ++i)
+			{
+				const uint32 first = faces_offsets_[i];
+				const uint32 size = faces_offsets_[i + 1u] - first;
+				auto pos = [&](uint32 k) -> const Vec3& {
+					return value<Vec3>(mesh_, vertex_position, vertices_[faces_rows_[first + k % size]]);
+				};
+				Vec3 n = normal(mesh_, faces_[i], vertex_position);
+				Scalar a = area(mesh_, faces_[i], vertex_position);
+				for (uint32 k = 0u; k < size; ++k)
+				{
+					const int r = int(faces_rows_[first + k]);
+					const Vec3& p0 = pos(k);
+					const Vec3& p1 = pos(k + 1u);
+					const Vec3& p2 = pos(k + size - 1u);
+
+					Vec3 g = n.cross(pos(k + 2u) - p1) / (2.0 * a);
+
+					Vec3 vecR = p0 - p2;
+					Vec3 vecL = p1 - p2;
+					Scalar cot1 = vecR.dot(vecL) / vecR.cross(vecL).norm();
+					vecR = p2 - p1;
+					vecL = p0 - p1;
+					Scalar cot2 = vecR.dot(vecL) / vecR.cross(vecL).norm();
+					Vec3 d = 0.5 * (cot1 * (p1 - p0) + cot2 * (p2 - p0));
+
+					for (uint32 x = 0u; x < 3u; ++x)
+					{
+						gradient_coeffs[3u * (first + k) + x] = {int(3u * i + x), r, g[x]};
+						divergence_coeffs[3u * (first + k) + x] = {r, int(3u * i + x), d[x]};
+					}
+				}
+			}
+			return true;
+		});
+		gradient_.resize(3u * nb_faces, nb_vertices);
+		gradient_.setFromTriplets(gradient_coeffs.begin(), gradient_coeffs.end());
+		divergence_.resize(nb_vertices, 3u * nb_faces);
+		divergence_.setFromTriplets(divergence_coeffs.begin(), divergence_coeffs.end());
+	}
+
+	void factorize()
+	{
+		heat_solver_.factorize(heat_);
+		poisson_solver_.factorize(laplacian_);
+		valid_ = heat_solver_.info() == Eigen::Success && poisson_solver_.info() == Eigen::Success;
+		geometry_dirty_ = false;
+	}
+
+	const MESH& mesh_;
+	const Attribute<Vec3>* vertex_position_;
+	Scalar t_multiplier_;
+
+	std::unique_ptr<SparseAssembler<MESH>> assembler_;
+	std::vector<Vertex> vertices_;
+	std::vector<uint32> vertex_row_; // vertex index -> row
+	std::vector<Face> faces_;
+	std::vector<uint32> faces_offsets_;
+	std::vector<uint32> faces_rows_;
+
+	SparseMatrix laplacian_;
+	SparseMatrix heat_;
+	SparseMatrix gradient_;
+	SparseMatrix divergence_;
+	Solver heat_solver_;
+	Solver poisson_solver_;
+
+	bool valid_ = false;
+	bool topology_dirty_ = false;
+	bool geometry_dirty_ = false;
+};
+
+} // namespace geometry
+
+} // namespace cgogn
+
+#endif // CGOGN_GEOMETRY_ALGOS_GEODESIC_SOLVER_H_
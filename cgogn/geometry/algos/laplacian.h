@@ -28,6 +28,7 @@
 
 #include <cgogn/geometry/algos/area.h>
 #include <cgogn/geometry/algos/length.h>
+#include <cgogn/geometry/algos/sparse_assembler.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
 #include <Eigen/Sparse>
@@ -46,8 +47,8 @@ namespace geometry
 
 template <typename MESH, typename std::enable_if_t<std::is_convertible_v<MESH&, MapBase&> &&
 												   (mesh_traits<MESH>::dimension == 2)>* = nullptr>
-Scalar edge_cotan_weight(const MESH& m, typename MESH::Edge e,
-						 const typename MESH::template Attribute<Vec3>* vertex_position)
+Scalar edge_cotan_weight(const MESH& m, typename mesh_traits<MESH>::Edge e,
+						 const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position)
 {
 	using Vertex = typename mesh_traits<MESH>::Vertex;
 
@@ -102,25 +103,11 @@ Eigen::SparseMatrix<Scalar, Eigen::ColMajor> cotan_operator_matrix(
 {
 	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
 
-	using Vertex = typename mesh_traits<MESH>::Vertex;
 	using Edge = typename mesh_traits<MESH>::Edge;
 
-	uint32 nb_vertices = nb_cells<Vertex>(m);
-	Eigen::SparseMatrix<Scalar, Eigen::ColMajor> COTAN(nb_vertices, nb_vertices);
-	std::vector<Eigen::Triplet<Scalar>> COTANcoeffs;
-	COTANcoeffs.reserve(nb_vertices * 10);
-	foreach_cell(m, [&](Edge e) -> bool {
-		Scalar w = value<Scalar>(m, edge_cotan_weight, e);
-		auto vertices = incident_vertices(m, e);
-		uint32 vidx1 = value<uint32>(m, vertex_index, vertices[0]);
-		uint32 vidx2 = value<uint32>(m, vertex_index, vertices[1]);
-		COTANcoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx1), int(vidx2), w));
-		COTANcoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx2), int(vidx1), w));
-		COTANcoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx1), int(vidx1), -w));
-		COTANcoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx2), int(vidx2), -w));
-		return true;
-	});
-	COTAN.setFromTriplets(COTANcoeffs.begin(), COTANcoeffs.end());
+	SparseAssembler<MESH> assembler(m, vertex_index);
+	Eigen::SparseMatrix<Scalar, Eigen::ColMajor> COTAN;
+	assembler.fill(COTAN, [&](Edge e) -> Scalar { return value<Scalar>(m, edge_cotan_weight, e); });
 
 	return COTAN;
 }
@@ -151,17 +138,14 @@ Eigen::SparseMatrix<Scalar, Eigen::ColMajor> cotan_laplacian_matrix(
 	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
 
 	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Edge = typename mesh_traits<MESH>::Edge;
 
-	Eigen::SparseMatrix<Scalar, Eigen::ColMajor> LAPL = cotan_operator_matrix(m, vertex_index, edge_cotan_weight);
+	SparseAssembler<MESH> assembler(m, vertex_index);
+	Eigen::SparseMatrix<Scalar, Eigen::ColMajor> LAPL;
+	assembler.fill(LAPL, [&](Edge e) -> Scalar { return value<Scalar>(m, edge_cotan_weight, e); });
+	assembler.scale_rows(LAPL, [&](Vertex v) -> Scalar { return 1.0 / value<Scalar>(m, vertex_area, v); });
 
-	Eigen::VectorXd A(LAPL.rows());
-	parallel_foreach_cell(m, [&](Vertex v) -> bool {
-		uint32 vidx = value<uint32>(m, vertex_index, v);
-		A(vidx) = value<Scalar>(m, vertex_area, v);
-		return true;
-	});
-
-	return A.asDiagonal().inverse() * LAPL;
+	return LAPL;
 }
 
 template <typename MESH>
@@ -203,24 +187,11 @@ template <typename MESH>
 Eigen::SparseMatrix<Scalar, Eigen::ColMajor> topo_laplacian_matrix(
 	MESH& m, const typename mesh_traits<MESH>::template Attribute<uint32>* vertex_index)
 {
-	using Vertex = typename mesh_traits<MESH>::Vertex;
 	using Edge = typename mesh_traits<MESH>::Edge;
 
-	uint32 nb_vertices = nb_cells<Vertex>(m);
-	Eigen::SparseMatrix<Scalar, Eigen::ColMajor> LAPL(nb_vertices, nb_vertices);
-	std::vector<Eigen::Triplet<Scalar>> LAPLcoeffs;
-	LAPLcoeffs.reserve(nb_vertices * 10);
-	foreach_cell(m, [&](Edge e) -> bool {
-		auto vertices = incident_vertices(m, e);
-		uint32 vidx1 = value<uint32>(m, vertex_index, vertices[0]);
-		uint32 vidx2 = value<uint32>(m, vertex_index, vertices[1]);
-		LAPLcoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx1), int(vidx2), 1));
-		LAPLcoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx2), int(vidx1), 1));
-		LAPLcoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx1), int(vidx1), -1));
-		LAPLcoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx2), int(vidx2), -1));
-		return true;
-	});
-	LAPL.setFromTriplets(LAPLcoeffs.begin(), LAPLcoeffs.end());
+	SparseAssembler<MESH> assembler(m, vertex_index);
+	Eigen::SparseMatrix<Scalar, Eigen::ColMajor> LAPL;
+	assembler.fill(LAPL, [](Edge) -> Scalar { return 1.0; });
 
 	return LAPL;
 }
@@ -25,6 +25,7 @@
 #define CGOGN_GEOMETRY_ALGOS_LENGTH_H_
 
 #include <cgogn/core/functions/traversals/edge.h>
+#include <cgogn/core/functions/traversals/global.h>
 
 #include <cgogn/geometry/types/vector_traits.h>
 
@@ -56,29 +57,14 @@ template <typename MESH>
 Scalar mean_edge_length(const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position)
 {
 	using Edge = typename mesh_traits<MESH>::Edge;
+	using SumCount = std::pair<Scalar, uint32>;
 
-	thread_pool()->execute_all([]() {
-		float64_value() = 0.0;
-		uint32_value() = 0;
-	});
+	SumCount sum_count = parallel_reduce_cell(
+		m, SumCount{0.0, 0},
+		[&](Edge e) -> SumCount { return {length(m, e, vertex_position), 1}; },
+		[](const SumCount& a, const SumCount& b) -> SumCount { return {a.first + b.first, a.second + b.second}; });
 
-	parallel_foreach_cell(m, [&](Edge e) -> bool {
-		float64_value() += length(m, e, vertex_position);
-		++uint32_value();
-		return true;
-	});
-
-	Scalar length_sum = 0.0;
-	uint32 nbe = 0;
-
-	std::mutex mutex;
-	thread_pool()->execute_all([&]() {
-		std::lock_guard<std::mutex> lock(mutex);
-		length_sum += float64_value();
-		nbe += uint32_value();
-	});
-
-	return length_sum / Scalar(nbe);
+	return sum_count.first / Scalar(sum_count.second);
 }
 
 } // namespace geometry
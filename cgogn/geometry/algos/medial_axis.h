@@ -24,17 +24,21 @@
 #ifndef CGOGN_GEOMETRY_ALGOS_MEDIAL_AXIS_H_
 #define CGOGN_GEOMETRY_ALGOS_MEDIAL_AXIS_H_
 
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/functions/traversals/global.h>
 #include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/utils/thread_pool.h>
 
 #include <cgogn/geometry/functions/angle.h>
+#include <cgogn/geometry/types/point_kd_tree.h>
+#include <cgogn/geometry/types/surface_bvh.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
-#include <array>
+#include <algorithm>
+#include <memory>
 #include <vector>
 
-#include <libacc/bvh_tree.h>
-#include <libacc/kd_tree.h>
-
 namespace cgogn
 {
 
@@ -59,88 +63,230 @@ const Scalar denoise_planar = 32.0 * M_PI / 180.0;
 const Scalar delta_convergence = 1e-5;
 const uint32 iteration_limit = 30;
 
+//////////////////////////
+// ShrinkingBalls class //
+//////////////////////////
+
+/**
+ * Shrinking ball medial axis approximation of a surface: for each vertex p of normal n, the ball tangent at p whose
+ * center is on -n is shrunk until no vertex lies inside it (adapted from https://github.com/tudelft3d/masbcpp).
+ * The kd-tree of the vertices and the BVH of the faces are built once and shared read only by all the threads.
+ * The vertices are processed in the spatially coherent order of the kd-tree, by batches of increasing density
+ * (every 2^k th vertex of this order, then the vertices in between, ...): after each batch the processed vertices
+ * sample the whole surface, so that a partial medial axis is available early.
+ * After a motion of the vertices, call update_geometry, after a change of the connectivity, call rebuild.
+ */
 template <typename MESH>
-std::pair<Vec3, Scalar> shrinking_ball_center(
-	MESH& m, typename mesh_traits<MESH>::Vertex v,
-	const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
-	const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_normal,
-	const acc::BVHTree<uint32, Vec3>* surface_bvh, const std::vector<typename mesh_traits<MESH>::Face>& bvh_faces,
-	const acc::KDTree<3, uint32>* surface_kdt)
+class ShrinkingBalls
 {
+	static_assert(mesh_traits<MESH>::dimension == 2, "ShrinkingBalls can only be used with meshes of dimension 2");
+
+	template <typename T>
+	using Attribute = typename mesh_traits<MESH>::template Attribute<T>;
 	using Vertex = typename mesh_traits<MESH>::Vertex;
-	using Face = typename mesh_traits<MESH>::Face;
 
-	const Vec3& p = value<Vec3>(m, vertex_position, v);
-	const Vec3& n = value<Vec3>(m, vertex_normal, v);
+	static const uint32 CHUNK_SIZE = 256u;
+	static const uint32 MAX_BATCH_SIZE = 65536u;
+	static const uint32 NB_LEVELS = 7u;
+
+public:
+	ShrinkingBalls(const MESH& m, const std::shared_ptr<Attribute<Vec3>>& vertex_position)
+		: mesh_(m), vertex_position_(vertex_position), bvh_(m, vertex_position)
+	{
+		collect_vertices();
+		update_kd_tree();
+	}
+
+	// the given position attribute is not owned and must outlive the ShrinkingBalls
+	ShrinkingBalls(const MESH& m, const Attribute<Vec3>* vertex_position)
+		: mesh_(m), vertex_position_(std::shared_ptr<const Attribute<Vec3>>(), vertex_position),
+		  bvh_(m, vertex_position)
+	{
+		collect_vertices();
+		update_kd_tree();
+	}
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(ShrinkingBalls);
+
+	// the vertices in processing order
+	inline const std::vector<Vertex>& vertices() const
+	{
+		return vertices_;
+	}
+
+	void update_geometry()
+	{
+		bvh_.refit();
+		update_kd_tree();
+	}
 
-	uint32 j = 0;
-	Scalar r = 0.;
+	void rebuild()
+	{
+		bvh_.rebuild();
+		collect_vertices();
+		update_kd_tree();
+	}
 
-	acc::Ray<Vec3> ray{p, -n, 1e-5, acc::inf};
-	acc::BVHTree<uint32, Vec3>::Hit h;
-	if (surface_bvh->intersect(ray, &h))
+	/**
+	 * @brief compute the center and radius of the shrinking ball of the vertices
+	 * @param progress bool(uint32 nb_processed, uint32 nb_vertices), called after each batch: the balls of the
+	 * first nb_processed vertices of vertices() are computed. Returning false stops the computation.
+	 * @return true if all the vertices have been processed
+	 */
+	template <typename FUNC>
+	bool compute(const Attribute<Vec3>* vertex_normal, Attribute<Vec3>* vertex_shrinking_ball_center,
+				 Attribute<Scalar>* vertex_shrinking_ball_radius, const FUNC& progress) const
 	{
-		Face f = bvh_faces[h.idx];
-		std::vector<Vertex> vertices = incident_vertices(m, f);
-		Vec3 ip = h.bcoords[0] * value<Vec3>(m, vertex_position, vertices[0]) +
-				  h.bcoords[1] * value<Vec3>(m, vertex_position, vertices[1]) +
-				  h.bcoords[2] * value<Vec3>(m, vertex_position, vertices[2]);
-		r = (p - ip).norm() * 0.75;
+		static_assert(is_func_return_same<FUNC, bool>::value, "Given function should return a bool");
+
+		const uint32 nb_vertices = uint32(vertices_.size());
+		for (uint32 b = 0u, bi = 0u; b < nb_vertices; b = batches_[bi++])
+		{
+			const uint32 e = batches_[bi];
+			parallel_foreach_chunk((e - b + CHUNK_SIZE - 1u) / CHUNK_SIZE, [&](uint32 c) -> bool {
+				for (uint32 i = b + c * CHUNK_SIZE, end = std::min(e, i + CHUNK_SIZE); i < end; ++i)
+				{
+					const Vertex v = vertices_[i];
+					auto [center, radius] = shrinking_ball(value<Vec3>(mesh_, vertex_position_.get(), v),
+														   value<Vec3>(mesh_, vertex_normal, v));
+					value<Vec3>(mesh_, vertex_shrinking_ball_center, v) = center;
+					value<Scalar>(mesh_, vertex_shrinking_ball_radius, v) = radius;
+				}
+				return true;
+			});
+			if (!progress(e, nb_vertices))
+				return e == nb_vertices;
+		}
+		return true;
 	}
-	// else
-	// 	std::cout << "intersection point not found !!!";
 
-	Vec3 c = p - (r * n);
+	void compute(const Attribute<Vec3>* vertex_normal, Attribute<Vec3>* vertex_shrinking_ball_center,
+				 Attribute<Scalar>* vertex_shrinking_ball_radius) const
+	{
+		compute(vertex_normal, vertex_shrinking_ball_center, vertex_shrinking_ball_radius,
+				[](uint32, uint32) { return true; });
+	}
 
-	while (true)
+	std::pair<Vec3, Scalar> shrinking_ball(const Vec3& p, const Vec3& n) const
 	{
-		// find closest point to c
-		std::pair<uint32, Scalar> k_res;
-		bool found = surface_kdt->find_nn(c, &k_res);
-		// std::pair<uint32, Vec3> cp_res;
-		// bool found = surface_bvh->closest_point(c, &cp_res);
-		if (!found)
-			std::cout << "closest point not found !!!";
-
-		const Vec3& q = surface_kdt->vertex(k_res.first);
-		Scalar d = k_res.second;
-		// Vec3 q = cp_res.second;
-		// Scalar d = (q - c).norm();
-
-		// This should handle all (special) cases where we want to break the loop
-		// - normal case when ball no longer shrinks
-		// - the case where q == p
-		// - any duplicate point cases
-		if ((d >= r - delta_convergence) || (p == q))
-			break;
-
-		// Compute next ball center
-		r = compute_radius(p, n, q);
-		Vec3 c_next = p - (r * n);
-
-		// // Denoising
-		if (denoise_preserve > 0 || denoise_planar > 0)
+		uint32 j = 0;
+		Scalar r = 0.;
+
+		typename SurfaceBVH<MESH>::Hit h = bvh_.intersect({p, -n, 1e-5});
+		if (h.valid_)
+			r = (p - h.position_).norm() * 0.75;
+
+		Vec3 c = p - (r * n);
+
+		while (true)
 		{
-			Scalar separation_angle = geometry::angle(p - c_next, q - c_next);
+			// find closest point to c
+			// (only the points closer than r - delta_convergence can shrink the ball: the search is bounded)
+			if (r <= delta_convergence)
+				break;
+			Scalar d;
+			const uint32 k = kd_tree_.nearest(c, d, r - delta_convergence);
+
+			// This should handle all (special) cases where we want to break the loop
+			// - normal case when ball no longer shrinks
+			// - the case where q == p
+			// - any duplicate point cases
+			if (k == INVALID_INDEX)
+				break;
+			const Vec3& q = kd_tree_.points()[k];
+			if ((d >= r - delta_convergence) || (p == q))
+				break;
+
+			// Compute next ball center
+			r = compute_radius(p, n, q);
+			Vec3 c_next = p - (r * n);
+
+			// // Denoising
+			if (denoise_preserve > 0 || denoise_planar > 0)
+			{
+				Scalar separation_angle = geometry::angle(p - c_next, q - c_next);
 
-			// if (j == 0 && denoise_planar > 0 && separation_angle < denoise_planar)
-			// 	break;
-			if (j > 0 && denoise_preserve > 0 && (separation_angle < denoise_preserve && r > (q - p).norm()))
+				// if (j == 0 && denoise_planar > 0 && separation_angle < denoise_planar)
+				// 	break;
+				if (j > 0 && denoise_preserve > 0 && (separation_angle < denoise_preserve && r > (q - p).norm()))
+					break;
+			}
+
+			// // Stop iteration if this looks like an infinite loop:
+			if (j > iteration_limit)
 				break;
+
+			c = c_next;
+			j++;
 		}
 
-		// // Stop iteration if this looks like an infinite loop:
-		if (j > iteration_limit)
-			break;
+		return {c, r};
+	}
 
-		c = c_next;
-		j++;
+private:
+	void collect_vertices()
+	{
+		vertices_.clear();
+		vertices_.reserve(nb_cells<Vertex>(mesh_));
+		foreach_cell(mesh_, [&](Vertex v) -> bool {
+			vertices_.push_back(v);
+			return true;
+		});
 	}
 
-	return {c, r};
-}
+	// rebuilds the kd-tree and reorders the vertices (kd-tree order interleaved by levels of decreasing stride)
+	void update_kd_tree()
+	{
+		const uint32 nb_vertices = uint32(vertices_.size());
+		std::vector<Vec3> positions(nb_vertices);
+		parallel_foreach_chunk((nb_vertices + CHUNK_SIZE - 1u) / CHUNK_SIZE, [&](uint32 c) -> bool {
+			for (uint32 i = c * CHUNK_SIZE, end = std::min(nb_vertices, i + CHUNK_SIZE); i < end; ++i)
+				positions[i] = value<Vec3>(mesh_, vertex_position_.get(), vertices_[i]);
+			return true;
+		});
+		kd_tree_.build(positions);
+
+		std::vector<Vertex> vertices;
+		vertices.reserve(nb_vertices);
+		batches_.clear();
+		const std::vector<uint32>& indices = kd_tree_.indices();
+		for (uint32 l = 0u; l <= NB_LEVELS; ++l)
+		{
+			const uint32 stride = 1u << (NB_LEVELS - l);
+			const uint32 first = l == 0u ? 0u : stride;
+			const uint32 step = l == 0u ? stride : 2u * stride;
+			for (uint32 i = first; i < nb_vertices; i += step)
+			{
+				vertices.push_back(vertices_[indices[i]]);
+				if (vertices.size() % MAX_BATCH_SIZE == 0u)
+					batches_.push_back(uint32(vertices.size()));
+			}
+			if (batches_.empty() || batches_.back() != vertices.size())
+				batches_.push_back(uint32(vertices.size()));
+		}
+		vertices_.swap(vertices);
+	}
+
+	const MESH& mesh_;
+	std::shared_ptr<const Attribute<Vec3>> vertex_position_;
+
+	SurfaceBVH<MESH> bvh_;
+	PointKDTree kd_tree_;
 
-// adapted from https://github.com/tudelft3d/masbcpp
+	std::vector<Vertex> vertices_;
+	std::vector<uint32> batches_; // end of each batch in vertices_
+};
+
+template <typename MESH>
+void shrinking_ball_centers(
+	MESH& m, const std::shared_ptr<typename mesh_traits<MESH>::template Attribute<Vec3>>& vertex_position,
+	const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_normal,
+	typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_shrinking_ball_center,
+	typename mesh_traits<MESH>::template Attribute<Scalar>* vertex_shrinking_ball_radius)
+{
+	ShrinkingBalls<MESH> shrinking_balls(m, vertex_position);
+	shrinking_balls.compute(vertex_normal, vertex_shrinking_ball_center, vertex_shrinking_ball_radius);
+}
 
 template <typename MESH>
 void shrinking_ball_centers(MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
@@ -148,55 +294,8 @@ void shrinking_ball_centers(MESH& m, const typename mesh_traits<MESH>::template
 							typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_shrinking_ball_center,
 							typename mesh_traits<MESH>::template Attribute<Scalar>* vertex_shrinking_ball_radius)
 {
-	using Vertex = typename mesh_traits<MESH>::Vertex;
-	using Face = typename mesh_traits<MESH>::Face;
-
-	uint32 nb_vertices = nb_cells<Vertex>(m);
-	uint32 nb_faces = nb_cells<Face>(m);
-
-	auto bvh_vertex_index = add_attribute<uint32, Vertex>(m, "__bvh_vertex_index");
-
-	std::vector<Vec3> vertex_position_vector;
-	vertex_position_vector.reserve(nb_vertices);
-	// std::vector<Vertex> kdt_vertices;
-	// kdt_vertices.reserve(nb_vertices);
-	uint32 idx = 0;
-	foreach_cell(m, [&](Vertex v) -> bool {
-		value<uint32>(m, bvh_vertex_index, v) = idx++;
-		vertex_position_vector.push_back(value<Vec3>(m, vertex_position, v));
-		// kdt_vertices.push_back(v);
-		return true;
-	});
-
-	std::vector<Face> bvh_faces;
-	bvh_faces.reserve(nb_faces);
-	std::vector<uint32> face_vertex_indices;
-	face_vertex_indices.reserve(nb_faces * 3);
-	foreach_cell(m, [&](Face f) -> bool {
-		bvh_faces.push_back(f);
-		foreach_incident_vertex(m, f, [&](Vertex v) -> bool {
-			face_vertex_indices.push_back(value<uint32>(m, bvh_vertex_index, v));
-			return true;
-		});
-		return true;
-	});
-
-	acc::BVHTree<uint32, Vec3>* surface_bvh =
-		new acc::BVHTree<uint32, Vec3>(face_vertex_indices, vertex_position_vector);
-
-	acc::KDTree<3, uint32>* surface_kdt = new acc::KDTree<3, uint32>(vertex_position_vector);
-
-	parallel_foreach_cell(m, [&](Vertex v) -> bool {
-		auto [c, r] = shrinking_ball_center(m, v, vertex_position, vertex_normal, surface_bvh, bvh_faces, surface_kdt);
-		value<Vec3>(m, vertex_shrinking_ball_center, v) = c;
-		value<Scalar>(m, vertex_shrinking_ball_radius, v) = r;
-		return true;
-	});
-
-	delete surface_kdt;
-
-	remove_attribute<Vertex>(m, bvh_vertex_index);
-	delete surface_bvh;
+	ShrinkingBalls<MESH> shrinking_balls(m, vertex_position);
+	shrinking_balls.compute(vertex_normal, vertex_shrinking_ball_center, vertex_shrinking_ball_radius);
 }
 
 } // namespace geometry
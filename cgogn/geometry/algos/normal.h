@@ -27,38 +27,44 @@
 #include <cgogn/core/functions/attributes.h>
 #include <cgogn/core/functions/traversals/face.h>
 #include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/utils/thread.h>
+#include <cgogn/core/utils/thread_pool.h>
 
 #include <cgogn/geometry/functions/normal.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace cgogn
 {
 
+template <typename MESH>
+class TopologySnapshot;
+
 namespace geometry
 {
 
-template <typename MESH>
-Vec3 normal(const MESH& m, typename mesh_traits<MESH>::Face f,
-			const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position)
+namespace internal
 {
-	static_assert(mesh_traits<MESH>::dimension >= 2, "MESH dimension should be >= 2");
 
-	using Vertex = typename mesh_traits<MESH>::Vertex;
-	std::vector<Vertex> vertices = incident_vertices(m, f);
-	if (uint32(vertices.size()) == 3)
+// normal of the polygon of nb vertices whose i-th vertex position is position(i)
+template <typename FUNC>
+Vec3 polygon_normal(uint32 nb, const FUNC& position)
+{
+	if (nb == 3)
 	{
-		Vec3 n = normal(value<Vec3>(m, vertex_position, vertices[0]), value<Vec3>(m, vertex_position, vertices[1]),
-						value<Vec3>(m, vertex_position, vertices[2]));
+		Vec3 n = normal(position(0), position(1), position(2));
 		n.normalize();
 		return n;
 	}
 	else
 	{
 		Vec3 n{0.0, 0.0, 0.0};
-		for (uint32 i = 0, nb = uint32(vertices.size()); i < nb; ++i)
+		for (uint32 i = 0; i < nb; ++i)
 		{
-			const Vec3& p = value<Vec3>(m, vertex_position, vertices[i]);
-			const Vec3& q = value<Vec3>(m, vertex_position, vertices[(i + 1) % nb]);
+			const Vec3& p = position(i);
+			const Vec3& q = position((i + 1) % nb);
 			n[0] += (p[1] - q[1]) * (p[2] + q[2]);
 			n[1] += (p[2] - q[2]) * (p[0] + q[0]);
 			n[2] += (p[0] - q[0]) * (p[1] + q[1]);
@@ -68,33 +74,30 @@ Vec3 normal(const MESH& m, typename mesh_traits<MESH>::Face f,
 	}
 }
 
+} // namespace internal
+
+template <typename MESH>
+Vec3 normal(const MESH& m, typename mesh_traits<MESH>::Face f,
+			const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position)
+{
+	static_assert(mesh_traits<MESH>::dimension >= 2, "MESH dimension should be >= 2");
+
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	std::vector<Vertex> vertices = incident_vertices(m, f);
+	return internal::polygon_normal(uint32(vertices.size()), [&](uint32 i) -> const Vec3& {
+		return value<Vec3>(m, vertex_position, vertices[i]);
+	});
+}
+
 template <typename MESH>
 Vec3 normal(const MESH& m, typename mesh_traits<MESH>::Face2 f,
 			const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position)
 {
 	using Vertex = typename mesh_traits<MESH>::Vertex;
 	std::vector<Vertex> vertices = incident_vertices(m, f);
-	if (uint32(vertices.size()) == 3)
-	{
-		Vec3 n = normal(value<Vec3>(m, vertex_position, vertices[0]), value<Vec3>(m, vertex_position, vertices[1]),
-						value<Vec3>(m, vertex_position, vertices[2]));
-		n.normalize();
-		return n;
-	}
-	else
-	{
-		Vec3 n{0.0, 0.0, 0.0};
-		for (uint32 i = 0, nb = uint32(vertices.size()); i < nb; ++i)
-		{
-			const Vec3& p = value<Vec3>(m, vertex_position, vertices[i]);
-			const Vec3& q = value<Vec3>(m, vertex_position, vertices[(i + 1) % nb]);
-			n[0] += (p[1] - q[1]) * (p[2] + q[2]);
-			n[1] += (p[2] - q[2]) * (p[0] + q[0]);
-			n[2] += (p[0] - q[0]) * (p[1] + q[1]);
-		}
-		n.normalize();
-		return n;
-	}
+	return internal::polygon_normal(uint32(vertices.size()), [&](uint32 i) -> const Vec3& {
+		return value<Vec3>(m, vertex_position, vertices[i]);
+	});
 }
 
 template <typename MESH>
@@ -142,6 +145,80 @@ void compute_normal(const MESH& m, const typename mesh_traits<MESH>::template At
 	});
 }
 
+// the face normals are computed once from the face->vertex relation of the snapshot
+// and the vertex normals are accumulated from the vertex->face relation
+template <typename CELL, typename MESH>
+void compute_normal(const TopologySnapshot<MESH>& ts,
+					const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
+					typename mesh_traits<MESH>::template Attribute<Vec3>* cell_normal)
+{
+	static_assert(is_in_tuple_v<CELL, typename mesh_traits<MESH>::Cells>, "CELL not supported in this MESH");
+	cgogn_message_assert(ts.is_valid(), "Using an outdated topology snapshot");
+
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Face = typename mesh_traits<MESH>::Face;
+
+	const MESH& m = static_cast<const MESH&>(ts);
+
+	if constexpr (std::is_same_v<CELL, Vertex> || std::is_same_v<CELL, Face>)
+	{
+		if (ts.has_faces())
+		{
+			const auto& position = *vertex_position;
+			auto face_normal = [&](uint32 fi) -> Vec3 {
+				auto vertices = ts.face_incident_vertices(fi);
+				const uint32* vi = vertices.begin();
+				return internal::polygon_normal(vertices.size(),
+												[&](uint32 i) -> const Vec3& { return position[vi[i]]; });
+			};
+
+			const uint32 nb_faces = ts.nb_face_indices();
+			std::vector<Vec3> face_normals;
+			if constexpr (std::is_same_v<CELL, Vertex>)
+				face_normals.resize(nb_faces);
+			auto compute_face_normals = [&](uint32 chunk) -> bool {
+				for (uint32 fi = chunk * PARALLEL_BUFFER_SIZE, end = std::min(nb_faces, fi + PARALLEL_BUFFER_SIZE);
+					 fi < end; ++fi)
+				{
+					if (ts.face(fi).dart_.is_nil())
+						continue;
+					if constexpr (std::is_same_v<CELL, Vertex>)
+						face_normals[fi] = face_normal(fi);
+					else
+						(*cell_normal)[fi] = face_normal(fi);
+				}
+				return true;
+			};
+			parallel_foreach_chunk((nb_faces + PARALLEL_BUFFER_SIZE - 1u) / PARALLEL_BUFFER_SIZE, compute_face_normals);
+
+			if constexpr (std::is_same_v<CELL, Vertex>)
+			{
+				const uint32 nb_vertices = ts.nb_vertex_indices();
+				auto compute_vertex_normals = [&](uint32 chunk) -> bool {
+					for (uint32 vi = chunk * PARALLEL_BUFFER_SIZE,
+								end = std::min(nb_vertices, vi + PARALLEL_BUFFER_SIZE);
+						 vi < end; ++vi)
+					{
+						if (ts.vertex(vi).dart_.is_nil())
+							continue;
+						Vec3 n{0.0, 0.0, 0.0};
+						for (uint32 fi : ts.vertex_incident_faces(vi))
+							n += face_normals[fi];
+						n.normalize();
+						(*cell_normal)[vi] = n;
+					}
+					return true;
+				};
+				parallel_foreach_chunk((nb_vertices + PARALLEL_BUFFER_SIZE - 1u) / PARALLEL_BUFFER_SIZE,
+									   compute_vertex_normals);
+			}
+			return;
+		}
+	}
+
+	compute_normal<CELL>(m, vertex_position, cell_normal);
+}
+
 } // namespace geometry
 
 } // namespace cgogn
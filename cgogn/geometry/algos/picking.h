@@ -25,9 +25,13 @@
 #define CGOGN_GEOMETRY_ALGOS_PICKING_H_
 
 #include <cgogn/core/functions/traversals/face.h>
+#include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/functions/traversals/volume.h>
 
+#include <cgogn/geometry/algos/centroid.h>
 #include <cgogn/geometry/functions/distance.h>
 #include <cgogn/geometry/functions/intersection.h>
+#include <cgogn/geometry/types/surface_bvh.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
 namespace cgogn
@@ -58,7 +62,7 @@ std::vector<std::tuple<typename mesh_traits<MESH>::Face, Vec3, Scalar>> picking(
 	parallel_foreach_cell(m, [&](Face f) -> bool {
 		uint32 worker_index = current_worker_index();
 		Vec3 intersection_point;
-		std::vector<Vertex> vertices = incident_vertices(m, f);
+		auto vertices = incident_vertices<8>(m, f);
 		if (vertices.size() == 3)
 		{
 			if (intersection_ray_triangle(A, AB, value<Vec3>(m, vertex_position, vertices[0]),
@@ -112,6 +116,93 @@ std::vector<std::tuple<typename mesh_traits<MESH>::Face, Vec3, Scalar>> picking(
 	return result;
 }
 
+template <typename MESH>
+typename mesh_traits<MESH>::Vertex closest_vertex(
+	const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
+	typename mesh_traits<MESH>::Face f, const Vec3& I)
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+
+	Scalar min_d2 = std::numeric_limits<Scalar>::max();
+	Vertex closest_vertex;
+	foreach_incident_vertex(m, f, [&](Vertex v) -> bool {
+		Scalar d2 = (value<Vec3>(m, vertex_position, v) - I).squaredNorm();
+		if (d2 < min_d2)
+		{
+			min_d2 = d2;
+			closest_vertex = v;
+		}
+		return true;
+	});
+	return closest_vertex;
+}
+
+template <typename MESH>
+typename mesh_traits<MESH>::Edge closest_edge(
+	const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
+	typename mesh_traits<MESH>::Face f, const Vec3& I)
+{
+	using Edge = typename mesh_traits<MESH>::Edge;
+
+	Scalar min_d2 = std::numeric_limits<Scalar>::max();
+	Edge closest_edge;
+	foreach_incident_edge(m, f, [&](Edge e) -> bool {
+		auto vertices = incident_vertices<2>(m, e);
+		Scalar d2 = squared_distance_line_point(value<Vec3>(m, vertex_position, vertices[0]),
+												value<Vec3>(m, vertex_position, vertices[1]), I);
+		if (d2 < min_d2)
+		{
+			min_d2 = d2;
+			closest_edge = e;
+		}
+		return true;
+	});
+	return closest_edge;
+}
+
+// cell of the face f hit at I by a ray of the given direction: the face itself, its vertex or edge closest to I, or
+// its incident volume that lies the furthest along the ray (the volume entered by the ray)
+template <typename CELL, typename MESH>
+CELL picked_cell(const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position,
+				 typename mesh_traits<MESH>::Face f, const Vec3& I, const Vec3& direction)
+{
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Edge = typename mesh_traits<MESH>::Edge;
+	using Face = typename mesh_traits<MESH>::Face;
+	using Volume = typename mesh_traits<MESH>::Volume;
+
+	if constexpr (std::is_same_v<CELL, Vertex>)
+		return closest_vertex(m, vertex_position, f, I);
+	else if constexpr (std::is_same_v<CELL, Edge>)
+		return closest_edge(m, vertex_position, f, I);
+	else if constexpr (std::is_same_v<CELL, Face>)
+		return f;
+	else
+	{
+		static_assert(std::is_same_v<CELL, Volume>, "CELL not supported in picking");
+		Scalar max_d = std::numeric_limits<Scalar>::lowest();
+		Volume picked_volume;
+		for (Volume v : incident_volumes(m, f))
+		{
+			Scalar d = (centroid<Vec3>(m, v, vertex_position) - I).dot(direction);
+			if (d > max_d)
+			{
+				max_d = d;
+				picked_volume = v;
+			}
+		}
+		return picked_volume;
+	}
+}
+
+template <typename MESH>
+typename SurfaceBVH<MESH>::Ray picking_ray(const Vec3& A, const Vec3& B)
+{
+	Vec3 AB = B - A;
+	cgogn_message_assert(AB.squaredNorm() > 0.0, "line must be defined by 2 different points");
+	return {A, AB.normalized()};
+}
+
 } // namespace internal
 
 template <typename MESH>
@@ -129,22 +220,7 @@ void picking(const MESH& m, const typename mesh_traits<MESH>::template Attribute
 	result.reserve(selected_faces.size());
 	for (const auto& sf : selected_faces)
 	{
-		Scalar min_d2 = std::numeric_limits<Scalar>::max();
-		Vertex closest_vertex;
-
-		Face f = std::get<0>(sf);
-		const Vec3& I = std::get<1>(sf);
-
-		foreach_incident_vertex(m, f, [&](Vertex v) -> bool {
-			Scalar d2 = (value<Vec3>(m, vertex_position, v) - I).squaredNorm();
-			if (d2 < min_d2)
-			{
-				min_d2 = d2;
-				closest_vertex = v;
-			}
-			return true;
-		});
-
+		Vertex closest_vertex = internal::closest_vertex(m, vertex_position, std::get<0>(sf), std::get<1>(sf));
 		if (!cm.is_marked(closest_vertex))
 		{
 			cm.mark(closest_vertex);
@@ -157,7 +233,6 @@ template <typename MESH>
 void picking(const MESH& m, const typename mesh_traits<MESH>::template Attribute<Vec3>* vertex_position, const Vec3& A,
 			 const Vec3& B, std::vector<typename mesh_traits<MESH>::Edge>& result)
 {
-	using Vertex = typename mesh_traits<MESH>::Vertex;
 	using Edge = typename mesh_traits<MESH>::Edge;
 	using Face = typename mesh_traits<MESH>::Face;
 	using SelectedFace = std::tuple<Face, Vec3, Scalar>;
@@ -169,24 +244,7 @@ void picking(const MESH& m, const typename mesh_traits<MESH>::template Attribute
 	result.reserve(selected_faces.size());
 	for (const auto& sf : selected_faces)
 	{
-		Scalar min_d2 = std::numeric_limits<Scalar>::max();
-		Edge closest_edge;
-
-		Face f = std::get<0>(sf);
-		const Vec3& I = std::get<1>(sf);
-
-		foreach_incident_edge(m, f, [&](Edge e) -> bool {
-			std::vector<Vertex> vertices = incident_vertices(m, e);
-			Scalar d2 = squared_distance_line_point(value<Vec3>(m, vertex_position, vertices[0]),
-													value<Vec3>(m, vertex_position, vertices[1]), I);
-			if (d2 < min_d2)
-			{
-				min_d2 = d2;
-				closest_edge = e;
-			}
-			return true;
-		});
-
+		Edge closest_edge = internal::closest_edge(m, vertex_position, std::get<0>(sf), std::get<1>(sf));
 		if (!cm.is_marked(closest_edge))
 		{
 			cm.mark(closest_edge);
@@ -210,6 +268,90 @@ void picking(const MESH& m, const typename mesh_traits<MESH>::template Attribute
 		result.push_back(std::get<0>(sf));
 }
 
+/////////////////////////////
+// BVH accelerated picking //
+/////////////////////////////
+
+// The following versions traverse the given SurfaceBVH of the mesh (that must be up to date with the connectivity and
+// the positions of the mesh) instead of testing all the faces of the mesh.
+// CELL is the Vertex, Edge, Face or Volume type of the mesh.
+
+/**
+ * @brief pick the first cell hit by the line (A,B)
+ * @returns false if the line does not hit the mesh
+ */
+template <typename MESH, typename CELL>
+bool picking(const SurfaceBVH<MESH>& bvh, const Vec3& A, const Vec3& B, CELL& result)
+{
+	typename SurfaceBVH<MESH>::Ray ray = internal::picking_ray<MESH>(A, B);
+	typename SurfaceBVH<MESH>::Hit hit = bvh.intersect(ray);
+	if (!hit.valid_)
+		return false;
+	result = internal::picked_cell<CELL>(bvh.mesh(), bvh.vertex_position(), hit.face_, hit.position_, ray.direction_);
+	return true;
+}
+
+/**
+ * @brief pick all the cells hit by the line (A,B), sorted from the closest to A (without duplicates)
+ */
+template <typename MESH, typename CELL>
+void picking(const SurfaceBVH<MESH>& bvh, const Vec3& A, const Vec3& B, std::vector<CELL>& result)
+{
+	using Hit = typename SurfaceBVH<MESH>::Hit;
+
+	typename SurfaceBVH<MESH>::Ray ray = internal::picking_ray<MESH>(A, B);
+	std::vector<Hit> hits;
+	bvh.intersect_all(ray, hits);
+
+	CellMarkerStore<MESH, CELL> cm(bvh.mesh());
+	result.clear();
+	result.reserve(hits.size());
+	for (const Hit& hit : hits)
+	{
+		CELL c = internal::picked_cell<CELL>(bvh.mesh(), bvh.vertex_position(), hit.face_, hit.position_,
+											 ray.direction_);
+		if (c.is_valid() && !cm.is_marked(c))
+		{
+			cm.mark(c);
+			result.push_back(c);
+		}
+	}
+}
+
+/**
+ * @brief pick the first cells hit by each of the given lines, e.g. the lines through the pixels of a rectangle or
+ * lasso area of the screen (the rays are traversed in parallel)
+ * the result contains each picked cell once, in the order of the lines
+ */
+template <typename MESH, typename CELL>
+void picking(const SurfaceBVH<MESH>& bvh, const std::vector<std::pair<Vec3, Vec3>>& lines, std::vector<CELL>& result)
+{
+	using Ray = typename SurfaceBVH<MESH>::Ray;
+	using Hit = typename SurfaceBVH<MESH>::Hit;
+
+	std::vector<Ray> rays;
+	rays.reserve(lines.size());
+	for (const auto& [A, B] : lines)
+		rays.push_back(internal::picking_ray<MESH>(A, B));
+	std::vector<Hit> hits;
+	bvh.intersect(rays, hits);
+
+	CellMarkerStore<MESH, CELL> cm(bvh.mesh());
+	result.clear();
+	for (uint32 i = 0u, n = uint32(hits.size()); i < n; ++i)
+	{
+		if (!hits[i].valid_)
+			continue;
+		CELL c = internal::picked_cell<CELL>(bvh.mesh(), bvh.vertex_position(), hits[i].face_, hits[i].position_,
+											 rays[i].direction_);
+		if (c.is_valid() && !cm.is_marked(c))
+		{
+			cm.mark(c);
+			result.push_back(c);
+		}
+	}
+}
+
 } // namespace geometry
 
 } // namespace cgogn
@@ -24,84 +24,55 @@
 #ifndef CGOGN_GEOMETRY_ALGOS_REGISTRATION_H_
 #define CGOGN_GEOMETRY_ALGOS_REGISTRATION_H_
 
+#include <cgogn/core/functions/attributes.h>
 #include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/utils/thread_pool.h>
 
 #include <cgogn/geometry/algos/centroid.h>
 #include <cgogn/geometry/algos/laplacian.h>
+#include <cgogn/geometry/algos/normal.h>
+#include <cgogn/geometry/algos/sparse_assembler.h>
+#include <cgogn/geometry/types/surface_bvh.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <Eigen/Dense>
 #include <Eigen/Sparse>
-#include <libacc/bvh_tree.h>
 #include <simpleICP/simpleicp.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 namespace cgogn
 {
 
 namespace geometry
 {
 
-template <typename MESHS, typename MESHT>
-Mat4 rigid_register_mesh(MESHS& source, typename mesh_traits<MESHS>::template Attribute<Vec3>* source_vertex_position,
-						 MESHT& target,
-						 const typename mesh_traits<MESHT>::template Attribute<Vec3>* target_vertex_position)
+enum ProximityPolicy : uint32
 {
-	using SVertex = typename mesh_traits<MESHS>::Vertex;
-	using TVertex = typename mesh_traits<MESHT>::Vertex;
-
-	uint32 source_nbv = nb_cells<SVertex>(source);
-	Eigen::MatrixXd X_source(source_nbv, 3);
-	auto source_vertex_index = add_attribute<uint32, SVertex>(source, "__vertex_index");
-	uint32 source_vertex_idx = 0;
-	foreach_cell(source, [&](SVertex v) -> bool {
-		const Vec3& p = value<Vec3>(source, source_vertex_position, v);
-		X_source(source_vertex_idx, 0) = p[0];
-		X_source(source_vertex_idx, 1) = p[1];
-		X_source(source_vertex_idx, 2) = p[2];
-		value<uint32>(source, source_vertex_index, v) = source_vertex_idx++;
-		return true;
-	});
-
-	uint32 target_nbv = nb_cells<TVertex>(target);
-	Eigen::MatrixXd X_target(target_nbv, 3);
-	auto target_vertex_index = add_attribute<uint32, TVertex>(target, "__vertex_index");
-	uint32 target_vertex_idx = 0;
-	foreach_cell(target, [&](TVertex v) -> bool {
-		const Vec3& p = value<Vec3>(target, target_vertex_position, v);
-		X_target(target_vertex_idx, 0) = p[0];
-		X_target(target_vertex_idx, 1) = p[1];
-		X_target(target_vertex_idx, 2) = p[2];
-		value<uint32>(target, target_vertex_index, v) = target_vertex_idx++;
-		return true;
-	});
-
-	Mat4 t = SimpleICP(X_target, X_source);
-
-	Eigen::MatrixXd X_sourceH(4, source_nbv);
-	foreach_cell(source, [&](SVertex v) -> bool {
-		uint32 idx = value<uint32>(source, source_vertex_index, v);
-		const Vec3& p = value<Vec3>(source, source_vertex_position, v);
-		X_sourceH(0, idx) = p[0];
-		X_sourceH(1, idx) = p[1];
-		X_sourceH(2, idx) = p[2];
-		X_sourceH(3, idx) = 1.0;
-		return true;
-	});
-	Eigen::MatrixXd res = t * X_sourceH;
-	foreach_cell(source, [&](SVertex v) -> bool {
-		uint32 idx = value<uint32>(source, source_vertex_index, v);
-		Vec3& p = value<Vec3>(source, source_vertex_position, v);
-		p[0] = res(0, idx);
-		p[1] = res(1, idx);
-		p[2] = res(2, idx);
-		return true;
-	});
-
-	remove_attribute<SVertex>(source, source_vertex_index);
-	remove_attribute<TVertex>(target, target_vertex_index);
+	NEAREST_POINT,
+	NORMAL_RAY
+};
 
-	return t;
-}
+enum ICPMetric : uint32
+{
+	POINT_TO_POINT,
+	POINT_TO_PLANE
+};
 
+/**
+ * Source side state of the non-rigid registration: vertex indices, Laplacian coordinates of the steady pose and
+ * factorization of the least squares system (L^T L + fit^2 I) x = L^T l + fit^2 t.
+ * The structure of the system does not depend on the fit to target weight: a change of this weight only recomputes
+ * the numerical factorization.
+ */
 template <typename MESH>
 struct NonRigidRegistration_Helper
 {
@@ -109,21 +80,13 @@ struct NonRigidRegistration_Helper
 	using Attribute = typename mesh_traits<MESH>::template Attribute<T>;
 
 	using Vertex = typename mesh_traits<MESH>::Vertex;
-	using Face = typename mesh_traits<MESH>::Face;
+	using Edge = typename mesh_traits<MESH>::Edge;
 
-	struct BVH_Hit
-	{
-		bool hit = false;
-		Face face;
-		Vec3 bcoords;
-		Scalar dist;
-		Vec3 pos;
-	};
+	using SparseMatrix = Eigen::SparseMatrix<Scalar, Eigen::ColMajor>;
 
 	NonRigidRegistration_Helper(MESH& source, const std::shared_ptr<Attribute<Vec3>>& source_vertex_position,
-								MESH& target, const Attribute<Vec3>* target_vertex_position, Scalar fit_to_target)
-		: source_(source), source_vertex_position_(source_vertex_position), target_(&target),
-		  target_vertex_position_(target_vertex_position), fit_to_target_(fit_to_target)
+								Scalar fit_to_target)
+		: source_(source), source_vertex_position_(source_vertex_position), fit_to_target_(fit_to_target)
 	{
 		source_vertex_position_init_ = add_attribute<Vec3, Vertex>(source, "__nrrh_vertex_position_init");
 		source_vertex_position_init_->copy(source_vertex_position_.get());
@@ -133,8 +96,6 @@ struct NonRigidRegistration_Helper
 		rm.setZero();
 		source_vertex_rotation_matrix_->fill(rm);
 
-		build_target_bvh(target, target_vertex_position);
-
 		// index source vertices
 		source_vertex_index_ = add_attribute<uint32, Vertex>(source_, "__nrrh_vertex_index");
 		source_nb_vertices_ = 0;
@@ -144,30 +105,28 @@ struct NonRigidRegistration_Helper
 		});
 
 		// compute source topo laplacian
-		Eigen::SparseMatrix<Scalar, Eigen::ColMajor> LAPL(source_nb_vertices_, source_nb_vertices_);
+		assembler_ = std::make_unique<SparseAssembler<MESH>>(source_, source_vertex_index_.get());
+		assembler_->fill(LAPL_, [](Edge) -> Scalar { return 1.0; });
 		Eigen::MatrixXd vpos(source_nb_vertices_, 3);
-		std::vector<Eigen::Triplet<Scalar>> LAPLcoeffs;
-		LAPLcoeffs.reserve(source_nb_vertices_ * 10);
-		foreach_cell(source, [&](Vertex v) -> bool {
+		parallel_foreach_cell(source_, [&](Vertex v) -> bool {
 			uint32 vidx = value<uint32>(source_, source_vertex_index_, v);
 			const Vec3& pos = value<Vec3>(source_, source_vertex_position_, v);
 			vpos(vidx, 0) = pos[0];
 			vpos(vidx, 1) = pos[1];
 			vpos(vidx, 2) = pos[2];
-			uint32 nbv = 0;
-			foreach_adjacent_vertex_through_edge(source_, v, [&](Vertex av) -> bool {
-				uint32 avidx = value<uint32>(source_, source_vertex_index_, av);
-				LAPLcoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx), int(avidx), 1));
-				++nbv;
-				return true;
-			});
-			LAPLcoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx), int(vidx), -1 * Scalar(nbv)));
 			return true;
 		});
-		LAPL.setFromTriplets(LAPLcoeffs.begin(), LAPLcoeffs.end());
-		lapl_ = LAPL * vpos;
+		lapl_ = LAPL_ * vpos;
 		rlapl_ = lapl_;
 
+		// the topo laplacian is symmetric: L^T L = L L
+		LTL_ = LAPL_ * LAPL_;
+		SparseMatrix I(source_nb_vertices_, source_nb_vertices_);
+		I.setIdentity();
+		system_ = LTL_ + I;
+		system_.makeCompressed();
+		solver_.analyzePattern(system_);
+
 		// build solver
 		build_solver(fit_to_target_);
 	}
@@ -176,92 +135,23 @@ struct NonRigidRegistration_Helper
 		remove_attribute<Vertex>(source_, source_vertex_index_);
 		remove_attribute<Vertex>(source_, source_vertex_position_init_);
 		remove_attribute<Vertex>(source_, source_vertex_rotation_matrix_);
-		delete target_bvh_;
 	}
 
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(NonRigidRegistration_Helper);
+
 	void init_source_steady_pos()
 	{
 		source_vertex_position_init_->copy(source_vertex_position_.get());
 	}
 
-	void build_target_bvh(MESH& target, const Attribute<Vec3>* target_vertex_position)
-	{
-		target_ = &target;
-		target_vertex_position_ = target_vertex_position;
-
-		auto target_vertex_index = add_attribute<uint32, Vertex>(target, "__nrrh_vertex_index");
-		std::vector<Vec3> target_vertex_positions;
-		uint32 target_nb_vertices = 0;
-		foreach_cell(target, [&](Vertex v) -> bool {
-			value<uint32>(target, target_vertex_index, v) = target_nb_vertices++;
-			target_vertex_positions.push_back(value<Vec3>(*target_, target_vertex_position_, v));
-			return true;
-		});
-		target_faces_.clear();
-		target_faces_.reserve(target_nb_vertices * 2);
-		std::vector<uint32> target_face_vertex_indices;
-		target_face_vertex_indices.reserve(target_nb_vertices * 6);
-		foreach_cell(*target_, [&](Face f) -> bool {
-			target_faces_.push_back(f);
-			foreach_incident_vertex(target, f, [&](Vertex v) -> bool {
-				target_face_vertex_indices.push_back(value<uint32>(*target_, target_vertex_index, v));
-				return true;
-			});
-			return true;
-		});
-		if (target_bvh_)
-			delete target_bvh_;
-		target_bvh_ = new acc::BVHTree<uint32, Vec3>(target_face_vertex_indices, target_vertex_positions);
-		remove_attribute<Vertex>(target, target_vertex_index);
-	}
-
-	bool is_inside_target(const Vec3& p)
-	{
-		std::pair<uint32, Vec3> cp;
-		target_bvh_->closest_point(p, &cp);
-		Vec3 dir = (cp.second - p).normalized();
-		Vec3 n = geometry::normal(*target_, target_faces_[cp.first], target_vertex_position_);
-		return dir.dot(n) >= 0.0;
-	}
-
-	BVH_Hit intersect_target_bvh(const acc::Ray<Vec3>& r)
-	{
-		acc::BVHTree<uint32, Vec3>::Hit h;
-		if (target_bvh_->intersect(r, &h))
-		{
-			Face f = target_faces_[h.idx];
-			std::vector<Vertex> vertices = incident_vertices(*target_, f);
-			Vec3 p = h.bcoords[0] * value<Vec3>(*target_, target_vertex_position_, vertices[0]) +
-					 h.bcoords[1] * value<Vec3>(*target_, target_vertex_position_, vertices[1]) +
-					 h.bcoords[2] * value<Vec3>(*target_, target_vertex_position_, vertices[2]);
-			return {true, f, {h.bcoords[0], h.bcoords[1], h.bcoords[2]}, h.t, p};
-		}
-		else
-			return BVH_Hit();
-	}
-
 	void build_solver(Scalar fit_to_target)
 	{
 		fit_to_target_ = fit_to_target;
-		std::vector<Eigen::Triplet<Scalar>> Acoeffs;
-		Acoeffs.reserve(source_nb_vertices_ * 10);
-		foreach_cell(source_, [&](Vertex v) -> bool {
-			uint32 vidx = value<uint32>(source_, source_vertex_index_, v);
-			uint32 nbv = 0;
-			foreach_adjacent_vertex_through_edge(source_, v, [&](Vertex av) -> bool {
-				uint32 avidx = value<uint32>(source_, source_vertex_index_, av);
-				Acoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx), int(avidx), 1));
-				++nbv;
-				return true;
-			});
-			Acoeffs.push_back(Eigen::Triplet<Scalar>(int(vidx), int(vidx), -1 * Scalar(nbv)));
-			Acoeffs.push_back(Eigen::Triplet<Scalar>(int(source_nb_vertices_ + vidx), int(vidx), fit_to_target_));
-			return true;
-		});
-		A_.resize(2 * source_nb_vertices_, source_nb_vertices_);
-		A_.setFromTriplets(Acoeffs.begin(), Acoeffs.end());
-		At_ = A_.transpose();
-		solver_.compute(At_ * A_);
+		SparseMatrix I(source_nb_vertices_, source_nb_vertices_);
+		I.setIdentity();
+		system_ = LTL_ + (fit_to_target_ * fit_to_target_) * I;
+		system_.makeCompressed();
+		solver_.factorize(system_);
 	}
 
 	MESH& source_;
@@ -273,160 +163,662 @@ struct NonRigidRegistration_Helper
 	Eigen::MatrixXd lapl_;
 	Eigen::MatrixXd rlapl_;
 
-	MESH* target_ = nullptr;
-	const Attribute<Vec3>* target_vertex_position_ = nullptr;
-
 	Scalar fit_to_target_;
-	acc::BVHTree<uint32, Vec3>* target_bvh_ = nullptr;
-	std::vector<Face> target_faces_;
 
-	Eigen::SparseMatrix<Scalar, Eigen::ColMajor> A_;
-	Eigen::SparseMatrix<Scalar, Eigen::ColMajor> At_;
-	Eigen::SimplicialLDLT<Eigen::SparseMatrix<Scalar, Eigen::ColMajor>> solver_;
-};
+	std::unique_ptr<SparseAssembler<MESH>> assembler_;
+	SparseMatrix LAPL_;
+	SparseMatrix LTL_;
+	SparseMatrix system_;
+	Eigen::SimplicialLDLT<SparseMatrix> solver_;
 
-enum ProximityPolicy : uint32
-{
-	NEAREST_POINT,
-	NORMAL_RAY
+	std::vector<Vec3> positions_; // by vertex index
+	std::vector<Vec3> targets_;	  // by vertex index
 };
 
+///////////////////////////////
+// SurfaceRegistration class //
+///////////////////////////////
+
+/**
+ * Rigid (point to point or point to plane ICP) and non-rigid registration against a target surface.
+ * The BVH of the target is built once and kept across the calls: after a motion of the target vertices,
+ * update_target_geometry refits it, after a change of its connectivity, rebuild_target recomputes it, and set_target
+ * replaces the target (the source state of the non-rigid registration is kept).
+ * The correspondences are searched in parallel for all the points at once, each search being bounded by the distance
+ * to the previous correspondence of the same point (which is still on the target surface), so that the searches of
+ * the successive iterations or frames only visit the neighborhood of the previous match.
+ * The rigid transform of the last registration is kept as the initial guess of the next one (warm start), so that
+ * a stream of frames can be registered incrementally. The statistics of each iteration of the last registration
+ * (number of correspondences, mean distance, correspondences search & solve timings) are available.
+ */
 template <typename MESH>
-void non_rigid_register_mesh(
-	MESH& source, std::shared_ptr<typename mesh_traits<MESH>::template Attribute<Vec3>>& source_vertex_position,
-	MESH& target, const typename mesh_traits<MESH>::template Attribute<Vec3>* target_vertex_position,
-	Scalar fit_to_target, bool relax, bool init_source_steady_pos, ProximityPolicy prox = NEAREST_POINT)
+class SurfaceRegistration
 {
+	static_assert(mesh_traits<MESH>::dimension == 2, "SurfaceRegistration can only be used with meshes of dimension 2");
+
+	template <typename T>
+	using Attribute = typename mesh_traits<MESH>::template Attribute<T>;
 	using Vertex = typename mesh_traits<MESH>::Vertex;
 	using Face = typename mesh_traits<MESH>::Face;
 
-	// static map to store helpers associated to meshes
-	// allows to store context without polluting outer context and function api
-	static std::unordered_map<MESH*, NonRigidRegistration_Helper<MESH>> helpers_;
-	auto [it, inserted] =
-		helpers_.try_emplace(&source, source, source_vertex_position, target, target_vertex_position, fit_to_target);
-	NonRigidRegistration_Helper<MESH>& helper = it->second;
-	if (&target != helper.target_ || target_vertex_position != helper.target_vertex_position_)
-		helper.build_target_bvh(target, target_vertex_position);
-	if (fit_to_target != helper.fit_to_target_)
-		helper.build_solver(fit_to_target);
-	if (init_source_steady_pos)
-		helper.init_source_steady_pos();
-
-	// rotate laplacian coordinates
-	parallel_foreach_cell(source, [&](Vertex v) -> bool {
-		Mat3 cov;
-		cov.setZero();
-		const Vec3& pos = value<Vec3>(source, helper.source_vertex_position_, v);
-		const Vec3& pos_i = value<Vec3>(source, helper.source_vertex_position_init_, v);
-		foreach_adjacent_vertex_through_edge(source, v, [&](Vertex av) -> bool {
-			Vec3 vec = (value<Vec3>(source, helper.source_vertex_position_, av) - pos).normalized();
-			Vec3 vec_i = (value<Vec3>(source, helper.source_vertex_position_init_, av) - pos_i).normalized();
-			for (uint32 i = 0; i < 3; ++i)
-				for (uint32 j = 0; j < 3; ++j)
-					cov(i, j) += vec[i] * vec_i[j];
+	using BVH = SurfaceBVH<MESH>;
+	using Hit = typename BVH::Hit;
+	using Clock = std::chrono::high_resolution_clock;
+	using Mat6 = Eigen::Matrix<Scalar, 6, 6>;
+	using Vec6 = Eigen::Matrix<Scalar, 6, 1>;
+
+	static const uint32 CHUNK_SIZE = 1024u;
+	static constexpr Scalar UPDATE_EPSILON = 1e-12;
+
+public:
+	struct RigidParameters
+	{
+		uint32 max_nb_points_ = 5000u; // number of registered points (regularly sampled), 0 for all the points
+		uint32 max_iterations_ = 100u;
+		Scalar min_change_ = 0.01;		// stop when the mean distance decreases by a smaller relative amount
+		Scalar rejection_factor_ = 3.0; // reject the correspondences with |d - median(d)| > factor * MAD(d)
+		ICPMetric metric_ = POINT_TO_POINT;
+	};
+
+	struct IterationStatistics
+	{
+		uint32 nb_correspondences_;
+		Scalar mean_distance_;
+		double correspondences_time_; // seconds
+		double solve_time_;			  // seconds
+	};
+
+	SurfaceRegistration(const MESH& target, const std::shared_ptr<Attribute<Vec3>>& target_vertex_position)
+		: target_bvh_(std::make_unique<BVH>(target, target_vertex_position)), transform_(Mat4::Identity())
+	{
+	}
+
+	// the given target position attribute must outlive the registration
+	SurfaceRegistration(const MESH& target, const Attribute<Vec3>* target_vertex_position)
+		: target_bvh_(std::make_unique<BVH>(target, target_vertex_position)), transform_(Mat4::Identity())
+	{
+	}
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(SurfaceRegistration);
+
+	inline const MESH& target() const
+	{
+		return target_bvh_->mesh();
+	}
+
+	inline const Attribute<Vec3>* target_vertex_position() const
+	{
+		return target_bvh_->vertex_position();
+	}
+
+	inline const BVH& target_bvh() const
+	{
+		return *target_bvh_;
+	}
+
+	void set_target(const MESH& target, const std::shared_ptr<Attribute<Vec3>>& target_vertex_position)
+	{
+		target_bvh_ = std::make_unique<BVH>(target, target_vertex_position);
+		correspondences_.clear();
+	}
+
+	void set_target(const MESH& target, const Attribute<Vec3>* target_vertex_position)
+	{
+		target_bvh_ = std::make_unique<BVH>(target, target_vertex_position);
+		correspondences_.clear();
+	}
+
+	void update_target_geometry()
+	{
+		target_bvh_->refit();
+		correspondences_.clear();
+	}
+
+	void rebuild_target()
+	{
+		target_bvh_->rebuild();
+		correspondences_.clear();
+	}
+
+	inline const Mat4& transform() const
+	{
+		return transform_;
+	}
+
+	inline void reset_transform()
+	{
+		transform_.setIdentity();
+	}
+
+	inline const std::vector<IterationStatistics>& statistics() const
+	{
+		return statistics_;
+	}
+
+	/**
+	 * @brief compute by ICP the rigid transform that maps the given points onto the target surface
+	 * @param warm_start start from the transform of the last registration (instead of the identity)
+	 * @return the transform (also kept as transform())
+	 */
+	Mat4 rigid_register(const std::vector<Vec3>& points, const RigidParameters& p = RigidParameters(),
+						bool warm_start = false)
+	{
+		statistics_.clear();
+		if (!warm_start)
+			transform_.setIdentity();
+
+		const uint32 nb_points = uint32(points.size());
+		uint32 stride = 1u;
+		if (p.max_nb_points_ > 0u && nb_points > p.max_nb_points_)
+			stride = (nb_points + p.max_nb_points_ - 1u) / p.max_nb_points_;
+		samples_.clear();
+		samples_.reserve(nb_points / stride + 1u);
+		for (uint32 i = 0u; i < nb_points; i += stride)
+			samples_.push_back(points[i]);
+		const uint32 nb_samples = uint32(samples_.size());
+		if (nb_samples == 0u)
+			return transform_;
+
+		// size of the samples, used to detect negligible updates
+		Vec3 bb_min = samples_[0], bb_max = samples_[0];
+		for (const Vec3& s : samples_)
+		{
+			bb_min = bb_min.cwiseMin(s);
+			bb_max = bb_max.cwiseMax(s);
+		}
+		const Scalar size = (bb_max - bb_min).norm();
+
+		moved_samples_.resize(nb_samples);
+		distances_.resize(nb_samples);
+		const uint32 nb_chunks = (nb_samples + CHUNK_SIZE - 1u) / CHUNK_SIZE;
+		std::vector<System> systems(nb_chunks);
+
+		Scalar previous_mean_distance = std::numeric_limits<Scalar>::max();
+		for (uint32 it = 0u; it < p.max_iterations_; ++it)
+		{
+			auto start = Clock::now();
+
+			const Mat3 R = transform_.topLeftCorner<3, 3>();
+			const Vec3 T = transform_.topRightCorner<3, 1>();
+			parallel_foreach_chunk(nb_chunks, [&](uint32 c) -> bool {
+				for (uint32 i = c * CHUNK_SIZE, end = std::min(nb_samples, i + CHUNK_SIZE); i < end; ++i)
+					moved_samples_[i] = R * samples_[i] + T;
+				return true;
+			});
+			closest_points(moved_samples_);
+
+			auto correspondences_end = Clock::now();
+
+			// outliers rejection
+			std::vector<Scalar> sorted_distances;
+			sorted_distances.reserve(nb_samples);
+			for (uint32 i = 0u; i < nb_samples; ++i)
+			{
+				distances_[i] = correspondences_[i].valid_ ? (moved_samples_[i] - correspondences_[i].position_).norm()
+														   : std::numeric_limits<Scalar>::max();
+				if (correspondences_[i].valid_)
+					sorted_distances.push_back(distances_[i]);
+			}
+			if (sorted_distances.empty())
+				break;
+			const Scalar median = median_of(sorted_distances);
+			for (Scalar& d : sorted_distances)
+				d = std::abs(d - median);
+			const Scalar max_deviation = p.rejection_factor_ * median_of(sorted_distances);
+
+			// point to point: sums of the cross-covariance of the pairs,
+			// point to plane: linearized system (small rotation angles & translation), accumulated by chunk
+			parallel_foreach_chunk(nb_chunks, [&](uint32 c) -> bool {
+				System& s = systems[c];
+				s.reset();
+				for (uint32 i = c * CHUNK_SIZE, end = std::min(nb_samples, i + CHUNK_SIZE); i < end; ++i)
+				{
+					if (distances_[i] == std::numeric_limits<Scalar>::max() ||
+						std::abs(distances_[i] - median) > max_deviation)
+						continue;
+					const Hit& h = correspondences_[i];
+					const Vec3& q = moved_samples_[i];
+					if (p.metric_ == POINT_TO_POINT)
+					{
+						s.sum_q_ += q;
+						s.sum_t_ += h.position_;
+						s.sum_qt_.noalias() += q * h.position_.transpose();
+					}
+					else
+					{
+						const Vec3 n = geometry::normal(target_bvh_->mesh(), h.face_, target_bvh_->vertex_position());
+						Vec6 J;
+						J << q.cross(n), n;
+						s.A_.noalias() += J * J.transpose();
+						s.b_ -= J * n.dot(q - h.position_);
+					}
+					s.distance_ += distances_[i];
+					++s.nb_correspondences_;
+				}
+				return true;
+			});
+			System s;
+			s.reset();
+			for (const System& cs : systems)
+			{
+				s.A_ += cs.A_;
+				s.b_ += cs.b_;
+				s.sum_q_ += cs.sum_q_;
+				s.sum_t_ += cs.sum_t_;
+				s.sum_qt_ += cs.sum_qt_;
+				s.distance_ += cs.distance_;
+				s.nb_correspondences_ += cs.nb_correspondences_;
+			}
+			if (s.nb_correspondences_ < (p.metric_ == POINT_TO_POINT ? 3u : 6u))
+				break;
+
+			Mat4 dH = Mat4::Identity();
+			if (p.metric_ == POINT_TO_POINT)
+			{
+				// Kabsch: rotation that best aligns the centered pairs
+				const Vec3 cq = s.sum_q_ / s.nb_correspondences_;
+				const Vec3 ct = s.sum_t_ / s.nb_correspondences_;
+				const Mat3 H = s.sum_qt_ - Scalar(s.nb_correspondences_) * cq * ct.transpose();
+				Eigen::JacobiSVD<Mat3> svd(H, Eigen::ComputeFullU | Eigen::ComputeFullV);
+				Mat3 R = svd.matrixV() * svd.matrixU().transpose();
+				if (R.determinant() < 0)
+				{
+					Mat3 V = svd.matrixV();
+					V.col(2) *= -1;
+					R = V * svd.matrixU().transpose();
+				}
+				dH.topLeftCorner<3, 3>() = R;
+				dH.topRightCorner<3, 1>() = ct - R * cq;
+			}
+			else
+			{
+				const Vec6 x = s.A_.ldlt().solve(s.b_);
+				const Vec3 w = x.head<3>();
+				const Scalar angle = w.norm();
+				if (angle > 0)
+					dH.topLeftCorner<3, 3>() = Eigen::AngleAxis<Scalar>(angle, w / angle).toRotationMatrix();
+				dH.topRightCorner<3, 1>() = x.tail<3>();
+			}
+			transform_ = dH * transform_;
+			const Scalar angle = Eigen::AngleAxis<Scalar>(Mat3(dH.topLeftCorner<3, 3>())).angle();
+
+			auto end = Clock::now();
+
+			const Scalar mean_distance = s.distance_ / s.nb_correspondences_;
+			statistics_.push_back({s.nb_correspondences_, mean_distance,
+								   std::chrono::duration<double>(correspondences_end - start).count(),
+								   std::chrono::duration<double>(end - correspondences_end).count()});
+
+			if (previous_mean_distance - mean_distance <= p.min_change_ * previous_mean_distance ||
+				(angle < UPDATE_EPSILON && dH.topRightCorner<3, 1>().norm() < UPDATE_EPSILON * size))
+				break;
+			previous_mean_distance = mean_distance;
+		}
+
+		return transform_;
+	}
+
+	/**
+	 * @brief register rigidly the vertices of the given mesh onto the target surface (the positions are transformed)
+	 */
+	template <typename MESHS>
+	Mat4 rigid_register(MESHS& source,
+						typename mesh_traits<MESHS>::template Attribute<Vec3>* source_vertex_position,
+						const RigidParameters& p = RigidParameters(), bool warm_start = false)
+	{
+		using SVertex = typename mesh_traits<MESHS>::Vertex;
+
+		std::vector<Vec3> points;
+		points.reserve(nb_cells<SVertex>(source));
+		foreach_cell(source, [&](SVertex v) -> bool {
+			points.push_back(value<Vec3>(source, source_vertex_position, v));
 			return true;
 		});
-		Eigen::JacobiSVD<Mat3> svd(cov, Eigen::ComputeFullU | Eigen::ComputeFullV);
-		Mat3 R = svd.matrixU() * svd.matrixV().transpose();
-		if (R.determinant() < 0)
+
+		const Mat4 t = rigid_register(points, p, warm_start);
+		const Mat3 R = t.topLeftCorner<3, 3>();
+		const Vec3 T = t.topRightCorner<3, 1>();
+		parallel_foreach_cell(source, [&](SVertex v) -> bool {
+			Vec3& pos = value<Vec3>(source, source_vertex_position, v);
+			pos = R * pos + T;
+			return true;
+		});
+
+		return t;
+	}
+
+	/**
+	 * @brief move the vertices of the source mesh toward the target surface while preserving its (rotated) Laplacian
+	 * coordinates. The source state (indices, factorization, ...) is kept until the source or its position changes.
+	 * @param relax do not preserve the Laplacian coordinates (smooth the displacement)
+	 * @param init_source_steady_pos take the current positions as the steady pose
+	 */
+	void non_rigid_register(MESH& source, const std::shared_ptr<Attribute<Vec3>>& source_vertex_position,
+							Scalar fit_to_target, bool relax, bool init_source_steady_pos,
+							ProximityPolicy prox = NEAREST_POINT)
+	{
+		statistics_.clear();
+
+		if (!non_rigid_ || &non_rigid_->source_ != &source ||
+			non_rigid_->source_vertex_position_ != source_vertex_position)
 		{
-			Mat3 U = svd.matrixU();
-			for (uint32 i = 0; i < 3; ++i)
-				U(i, 2) *= -1;
-			R = U * svd.matrixV().transpose();
+			non_rigid_.reset();
+			non_rigid_ =
+				std::make_unique<NonRigidRegistration_Helper<MESH>>(source, source_vertex_position, fit_to_target);
 		}
-		value<Mat3>(source, helper.source_vertex_rotation_matrix_, v) = R;
-		return true;
-	});
-	parallel_foreach_cell(source, [&](Vertex v) -> bool {
-		// uint32 degree = 0;
-		// Mat3 r;
-		// r.setZero();
-		// foreach_adjacent_vertex_through_edge(source, v, [&](Vertex av) -> bool {
-		// 	r += value<Mat3>(source, helper.source_vertex_rotation_matrix_, av);
-		// 	++degree;
-		// 	return true;
-		// });
-		// r += value<Mat3>(source, helper.source_vertex_rotation_matrix_, v);
-		// r /= degree + 1;
-		const Mat3& r = value<Mat3>(source, helper.source_vertex_rotation_matrix_, v);
-		uint32 vidx = value<uint32>(source, helper.source_vertex_index_, v);
-		Vec3 l;
-		l[0] = helper.lapl_(vidx, 0);
-		l[1] = helper.lapl_(vidx, 1);
-		l[2] = helper.lapl_(vidx, 2);
-		Vec3 rl = r * l;
-		helper.rlapl_(vidx, 0) = rl[0];
-		helper.rlapl_(vidx, 1) = rl[1];
-		helper.rlapl_(vidx, 2) = rl[2];
-		return true;
-	});
+		NonRigidRegistration_Helper<MESH>& helper = *non_rigid_;
+		if (fit_to_target != helper.fit_to_target_)
+			helper.build_solver(fit_to_target);
+		if (init_source_steady_pos)
+			helper.init_source_steady_pos();
+
+		auto start = Clock::now();
+
+		// rotate laplacian coordinates
+		parallel_foreach_cell(source, [&](Vertex v) -> bool {
+			Mat3 cov;
+			cov.setZero();
+			const Vec3& pos = value<Vec3>(source, helper.source_vertex_position_, v);
+			const Vec3& pos_i = value<Vec3>(source, helper.source_vertex_position_init_, v);
+			foreach_adjacent_vertex_through_edge(source, v, [&](Vertex av) -> bool {
+				Vec3 vec = (value<Vec3>(source, helper.source_vertex_position_, av) - pos).normalized();
+				Vec3 vec_i = (value<Vec3>(source, helper.source_vertex_position_init_, av) - pos_i).normalized();
+				for (uint32 i = 0; i < 3; ++i)
+					for (uint32 j = 0; j < 3; ++j)
+						cov(i, j) += vec[i] * vec_i[j];
+				return true;
+			});
+			Eigen::JacobiSVD<Mat3> svd(cov, Eigen::ComputeFullU | Eigen::ComputeFullV);
+			Mat3 R = svd.matrixU() * svd.matrixV().transpose();
+			if (R.determinant() < 0)
+			{
+				Mat3 U = svd.matrixU();
+				for (uint32 i = 0; i < 3; ++i)
+					U(i, 2) *= -1;
+				R = U * svd.matrixV().transpose();
+			}
+			value<Mat3>(source, helper.source_vertex_rotation_matrix_, v) = R;
+			return true;
+		});
+		parallel_foreach_cell(source, [&](Vertex v) -> bool {
+			const Mat3& r = value<Mat3>(source, helper.source_vertex_rotation_matrix_, v);
+			uint32 vidx = value<uint32>(source, helper.source_vertex_index_, v);
+			Vec3 l;
+			l[0] = helper.lapl_(vidx, 0);
+			l[1] = helper.lapl_(vidx, 1);
+			l[2] = helper.lapl_(vidx, 2);
+			Vec3 rl = r * l;
+			helper.rlapl_(vidx, 0) = rl[0];
+			helper.rlapl_(vidx, 1) = rl[1];
+			helper.rlapl_(vidx, 2) = rl[2];
+			return true;
+		});
 
-	// setup RHS
-	Eigen::MatrixXd b(2 * helper.source_nb_vertices_, 3);
-	Vec3 pos;
-	parallel_foreach_cell(source, [&](Vertex v) -> bool {
-		Vec3 pos;
+		// correspondences
+		helper.positions_.resize(helper.source_nb_vertices_);
+		helper.targets_.resize(helper.source_nb_vertices_);
+		parallel_foreach_cell(source, [&](Vertex v) -> bool {
+			helper.positions_[value<uint32>(source, helper.source_vertex_index_, v)] =
+				value<Vec3>(source, helper.source_vertex_position_, v);
+			return true;
+		});
 		switch (prox)
 		{
 		case NEAREST_POINT: {
-			pos = helper.target_bvh_->closest_point(value<Vec3>(source, helper.source_vertex_position_, v));
+			closest_points(helper.positions_);
+			for (uint32 i = 0u; i < helper.source_nb_vertices_; ++i)
+				helper.targets_[i] = correspondences_[i].valid_ ? correspondences_[i].position_ : helper.positions_[i];
 		}
 		break;
 		case NORMAL_RAY: {
-			const Vec3& p = value<Vec3>(source, helper.source_vertex_position_, v);
-			Vec3 n{0, 0, 0};
-			foreach_incident_face(source, v, [&](Face f) -> bool {
-				Vec3 nf = geometry::normal(source, f, helper.source_vertex_position_.get());
-				Vec3 cf = geometry::centroid<Vec3>(source, f, helper.source_vertex_position_.get());
-				bool inside = helper.is_inside_target(cf);
-				if (!inside)
-					nf *= -1;
-				typename NonRigidRegistration_Helper<MESH>::BVH_Hit h =
-					helper.intersect_target_bvh({cf, nf, 0, acc::inf});
-				if (h.hit)
-					n += inside ? h.pos - cf : cf - h.pos;
+			parallel_foreach_cell(source, [&](Vertex v) -> bool {
+				const uint32 vidx = value<uint32>(source, helper.source_vertex_index_, v);
+				const Vec3& p = helper.positions_[vidx];
+				Vec3 n{0, 0, 0};
+				foreach_incident_face(source, v, [&](Face f) -> bool {
+					Vec3 nf = geometry::normal(source, f, helper.source_vertex_position_.get());
+					Vec3 cf = geometry::centroid<Vec3>(source, f, helper.source_vertex_position_.get());
+					bool inside = is_inside_target(cf);
+					if (!inside)
+						nf *= -1;
+					Hit h = target_bvh_->intersect({cf, nf});
+					if (h.valid_)
+						n += inside ? h.position_ - cf : cf - h.position_;
+					return true;
+				});
+				n.normalize();
+
+				if (!is_inside_target(p))
+					n *= -1;
+
+				Hit h = target_bvh_->intersect({p, n});
+				if (!h.valid_)
+					h = target_bvh_->closest_point(p);
+				helper.targets_[vidx] = h.valid_ ? h.position_ : p;
 				return true;
 			});
-			n.normalize();
-
-			if (!helper.is_inside_target(p))
-				n *= -1;
-
-			typename NonRigidRegistration_Helper<MESH>::BVH_Hit h = helper.intersect_target_bvh({p, n, 0, acc::inf});
-			if (h.hit)
-				pos = h.pos;
-			else
-				pos = helper.target_bvh_->closest_point(p);
 		}
 		break;
 		};
 
-		uint32 vidx = value<uint32>(source, helper.source_vertex_index_, v);
+		auto correspondences_end = Clock::now();
+
+		// setup RHS: L^T (L x - rl) + fit^2 (x - t) = 0
+		const Scalar fit2 = fit_to_target * fit_to_target;
+		Eigen::MatrixXd b(helper.source_nb_vertices_, 3);
+		Scalar distance = 0;
+		for (uint32 i = 0u; i < helper.source_nb_vertices_; ++i)
+		{
+			const Vec3& t = helper.targets_[i];
+			b(i, 0) = fit2 * t[0];
+			b(i, 1) = fit2 * t[1];
+			b(i, 2) = fit2 * t[2];
+			distance += (t - helper.positions_[i]).norm();
+		}
+		if (!relax)
+			b += helper.LAPL_ * helper.rlapl_;
+
+		// solve
+		Eigen::MatrixXd vpos = helper.solver_.solve(b);
+
+		// store result
+		parallel_foreach_cell(source, [&](Vertex v) -> bool {
+			uint32 vidx = value<uint32>(source, helper.source_vertex_index_, v);
+			Vec3& pos = value<Vec3>(source, helper.source_vertex_position_, v);
+			pos[0] = vpos(vidx, 0);
+			pos[1] = vpos(vidx, 1);
+			pos[2] = vpos(vidx, 2);
+			return true;
+		});
+
+		auto end = Clock::now();
+
+		statistics_.push_back({helper.source_nb_vertices_,
+							   helper.source_nb_vertices_ > 0u ? distance / helper.source_nb_vertices_ : Scalar(0),
+							   std::chrono::duration<double>(correspondences_end - start).count(),
+							   std::chrono::duration<double>(end - correspondences_end).count()});
+	}
+
+	bool is_inside_target(const Vec3& p) const
+	{
+		const Hit h = target_bvh_->closest_point(p);
+		Vec3 dir = (h.position_ - p).normalized();
+		Vec3 n = geometry::normal(target_bvh_->mesh(), h.face_, target_bvh_->vertex_position());
+		return dir.dot(n) >= 0.0;
+	}
+
+private:
+	struct System
+	{
+		Mat6 A_;
+		Vec6 b_;
+		Vec3 sum_q_;
+		Vec3 sum_t_;
+		Mat3 sum_qt_;
+		Scalar distance_;
+		uint32 nb_correspondences_;
+
+		inline void reset()
+		{
+			A_.setZero();
+			b_.setZero();
+			sum_q_.setZero();
+			sum_t_.setZero();
+			sum_qt_.setZero();
+			distance_ = 0;
+			nb_correspondences_ = 0u;
+		}
+	};
+
+	static Scalar median_of(std::vector<Scalar>& values)
+	{
+		auto it = values.begin() + values.size() / 2;
+		std::nth_element(values.begin(), it, values.end());
+		return *it;
+	}
+
+	// fills correspondences_ with the closest points of the target to the given points
+	void closest_points(const std::vector<Vec3>& points)
+	{
+		const uint32 nb_points = uint32(points.size());
+		const bool bounded = correspondences_.size() == points.size();
+		if (!bounded)
+		{
+			correspondences_.clear();
+			correspondences_.resize(nb_points);
+		}
+		parallel_foreach_chunk((nb_points + CHUNK_SIZE - 1u) / CHUNK_SIZE, [&](uint32 c) -> bool {
+			for (uint32 i = c * CHUNK_SIZE, end = std::min(nb_points, i + CHUNK_SIZE); i < end; ++i)
+			{
+				Hit& h = correspondences_[i];
+				if (h.valid_)
+				{
+					// the previous correspondence is on the surface: the closest point is not further away
+					const Scalar bound = (points[i] - h.position_).norm() * Scalar(1.0001) + Scalar(1e-12);
+					h = target_bvh_->closest_point(points[i], bound);
+					if (h.valid_)
+						continue;
+				}
+				h = target_bvh_->closest_point(points[i]);
+			}
+			return true;
+		});
+	}
+
+	std::unique_ptr<BVH> target_bvh_;
+	Mat4 transform_;
+	std::vector<IterationStatistics> statistics_;
 
-		b(vidx, 0) = relax ? 0.0 : helper.rlapl_(vidx, 0);
-		b(vidx, 1) = relax ? 0.0 : helper.rlapl_(vidx, 1);
-		b(vidx, 2) = relax ? 0.0 : helper.rlapl_(vidx, 2);
-		b(helper.source_nb_vertices_ + vidx, 0) = fit_to_target * pos[0];
-		b(helper.source_nb_vertices_ + vidx, 1) = fit_to_target * pos[1];
-		b(helper.source_nb_vertices_ + vidx, 2) = fit_to_target * pos[2];
+	std::vector<Hit> correspondences_;
+	std::vector<Vec3> samples_;
+	std::vector<Vec3> moved_samples_;
+	std::vector<Scalar> distances_;
 
+	std::unique_ptr<NonRigidRegistration_Helper<MESH>> non_rigid_;
+};
+
+template <typename MESHS, typename MESHT>
+Mat4 rigid_register_mesh(MESHS& source, typename mesh_traits<MESHS>::template Attribute<Vec3>* source_vertex_position,
+						 MESHT& target,
+						 const typename mesh_traits<MESHT>::template Attribute<Vec3>* target_vertex_position)
+{
+	using SVertex = typename mesh_traits<MESHS>::Vertex;
+	using TVertex = typename mesh_traits<MESHT>::Vertex;
+
+	uint32 source_nbv = nb_cells<SVertex>(source);
+	Eigen::MatrixXd X_source(source_nbv, 3);
+	auto source_vertex_index = add_attribute<uint32, SVertex>(source, "__vertex_index");
+	uint32 source_vertex_idx = 0;
+	foreach_cell(source, [&](SVertex v) -> bool {
+		const Vec3& p = value<Vec3>(source, source_vertex_position, v);
+		X_source(source_vertex_idx, 0) = p[0];
+		X_source(source_vertex_idx, 1) = p[1];
+		X_source(source_vertex_idx, 2) = p[2];
+		value<uint32>(source, source_vertex_index, v) = source_vertex_idx++;
 		return true;
 	});
 
-	// solve
-	Eigen::MatrixXd vpos = helper.solver_.solve(helper.At_ * b);
+	uint32 target_nbv = nb_cells<TVertex>(target);
+	Eigen::MatrixXd X_target(target_nbv, 3);
+	auto target_vertex_index = add_attribute<uint32, TVertex>(target, "__vertex_index");
+	uint32 target_vertex_idx = 0;
+	foreach_cell(target, [&](TVertex v) -> bool {
+		const Vec3& p = value<Vec3>(target, target_vertex_position, v);
+		X_target(target_vertex_idx, 0) = p[0];
+		X_target(target_vertex_idx, 1) = p[1];
+		X_target(target_vertex_idx, 2) = p[2];
+		value<uint32>(target, target_vertex_index, v) = target_vertex_idx++;
+		return true;
+	});
+
+	Mat4 t = SimpleICP(X_target, X_source);
 
-	// store result
-	parallel_foreach_cell(source, [&](Vertex v) -> bool {
-		uint32 vidx = value<uint32>(source, helper.source_vertex_index_, v);
-		Vec3& pos = value<Vec3>(source, helper.source_vertex_position_, v);
-		pos[0] = vpos(vidx, 0);
-		pos[1] = vpos(vidx, 1);
-		pos[2] = vpos(vidx, 2);
+	Eigen::MatrixXd X_sourceH(4, source_nbv);
+	foreach_cell(source, [&](SVertex v) -> bool {
+		uint32 idx = value<uint32>(source, source_vertex_index, v);
+		const Vec3& p = value<Vec3>(source, source_vertex_position, v);
+		X_sourceH(0, idx) = p[0];
+		X_sourceH(1, idx) = p[1];
+		X_sourceH(2, idx) = p[2];
+		X_sourceH(3, idx) = 1.0;
 		return true;
 	});
+	Eigen::MatrixXd res = t * X_sourceH;
+	foreach_cell(source, [&](SVertex v) -> bool {
+		uint32 idx = value<uint32>(source, source_vertex_index, v);
+		Vec3& p = value<Vec3>(source, source_vertex_position, v);
+		p[0] = res(0, idx);
+		p[1] = res(1, idx);
+		p[2] = res(2, idx);
+		return true;
+	});
+
+	remove_attribute<SVertex>(source, source_vertex_index);
+	remove_attribute<TVertex>(target, target_vertex_index);
+
+	return t;
+}
+
+namespace internal
+{
+
+// registrations of non_rigid_register_mesh, by source mesh
+template <typename MESH>
+std::unordered_map<const MESH*, std::unique_ptr<SurfaceRegistration<MESH>>>& non_rigid_registrations()
+{
+	static std::unordered_map<const MESH*, std::unique_ptr<SurfaceRegistration<MESH>>> registrations;
+	return registrations;
+}
+
+} // namespace internal
+
+/**
+ * @brief non-rigid registration of source onto target: the source state (indices, factorization, ...) is kept from one
+ * call to the next (by source mesh) and only the BVH of the target is rebuilt when the target changes.
+ * release_non_rigid_register_mesh must be called before the destruction of the source or the target.
+ */
+template <typename MESH>
+void non_rigid_register_mesh(
+	MESH& source, std::shared_ptr<typename mesh_traits<MESH>::template Attribute<Vec3>>& source_vertex_position,
+	MESH& target, const typename mesh_traits<MESH>::template Attribute<Vec3>* target_vertex_position,
+	Scalar fit_to_target, bool relax, bool init_source_steady_pos, ProximityPolicy prox = NEAREST_POINT)
+{
+	std::unique_ptr<SurfaceRegistration<MESH>>& registration = internal::non_rigid_registrations<MESH>()[&source];
+	if (!registration)
+		registration = std::make_unique<SurfaceRegistration<MESH>>(target, target_vertex_position);
+	else if (&target != &registration->target() || target_vertex_position != registration->target_vertex_position())
+		registration->set_target(target, target_vertex_position);
+	registration->non_rigid_register(source, source_vertex_position, fit_to_target, relax, init_source_steady_pos,
+									 prox);
+}
+
+/**
+ * @brief release the state kept by non_rigid_register_mesh for the given source (and its attributes on the source)
+ */
+template <typename MESH>
+void release_non_rigid_register_mesh(const MESH& source)
+{
+	internal::non_rigid_registrations<MESH>().erase(&source);
 }
 
 } // namespace geometry
@@ -0,0 +1,380 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_GEOMETRY_ALGOS_SPARSE_ASSEMBLER_H_
+#define CGOGN_GEOMETRY_ALGOS_SPARSE_ASSEMBLER_H_
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <cgogn/geometry/types/vector_traits.h>
+
+#include <Eigen/Sparse>
+
+#include <algorithm>
+#include <vector>
+
+namespace cgogn
+{
+
+namespace geometry
+{
+
+///////////////////////////
+// SparseAssembler class //
+///////////////////////////
+
+/**
+ * Assembly of the sparse vertex x vertex matrices whose nonzeros are the diagonal and the edges of a mesh (Laplacians,
+ * heat or smoothing operators, ...).
+ * The compressed column pattern is built once from the connectivity, together with the position in the value array of
+ * the 2 coefficients of each edge and of each diagonal coefficient (slots). Filling a matrix is then a parallel loop
+ * over the edges and the columns writing directly into its value array: the structure of the filled matrices never
+ * changes, so that a solver can keep its symbolic analysis (analyzePattern once, factorize after each fill).
+ * The rows are given by a vertex index attribute (that must number the vertices from 0) or by the traversal order.
+ * MESH can be a mesh view (CellCache, ...): only its vertices and edges are considered.
+ * After a change of the connectivity (or of the vertex indices), call rebuild.
+ */
+template <typename MESH>
+class SparseAssembler
+{
+	template <typename T>
+	using Attribute = typename mesh_traits<MESH>::template Attribute<T>;
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Edge = typename mesh_traits<MESH>::Edge;
+
+	static const uint32 CHUNK_SIZE = 4096u;
+
+public:
+	using SparseMatrix = Eigen::SparseMatrix<Scalar, Eigen::ColMajor>;
+
+	// the vertex index attribute is referenced (not copied) and must outlive the assembler
+	SparseAssembler(const MESH& m, const Attribute<uint32>* vertex_index = nullptr)
+		: mesh_(m), vertex_index_(vertex_index)
+	{
+		rebuild();
+	}
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(SparseAssembler);
+
+	inline uint32 nb_rows() const
+	{
+		return uint32(row_vertices_.size());
+	}
+
+	// vertex of each row
+	inline const std::vector<Vertex>& vertices() const
+	{
+		return row_vertices_;
+	}
+
+	inline const std::vector<Edge>& edges() const
+	{
+		return edges_;
+	}
+
+	// matrix with the sparsity pattern and null values
+	inline const SparseMatrix& pattern() const
+	{
+		return pattern_;
+	}
+
+	/**
+	 * @brief recompute the sparsity pattern and the slots of the coefficients
+	 */
+	void rebuild()
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32> index_row; // vertex index -> row (traversal order)
+		foreach_cell(mesh_, [&](Vertex v) -> bool {
+			if (!vertex_index_)
+			{
+				const uint32 index = index_of(mesh_, v);
+				if (index >= index_row.size())
+					index_row.resize(index + 1u, INVALID_INDEX);
+				index_row[index] = uint32(vertices.size());
+			}
+			vertices.push_back(v);
+			return true;
+		});
+		auto row = [&](Vertex v) -> uint32 {
+			return vertex_index_ ? value<uint32>(mesh_, vertex_index_, v) : index_row[index_of(mesh_, v)];
+		};
+		const uint32 nb_rows = uint32(vertices.size());
+		row_vertices_.resize(nb_rows);
+		for (Vertex v : vertices)
+		{
+			cgogn_message_assert(row(v) < nb_rows, "Vertex indices should be in [0, nb vertices)");
+			row_vertices_[row(v)] = v;
+		}
+
+		// edges rows (loops do not contribute to the matrix and are not kept)
+		edges_.clear();
+		std::vector<uint32> edges_rows;
+		foreach_cell(mesh_, [&](Edge e) -> bool {
+			auto vertices = incident_vertices(mesh_, e);
+			uint32 r1 = row(vertices[0]);
+			uint32 r2 = row(vertices[1]);
+			if (r1 != r2)
+			{
+				edges_.push_back(e);
+				edges_rows.push_back(r1);
+				edges_rows.push_back(r2);
+			}
+			return true;
+		});
+		const uint32 nb_edges = uint32(edges_.size());
+
+		// rows of each column: the diagonal and the adjacent vertices (sorted, without duplicates)
+		std::vector<int> outer(nb_rows + 1u, 0);
+		for (uint32 r = 0u; r < nb_rows; ++r)
+			outer[r + 1u] = 1;
+		for (uint32 r : edges_rows)
+			++outer[r + 1u];
+		for (uint32 r = 0u; r < nb_rows; ++r)
+			outer[r + 1u] += outer[r];
+		std::vector<int> inner(outer[nb_rows]);
+		std::vector<int> fill(outer.begin(), outer.end() - 1);
+		for (uint32 r = 0u; r < nb_rows; ++r)
+			inner[fill[r]++] = int(r);
+		for (uint32 i = 0u; i < nb_edges; ++i)
+		{
+			const uint32 r1 = edges_rows[2u * i];
+			const uint32 r2 = edges_rows[2u * i + 1u];
+			inner[fill[r2]++] = int(r1);
+			inner[fill[r1]++] = int(r2);
+		}
+		int nnz = 0;
+		for (uint32 c = 0u; c < nb_rows; ++c)
+		{
+			auto first = inner.begin() + outer[c];
+			auto last = inner.begin() + outer[c + 1u];
+			std::sort(first, last);
+			last = std::unique(first, last);
+			const int size = int(last - first);
+			std::copy(first, last, inner.begin() + nnz);
+			outer[c] = nnz;
+			nnz += size;
+		}
+		outer[nb_rows] = nnz;
+		inner.resize(nnz);
+
+		pattern_ = SparseMatrix(nb_rows, nb_rows);
+		pattern_.resizeNonZeros(nnz);
+		std::copy(outer.begin(), outer.end(), pattern_.outerIndexPtr());
+		std::copy(inner.begin(), inner.end(), pattern_.innerIndexPtr());
+		std::fill(pattern_.valuePtr(), pattern_.valuePtr() + nnz, Scalar(0));
+
+		// slots of the coefficients (r1,r2) & (r2,r1) of the edges and of the diagonal coefficients
+		auto slot = [&](uint32 r, uint32 c) -> uint32 {
+			return uint32(std::lower_bound(inner.begin() + outer[c], inner.begin() + outer[c + 1u], int(r)) -
+						  inner.begin());
+		};
+		diagonal_slots_.resize(nb_rows);
+		for (uint32 c = 0u; c < nb_rows; ++c)
+			diagonal_slots_[c] = slot(c, c);
+		edges_slots_.resize(2u * nb_edges);
+		std::vector<uint32> slot_use(nnz, 0u);
+		for (uint32 i = 0u; i < nb_edges; ++i)
+		{
+			edges_slots_[2u * i] = slot(edges_rows[2u * i], edges_rows[2u * i + 1u]);
+			edges_slots_[2u * i + 1u] = slot(edges_rows[2u * i + 1u], edges_rows[2u * i]);
+			++slot_use[edges_slots_[2u * i]];
+			++slot_use[edges_slots_[2u * i + 1u]];
+		}
+		// edges that share their coefficients with other edges (multiple edges between 2 vertices) are accumulated
+		// sequentially after the parallel fill
+		edges_shared_.assign(nb_edges, false);
+		shared_edges_.clear();
+		for (uint32 i = 0u; i < nb_edges; ++i)
+		{
+			if (slot_use[edges_slots_[2u * i]] > 1u || slot_use[edges_slots_[2u * i + 1u]] > 1u)
+			{
+				edges_shared_[i] = true;
+				shared_edges_.push_back(i);
+			}
+		}
+	}
+
+	/**
+	 * @brief fill the given matrix: M(i,j) = M(j,i) = w(e) for each edge e = (v_i,v_j), M(i,i) = d(v_i) - sum_j M(i,j)
+	 * (a matrix that does not have the pattern of the assembler is first reset to it)
+	 * @param edge_weight Scalar(Edge), called in parallel
+	 * @param diagonal Scalar(Vertex), called in parallel
+	 */
+	template <typename EDGE_WEIGHT, typename DIAGONAL>
+	void fill(SparseMatrix& M, const EDGE_WEIGHT& edge_weight, const DIAGONAL& diagonal) const
+	{
+		static_assert(is_func_parameter_same<EDGE_WEIGHT, Edge>::value, "Given edge function should take an Edge");
+		static_assert(is_func_parameter_same<DIAGONAL, Vertex>::value, "Given diagonal function should take a Vertex");
+
+		if (!has_pattern(M))
+			M = pattern_;
+		Scalar* values = M.valuePtr();
+		const int* outer = M.outerIndexPtr();
+		const uint32 nb_rows = this->nb_rows();
+		const uint32 nb_edges = uint32(edges_.size());
+
+		parallel_foreach_chunk(nb_chunks(nb_edges), [&](uint32 c) -> bool {
+			for (uint32 i = c * CHUNK_SIZE, end = std::min(nb_edges, i + CHUNK_SIZE); i < end; ++i)
+			{
+				if (edges_shared_[i])
+					continue;
+				const Scalar w = edge_weight(edges_[i]);
+				values[edges_slots_[2u * i]] = w;
+				values[edges_slots_[2u * i + 1u]] = w;
+			}
+			return true;
+		});
+		if (!shared_edges_.empty())
+		{
+			for (uint32 i : shared_edges_)
+			{
+				values[edges_slots_[2u * i]] = 0;
+				values[edges_slots_[2u * i + 1u]] = 0;
+			}
+			for (uint32 i : shared_edges_)
+			{
+				const Scalar w = edge_weight(edges_[i]);
+				values[edges_slots_[2u * i]] += w;
+				values[edges_slots_[2u * i + 1u]] += w;
+			}
+		}
+
+		// the matrix is symmetric: the sum of a row is the sum of the column
+		parallel_foreach_chunk(nb_chunks(nb_rows), [&](uint32 c) -> bool {
+			for (uint32 j = c * CHUNK_SIZE, end = std::min(nb_rows, j + CHUNK_SIZE); j < end; ++j)
+			{
+				const uint32 d = diagonal_slots_[j];
+				Scalar sum = 0;
+				for (int k = outer[j]; k < outer[j + 1u]; ++k)
+					if (uint32(k) != d)
+						sum += values[k];
+				values[d] = diagonal(row_vertices_[j]) - sum;
+			}
+			return true;
+		});
+	}
+
+	template <typename EDGE_WEIGHT>
+	void fill(SparseMatrix& M, const EDGE_WEIGHT& edge_weight) const
+	{
+		fill(M, edge_weight, [](Vertex) -> Scalar { return 0; });
+	}
+
+	/**
+	 * @brief multiply the rows of the given matrix: M(i,:) *= s(v_i)
+	 * @param row_scale Scalar(Vertex), called in parallel
+	 */
+	template <typename ROW_SCALE>
+	void scale_rows(SparseMatrix& M, const ROW_SCALE& row_scale) const
+	{
+		static_assert(is_func_parameter_same<ROW_SCALE, Vertex>::value, "Given function should take a Vertex");
+
+		std::vector<Scalar> scale(nb_rows());
+		foreach_row([&](uint32 r) { scale[r] = row_scale(row_vertices_[r]); });
+		foreach_coefficient(M, [&](int, int r, Scalar& value) { value *= scale[r]; });
+	}
+
+	/**
+	 * @brief replace the rows of the given matrix for which constrained(v_i) is true by the rows of the identity
+	 * (the coefficients are set to 0 and not removed: the pattern is unchanged)
+	 * M can be any compressed matrix whose rows are the rows of the assembler (e.g. a product of filled matrices),
+	 * its diagonal coefficients must be in its pattern
+	 * @param constrained bool(Vertex), called in parallel
+	 */
+	template <typename CONSTRAINED>
+	void set_identity_rows(SparseMatrix& M, const CONSTRAINED& constrained) const
+	{
+		static_assert(is_func_parameter_same<CONSTRAINED, Vertex>::value, "Given function should take a Vertex");
+		cgogn_message_assert(M.isCompressed() && uint32(M.rows()) == nb_rows(), "Matrix does not match the rows");
+
+		std::vector<uint8> identity(nb_rows());
+		foreach_row([&](uint32 r) { identity[r] = constrained(row_vertices_[r]); });
+		foreach_coefficient(M, [&](int c, int r, Scalar& value) {
+			if (identity[r])
+				value = r == c ? 1 : 0;
+		});
+	}
+
+private:
+	static inline uint32 nb_chunks(uint32 n)
+	{
+		return (n + CHUNK_SIZE - 1u) / CHUNK_SIZE;
+	}
+
+	bool has_pattern(const SparseMatrix& M) const
+	{
+		return M.isCompressed() && M.rows() == pattern_.rows() && M.cols() == pattern_.cols() &&
+			   M.nonZeros() == pattern_.nonZeros() &&
+			   std::equal(M.outerIndexPtr(), M.outerIndexPtr() + M.outerSize() + 1, pattern_.outerIndexPtr()) &&
+			   std::equal(M.innerIndexPtr(), M.innerIndexPtr() + M.nonZeros(), pattern_.innerIndexPtr());
+	}
+
+	template <typename FUNC>
+	void foreach_row(const FUNC& f) const
+	{
+		const uint32 nb_rows = this->nb_rows();
+		parallel_foreach_chunk(nb_chunks(nb_rows), [&](uint32 c) -> bool {
+			for (uint32 r = c * CHUNK_SIZE, end = std::min(nb_rows, r + CHUNK_SIZE); r < end; ++r)
+				f(r);
+			return true;
+		});
+	}
+
+	// f(column, row, value) is called in parallel on the coefficients (the columns are distributed over the threads)
+	template <typename FUNC>
+	static void foreach_coefficient(SparseMatrix& M, const FUNC& f)
+	{
+		const uint32 nb_columns = uint32(M.outerSize());
+		const int* outer = M.outerIndexPtr();
+		const int* inner = M.innerIndexPtr();
+		Scalar* values = M.valuePtr();
+		parallel_foreach_chunk(nb_chunks(nb_columns), [&](uint32 c) -> bool {
+			for (uint32 j = c * CHUNK_SIZE, end = std::min(nb_columns, j + CHUNK_SIZE); j < end; ++j)
+				for (int k = outer[j]; k < outer[j + 1u]; ++k)
+					f(int(j), inner[k], values[k]);
+			return true;
+		});
+	}
+
+	const MESH& mesh_;
+	const Attribute<uint32>* vertex_index_;
+
+	std::vector<Vertex> row_vertices_;
+	std::vector<Edge> edges_;
+	std::vector<uint32> edges_slots_; // 2 per edge: slots of (r1,r2) & (r2,r1)
+	std::vector<uint32> diagonal_slots_;
+	std::vector<bool> edges_shared_; // the coefficients of the edge are shared with other edges
+	std::vector<uint32> shared_edges_;
+
+	SparseMatrix pattern_;
+};
+
+} // namespace geometry
+
+} // namespace cgogn
+
+#endif // CGOGN_GEOMETRY_ALGOS_SPARSE_ASSEMBLER_H_
@@ -44,15 +44,12 @@ std::pair<VEC, VEC> bounding_box(const CONTAINER<VEC>& container)
 		bb_min[i] = std::numeric_limits<Scalar>::max();
 		bb_max[i] = std::numeric_limits<Scalar>::lowest();
 	}
-	for (const VEC& v : container)
+	for (uint32 b = 0, nb = container.nb_blocks(); b < nb; ++b)
 	{
-		for (std::size_t i = 0; i < dimension; ++i)
-		{
-			if (v[i] < bb_min[i])
-				bb_min[i] = v[i];
-			if (v[i] > bb_max[i])
-				bb_max[i] = v[i];
-		}
+		container.block(b).foreach_value([&](const VEC& v) {
+			bb_min = bb_min.cwiseMin(v);
+			bb_max = bb_max.cwiseMax(v);
+		});
 	}
 	return {bb_min, bb_max};
 }
@@ -72,10 +69,12 @@ void rescale(CONTAINER<VEC>& container, typename vector_traits<VEC>::Scalar s)
 			max = range[i];
 	}
 	VEC scale = (range / max) * s;
-	for (VEC& v : container)
+	for (uint32 b = 0, nb = container.nb_blocks(); b < nb; ++b)
 	{
-		for (std::size_t i = 0; i < dimension; ++i)
-			v[i] = (v[i] - bb_min[i]) / range[i] * scale[i];
+		container.block(b).foreach_value([&](VEC& v) {
+			for (std::size_t i = 0; i < dimension; ++i)
+				v[i] = (v[i] - bb_min[i]) / range[i] * scale[i];
+		});
 	}
 }
 
@@ -0,0 +1,159 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/types/cell_marker.h>
+#include <cgogn/core/utils/thread_pool.h>
+#include <cgogn/geometry/algos/sparse_assembler.h>
+
+#include <gtest/gtest.h>
+
+#include <Eigen/SparseCholesky>
+
+#include <vector>
+
+namespace cgogn
+{
+
+using geometry::Scalar;
+using SparseMatrix = geometry::SparseAssembler<CMap2>::SparseMatrix;
+
+class SparseAssemblerTest : public ::testing::Test
+{
+protected:
+	static const uint32 NB_WORKERS = 4u;
+
+	SparseAssemblerTest() : pool_(NB_WORKERS), scope_(&pool_)
+	{
+		// more edges & vertices than a chunk of the assembler (and multiple edges between the vertices of 2-gons)
+		for (uint32 i = 0u; i < 2000u; ++i)
+			add_prism(map_, 3u + i % 5u);
+		for (uint32 i = 0u; i < 10u; ++i)
+			add_face(map_, 2u);
+		vertex_index_ = add_attribute<uint32, CMap2::Vertex>(map_, "index");
+		uint32 nb_vertices = 0u;
+		foreach_cell(map_, [&](CMap2::Vertex v) -> bool {
+			value<uint32>(map_, vertex_index_, v) = nb_vertices++;
+			return true;
+		});
+	}
+
+	Scalar edge_weight(CMap2::Edge e, Scalar factor) const
+	{
+		auto vertices = incident_vertices(map_, e);
+		const uint32 r1 = value<uint32>(map_, vertex_index_, vertices[0]);
+		const uint32 r2 = value<uint32>(map_, vertex_index_, vertices[1]);
+		return -factor * Scalar(1u + (r1 + r2) % 7u);
+	}
+
+	// same matrix built from triplets
+	SparseMatrix reference(Scalar factor) const
+	{
+		uint32 nb_vertices = 0u;
+		std::vector<Eigen::Triplet<Scalar>> triplets;
+		std::vector<Scalar> row_sums;
+		foreach_cell(map_, [&](CMap2::Vertex) -> bool {
+			++nb_vertices;
+			return true;
+		});
+		row_sums.resize(nb_vertices, 0);
+		foreach_cell(map_, [&](CMap2::Edge e) -> bool {
+			auto vertices = incident_vertices(map_, e);
+			const uint32 r1 = value<uint32>(map_, vertex_index_, vertices[0]);
+			const uint32 r2 = value<uint32>(map_, vertex_index_, vertices[1]);
+			const Scalar w = edge_weight(e, factor);
+			triplets.emplace_back(r1, r2, w);
+			triplets.emplace_back(r2, r1, w);
+			row_sums[r1] += w;
+			row_sums[r2] += w;
+			return true;
+		});
+		for (uint32 r = 0u; r < nb_vertices; ++r)
+			triplets.emplace_back(r, r, 1 - row_sums[r]);
+		SparseMatrix M(nb_vertices, nb_vertices);
+		M.setFromTriplets(triplets.begin(), triplets.end());
+		return M;
+	}
+
+	void fill(const geometry::SparseAssembler<CMap2>& assembler, SparseMatrix& M, Scalar factor) const
+	{
+		assembler.fill(
+			M, [&](CMap2::Edge e) -> Scalar { return edge_weight(e, factor); },
+			[](CMap2::Vertex) -> Scalar { return 1; });
+	}
+
+	CMap2 map_;
+	std::shared_ptr<CMap2::Attribute<uint32>> vertex_index_;
+	ThreadPool pool_;
+	ThreadPoolScope scope_;
+};
+
+TEST_F(SparseAssemblerTest, Fill)
+{
+	geometry::SparseAssembler<CMap2> assembler(map_, vertex_index_.get());
+	SparseMatrix M;
+	fill(assembler, M, 1);
+	EXPECT_EQ(M.nonZeros(), assembler.pattern().nonZeros());
+	EXPECT_LT((M - reference(1)).norm(), 1e-12);
+}
+
+// a refill writes the values in place: the structure of the matrix (and the symbolic analysis of a solver) is kept
+TEST_F(SparseAssemblerTest, Refill)
+{
+	geometry::SparseAssembler<CMap2> assembler(map_, vertex_index_.get());
+	SparseMatrix M;
+	fill(assembler, M, 1);
+	const Scalar* values = M.valuePtr();
+	const int* inner = M.innerIndexPtr();
+
+	Eigen::SimplicialLDLT<SparseMatrix> solver;
+	solver.analyzePattern(M);
+	const Eigen::VectorXd b = Eigen::VectorXd::LinSpaced(assembler.nb_rows(), 0.0, 1.0);
+	for (Scalar factor : {2.0, 0.5, 3.0})
+	{
+		fill(assembler, M, factor);
+		EXPECT_EQ(M.valuePtr(), values);
+		EXPECT_EQ(M.innerIndexPtr(), inner);
+		EXPECT_LT((M - reference(factor)).norm(), 1e-12);
+
+		solver.factorize(M);
+		ASSERT_EQ(solver.info(), Eigen::Success);
+		const Eigen::VectorXd x = solver.solve(b);
+		EXPECT_LT((M * x - b).norm(), 1e-8);
+	}
+}
+
+// a matrix that does not have the pattern of the assembler is reset to it
+TEST_F(SparseAssemblerTest, FillOtherMatrix)
+{
+	geometry::SparseAssembler<CMap2> assembler(map_, vertex_index_.get());
+	SparseMatrix M(3, 3);
+	M.insert(0, 1) = 1;
+	fill(assembler, M, 2);
+	EXPECT_LT((M - reference(2)).norm(), 1e-12);
+}
+
+} // namespace cgogn
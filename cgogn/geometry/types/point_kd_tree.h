@@ -0,0 +1,231 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_GEOMETRY_TYPES_POINT_KD_TREE_H_
+#define CGOGN_GEOMETRY_TYPES_POINT_KD_TREE_H_
+
+#include <cgogn/core/utils/numerics.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <cgogn/geometry/types/vector_traits.h>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace cgogn
+{
+
+namespace geometry
+{
+
+///////////////////////
+// PointKDTree class //
+///////////////////////
+
+/**
+ * Static kd-tree over a set of points, for nearest neighbor queries.
+ * The tree is implicit: the points are stored in a flat array in the tree order (that is also a spatially coherent
+ * order of the points), the median of the range [b, e) of a node is at (b + e) / 2 and splits its range along the
+ * axis of largest extent. The tight bounds of the inner nodes are stored at the position of their median, so that the
+ * empty space around the points is pruned (balls that touch many points, as in medial axis computations, are then
+ * quickly validated). The queries are read only and allocation free, so that they can be issued concurrently.
+ */
+class PointKDTree
+{
+public:
+	PointKDTree()
+	{
+	}
+
+	PointKDTree(const std::vector<Vec3>& points)
+	{
+		build(points);
+	}
+
+	inline uint32 size() const
+	{
+		return uint32(points_.size());
+	}
+
+	// the points in the tree order and their index in the given points
+	inline const std::vector<Vec3>& points() const
+	{
+		return points_;
+	}
+
+	inline const std::vector<uint32>& indices() const
+	{
+		return indices_;
+	}
+
+	void build(const std::vector<Vec3>& points)
+	{
+		const uint32 nb_points = uint32(points.size());
+		indices_.resize(nb_points);
+		std::iota(indices_.begin(), indices_.end(), 0u);
+		axes_.assign(nb_points, 0u);
+		bounds_.resize(nb_points);
+
+		// nodes are split until their range fits in a leaf
+		std::vector<std::array<uint32, 2>> stack;
+		if (nb_points > MAX_LEAF_SIZE)
+			stack.push_back({0u, nb_points});
+		while (!stack.empty())
+		{
+			const auto [b, e] = stack.back();
+			stack.pop_back();
+
+			Vec3 bb_min = points[indices_[b]], bb_max = points[indices_[b]];
+			for (uint32 i = b + 1u; i < e; ++i)
+			{
+				bb_min = bb_min.cwiseMin(points[indices_[i]]);
+				bb_max = bb_max.cwiseMax(points[indices_[i]]);
+			}
+			uint32 axis;
+			(bb_max - bb_min).maxCoeff(&axis);
+
+			const uint32 m = (b + e) / 2u;
+			std::nth_element(indices_.begin() + b, indices_.begin() + m, indices_.begin() + e,
+							 [&](uint32 i, uint32 j) { return points[i][axis] < points[j][axis]; });
+			axes_[m] = uint8(axis);
+			bounds_[m] = {bb_min, bb_max};
+
+			if (m - b > MAX_LEAF_SIZE)
+				stack.push_back({b, m});
+			if (e - m - 1u > MAX_LEAF_SIZE)
+				stack.push_back({m + 1u, e});
+		}
+
+		points_.resize(nb_points);
+		for (uint32 i = 0u; i < nb_points; ++i)
+			points_[i] = points[indices_[i]];
+	}
+
+	/**
+	 * @brief find the nearest point to the given point
+	 * @param max_distance only the points closer than this distance are searched for
+	 * @return the position of the found point in the tree order (INVALID_INDEX if none was found)
+	 */
+	uint32 nearest(const Vec3& p, Scalar& distance, Scalar max_distance = std::numeric_limits<Scalar>::max()) const
+	{
+		uint32 nearest = INVALID_INDEX;
+		Scalar best = max_distance < std::numeric_limits<Scalar>::max() ? max_distance * max_distance : max_distance;
+
+		// ranges to visit with a lower bound of their squared distance to p
+		std::array<Range, MAX_DEPTH> stack;
+		uint32 stack_size = 0u;
+		stack[stack_size++] = {0u, size(), Scalar(0)};
+		while (stack_size > 0u)
+		{
+			const Range r = stack[--stack_size];
+			if (r.distance_ >= best)
+				continue;
+			if (r.end_ - r.begin_ <= MAX_LEAF_SIZE)
+			{
+				for (uint32 i = r.begin_; i < r.end_; ++i)
+					test_point(p, i, nearest, best);
+				continue;
+			}
+
+			const uint32 m = (r.begin_ + r.end_) / 2u;
+			test_point(p, m, nearest, best);
+			const Scalar diff = p[axes_[m]] - points_[m][axes_[m]];
+			Range low{r.begin_, m, diff < 0 ? r.distance_ : std::max(r.distance_, diff * diff)};
+			Range high{m + 1u, r.end_, diff < 0 ? std::max(r.distance_, diff * diff) : r.distance_};
+			for (Range* c : {&low, &high})
+			{
+				if (c->end_ - c->begin_ > MAX_LEAF_SIZE)
+					c->distance_ = squared_distance(p, bounds_[(c->begin_ + c->end_) / 2u]);
+			}
+			// the nearest range is pushed last
+			if (low.distance_ < high.distance_)
+				std::swap(low, high);
+			if (low.distance_ < best)
+				stack[stack_size++] = low;
+			if (high.distance_ < best)
+				stack[stack_size++] = high;
+		}
+
+		if (nearest != INVALID_INDEX)
+			distance = std::sqrt(best);
+		return nearest;
+	}
+
+	/**
+	 * @brief find in parallel the nearest points to the given points (INVALID_INDEX if none was found)
+	 */
+	void nearest(const std::vector<Vec3>& queries, std::vector<uint32>& nearest_points,
+				 std::vector<Scalar>& distances, Scalar max_distance = std::numeric_limits<Scalar>::max()) const
+	{
+		const uint32 nb_queries = uint32(queries.size());
+		nearest_points.resize(nb_queries);
+		distances.resize(nb_queries);
+		parallel_foreach_chunk((nb_queries + QUERIES_CHUNK_SIZE - 1u) / QUERIES_CHUNK_SIZE, [&](uint32 c) -> bool {
+			for (uint32 i = c * QUERIES_CHUNK_SIZE, end = std::min(nb_queries, i + QUERIES_CHUNK_SIZE); i < end; ++i)
+				nearest_points[i] = nearest(queries[i], distances[i], max_distance);
+			return true;
+		});
+	}
+
+private:
+	static const uint32 MAX_LEAF_SIZE = 8u;
+	static const uint32 MAX_DEPTH = 128u;
+	static const uint32 QUERIES_CHUNK_SIZE = 256u;
+
+	struct Range
+	{
+		uint32 begin_;
+		uint32 end_;
+		Scalar distance_;
+	};
+
+	static inline Scalar squared_distance(const Vec3& p, const std::array<Vec3, 2>& bounds)
+	{
+		return (bounds[0] - p).cwiseMax(p - bounds[1]).cwiseMax(Scalar(0)).squaredNorm();
+	}
+
+	inline void test_point(const Vec3& p, uint32 i, uint32& nearest, Scalar& best) const
+	{
+		const Scalar d2 = (points_[i] - p).squaredNorm();
+		if (d2 < best)
+		{
+			best = d2;
+			nearest = i;
+		}
+	}
+
+	std::vector<Vec3> points_;
+	std::vector<uint32> indices_;
+	// split axis and bounds of the inner nodes (stored at the position of their median)
+	std::vector<uint8> axes_;
+	std::vector<std::array<Vec3, 2>> bounds_;
+};
+
+} // namespace geometry
+
+} // namespace cgogn
+
+#endif // CGOGN_GEOMETRY_TYPES_POINT_KD_TREE_H_
@@ -0,0 +1,749 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_GEOMETRY_TYPES_SURFACE_BVH_H_
+#define CGOGN_GEOMETRY_TYPES_SURFACE_BVH_H_
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <cgogn/geometry/functions/distance.h>
+#include <cgogn/geometry/types/vector_traits.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace cgogn
+{
+
+namespace geometry
+{
+
+//////////////////////
+// SurfaceBVH class //
+//////////////////////
+
+/**
+ * Bounding volume hierarchy over the faces of a surface mesh (the polygonal faces are fan triangulated).
+ * The hierarchy references the vertex position attribute (no copy of the positions): after a motion of the vertices,
+ * refit updates the bounds in O(n), after a change of the connectivity, rebuild recomputes the hierarchy.
+ * The nodes are stored depth first in a flat array of 64 bytes nodes that hold the float bounds of their 2 children
+ * in a structure of arrays layout, so that both children are tested at once (vectorized loops) with one cache line.
+ */
+template <typename MESH>
+class SurfaceBVH
+{
+	template <typename T>
+	using Attribute = typename mesh_traits<MESH>::template Attribute<T>;
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using Face = typename mesh_traits<MESH>::Face;
+
+public:
+	struct Ray
+	{
+		Vec3 origin_;
+		Vec3 direction_;
+		Scalar tmin_ = 0;
+		Scalar tmax_ = std::numeric_limits<Scalar>::max();
+	};
+
+	struct Hit
+	{
+		bool valid_ = false;
+		Face face_;
+		Vec3 position_;
+		// barycentric coordinates of position_ in the triangle of face_ (for triangle faces, the coordinates are given
+		// in the order of the incident vertices of the face)
+		Vec3 bcoords_;
+		// distance to the query point or ray parameter of the intersection
+		Scalar distance_;
+	};
+
+	SurfaceBVH(const MESH& m, const std::shared_ptr<Attribute<Vec3>>& vertex_position)
+		: mesh_(m), vertex_position_(vertex_position), all_faces_(true)
+	{
+		rebuild();
+	}
+
+	SurfaceBVH(const MESH& m, const std::shared_ptr<Attribute<Vec3>>& vertex_position, const std::vector<Face>& faces)
+		: mesh_(m), vertex_position_(vertex_position), faces_(faces), all_faces_(false)
+	{
+		rebuild();
+	}
+
+	// the given position attribute is not owned by the BVH and must outlive it
+	SurfaceBVH(const MESH& m, const Attribute<Vec3>* vertex_position)
+		: mesh_(m), vertex_position_(std::shared_ptr<const Attribute<Vec3>>(), vertex_position), all_faces_(true)
+	{
+		rebuild();
+	}
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(SurfaceBVH);
+
+	inline const MESH& mesh() const
+	{
+		return mesh_;
+	}
+
+	inline const Attribute<Vec3>* vertex_position() const
+	{
+		return vertex_position_.get();
+	}
+
+	inline const std::vector<Face>& faces() const
+	{
+		return faces_;
+	}
+
+	inline uint32 nb_triangles() const
+	{
+		return uint32(triangles_.size());
+	}
+
+	inline uint32 nb_nodes() const
+	{
+		return uint32(nodes_.size());
+	}
+
+	/**
+	 * @brief recompute the hierarchy (after a change of the connectivity of the mesh or of the face set)
+	 */
+	void rebuild()
+	{
+		if (all_faces_)
+		{
+			faces_.clear();
+			faces_.reserve(nb_cells<Face>(mesh_));
+			foreach_cell(mesh_, [&](Face f) -> bool {
+				faces_.push_back(f);
+				return true;
+			});
+		}
+
+		triangles_.clear();
+		triangles_face_.clear();
+		std::vector<uint32> face_vertices;
+		for (uint32 i = 0u, n = uint32(faces_.size()); i < n; ++i)
+		{
+			face_vertices.clear();
+			foreach_incident_vertex(mesh_, faces_[i], [&](Vertex v) -> bool {
+				face_vertices.push_back(index_of(mesh_, v));
+				return true;
+			});
+			for (uint32 j = 1u; j + 1u < uint32(face_vertices.size()); ++j)
+			{
+				triangles_.push_back({face_vertices[0], face_vertices[j], face_vertices[j + 1u]});
+				triangles_face_.push_back(i);
+			}
+		}
+
+		build();
+	}
+
+	/**
+	 * @brief update the bounds of the hierarchy after a motion of the vertices (the hierarchy is unchanged)
+	 */
+	void refit()
+	{
+		const uint32 nb_nodes = uint32(nodes_.size());
+
+		// bounds of the leaves (independent)
+		parallel_foreach_chunk((nb_nodes + NODES_CHUNK_SIZE - 1u) / NODES_CHUNK_SIZE, [&](uint32 c) -> bool {
+			for (uint32 i = c * NODES_CHUNK_SIZE, end = std::min(nb_nodes, i + NODES_CHUNK_SIZE); i < end; ++i)
+			{
+				Node& node = nodes_[i];
+				for (uint32 k = 0u; k < 2u; ++k)
+				{
+					if (node.nb_triangles_[k] > 0u)
+						node.set_bounds(k, triangles_bounds(node.child_[k], node.child_[k] + node.nb_triangles_[k]));
+				}
+			}
+			return true;
+		});
+
+		// bounds of the inner nodes (the children of a node are stored after it)
+		for (uint32 i = nb_nodes; i-- > 0u;)
+		{
+			Node& node = nodes_[i];
+			for (uint32 k = 0u; k < 2u; ++k)
+			{
+				if (node.nb_triangles_[k] == 0u && node.child_[k] != INVALID_INDEX)
+					node.set_bounds(k, nodes_[node.child_[k]]);
+			}
+		}
+	}
+
+	/**
+	 * @brief find the closest point of the surface to the given point
+	 * @param max_distance only the points closer than this distance are searched for
+	 */
+	Hit closest_point(const Vec3& p, Scalar max_distance = std::numeric_limits<Scalar>::max()) const
+	{
+		Hit hit;
+		Scalar best = max_distance < std::numeric_limits<Scalar>::max() ? max_distance * max_distance : max_distance;
+
+		std::array<std::pair<uint32, Scalar>, MAX_DEPTH> stack;
+		uint32 stack_size = 0u;
+		stack[stack_size++] = {0u, Scalar(0)};
+		while (stack_size > 0u)
+		{
+			auto [node_index, node_distance] = stack[--stack_size];
+			if (node_distance > best)
+				continue;
+			const std::array<Scalar, 2> d2 = nodes_[node_index].squared_distances(p);
+			const Node& node = nodes_[node_index];
+
+			// the farthest child is pushed first
+			const uint32 first = d2[1] < d2[0] ? 1u : 0u;
+			for (uint32 j = 0u; j < 2u; ++j)
+			{
+				const uint32 k = j == 0u ? 1u - first : first;
+				if (node.child_[k] == INVALID_INDEX || d2[k] > best)
+					continue;
+				if (node.nb_triangles_[k] > 0u)
+				{
+					for (uint32 t = node.child_[k], end = t + node.nb_triangles_[k]; t < end; ++t)
+						closest_point_in_triangle(p, t, hit, best);
+				}
+				else
+					stack[stack_size++] = {node.child_[k], d2[k]};
+			}
+		}
+
+		if (hit.valid_)
+			hit.distance_ = std::sqrt(best);
+		return hit;
+	}
+
+	/**
+	 * @brief find the first intersection of the given ray with the surface (in [tmin_, tmax_])
+	 */
+	Hit intersect(const Ray& r) const
+	{
+		Hit hit;
+		Scalar tmax = r.tmax_;
+
+		const Vec3 inv_direction = inverse_direction(r);
+
+		std::array<uint32, MAX_DEPTH> stack;
+		uint32 stack_size = 0u;
+		stack[stack_size++] = 0u;
+		while (stack_size > 0u)
+		{
+			const Node& node = nodes_[stack[--stack_size]];
+			const std::array<Scalar, 2> tnear = node.entry_distances(r, inv_direction, tmax);
+
+			// the nearest child is pushed last
+			const uint32 first = tnear[1] < tnear[0] ? 1u : 0u;
+			for (uint32 j = 0u; j < 2u; ++j)
+			{
+				const uint32 k = j == 0u ? 1u - first : first;
+				if (node.child_[k] == INVALID_INDEX || tnear[k] == std::numeric_limits<Scalar>::infinity())
+					continue;
+				if (node.nb_triangles_[k] > 0u)
+				{
+					for (uint32 t = node.child_[k], end = t + node.nb_triangles_[k]; t < end; ++t)
+						intersect_triangle(r, t, hit, tmax);
+				}
+				else
+					stack[stack_size++] = node.child_[k];
+			}
+		}
+
+		if (hit.valid_)
+			hit.distance_ = tmax;
+		return hit;
+	}
+
+	/**
+	 * @brief find all the intersections of the given ray with the surface (in [tmin_, tmax_]): one hit per face (its
+	 * closest intersection), sorted by increasing distance
+	 */
+	void intersect_all(const Ray& r, std::vector<Hit>& hits) const
+	{
+		hits.clear();
+		std::vector<std::pair<uint32, Hit>> face_hits;
+
+		const Vec3 inv_direction = inverse_direction(r);
+
+		std::array<uint32, MAX_DEPTH> stack;
+		uint32 stack_size = 0u;
+		stack[stack_size++] = 0u;
+		while (stack_size > 0u)
+		{
+			const Node& node = nodes_[stack[--stack_size]];
+			const std::array<Scalar, 2> tnear = node.entry_distances(r, inv_direction, r.tmax_);
+			for (uint32 k = 0u; k < 2u; ++k)
+			{
+				if (node.child_[k] == INVALID_INDEX || tnear[k] == std::numeric_limits<Scalar>::infinity())
+					continue;
+				if (node.nb_triangles_[k] > 0u)
+				{
+					for (uint32 t = node.child_[k], end = t + node.nb_triangles_[k]; t < end; ++t)
+					{
+						Hit hit;
+						Scalar tmax = r.tmax_;
+						intersect_triangle(r, t, hit, tmax);
+						if (hit.valid_)
+						{
+							hit.distance_ = tmax;
+							face_hits.emplace_back(triangles_face_[t], hit);
+						}
+					}
+				}
+				else
+					stack[stack_size++] = node.child_[k];
+			}
+		}
+
+		// keep the closest hit of each face (the triangles of a polygonal face or a hit on a shared triangle edge)
+		std::sort(face_hits.begin(), face_hits.end(), [](const auto& h1, const auto& h2) {
+			return h1.first < h2.first || (h1.first == h2.first && h1.second.distance_ < h2.second.distance_);
+		});
+		face_hits.erase(std::unique(face_hits.begin(), face_hits.end(),
+									[](const auto& h1, const auto& h2) { return h1.first == h2.first; }),
+						face_hits.end());
+		hits.reserve(face_hits.size());
+		for (const auto& fh : face_hits)
+			hits.push_back(fh.second);
+		std::sort(hits.begin(), hits.end(), [](const Hit& h1, const Hit& h2) { return h1.distance_ < h2.distance_; });
+	}
+
+	/**
+	 * @brief get the faces that intersect the given sphere (sorted by index in faces())
+	 */
+	void faces_in_sphere(const Vec3& center, Scalar radius, std::vector<Face>& faces) const
+	{
+		faces.clear();
+		std::vector<uint32> face_indices;
+		const Scalar r2 = radius * radius;
+
+		std::array<uint32, MAX_DEPTH> stack;
+		uint32 stack_size = 0u;
+		stack[stack_size++] = 0u;
+		while (stack_size > 0u)
+		{
+			const Node& node = nodes_[stack[--stack_size]];
+			const std::array<Scalar, 2> d2 = node.squared_distances(center);
+
+			for (uint32 k = 0u; k < 2u; ++k)
+			{
+				if (node.child_[k] == INVALID_INDEX || d2[k] > r2)
+					continue;
+				if (node.nb_triangles_[k] > 0u)
+				{
+					for (uint32 t = node.child_[k], end = t + node.nb_triangles_[k]; t < end; ++t)
+					{
+						const std::array<uint32, 3>& tri = triangles_[t];
+						if (squared_distance_point_triangle(center, (*vertex_position_)[tri[0]],
+															(*vertex_position_)[tri[1]],
+															(*vertex_position_)[tri[2]]) <= r2)
+							face_indices.push_back(triangles_face_[t]);
+					}
+				}
+				else
+					stack[stack_size++] = node.child_[k];
+			}
+		}
+
+		std::sort(face_indices.begin(), face_indices.end());
+		face_indices.erase(std::unique(face_indices.begin(), face_indices.end()), face_indices.end());
+		faces.reserve(face_indices.size());
+		for (uint32 i : face_indices)
+			faces.push_back(faces_[i]);
+	}
+
+	/**
+	 * @brief find in parallel the closest points of the surface to the given points
+	 */
+	void closest_points(const std::vector<Vec3>& points, std::vector<Hit>& hits,
+						Scalar max_distance = std::numeric_limits<Scalar>::max()) const
+	{
+		hits.resize(points.size());
+		foreach_query(uint32(points.size()), [&](uint32 i) { hits[i] = closest_point(points[i], max_distance); });
+	}
+
+	/**
+	 * @brief find in parallel the first intersections of the given rays with the surface
+	 */
+	void intersect(const std::vector<Ray>& rays, std::vector<Hit>& hits) const
+	{
+		hits.resize(rays.size());
+		foreach_query(uint32(rays.size()), [&](uint32 i) { hits[i] = intersect(rays[i]); });
+	}
+
+	/**
+	 * @brief get in parallel the faces that intersect the given spheres
+	 */
+	void faces_in_spheres(const std::vector<Vec3>& centers, const std::vector<Scalar>& radii,
+						  std::vector<std::vector<Face>>& faces) const
+	{
+		faces.resize(centers.size());
+		foreach_query(uint32(centers.size()), [&](uint32 i) { faces_in_sphere(centers[i], radii[i], faces[i]); });
+	}
+
+private:
+	static const uint32 MAX_LEAF_SIZE = 4u;
+	static const uint32 NB_BINS = 16u;
+	static const uint32 MAX_DEPTH = 128u;
+	static const uint32 NODES_CHUNK_SIZE = 1024u;
+	static const uint32 QUERIES_CHUNK_SIZE = 256u;
+
+	struct Bounds
+	{
+		Vec3 min_ = Vec3::Constant(std::numeric_limits<Scalar>::max());
+		Vec3 max_ = Vec3::Constant(std::numeric_limits<Scalar>::lowest());
+
+		inline void extend(const Vec3& p)
+		{
+			min_ = min_.cwiseMin(p);
+			max_ = max_.cwiseMax(p);
+		}
+		inline void extend(const Bounds& b)
+		{
+			min_ = min_.cwiseMin(b.min_);
+			max_ = max_.cwiseMax(b.max_);
+		}
+		inline Scalar half_area() const
+		{
+			const Vec3 d = max_ - min_;
+			return d[0] < 0 ? 0 : d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+		}
+	};
+
+	struct alignas(64) Node
+	{
+		// float bounds of the 2 children (rounded outward)
+		std::array<std::array<float32, 2>, 3> min_;
+		std::array<std::array<float32, 2>, 3> max_;
+		// index of the child node or of the first triangle of the child leaf (INVALID_INDEX for no child)
+		std::array<uint32, 2> child_;
+		// number of triangles of the child leaf (0 for a child node)
+		std::array<uint32, 2> nb_triangles_;
+
+		inline void set_bounds(uint32 k, const Bounds& b)
+		{
+			for (uint32 a = 0u; a < 3u; ++a)
+			{
+				min_[a][k] = std::nextafter(float32(b.min_[a]), std::numeric_limits<float32>::lowest());
+				max_[a][k] = std::nextafter(float32(b.max_[a]), std::numeric_limits<float32>::max());
+			}
+		}
+		// bounds of the given child node (union of the bounds of its children)
+		inline void set_bounds(uint32 k, const Node& child)
+		{
+			for (uint32 a = 0u; a < 3u; ++a)
+			{
+				min_[a][k] = std::min(child.min_[a][0], child.min_[a][1]);
+				max_[a][k] = std::max(child.max_[a][0], child.max_[a][1]);
+			}
+		}
+		// squared distances from the given point to the bounds of the children (the float bounds are exactly
+		// converted: the distances are lower bounds of the distances to the triangles)
+		inline std::array<Scalar, 2> squared_distances(const Vec3& p) const
+		{
+			std::array<Scalar, 2> d2 = {0, 0};
+			for (uint32 a = 0u; a < 3u; ++a)
+			{
+				for (uint32 k = 0u; k < 2u; ++k)
+				{
+					const Scalar d = std::max(std::max(min_[a][k] - p[a], p[a] - max_[a][k]), Scalar(0));
+					d2[k] += d * d;
+				}
+			}
+			return d2;
+		}
+		// distances along the given ray at which it enters the bounds of the children (infinity if it does not cross
+		// them in [r.tmin_, tmax])
+		inline std::array<Scalar, 2> entry_distances(const Ray& r, const Vec3& inv_direction, Scalar tmax) const
+		{
+			std::array<Scalar, 2> tnear = {r.tmin_, r.tmin_};
+			std::array<Scalar, 2> tfar = {tmax, tmax};
+			for (uint32 a = 0u; a < 3u; ++a)
+			{
+				for (uint32 k = 0u; k < 2u; ++k)
+				{
+					const Scalar t0 = (min_[a][k] - r.origin_[a]) * inv_direction[a];
+					const Scalar t1 = (max_[a][k] - r.origin_[a]) * inv_direction[a];
+					tnear[k] = std::max(tnear[k], std::min(t0, t1));
+					tfar[k] = std::min(tfar[k], std::max(t0, t1));
+				}
+			}
+			for (uint32 k = 0u; k < 2u; ++k)
+				if (tnear[k] > tfar[k])
+					tnear[k] = std::numeric_limits<Scalar>::infinity();
+			return tnear;
+		}
+	};
+
+	static Vec3 inverse_direction(const Ray& r)
+	{
+		Vec3 inv_direction;
+		for (uint32 a = 0u; a < 3u; ++a)
+		{
+			// a null component gives an infinite slab instead of NaN values
+			const Scalar d = r.direction_[a];
+			inv_direction[a] = d != 0 ? Scalar(1) / d : std::copysign(std::numeric_limits<Scalar>::max(), d);
+		}
+		return inv_direction;
+	}
+
+	Bounds triangles_bounds(uint32 first, uint32 last) const
+	{
+		Bounds b;
+		for (uint32 t = first; t < last; ++t)
+		{
+			for (uint32 v : triangles_[t])
+				b.extend((*vertex_position_)[v]);
+		}
+		return b;
+	}
+
+	void build()
+	{
+		const uint32 nb_triangles = uint32(triangles_.size());
+
+		// bounds and centroids of the triangles
+		std::vector<Bounds> bounds(nb_triangles);
+		std::vector<Vec3> centroids(nb_triangles);
+		parallel_foreach_chunk((nb_triangles + NODES_CHUNK_SIZE - 1u) / NODES_CHUNK_SIZE, [&](uint32 c) -> bool {
+			for (uint32 t = c * NODES_CHUNK_SIZE, end = std::min(nb_triangles, t + NODES_CHUNK_SIZE); t < end; ++t)
+			{
+				bounds[t] = triangles_bounds(t, t + 1u);
+				centroids[t] = (bounds[t].min_ + bounds[t].max_) / Scalar(2);
+			}
+			return true;
+		});
+
+		std::vector<uint32> order(nb_triangles);
+		for (uint32 t = 0u; t < nb_triangles; ++t)
+			order[t] = t;
+
+		nodes_.clear();
+		nodes_.reserve(nb_triangles / 2u + 1u);
+		nodes_.emplace_back();
+		if (nb_triangles <= MAX_LEAF_SIZE)
+		{
+			set_child(0u, 0u, order, 0u, nb_triangles, bounds, centroids, 1u);
+			set_child(0u, 1u, order, 0u, 0u, bounds, centroids, 1u);
+		}
+		else
+			build_node(0u, order, 0u, nb_triangles, bounds, centroids, 1u);
+
+		// the triangles are stored in the order of the leaves
+		std::vector<std::array<uint32, 3>> triangles(nb_triangles);
+		std::vector<uint32> triangles_face(nb_triangles);
+		for (uint32 t = 0u; t < nb_triangles; ++t)
+		{
+			triangles[t] = triangles_[order[t]];
+			triangles_face[t] = triangles_face_[order[t]];
+		}
+		triangles_.swap(triangles);
+		triangles_face_.swap(triangles_face);
+	}
+
+	// split the [first, last) range of triangles between the 2 children of the given node
+	void build_node(uint32 node, std::vector<uint32>& order, uint32 first, uint32 last,
+					const std::vector<Bounds>& bounds, const std::vector<Vec3>& centroids, uint32 depth)
+	{
+		Bounds centroid_bounds;
+		for (uint32 i = first; i < last; ++i)
+			centroid_bounds.extend(centroids[order[i]]);
+		const Vec3 extent = centroid_bounds.max_ - centroid_bounds.min_;
+		uint32 axis = 0u;
+		if (extent[1] > extent[axis])
+			axis = 1u;
+		if (extent[2] > extent[axis])
+			axis = 2u;
+
+		uint32 middle = first + (last - first) / 2u;
+		if (extent[axis] > 0 && depth < MAX_DEPTH - 32u)
+		{
+			// binned surface area heuristic
+			const Scalar scale = Scalar(NB_BINS) / extent[axis];
+			auto bin_of = [&](uint32 t) -> uint32 {
+				return std::min(NB_BINS - 1u, uint32((centroids[t][axis] - centroid_bounds.min_[axis]) * scale));
+			};
+			std::array<Bounds, NB_BINS> bins_bounds;
+			std::array<uint32, NB_BINS> bins_count{};
+			for (uint32 i = first; i < last; ++i)
+			{
+				const uint32 b = bin_of(order[i]);
+				bins_bounds[b].extend(bounds[order[i]]);
+				++bins_count[b];
+			}
+			std::array<Scalar, NB_BINS> right_cost;
+			Bounds right;
+			uint32 right_count = 0u;
+			for (uint32 b = NB_BINS - 1u; b > 0u; --b)
+			{
+				right.extend(bins_bounds[b]);
+				right_count += bins_count[b];
+				right_cost[b] = right.half_area() * right_count;
+			}
+			Bounds left;
+			uint32 left_count = 0u, best_split = 0u;
+			Scalar best_cost = std::numeric_limits<Scalar>::max();
+			for (uint32 b = 1u; b < NB_BINS; ++b)
+			{
+				left.extend(bins_bounds[b - 1u]);
+				left_count += bins_count[b - 1u];
+				const Scalar cost = left.half_area() * left_count + right_cost[b];
+				if (left_count > 0u && left_count < last - first && cost < best_cost)
+				{
+					best_cost = cost;
+					best_split = b;
+				}
+			}
+			if (best_split > 0u)
+				middle = uint32(std::partition(order.begin() + first, order.begin() + last,
+											   [&](uint32 t) { return bin_of(t) < best_split; }) -
+								order.begin());
+			else
+				std::nth_element(order.begin() + first, order.begin() + middle, order.begin() + last,
+								 [&](uint32 t1, uint32 t2) { return centroids[t1][axis] < centroids[t2][axis]; });
+		}
+
+		set_child(node, 0u, order, first, middle, bounds, centroids, depth);
+		set_child(node, 1u, order, middle, last, bounds, centroids, depth);
+	}
+
+	void set_child(uint32 node, uint32 k, std::vector<uint32>& order, uint32 first, uint32 last,
+				   const std::vector<Bounds>& bounds, const std::vector<Vec3>& centroids, uint32 depth)
+	{
+		if (first == last)
+		{
+			nodes_[node].child_[k] = INVALID_INDEX;
+			nodes_[node].nb_triangles_[k] = 0u;
+			for (uint32 a = 0u; a < 3u; ++a)
+			{
+				nodes_[node].min_[a][k] = std::numeric_limits<float32>::max();
+				nodes_[node].max_[a][k] = std::numeric_limits<float32>::lowest();
+			}
+			return;
+		}
+
+		Bounds b;
+		for (uint32 i = first; i < last; ++i)
+			b.extend(bounds[order[i]]);
+
+		if (last - first <= MAX_LEAF_SIZE)
+		{
+			nodes_[node].child_[k] = first;
+			nodes_[node].nb_triangles_[k] = last - first;
+		}
+		else
+		{
+			const uint32 child = uint32(nodes_.size());
+			nodes_.emplace_back();
+			nodes_[node].child_[k] = child;
+			nodes_[node].nb_triangles_[k] = 0u;
+			build_node(child, order, first, last, bounds, centroids, depth + 1u);
+		}
+		nodes_[node].set_bounds(k, b);
+	}
+
+	void closest_point_in_triangle(const Vec3& p, uint32 t, Hit& hit, Scalar& best) const
+	{
+		const std::array<uint32, 3>& tri = triangles_[t];
+		const Vec3& a = (*vertex_position_)[tri[0]];
+		const Vec3& b = (*vertex_position_)[tri[1]];
+		const Vec3& c = (*vertex_position_)[tri[2]];
+		Scalar u, v, w;
+		geometry::closest_point_in_triangle(p, a, b, c, u, v, w);
+		const Vec3 q = u * a + v * b + w * c;
+		const Scalar d2 = (q - p).squaredNorm();
+		if (d2 < best)
+		{
+			best = d2;
+			hit.valid_ = true;
+			hit.face_ = faces_[triangles_face_[t]];
+			hit.position_ = q;
+			hit.bcoords_ = {u, v, w};
+		}
+	}
+
+	void intersect_triangle(const Ray& r, uint32 t, Hit& hit, Scalar& tmax) const
+	{
+		const std::array<uint32, 3>& tri = triangles_[t];
+		const Vec3& a = (*vertex_position_)[tri[0]];
+		const Vec3 e1 = (*vertex_position_)[tri[1]] - a;
+		const Vec3 e2 = (*vertex_position_)[tri[2]] - a;
+		const Vec3 pv = r.direction_.cross(e2);
+		const Scalar det = e1.dot(pv);
+		if (det == 0)
+			return;
+		const Scalar inv_det = Scalar(1) / det;
+		const Vec3 tv = r.origin_ - a;
+		const Scalar u = tv.dot(pv) * inv_det;
+		if (u < 0 || u > 1)
+			return;
+		const Vec3 qv = tv.cross(e1);
+		const Scalar v = r.direction_.dot(qv) * inv_det;
+		if (v < 0 || u + v > 1)
+			return;
+		const Scalar d = e2.dot(qv) * inv_det;
+		if (d < r.tmin_ || d > tmax)
+			return;
+		tmax = d;
+		hit.valid_ = true;
+		hit.face_ = faces_[triangles_face_[t]];
+		hit.position_ = r.origin_ + d * r.direction_;
+		hit.bcoords_ = {1 - u - v, u, v};
+	}
+
+	template <typename FUNC>
+	void foreach_query(uint32 nb_queries, const FUNC& f) const
+	{
+		parallel_foreach_chunk((nb_queries + QUERIES_CHUNK_SIZE - 1u) / QUERIES_CHUNK_SIZE, [&](uint32 c) -> bool {
+			for (uint32 i = c * QUERIES_CHUNK_SIZE, end = std::min(nb_queries, i + QUERIES_CHUNK_SIZE); i < end; ++i)
+				f(i);
+			return true;
+		});
+	}
+
+	const MESH& mesh_;
+	std::shared_ptr<const Attribute<Vec3>> vertex_position_;
+
+	std::vector<Face> faces_;
+	bool all_faces_;
+
+	// vertices (indices in the position attribute) and face (index in faces_) of the triangles in the leaves order
+	std::vector<std::array<uint32, 3>> triangles_;
+	std::vector<uint32> triangles_face_;
+
+	std::vector<Node> nodes_;
+};
+
+} // namespace geometry
+
+} // namespace cgogn
+
+#endif // CGOGN_GEOMETRY_TYPES_SURFACE_BVH_H_
@@ -0,0 +1,603 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_GEOMETRY_TYPES_VERTEX_NEIGHBORHOODS_H_
+#define CGOGN_GEOMETRY_TYPES_VERTEX_NEIGHBORHOODS_H_
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/functions/traversals/face.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/core/functions/traversals/vertex.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <cgogn/geometry/functions/inclusion.h>
+#include <cgogn/geometry/types/vector_traits.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace cgogn
+{
+
+struct MapBase;
+
+namespace geometry
+{
+
+/////////////////////////////
+// VertexNeighborhood view //
+/////////////////////////////
+
+// neighborhood of a vertex computed by VertexNeighborhoods (the cells are not copied: the view is valid as long as
+// the storage it refers to is not modified)
+// - vertices: the vertices of the neighborhood, in breadth first order from the center
+// - edges & faces: the edges & faces whose vertices are all in the neighborhood
+// - halfedges: the halfedges going from a vertex of the neighborhood to an adjacent vertex out of the neighborhood
+template <typename MESH>
+class VertexNeighborhood
+{
+public:
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using HalfEdge = typename mesh_traits<MESH>::HalfEdge;
+	using Edge = typename mesh_traits<MESH>::Edge;
+	using Face = typename mesh_traits<MESH>::Face;
+
+	template <typename CELL>
+	class Range
+	{
+		const CELL* begin_;
+		const CELL* end_;
+
+	public:
+		Range(const CELL* begin, const CELL* end) : begin_(begin), end_(end)
+		{
+		}
+		inline const CELL* begin() const
+		{
+			return begin_;
+		}
+		inline const CELL* end() const
+		{
+			return end_;
+		}
+		inline uint32 size() const
+		{
+			return uint32(end_ - begin_);
+		}
+	};
+
+	VertexNeighborhood(const MESH& m, Range<Vertex> vertices, Range<HalfEdge> halfedges, Range<Edge> edges,
+					   Range<Face> faces)
+		: m_(m), vertices_(vertices), halfedges_(halfedges), edges_(edges), faces_(faces)
+	{
+	}
+
+	operator const MESH&() const
+	{
+		return m_;
+	}
+
+	inline Vertex center() const
+	{
+		return *vertices_.begin();
+	}
+
+	template <typename CELL>
+	inline Range<CELL> cells() const
+	{
+		if constexpr (std::is_same_v<CELL, Vertex>)
+			return vertices_;
+		else if constexpr (std::is_same_v<CELL, HalfEdge>)
+			return halfedges_;
+		else if constexpr (std::is_same_v<CELL, Edge>)
+			return edges_;
+		else
+		{
+			static_assert(std::is_same_v<CELL, Face>, "CELL not supported in VertexNeighborhood");
+			return faces_;
+		}
+	}
+
+private:
+	const MESH& m_;
+	Range<Vertex> vertices_;
+	Range<HalfEdge> halfedges_;
+	Range<Edge> edges_;
+	Range<Face> faces_;
+};
+
+template <typename MESH, typename FUNC>
+void foreach_cell(const VertexNeighborhood<MESH>& n, const FUNC& f)
+{
+	using CELL = func_parameter_type<FUNC>;
+	static_assert(is_func_return_same<FUNC, bool>::value, "Given function should return a bool");
+
+	for (CELL c : n.template cells<CELL>())
+		if (!f(c))
+			break;
+}
+
+///////////////////////////////
+// VertexNeighborhoods class //
+///////////////////////////////
+
+/**
+ * Neighborhoods of the vertices of a surface map: vertices within a sphere (connected to the center) or k-rings.
+ * The adjacency of the map (vertex->adjacent vertex with the edge & halfedge, vertex->incident face, face->vertex) is
+ * copied once in flat arrays, so that the breadth first traversals do not walk the darts of the map and mark
+ * vertices in a scratch array (with a generation counter: O(1) reset between 2 centers) instead of a dart marker.
+ * The neighborhoods of all the vertices can be either streamed to a function (parallel_foreach_*, nothing is stored),
+ * or stored in compact CSR arrays (compute_*, e.g. for k-rings that only depend on the connectivity).
+ * The flat adjacency is outdated by any change of the connectivity of the map (call rebuild).
+ * A VertexNeighborhoods object is not meant to be used concurrently by several threads.
+ */
+template <typename MESH>
+class VertexNeighborhoods
+{
+	static_assert(mesh_traits<MESH>::dimension == 2, "VertexNeighborhoods can only be used with meshes of dimension 2");
+	static_assert(std::is_convertible_v<MESH&, MapBase&>, "VertexNeighborhoods can only be used with maps");
+
+	template <typename T>
+	using Attribute = typename mesh_traits<MESH>::template Attribute<T>;
+	using Vertex = typename mesh_traits<MESH>::Vertex;
+	using HalfEdge = typename mesh_traits<MESH>::HalfEdge;
+	using Edge = typename mesh_traits<MESH>::Edge;
+	using Face = typename mesh_traits<MESH>::Face;
+
+	using Neighborhood = VertexNeighborhood<MESH>;
+
+	static const uint32 CENTERS_CHUNK_SIZE = 256u;
+
+	// traversal buffers of a worker
+	struct Scratch
+	{
+		std::vector<uint32> mark_; // == generation_ <=> vertex in the current neighborhood
+		uint32 generation_ = 0u;
+		std::vector<uint32> rows_;
+		std::vector<uint32> depths_;
+		std::vector<Vertex> vertices_;
+		std::vector<HalfEdge> halfedges_;
+		std::vector<Edge> edges_;
+		std::vector<Face> faces_;
+	};
+
+	// stored neighborhoods (CSR)
+	template <typename CELL>
+	struct Cells
+	{
+		std::vector<uint32> offsets_;
+		std::vector<CELL> cells_;
+	};
+
+public:
+	VertexNeighborhoods(const MESH& m) : m_(m)
+	{
+		rebuild();
+	}
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(VertexNeighborhoods);
+
+	inline const MESH& mesh() const
+	{
+		return m_;
+	}
+
+	inline uint32 nb_vertices() const
+	{
+		return uint32(vertices_.size());
+	}
+
+	// vertices in the order of the centers of the stored neighborhoods
+	inline const std::vector<Vertex>& vertices() const
+	{
+		return vertices_;
+	}
+
+	inline uint32 row(Vertex v) const
+	{
+		return vertex_row_[index_of(m_, v)];
+	}
+
+	/**
+	 * @brief copy the adjacency of the map (after a change of its connectivity), the stored neighborhoods are cleared
+	 */
+	void rebuild()
+	{
+		vertices_.clear();
+		vertices_.reserve(nb_cells<Vertex>(m_));
+		uint32 max_index = 0u;
+		foreach_cell(m_, [&](Vertex v) -> bool {
+			vertices_.push_back(v);
+			max_index = std::max(max_index, index_of(m_, v));
+			return true;
+		});
+		vertex_row_.assign(max_index + 1u, INVALID_INDEX);
+		const uint32 nb_vertices = uint32(vertices_.size());
+		for (uint32 i = 0u; i < nb_vertices; ++i)
+			vertex_row_[index_of(m_, vertices_[i])] = i;
+
+		// face of each dart (the faces of the map may not be indexed)
+		std::vector<uint32> dart_face(m_.darts_.maximum_index(), INVALID_INDEX);
+		faces_.clear();
+		faces_offsets_.assign(1u, 0u);
+		faces_rows_.clear();
+		foreach_cell(m_, [&](Face f) -> bool {
+			const uint32 id = uint32(faces_.size());
+			faces_.push_back(f);
+			foreach_dart_of_orbit(m_, f, [&](Dart d) -> bool {
+				dart_face[d.index_] = id;
+				return true;
+			});
+			foreach_incident_vertex(m_, f, [&](Vertex v) -> bool {
+				faces_rows_.push_back(row(v));
+				return true;
+			});
+			faces_offsets_.push_back(uint32(faces_rows_.size()));
+			return true;
+		});
+
+		adjacency_offsets_.assign(1u, 0u);
+		adjacency_rows_.clear();
+		adjacency_halfedges_.clear();
+		incident_faces_offsets_.assign(1u, 0u);
+		incident_faces_.clear();
+		for (Vertex v : vertices_)
+		{
+			foreach_adjacent_vertex_through_edge(m_, v, [&](Vertex av) -> bool {
+				adjacency_rows_.push_back(row(av));
+				adjacency_halfedges_.push_back(HalfEdge(phi2(m_, av.dart_))); // dart of v, toward av
+				return true;
+			});
+			adjacency_offsets_.push_back(uint32(adjacency_rows_.size()));
+			foreach_incident_face(m_, v, [&](Face f) -> bool {
+				incident_faces_.push_back(dart_face[f.dart_.index_]);
+				return true;
+			});
+			incident_faces_offsets_.push_back(uint32(incident_faces_.size()));
+		}
+
+		clear();
+	}
+
+	/**
+	 * @brief neighborhood of the given vertex: the vertices within the sphere of given radius connected to the center
+	 * (the view refers to the buffers of the object and is valid until the next traversal)
+	 */
+	Neighborhood within_sphere(Vertex center, const Attribute<Vec3>* vertex_position, Scalar radius)
+	{
+		Scratch& s = scratch(1u)[0];
+		return gather(s, row(center), sphere_test(vertex_position, radius, s));
+	}
+
+	/**
+	 * @brief neighborhood of the given vertex: the vertices at most k edges away from the center
+	 * (the view refers to the buffers of the object and is valid until the next traversal)
+	 */
+	Neighborhood k_ring(Vertex center, uint32 k)
+	{
+		Scratch& s = scratch(1u)[0];
+		return gather(s, row(center), ring_test(k));
+	}
+
+	/**
+	 * @brief call f on the sphere neighborhood of each vertex, in parallel (nothing is stored)
+	 */
+	template <typename FUNC>
+	void parallel_foreach_within_sphere(const Attribute<Vec3>* vertex_position, Scalar radius, const FUNC& f)
+	{
+		parallel_foreach_neighborhood([&](Scratch& s) { return sphere_test(vertex_position, radius, s); }, f);
+	}
+
+	/**
+	 * @brief call f on the k-ring of each vertex, in parallel (nothing is stored)
+	 */
+	template <typename FUNC>
+	void parallel_foreach_k_ring(uint32 k, const FUNC& f)
+	{
+		parallel_foreach_neighborhood([&](Scratch&) { return ring_test(k); }, f);
+	}
+
+	// compute and store the sphere neighborhoods of all the vertices
+	void compute_within_sphere(const Attribute<Vec3>* vertex_position, Scalar radius)
+	{
+		store([&](Scratch& s) { return sphere_test(vertex_position, radius, s); });
+	}
+
+	// compute and store the k-rings of all the vertices
+	void compute_k_ring(uint32 k)
+	{
+		store([&](Scratch&) { return ring_test(k); });
+	}
+
+	inline bool is_stored() const
+	{
+		return stored_;
+	}
+
+	// stored neighborhood of the given vertex
+	inline Neighborhood neighborhood(Vertex v) const
+	{
+		return stored_neighborhood(row(v));
+	}
+
+	// stored neighborhood of the vertex of the given row
+	inline Neighborhood stored_neighborhood(uint32 i) const
+	{
+		cgogn_message_assert(stored_, "No stored neighborhoods");
+		return Neighborhood(m_, range(stored_vertices_, i), range(stored_halfedges_, i), range(stored_edges_, i),
+							range(stored_faces_, i));
+	}
+
+	// release the stored neighborhoods
+	void clear()
+	{
+		stored_ = false;
+		clear(stored_vertices_);
+		clear(stored_halfedges_);
+		clear(stored_edges_);
+		clear(stored_faces_);
+	}
+
+private:
+	auto sphere_test(const Attribute<Vec3>* vertex_position, Scalar radius, Scratch& s) const
+	{
+		return [this, vertex_position, radius, &s](uint32 r, uint32) -> bool {
+			return in_sphere(value<Vec3>(m_, vertex_position, vertices_[r]),
+							 value<Vec3>(m_, vertex_position, vertices_[s.rows_[0]]), radius);
+		};
+	}
+
+	auto ring_test(uint32 k) const
+	{
+		return [k](uint32, uint32 depth) -> bool { return depth <= k; };
+	}
+
+	std::vector<Scratch>& scratch(uint32 nb)
+	{
+		if (scratch_.size() < nb)
+			scratch_.resize(nb);
+		return scratch_;
+	}
+
+	// breadth first traversal from the center: inside(row, depth) tells if a reached vertex is in the neighborhood
+	template <typename INSIDE>
+	Neighborhood gather(Scratch& s, uint32 center, const INSIDE& inside) const
+	{
+		if (s.mark_.size() != vertices_.size())
+		{
+			s.mark_.assign(vertices_.size(), 0u);
+			s.generation_ = 0u;
+		}
+		if (++s.generation_ == 0u) // the generation value wrapped: actually clear the marks
+		{
+			std::fill(s.mark_.begin(), s.mark_.end(), 0u);
+			s.generation_ = 1u;
+		}
+		const uint32 g = s.generation_;
+
+		s.rows_.clear();
+		s.depths_.clear();
+		s.vertices_.clear();
+		s.halfedges_.clear();
+		s.edges_.clear();
+		s.faces_.clear();
+
+		s.rows_.push_back(center);
+		s.depths_.push_back(0u);
+		s.mark_[center] = g;
+		for (uint32 i = 0u; i < uint32(s.rows_.size()); ++i)
+		{
+			const uint32 r = s.rows_[i];
+			const uint32 depth = s.depths_[i] + 1u;
+			for (uint32 a = adjacency_offsets_[r], end = adjacency_offsets_[r + 1u]; a < end; ++a)
+			{
+				const uint32 ar = adjacency_rows_[a];
+				if (s.mark_[ar] != g && inside(ar, depth))
+				{
+					s.mark_[ar] = g;
+					s.rows_.push_back(ar);
+					s.depths_.push_back(depth);
+				}
+			}
+		}
+
+		for (uint32 r : s.rows_)
+		{
+			s.vertices_.push_back(vertices_[r]);
+			for (uint32 a = adjacency_offsets_[r], end = adjacency_offsets_[r + 1u]; a < end; ++a)
+			{
+				const uint32 ar = adjacency_rows_[a];
+				if (s.mark_[ar] != g)
+					s.halfedges_.push_back(adjacency_halfedges_[a]);
+				else if (r < ar)
+					s.edges_.push_back(Edge(adjacency_halfedges_[a].dart_));
+			}
+			// a face is gathered by its vertex of lowest row
+			for (uint32 fa = incident_faces_offsets_[r], end = incident_faces_offsets_[r + 1u]; fa < end; ++fa)
+			{
+				const uint32 fi = incident_faces_[fa];
+				bool all_in = true;
+				bool lowest = true;
+				for (uint32 k = faces_offsets_[fi], kend = faces_offsets_[fi + 1u]; k < kend && all_in; ++k)
+				{
+					all_in = s.mark_[faces_rows_[k]] == g;
+					lowest &= faces_rows_[k] >= r;
+				}
+				if (all_in && lowest)
+					s.faces_.push_back(faces_[fi]);
+			}
+		}
+
+		return Neighborhood(m_, {s.vertices_.data(), s.vertices_.data() + s.vertices_.size()},
+							{s.halfedges_.data(), s.halfedges_.data() + s.halfedges_.size()},
+							{s.edges_.data(), s.edges_.data() + s.edges_.size()},
+							{s.faces_.data(), s.faces_.data() + s.faces_.size()});
+	}
+
+	// the centers are distributed by chunks over the workers, each worker using its own scratch buffers
+	template <typename INSIDE_FACTORY, typename FUNC>
+	void parallel_foreach_neighborhood(const INSIDE_FACTORY& inside_factory, const FUNC& f)
+	{
+		const uint32 nb_vertices = uint32(vertices_.size());
+		const uint32 nb_chunks = (nb_vertices + CENTERS_CHUNK_SIZE - 1u) / CENTERS_CHUNK_SIZE;
+		ThreadPool* pool = thread_pool();
+		const uint32 nb_workers = std::max(1u, std::min(pool->nb_workers(), nb_chunks));
+		std::vector<Scratch>& scratches = scratch(nb_workers);
+
+		std::atomic<uint32> next_chunk(0u);
+		pool->fork_join(nb_workers, [&](uint32 w) {
+			Scratch& s = scratches[w];
+			auto inside = inside_factory(s);
+			for (uint32 c = next_chunk.fetch_add(1u); c < nb_chunks; c = next_chunk.fetch_add(1u))
+			{
+				for (uint32 i = c * CENTERS_CHUNK_SIZE, end = std::min(nb_vertices, i + CENTERS_CHUNK_SIZE); i < end;
+					 ++i)
+					f(gather(s, i, inside));
+			}
+		});
+	}
+
+	// each chunk of centers is gathered in its own buffers, then the buffers are concatenated
+	template <typename INSIDE_FACTORY>
+	void store(const INSIDE_FACTORY& inside_factory)
+	{
+		const uint32 nb_vertices = uint32(vertices_.size());
+		const uint32 nb_chunks = (nb_vertices + CENTERS_CHUNK_SIZE - 1u) / CENTERS_CHUNK_SIZE;
+
+		struct ChunkCells
+		{
+			Cells<Vertex> vertices_;
+			Cells<HalfEdge> halfedges_;
+			Cells<Edge> edges_;
+			Cells<Face> faces_;
+		};
+		std::vector<ChunkCells> chunks(nb_chunks);
+
+		const uint32 nb_workers = std::max(1u, std::min(thread_pool()->nb_workers(), nb_chunks));
+		std::vector<Scratch>& scratches = scratch(nb_workers);
+		std::atomic<uint32> next_chunk(0u);
+		thread_pool()->fork_join(nb_workers, [&](uint32 w) {
+			Scratch& s = scratches[w];
+			auto inside = inside_factory(s);
+			for (uint32 c = next_chunk.fetch_add(1u); c < nb_chunks; c = next_chunk.fetch_add(1u))
+			{
+				ChunkCells& cc = chunks[c];
+				for (uint32 i = c * CENTERS_CHUNK_SIZE, end = std::min(nb_vertices, i + CENTERS_CHUNK_SIZE); i < end;
+					 ++i)
+				{
+					Neighborhood n = gather(s, i, inside);
+					append(cc.vertices_, n.template cells<Vertex>());
+					append(cc.halfedges_, n.template cells<HalfEdge>());
+					append(cc.edges_, n.template cells<Edge>());
+					append(cc.faces_, n.template cells<Face>());
+				}
+			}
+		});
+
+		concatenate(chunks, stored_vertices_, [](ChunkCells& cc) -> Cells<Vertex>& { return cc.vertices_; });
+		concatenate(chunks, stored_halfedges_, [](ChunkCells& cc) -> Cells<HalfEdge>& { return cc.halfedges_; });
+		concatenate(chunks, stored_edges_, [](ChunkCells& cc) -> Cells<Edge>& { return cc.edges_; });
+		concatenate(chunks, stored_faces_, [](ChunkCells& cc) -> Cells<Face>& { return cc.faces_; });
+		stored_ = true;
+	}
+
+	template <typename CELL>
+	static void append(Cells<CELL>& cells, typename Neighborhood::template Range<CELL> range)
+	{
+		cells.cells_.insert(cells.cells_.end(), range.begin(), range.end());
+		cells.offsets_.push_back(uint32(cells.cells_.size()));
+	}
+
+	template <typename CHUNKS, typename CELL, typename GET>
+	static void concatenate(CHUNKS& chunks, Cells<CELL>& result, const GET& get)
+	{
+		const uint32 nb_chunks = uint32(chunks.size());
+		std::vector<uint32> chunk_first(nb_chunks + 1u, 0u);
+		uint32 nb_centers = 0u;
+		for (uint32 c = 0u; c < nb_chunks; ++c)
+		{
+			chunk_first[c + 1u] = chunk_first[c] + uint32(get(chunks[c]).cells_.size());
+			nb_centers += uint32(get(chunks[c]).offsets_.size());
+		}
+		result.cells_.resize(chunk_first[nb_chunks]);
+		result.offsets_.resize(nb_centers + 1u);
+		result.offsets_[0] = 0u;
+		parallel_foreach_chunk(nb_chunks, [&](uint32 c) -> bool {
+			Cells<CELL>& cc = get(chunks[c]);
+			std::copy(cc.cells_.begin(), cc.cells_.end(), result.cells_.begin() + chunk_first[c]);
+			uint32* offsets = result.offsets_.data() + 1u + c * CENTERS_CHUNK_SIZE;
+			for (uint32 o : cc.offsets_)
+				*offsets++ = chunk_first[c] + o;
+			cc = Cells<CELL>();
+			return true;
+		});
+	}
+
+	template <typename CELL>
+	static typename Neighborhood::template Range<CELL> range(const Cells<CELL>& cells, uint32 i)
+	{
+		const CELL* data = cells.cells_.data();
+		return {data + cells.offsets_[i], data + cells.offsets_[i + 1u]};
+	}
+
+	template <typename CELL>
+	static void clear(Cells<CELL>& cells)
+	{
+		cells.offsets_ = std::vector<uint32>();
+		cells.cells_ = std::vector<CELL>();
+	}
+
+	const MESH& m_;
+
+	std::vector<Vertex> vertices_;
+	std::vector<uint32> vertex_row_; // vertex index -> row
+	std::vector<uint32> adjacency_offsets_;
+	std::vector<uint32> adjacency_rows_;
+	std::vector<HalfEdge> adjacency_halfedges_;
+	std::vector<uint32> incident_faces_offsets_;
+	std::vector<uint32> incident_faces_;
+	std::vector<Face> faces_;
+	std::vector<uint32> faces_offsets_;
+	std::vector<uint32> faces_rows_;
+
+	std::vector<Scratch> scratch_;
+
+	bool stored_ = false;
+	Cells<Vertex> stored_vertices_;
+	Cells<HalfEdge> stored_halfedges_;
+	Cells<Edge> stored_edges_;
+	Cells<Face> stored_faces_;
+};
+
+} // namespace geometry
+
+template <typename MESH>
+struct mesh_traits<geometry::VertexNeighborhood<MESH>> : public mesh_traits<MESH>
+{
+};
+
+} // namespace cgogn
+
+#endif // CGOGN_GEOMETRY_TYPES_VERTEX_NEIGHBORHOODS_H_
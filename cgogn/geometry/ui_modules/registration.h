@@ -32,6 +32,11 @@
 #include <cgogn/geometry/algos/registration.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <boost/synapse/connect.hpp>
+
+#include <memory>
+#include <vector>
+
 namespace cgogn
 {
 
@@ -59,20 +64,51 @@ public:
 	}
 
 	void rigid_register_mesh(MESH& source, Attribute<Vec3>* source_position, MESH& target,
-							 const Attribute<Vec3>* target_position)
+							 const std::shared_ptr<Attribute<Vec3>>& target_position,
+							 geometry::ICPMetric metric = geometry::POINT_TO_POINT)
 	{
-		geometry::rigid_register_mesh(source, source_position, target, target_position);
+		typename geometry::SurfaceRegistration<MESH>::RigidParameters p;
+		p.metric_ = metric;
+		registration(target, target_position).rigid_register(source, source_position, p);
 		mesh_provider_->emit_attribute_changed(source, source_position);
 	}
 
 	void non_rigid_register_mesh(MESH& source, std::shared_ptr<Attribute<Vec3>>& source_position, MESH& target,
-								 const Attribute<Vec3>* target_position, Scalar fit_to_target, bool relax)
+								 const std::shared_ptr<Attribute<Vec3>>& target_position, Scalar fit_to_target,
+								 bool relax)
 	{
-		geometry::non_rigid_register_mesh(source, source_position, target, target_position, fit_to_target, relax, false,
-										  geometry::NEAREST_POINT);
+		registration(target, target_position)
+			.non_rigid_register(source, source_position, fit_to_target, relax, false, geometry::NEAREST_POINT);
 		mesh_provider_->emit_attribute_changed(source, source_position.get());
 	}
 
+	// the registration (and the BVH of the target) is kept until the target or its position changes
+	geometry::SurfaceRegistration<MESH>& registration(MESH& target,
+													  const std::shared_ptr<Attribute<Vec3>>& target_position)
+	{
+		if (!registration_ || &registration_->target() != &target ||
+			registration_->target_vertex_position() != target_position.get())
+		{
+			registration_ = std::make_unique<geometry::SurfaceRegistration<MESH>>(target, target_position);
+			target_outdated_ = false;
+			target_connections_.clear();
+			target_connections_.push_back(boost::synapse::connect<typename MeshProvider<MESH>::connectivity_changed>(
+				&target, [this]() { registration_.reset(); }));
+			target_connections_.push_back(
+				boost::synapse::connect<typename MeshProvider<MESH>::template attribute_changed_t<Vec3>>(
+					&target, [this](Attribute<Vec3>* attribute) {
+						if (registration_ && registration_->target_vertex_position() == attribute)
+							target_outdated_ = true;
+					}));
+		}
+		else if (target_outdated_)
+		{
+			registration_->update_target_geometry();
+			target_outdated_ = false;
+		}
+		return *registration_;
+	}
+
 protected:
 	void init() override
 	{
@@ -113,9 +149,12 @@ protected:
 		if (selected_source_mesh_ && selected_source_vertex_position_ && selected_target_mesh_ &&
 			selected_target_vertex_position_)
 		{
+			static bool point_to_plane = false;
+			ImGui::Checkbox("Point to plane", &point_to_plane);
 			if (ImGui::Button("Rigid registration"))
 				rigid_register_mesh(*selected_source_mesh_, selected_source_vertex_position_.get(),
-									*selected_target_mesh_, selected_target_vertex_position_.get());
+									*selected_target_mesh_, selected_target_vertex_position_,
+									point_to_plane ? geometry::POINT_TO_PLANE : geometry::POINT_TO_POINT);
 			static float fit_to_target = 0.05f;
 			static bool relax = false;
 			ImGui::SliderFloat("Fit to target", &fit_to_target, 0.0, 10.0);
@@ -128,8 +167,17 @@ protected:
 			}
 			if (ImGui::Button("Non-rigid registration"))
 				non_rigid_register_mesh(*selected_source_mesh_, selected_source_vertex_position_,
-										*selected_target_mesh_, selected_target_vertex_position_.get(), fit_to_target,
-										relax);
+										*selected_target_mesh_, selected_target_vertex_position_, fit_to_target, relax);
+
+			if (registration_ && !registration_->statistics().empty())
+			{
+				const auto& statistics = registration_->statistics();
+				double time = 0.0;
+				for (const auto& s : statistics)
+					time += s.correspondences_time_ + s.solve_time_;
+				ImGui::Text("Iterations: %d (%.2f ms)", int(statistics.size()), time * 1000.0);
+				ImGui::Text("Mean distance: %g", statistics.back().mean_distance_);
+			}
 		}
 	}
 
@@ -139,6 +187,10 @@ private:
 	MESH* selected_target_mesh_ = nullptr;
 	std::shared_ptr<Attribute<Vec3>> selected_target_vertex_position_ = nullptr;
 	MeshProvider<MESH>* mesh_provider_ = nullptr;
+
+	std::unique_ptr<geometry::SurfaceRegistration<MESH>> registration_;
+	bool target_outdated_ = false;
+	std::vector<std::shared_ptr<boost::synapse::connection>> target_connections_;
 };
 
 } // namespace ui
@@ -33,6 +33,7 @@
 #include <cgogn/geometry/algos/angle.h>
 #include <cgogn/geometry/algos/area.h>
 #include <cgogn/geometry/algos/curvature.h>
+#include <cgogn/geometry/algos/differential_properties.h>
 #include <cgogn/geometry/algos/length.h>
 #include <cgogn/geometry/algos/normal.h>
 #include <cgogn/geometry/types/vector_traits.h>
@@ -63,7 +64,8 @@ public:
 		: Module(app, "SurfaceDifferentialProperties (" + std::string{mesh_traits<MESH>::name} + ")"),
 		  selected_mesh_(nullptr), selected_vertex_position_(nullptr), selected_vertex_normal_(nullptr),
 		  selected_vertex_kmax_(nullptr), selected_vertex_kmin_(nullptr), selected_vertex_kgaussian_(nullptr),
-		  selected_vertex_Kmax_(nullptr), selected_vertex_Kmin_(nullptr), selected_vertex_Knormal_(nullptr),
+		  selected_vertex_kmean_(nullptr), selected_vertex_Kmax_(nullptr), selected_vertex_Kmin_(nullptr),
+		  selected_vertex_Knormal_(nullptr),
 		  selected_area_policy_(geometry::VertexAreaPolicy::BARYCENTER)
 	{
 	}
@@ -108,6 +110,21 @@ public:
 		mesh_provider_->emit_attribute_changed(m, vertex_kgaussian);
 	}
 
+	// normal, angular defect gaussian curvature & cotan mean curvature in one fused sweep
+	void compute_differential_properties(const MESH& m, const Attribute<Vec3>* vertex_position,
+										 Attribute<Vec3>* vertex_normal, Attribute<Scalar>* vertex_kgaussian,
+										 Attribute<Scalar>* vertex_kmean)
+	{
+		geometry::DifferentialProperties<MESH> properties;
+		properties.vertex_normal_ = vertex_normal;
+		properties.vertex_gaussian_curvature_ = vertex_kgaussian;
+		properties.vertex_mean_curvature_ = vertex_kmean;
+		geometry::compute_differential_properties(m, vertex_position, properties);
+		mesh_provider_->emit_attribute_changed(m, vertex_normal);
+		mesh_provider_->emit_attribute_changed(m, vertex_kgaussian);
+		mesh_provider_->emit_attribute_changed(m, vertex_kmean);
+	}
+
 protected:
 	void init() override
 	{
@@ -124,6 +141,7 @@ protected:
 			selected_vertex_kmax_.reset();
 			selected_vertex_kmin_.reset();
 			selected_vertex_kgaussian_.reset();
+			selected_vertex_kmean_.reset();
 			selected_vertex_Kmax_.reset();
 			selected_vertex_Kmin_.reset();
 			selected_vertex_Knormal_.reset();
@@ -152,6 +170,10 @@ protected:
 				*selected_mesh_, selected_vertex_kgaussian_, "kgaussian",
 				[&](const decltype(selected_vertex_kgaussian_)& attribute) { selected_vertex_kgaussian_ = attribute; });
 
+			imgui_combo_attribute<Vertex, Scalar>(
+				*selected_mesh_, selected_vertex_kmean_, "kmean",
+				[&](const decltype(selected_vertex_kmean_)& attribute) { selected_vertex_kmean_ = attribute; });
+
 			imgui_combo_attribute<Vertex, Vec3>(
 				*selected_mesh_, selected_vertex_Kmax_, "Kmax",
 				[&](const decltype(selected_vertex_Kmax_)& attribute) { selected_vertex_Kmax_ = attribute; });
@@ -201,6 +223,19 @@ protected:
 					compute_gaussian_curvature(*selected_mesh_, selected_vertex_position_.get(), selected_area_policy_,
 											   selected_vertex_kgaussian_.get());
 				}
+
+				if (ImGui::Button("Compute normal, gaussian & mean curvature"))
+				{
+					if (!selected_vertex_normal_)
+						selected_vertex_normal_ = get_or_add_attribute<Vec3, Vertex>(*selected_mesh_, "normal");
+					if (!selected_vertex_kgaussian_)
+						selected_vertex_kgaussian_ = get_or_add_attribute<Scalar, Vertex>(*selected_mesh_, "kgaussian");
+					if (!selected_vertex_kmean_)
+						selected_vertex_kmean_ = get_or_add_attribute<Scalar, Vertex>(*selected_mesh_, "kmean");
+					compute_differential_properties(*selected_mesh_, selected_vertex_position_.get(),
+													selected_vertex_normal_.get(), selected_vertex_kgaussian_.get(),
+													selected_vertex_kmean_.get());
+				}
 			}
 
 			if (selected_vertex_position_ && selected_vertex_normal_)
@@ -246,6 +281,7 @@ private:
 	std::shared_ptr<Attribute<Scalar>> selected_vertex_kmax_;
 	std::shared_ptr<Attribute<Scalar>> selected_vertex_kmin_;
 	std::shared_ptr<Attribute<Scalar>> selected_vertex_kgaussian_;
+	std::shared_ptr<Attribute<Scalar>> selected_vertex_kmean_;
 	std::shared_ptr<Attribute<Vec3>> selected_vertex_Kmax_;
 	std::shared_ptr<Attribute<Vec3>> selected_vertex_Kmin_;
 	std::shared_ptr<Attribute<Vec3>> selected_vertex_Knormal_;
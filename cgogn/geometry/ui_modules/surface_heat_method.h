@@ -31,10 +31,13 @@
 
 #include <cgogn/geometry/algos/distance.h>
 
+#include <boost/synapse/connect.hpp>
+
 #include <chrono>
 #include <cmath>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <queue>
 #include <unordered_set>
 #include <utility>
@@ -88,9 +91,30 @@ public:
 	}
 
 	void geodesic_distance(MESH& m, const Attribute<Vec3>* vertex_position,
-						   const CellsSet<MESH, Vertex>* source_vertices, Attribute<Scalar>* vertex_geodesic_distance)
+						   const CellsSet<MESH, Vertex>* source_vertices, Attribute<Scalar>* vertex_geodesic_distance,
+						   Scalar t_multiplier = 1.0)
 	{
-		geometry::compute_geodesic_distance(m, vertex_position, source_vertices, vertex_geodesic_distance);
+		// the solver (and its factorizations) is kept between the queries on the same mesh & position attribute
+		if (!geodesic_solver_ || geodesic_solver_mesh_ != &m || geodesic_solver_vertex_position_ != vertex_position)
+		{
+			geodesic_solver_ = std::make_unique<geometry::GeodesicSolver<MESH>>(m, vertex_position, t_multiplier);
+			geodesic_solver_mesh_ = &m;
+			geodesic_solver_vertex_position_ = vertex_position;
+			geodesic_solver_connections_.clear();
+			geodesic_solver_connections_.push_back(
+				boost::synapse::connect<typename MeshProvider<MESH>::connectivity_changed>(
+					&m, [this]() { geodesic_solver_->invalidate_topology(); }));
+			geodesic_solver_connections_.push_back(
+				boost::synapse::connect<typename MeshProvider<MESH>::template attribute_changed_t<Vec3>>(
+					&m, [this](Attribute<Vec3>* attribute) {
+						if (attribute == geodesic_solver_vertex_position_)
+							geodesic_solver_->invalidate_geometry();
+					}));
+		}
+		else
+			geodesic_solver_->set_t_multiplier(t_multiplier);
+
+		geodesic_solver_->compute(source_vertices, vertex_geodesic_distance);
 		mesh_provider_->emit_attribute_changed(m, vertex_geodesic_distance);
 	}
 
@@ -106,6 +130,7 @@ protected:
 		imgui_mesh_selector(mesh_provider_, selected_mesh_, "Surface", [&](MESH& m) {
 			selected_mesh_ = &m;
 			selected_vertex_position_.reset();
+			reset_geodesic_solver();
 			mesh_provider_->mesh_data(m).outlined_until_ = App::frame_time_ + 1.0;
 		});
 
@@ -115,7 +140,10 @@ protected:
 
 			imgui_combo_attribute<Vertex, Vec3>(
 				*selected_mesh_, selected_vertex_position_, "Vertex Position",
-				[&](const std::shared_ptr<Attribute<Vec3>>& attribute) { selected_vertex_position_ = attribute; });
+				[&](const std::shared_ptr<Attribute<Vec3>>& attribute) {
+					selected_vertex_position_ = attribute;
+					reset_geodesic_solver();
+				});
 
 			imgui_combo_cells_set(md, selected_vertices_set_, "Source vertices",
 								  [&](CellsSet<MESH, Vertex>* cs) { selected_vertices_set_ = cs; });
@@ -148,19 +176,30 @@ protected:
 						geodesic_distance_vertex_ =
 							get_or_add_attribute<Scalar, Vertex>(*selected_mesh_, "geodesic distance");
 					geodesic_distance(*selected_mesh_, selected_vertex_position_.get(), selected_vertices_set_,
-									  geodesic_distance_vertex_.get());
+									  geodesic_distance_vertex_.get(), t_multiplier_);
 				}
 
-				static double t_multiplier = 1.0;
-				ImGui::InputDouble("Scalar t_multiplier", &t_multiplier, 0.01f, 100.0f, "%.3f");
+				ImGui::InputDouble("Scalar t_multiplier", &t_multiplier_, 0.01f, 100.0f, "%.3f");
 			}
 		}
 	}
 
 private:
+	void reset_geodesic_solver()
+	{
+		geodesic_solver_connections_.clear();
+		geodesic_solver_.reset();
+		geodesic_solver_mesh_ = nullptr;
+		geodesic_solver_vertex_position_ = nullptr;
+	}
+
 	MESH* selected_mesh_ = nullptr;
 
-	// geometry::DistanceHeatSolver<MESH>* distanceHeatSolver = nullptr;
+	std::unique_ptr<geometry::GeodesicSolver<MESH>> geodesic_solver_;
+	const MESH* geodesic_solver_mesh_ = nullptr;
+	const Attribute<Vec3>* geodesic_solver_vertex_position_ = nullptr;
+	std::vector<std::shared_ptr<boost::synapse::connection>> geodesic_solver_connections_;
+	double t_multiplier_ = 1.0;
 
 	std::shared_ptr<Attribute<Vec3>> selected_vertex_position_ = nullptr;
 	CellsSet<MESH, Vertex>* selected_vertices_set_ = nullptr;
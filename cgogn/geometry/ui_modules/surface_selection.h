@@ -35,6 +35,7 @@
 #include <cgogn/geometry/algos/picking.h>
 #include <cgogn/geometry/algos/selection.h>
 #include <cgogn/geometry/types/vector_traits.h>
+#include <cgogn/geometry/types/vertex_neighborhoods.h>
 
 #include <cgogn/rendering/shaders/shader_bold_line.h>
 #include <cgogn/rendering/shaders/shader_flat.h>
@@ -94,9 +95,9 @@ class SurfaceSelection : public ViewModule
 	struct Parameters
 	{
 		Parameters()
-			: vertex_position_(nullptr), vertex_scale_factor_(1.0), sphere_scale_factor_(10.0), angle_threshold_(0.5f),
-			  selected_vertices_set_(nullptr), selected_edges_set_(nullptr), selected_faces_set_(nullptr),
-			  selecting_cell_(VertexSelect), selection_method_(SingleCell)
+			: vertex_position_(nullptr), bvh_outdated_(false), vertex_scale_factor_(1.0), sphere_scale_factor_(10.0),
+			  angle_threshold_(0.5f), selected_vertices_set_(nullptr), selected_edges_set_(nullptr),
+			  selected_faces_set_(nullptr), selecting_cell_(VertexSelect), selection_method_(SingleCell)
 		{
 			param_point_sprite_ = rendering::ShaderPointSprite::generate_param();
 			param_point_sprite_->color_ = rendering::GLColor(1, 0, 0, 0.65f);
@@ -161,9 +162,26 @@ class SurfaceSelection : public ViewModule
 			}
 		}
 
+		// hierarchy of the faces used for picking (built on first use, refitted after a motion of the vertices)
+		const geometry::SurfaceBVH<MESH>& bvh()
+		{
+			if (!bvh_)
+				bvh_ = std::make_unique<geometry::SurfaceBVH<MESH>>(*mesh_, vertex_position_);
+			else if (bvh_outdated_)
+				bvh_->refit();
+			bvh_outdated_ = false;
+			return *bvh_;
+		}
+
 		MESH* mesh_;
 		std::shared_ptr<Attribute<Vec3>> vertex_position_;
 
+		std::unique_ptr<geometry::SurfaceBVH<MESH>> bvh_;
+		bool bvh_outdated_;
+
+		// flat adjacency used to gather the sphere selections (built on first use, reset on connectivity change)
+		std::unique_ptr<geometry::VertexNeighborhoods<MESH>> neighborhoods_;
+
 		std::unique_ptr<rendering::ShaderPointSprite::Param> param_point_sprite_;
 		std::unique_ptr<rendering::ShaderBoldLine::Param> param_edge_;
 		std::unique_ptr<rendering::ShaderFlat::Param> param_flat_;
@@ -215,12 +233,19 @@ private:
 	{
 		Parameters& p = parameters_[m];
 		p.mesh_ = m;
+		mesh_connections_[m].push_back(boost::synapse::connect<typename MeshProvider<MESH>::connectivity_changed>(
+			m, [this, m]() {
+				Parameters& p = parameters_[m];
+				p.neighborhoods_.reset();
+				p.bvh_.reset();
+			}));
 		mesh_connections_[m].push_back(
 			boost::synapse::connect<typename MeshProvider<MESH>::template attribute_changed_t<Vec3>>(
 				m, [this, m](Attribute<Vec3>* attribute) {
 					Parameters& p = parameters_[m];
 					if (p.vertex_position_.get() == attribute)
 					{
+						p.bvh_outdated_ = true;
 						p.vertex_base_size_ = float32(geometry::mean_edge_length(*m, p.vertex_position_.get()) / 6);
 						p.update_selected_vertices_vbo();
 						p.update_selected_edges_vbo();
@@ -284,11 +309,10 @@ private:
 				{
 				case VertexSelect: {
 					selecting_vertices_.clear();
-					std::vector<Vertex> picked;
-					cgogn::geometry::picking(*selected_mesh_, p.vertex_position_.get(), A, B, picked);
-					if (!picked.empty())
+					Vertex picked;
+					if (geometry::picking(p.bvh(), A, B, picked))
 					{
-						selecting_vertices_.push_back(picked[0]);
+						selecting_vertices_.push_back(picked);
 						std::vector<Vec3> selecting_points;
 						selecting_points.reserve(selecting_vertices_.size());
 						for (Vertex v : selecting_vertices_)
@@ -299,11 +323,10 @@ private:
 				break;
 				case EdgeSelect: {
 					selecting_edges_.clear();
-					std::vector<Edge> picked;
-					cgogn::geometry::picking(*selected_mesh_, p.vertex_position_.get(), A, B, picked);
-					if (!picked.empty())
+					Edge picked;
+					if (geometry::picking(p.bvh(), A, B, picked))
 					{
-						selecting_edges_.push_back(picked[0]);
+						selecting_edges_.push_back(picked);
 						std::vector<Vec3> selecting_segments;
 						selecting_segments.reserve(2 * selecting_edges_.size());
 						for (Edge e : selecting_edges_)
@@ -318,11 +341,10 @@ private:
 				break;
 				case FaceSelect: {
 					selecting_faces_.clear();
-					std::vector<Face> picked;
-					cgogn::geometry::picking(*selected_mesh_, p.vertex_position_.get(), A, B, picked);
-					if (!picked.empty())
+					Face picked;
+					if (geometry::picking(p.bvh(), A, B, picked))
 					{
-						selecting_faces_.push_back(picked[0]);
+						selecting_faces_.push_back(picked);
 						std::vector<Vec3> selecting_polygons;
 						selecting_polygons.reserve(3 * selecting_faces_.size());
 						for (Face f : selecting_faces_)
@@ -343,12 +365,11 @@ private:
 				switch (p.selecting_cell_)
 				{
 				case VertexSelect: {
-					std::vector<Vertex> picked;
-					cgogn::geometry::picking(*selected_mesh_, p.vertex_position_.get(), A, B, picked);
-					if (!picked.empty())
+					Vertex picked;
+					if (geometry::picking(p.bvh(), A, B, picked))
 					{
 						selecting_vertices_ = geometry::within_normal_angle_threshold<Vertex>(
-							*selected_mesh_, picked[0], p.angle_threshold_, p.vertex_position_.get());
+							*selected_mesh_, picked, p.angle_threshold_, p.vertex_position_.get());
 						std::vector<Vec3> selecting_points;
 						selecting_points.reserve(selecting_vertices_.size());
 						for (Vertex v : selecting_vertices_)
@@ -360,12 +381,11 @@ private:
 				}
 				break;
 				case EdgeSelect: {
-					std::vector<Edge> picked;
-					cgogn::geometry::picking(*selected_mesh_, p.vertex_position_.get(), A, B, picked);
-					if (!picked.empty())
+					Edge picked;
+					if (geometry::picking(p.bvh(), A, B, picked))
 					{
 						selecting_edges_ = geometry::within_normal_angle_threshold<Edge>(
-							*selected_mesh_, picked[0], p.angle_threshold_, p.vertex_position_.get());
+							*selected_mesh_, picked, p.angle_threshold_, p.vertex_position_.get());
 						std::vector<Vec3> selecting_segments;
 						selecting_segments.reserve(2 * selecting_edges_.size());
 						for (Edge e : selecting_edges_)
@@ -381,12 +401,11 @@ private:
 				}
 				break;
 				case FaceSelect: {
-					std::vector<Face> picked;
-					cgogn::geometry::picking(*selected_mesh_, p.vertex_position_.get(), A, B, picked);
-					if (!picked.empty())
+					Face picked;
+					if (geometry::picking(p.bvh(), A, B, picked))
 					{
 						selecting_faces_ = geometry::within_normal_angle_threshold<Face>(
-							*selected_mesh_, picked[0], p.angle_threshold_, p.vertex_position_.get());
+							*selected_mesh_, picked, p.angle_threshold_, p.vertex_position_.get());
 						std::vector<Vec3> selecting_polygons;
 						selecting_polygons.reserve(3 * selecting_faces_.size());
 						for (Face f : selecting_faces_)
@@ -407,11 +426,10 @@ private:
 			break;
 			case WithinSphere: {
 				selecting_vertices_.clear();
-				std::vector<Vertex> picked;
-				cgogn::geometry::picking(*selected_mesh_, p.vertex_position_.get(), A, B, picked);
-				if (!picked.empty())
+				Vertex picked;
+				if (geometry::picking(p.bvh(), A, B, picked))
 				{
-					selecting_vertices_.push_back(picked[0]);
+					selecting_vertices_.push_back(picked);
 					std::vector<Vec3> selecting_points;
 					selecting_points.reserve(selecting_vertices_.size());
 					for (Vertex v : selecting_vertices_)
@@ -433,6 +451,7 @@ public:
 		Parameters& p = parameters_[&m];
 
 		p.vertex_position_ = vertex_position;
+		p.bvh_.reset();
 		if (p.vertex_position_)
 		{
 			p.vertex_base_size_ = float32(geometry::mean_edge_length(m, p.vertex_position_.get()) / 6); // 6 ???
@@ -579,9 +598,10 @@ protected:
 			case WithinSphere: {
 				if (!selecting_vertices_.empty())
 				{
-					CellCache<MESH> cache =
-						geometry::within_sphere(*selected_mesh_, selecting_vertices_.front(),
-												p.vertex_base_size_ * p.sphere_scale_factor_, p.vertex_position_.get());
+					if (!p.neighborhoods_)
+						p.neighborhoods_ = std::make_unique<geometry::VertexNeighborhoods<MESH>>(*selected_mesh_);
+					auto cache = p.neighborhoods_->within_sphere(selecting_vertices_.front(), p.vertex_position_.get(),
+																 p.vertex_base_size_ * p.sphere_scale_factor_);
 					switch (p.selecting_cell_)
 					{
 					case VertexSelect:
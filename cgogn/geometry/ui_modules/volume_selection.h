@@ -81,9 +81,9 @@ class VolumeSelection : public ViewModule
 	struct Parameters
 	{
 		Parameters()
-			: vertex_position_(nullptr), vertex_scale_factor_(1.0), selected_vertices_set_(nullptr),
-			  selected_faces_set_(nullptr), selecting_cell_(VertexSelect), selection_method_(SingleCell),
-			  choosing_cell_(false)
+			: vertex_position_(nullptr), bvh_outdated_(false), vertex_scale_factor_(1.0),
+			  selected_vertices_set_(nullptr), selected_faces_set_(nullptr), selecting_cell_(VertexSelect),
+			  selection_method_(SingleCell), choosing_cell_(false)
 		{
 			param_point_sprite_ = rendering::ShaderPointSprite::generate_param();
 			param_point_sprite_->color_ = rendering::GLColor(1, 0, 0, 0.65f);
@@ -134,9 +134,23 @@ class VolumeSelection : public ViewModule
 			}
 		}
 
+		// hierarchy of the faces used for picking (built on first use, refitted after a motion of the vertices)
+		const geometry::SurfaceBVH<MESH>& bvh()
+		{
+			if (!bvh_)
+				bvh_ = std::make_unique<geometry::SurfaceBVH<MESH>>(*mesh_, vertex_position_);
+			else if (bvh_outdated_)
+				bvh_->refit();
+			bvh_outdated_ = false;
+			return *bvh_;
+		}
+
 		MESH* mesh_;
 		std::shared_ptr<Attribute<Vec3>> vertex_position_;
 
+		std::unique_ptr<geometry::SurfaceBVH<MESH>> bvh_;
+		bool bvh_outdated_;
+
 		std::unique_ptr<rendering::ShaderPointSprite::Param> param_point_sprite_;
 		std::unique_ptr<rendering::ShaderFlat::Param> param_flat_;
 
@@ -176,12 +190,15 @@ private:
 	{
 		Parameters& p = parameters_[m];
 		p.mesh_ = m;
+		mesh_connections_[m].push_back(boost::synapse::connect<typename MeshProvider<MESH>::connectivity_changed>(
+			m, [this, m]() { parameters_[m].bvh_.reset(); }));
 		mesh_connections_[m].push_back(
 			boost::synapse::connect<typename MeshProvider<MESH>::template attribute_changed_t<Vec3>>(
 				m, [this, m](Attribute<Vec3>* attribute) {
 					Parameters& p = parameters_[m];
 					if (p.vertex_position_.get() == attribute)
 					{
+						p.bvh_outdated_ = true;
 						p.vertex_base_size_ = float32(geometry::mean_edge_length(*m, p.vertex_position_.get()) / 6);
 						p.update_selected_vertices_vbo();
 						p.update_selected_faces_vbo();
@@ -220,6 +237,7 @@ public:
 		Parameters& p = parameters_[&m];
 
 		p.vertex_position_ = vertex_position;
+		p.bvh_.reset();
 		if (p.vertex_position_)
 		{
 			p.vertex_base_size_ = float32(geometry::mean_edge_length(m, p.vertex_position_.get()) / 6);
@@ -266,8 +284,7 @@ protected:
 						case VertexSelect:
 							if (p.selected_vertices_set_)
 							{
-								cgogn::geometry::picking(*selected_mesh_, p.vertex_position_.get(), A, B,
-														 p.picked_vertices_);
+								cgogn::geometry::picking(p.bvh(), A, B, p.picked_vertices_);
 								if (!p.picked_vertices_.empty())
 								{
 									p.choosing_cell_ = true;
@@ -293,8 +310,7 @@ protected:
 						case FaceSelect:
 							if (p.selected_faces_set_)
 							{
-								cgogn::geometry::picking(*selected_mesh_, p.vertex_position_.get(), A, B,
-														 p.picked_faces_);
+								cgogn::geometry::picking(p.bvh(), A, B, p.picked_faces_);
 								if (!p.picked_faces_.empty())
 								{
 									p.choosing_cell_ = true;
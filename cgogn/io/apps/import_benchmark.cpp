@@ -0,0 +1,229 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+
+#include <cgogn/io/surface/obj.h>
+#include <cgogn/io/surface/off.h>
+
+#include <cgogn/core/utils/string.h>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+#define DEFAULT_MESH_PATH CGOGN_STR(CGOGN_DATA_PATH) "/meshes/"
+
+using namespace cgogn;
+
+// reference std::istream based readers (the former implementation of import_OFF & import_OBJ)
+
+bool stream_parse_OFF(const std::string& filename, io::SurfaceImportData& surface_data)
+{
+	io::Scoped_C_Locale loc;
+
+	std::ifstream fp(filename.c_str(), std::ios::in);
+
+	std::string line;
+	line.reserve(512u);
+
+	io::getline_safe(fp, line);
+	if (line.rfind("OFF") == std::string::npos)
+		return false;
+
+	const uint32 nb_vertices = io::read_uint(fp, line);
+	const uint32 nb_faces = io::read_uint(fp, line);
+	io::read_uint(fp, line);
+
+	surface_data.reserve(nb_vertices, nb_faces);
+
+	for (uint32 i = 0u; i < nb_vertices; ++i)
+	{
+		float64 x = io::read_double(fp, line);
+		float64 y = io::read_double(fp, line);
+		float64 z = io::read_double(fp, line);
+		surface_data.vertex_position_.push_back({x, y, z});
+	}
+
+	for (uint32 i = 0u; i < nb_faces; ++i)
+	{
+		uint32 n = io::read_uint(fp, line);
+		std::vector<uint32> indices(n);
+		for (uint32 j = 0u; j < n; ++j)
+			indices[j] = io::read_uint(fp, line);
+		surface_data.faces_nb_vertices_.push_back(n);
+		surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(), indices.begin(),
+												  indices.end());
+	}
+
+	return true;
+}
+
+bool stream_parse_OBJ(const std::string& filename, io::SurfaceImportData& surface_data)
+{
+	io::Scoped_C_Locale loc;
+
+	std::ifstream fp(filename.c_str(), std::ios::in);
+
+	std::string line, tag;
+	line.reserve(512u);
+
+	do
+	{
+		fp >> tag;
+		if (tag == std::string("v"))
+		{
+			surface_data.nb_vertices_++;
+			float64 x = io::read_double(fp, line);
+			float64 y = io::read_double(fp, line);
+			float64 z = io::read_double(fp, line);
+			surface_data.vertex_position_.push_back({x, y, z});
+		}
+		io::getline_safe(fp, line);
+	} while (!fp.eof());
+
+	fp.clear();
+	fp.seekg(0, std::ios::beg);
+
+	do
+	{
+		fp >> tag;
+		io::getline_safe(fp, line);
+		if (tag == std::string("f"))
+		{
+			surface_data.nb_faces_++;
+			std::vector<uint32> indices;
+			std::istringstream iss(line);
+			std::string str;
+			while (!iss.eof())
+			{
+				iss >> str;
+				uint32 ind = 0;
+				while ((ind < str.length()) && (str[ind] != '/'))
+					ind++;
+				if (ind > 0)
+				{
+					uint32 index;
+					std::stringstream iss(str.substr(0, ind));
+					iss >> index;
+					indices.push_back(index - 1);
+				}
+			}
+			surface_data.faces_nb_vertices_.push_back(uint32(indices.size()));
+			surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(), indices.begin(),
+													  indices.end());
+		}
+	} while (!fp.eof());
+
+	return true;
+}
+
+bool mapped_parse(const std::string& filename, const std::string& ext, io::SurfaceImportData& surface_data)
+{
+	io::Scoped_C_Locale loc;
+
+	io::MappedFile file(filename);
+	if (!file.is_open())
+		return false;
+
+	if (ext == "obj")
+		return io::internal::parse_OBJ(file.begin(), file.end(), surface_data);
+
+	const char* p = file.begin();
+	const char* end = file.end();
+	uint32 nb_vertices = 0u, nb_faces = 0u;
+	p = io::skip_to_data(io::next_line(p, end), end);
+	bool valid = io::parse_uint(p, end, nb_vertices);
+	p = io::skip_to_data(p, end);
+	valid = valid && io::parse_uint(p, end, nb_faces);
+	return valid && io::internal::parse_OFF_body(io::next_line(p, end), end, nb_vertices, nb_faces, surface_data);
+}
+
+template <typename FUNC>
+float64 best_time(uint32 nb_runs, const FUNC& f)
+{
+	float64 best = std::numeric_limits<float64>::max();
+	for (uint32 i = 0u; i < nb_runs; ++i)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		f();
+		auto end = std::chrono::high_resolution_clock::now();
+		best = std::min(best, std::chrono::duration<float64>(end - start).count());
+	}
+	return best;
+}
+
+int main(int argc, char** argv)
+{
+	std::string filename;
+	if (argc < 2)
+		filename = std::string(DEFAULT_MESH_PATH) + std::string("off/horse.off");
+	else
+		filename = std::string(argv[1]);
+	const uint32 nb_runs = argc < 3 ? 3u : uint32(std::stoul(argv[2]));
+
+	const std::string ext = to_lower(extension(filename));
+	if (ext != "off" && ext != "obj")
+	{
+		std::cerr << "usage: " << argv[0] << " file.{off|obj} [nb_runs]" << std::endl;
+		return 1;
+	}
+
+	io::MappedFile file(filename);
+	if (!file.is_open())
+	{
+		std::cerr << "Unable to open file \"" << filename << "\"." << std::endl;
+		return 1;
+	}
+	const float64 size = float64(file.size()) / (1024.0 * 1024.0);
+	file.close();
+
+	std::cout << filename << ": " << size << " MB, " << thread_pool()->nb_workers() << " workers" << std::endl;
+
+	io::SurfaceImportData stream_data, mapped_data;
+	const float64 stream_time = best_time(nb_runs, [&]() {
+		stream_data = io::SurfaceImportData();
+		ext == "obj" ? stream_parse_OBJ(filename, stream_data) : stream_parse_OFF(filename, stream_data);
+	});
+	const float64 mapped_time = best_time(nb_runs, [&]() {
+		mapped_data = io::SurfaceImportData();
+		if (!mapped_parse(filename, ext, mapped_data))
+			std::cerr << "parse error" << std::endl;
+	});
+
+	// (faces_nb_vertices_ is not compared: the stream OBJ reader adds an empty face when the file ends with a face)
+	const bool same = stream_data.vertex_position_ == mapped_data.vertex_position_ &&
+					  stream_data.faces_vertex_indices_ == mapped_data.faces_vertex_indices_;
+
+	std::cout << "parse (stream): " << stream_time << " s, " << size / stream_time << " MB/s" << std::endl;
+	std::cout << "parse (mapped): " << mapped_time << " s, " << size / mapped_time << " MB/s" << std::endl;
+	std::cout << "speedup: " << stream_time / mapped_time << (same ? "" : " (results differ!)") << std::endl;
+
+	const float64 import_time = best_time(nb_runs, [&]() {
+		CMap2 m;
+		ext == "obj" ? io::import_OBJ(m, filename) : io::import_OFF(m, filename);
+	});
+	std::cout << "import (mapped): " << import_time << " s" << std::endl;
+
+	return same ? 0 : 1;
+}
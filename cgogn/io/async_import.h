@@ -0,0 +1,163 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_IO_ASYNC_IMPORT_H_
+#define CGOGN_IO_ASYNC_IMPORT_H_
+
+#include <cgogn/io/import_progress.h>
+
+#include <cgogn/core/utils/thread.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+
+namespace cgogn
+{
+
+namespace io
+{
+
+///////////////////////
+// AsyncImport class //
+///////////////////////
+
+/**
+ * Import of a mesh run by a background thread.
+ * The mesh is created and filled by the background thread and is only given to the caller (see get) once the import
+ * is complete, so that it is never visible in a partial state. The parallel parts of the import use the pool of the
+ * calling thread (see thread_pool): several imports can run at the same time and share this pool.
+ */
+template <typename MESH>
+class AsyncImport
+{
+public:
+	using ImportFunction = std::function<bool(MESH&, const std::string&)>;
+
+	AsyncImport(const std::string& filename, const ImportFunction& import)
+		: filename_(filename), progress_(std::make_shared<ImportProgress>())
+	{
+		ThreadPool* pool = thread_pool();
+		result_ = std::async(std::launch::async, [filename, import, pool, progress = progress_]() {
+			// the background thread has its own thread index (e.g. for its markers)
+			const uint32 thread_index = acquire_thread_index();
+			thread_start(thread_index);
+			std::unique_ptr<MESH> m;
+			{
+				ThreadPoolScope pool_scope(pool);
+				m = run(filename, import, *progress);
+			}
+			thread_stop();
+			release_thread_index(thread_index);
+			return m;
+		});
+	}
+
+	// an import that is still running when its handle is destroyed is cancelled (and waited for)
+	~AsyncImport()
+	{
+		if (result_.valid())
+		{
+			progress_->cancel();
+			result_.wait();
+		}
+	}
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(AsyncImport);
+
+	inline const std::string& filename() const
+	{
+		return filename_;
+	}
+	inline const ImportProgress& progress() const
+	{
+		return *progress_;
+	}
+	inline void cancel()
+	{
+		progress_->cancel();
+	}
+
+	// the result is available: get does not block
+	bool is_ready() const
+	{
+		return !result_.valid() || result_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	/**
+	 * @brief wait for the end of the import and take the imported mesh
+	 * @return the mesh or nullptr if the import failed or has been cancelled (or if the mesh has already been taken)
+	 */
+	std::unique_ptr<MESH> get()
+	{
+		if (!result_.valid())
+			return nullptr;
+		return result_.get();
+	}
+
+private:
+	static std::unique_ptr<MESH> run(const std::string& filename, const ImportFunction& import,
+									 ImportProgress& progress)
+	{
+		ImportProgressScope progress_scope(&progress);
+		progress.set_phase(ImportPhase::Reading);
+		std::unique_ptr<MESH> m = std::make_unique<MESH>();
+		const bool imported = import(*m, filename);
+		if (progress.cancel_requested())
+		{
+			progress.set_phase(ImportPhase::Cancelled);
+			return std::unique_ptr<MESH>();
+		}
+		if (!imported)
+		{
+			progress.set_phase(ImportPhase::Failed);
+			return std::unique_ptr<MESH>();
+		}
+		progress.set_phase(ImportPhase::Done);
+		return m;
+	}
+
+	std::string filename_;
+	std::shared_ptr<ImportProgress> progress_;
+	std::future<std::unique_ptr<MESH>> result_;
+};
+
+/**
+ * @brief start the import of the given file by a background thread
+ * @param import function that imports the file in the given (empty) mesh and returns false on failure
+ * (e.g. [](CMap2& m, const std::string& f) { return import_OFF(m, f); })
+ */
+template <typename MESH>
+std::shared_ptr<AsyncImport<MESH>> import_async(const std::string& filename,
+												const typename AsyncImport<MESH>::ImportFunction& import)
+{
+	return std::make_shared<AsyncImport<MESH>>(filename, import);
+}
+
+} // namespace io
+
+} // namespace cgogn
+
+#endif // CGOGN_IO_ASYNC_IMPORT_H_
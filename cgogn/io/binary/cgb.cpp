@@ -0,0 +1,924 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/io/binary/cgb.h>
+#include <cgogn/io/mapped_file.h>
+
+#include <cgogn/core/types/incidence_graph/incidence_graph.h>
+#include <cgogn/core/types/maps/cmap/cmap3.h>
+#include <cgogn/core/types/maps/cmap/cph3.h>
+#include <cgogn/core/types/maps/cmap/graph.h>
+#include <cgogn/core/types/maps/gmap/gmap2.h>
+#include <cgogn/core/types/maps/gmap/gmap3.h>
+
+#include <cgogn/geometry/types/vector_traits.h>
+
+#include <algorithm>
+#include <any>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+namespace cgogn
+{
+
+namespace io
+{
+
+namespace
+{
+
+using AttributeContainer = MapBase::AttributeContainer;
+static_assert(std::is_same_v<AttributeContainer, IncidenceGraphBase::AttributeContainer>,
+			  "Maps and incidence graphs should use the same attribute containers");
+
+const char CGB_MAGIC[8] = {'C', 'G', 'o', 'G', 'N', 'C', 'G', 'B'};
+const uint32 CGB_VERSION = 1u;
+// the attributes payloads are aligned like the chunks of the pool so that they can be adopted from the mapped file
+const uint64 CGB_ALIGNMENT = ChunkPool::ALIGNMENT;
+
+enum AttributeKind : uint8
+{
+	USER_ATTRIBUTE = 0,
+	REF_COUNTER,
+	BOUNDARY_MARKER
+};
+
+inline uint64 aligned(uint64 offset)
+{
+	return (offset + CGB_ALIGNMENT - 1u) / CGB_ALIGNMENT * CGB_ALIGNMENT;
+}
+
+////////////////////////////
+// Writer & Reader classes //
+////////////////////////////
+
+class Writer
+{
+public:
+	explicit Writer(const std::string& filename) : out_(filename, std::ios::out | std::ios::binary)
+	{
+	}
+
+	inline bool good() const
+	{
+		return out_.good();
+	}
+
+	inline uint64 position()
+	{
+		return uint64(out_.tellp());
+	}
+
+	inline void write_bytes(const void* data, uint64 size)
+	{
+		out_.write(static_cast<const char*>(data), std::streamsize(size));
+	}
+
+	template <typename T>
+	inline void write_value(const T& value)
+	{
+		write_bytes(&value, sizeof(T));
+	}
+
+	inline void write_string(const std::string& s)
+	{
+		write_value(uint32(s.size()));
+		write_bytes(s.data(), s.size());
+	}
+
+	template <typename T>
+	inline void write_vector(const std::vector<T>& v)
+	{
+		write_value(uint64(v.size()));
+		write_bytes(v.data(), v.size() * sizeof(T));
+	}
+
+	inline void align()
+	{
+		static const char zeros[CGB_ALIGNMENT] = {};
+		const uint64 p = position();
+		write_bytes(zeros, aligned(p) - p);
+	}
+
+	// a block is an aligned payload preceded by its size (written by end_block once it is known)
+	inline uint64 begin_block()
+	{
+		const uint64 size_position = position();
+		write_value(uint64(0u));
+		align();
+		return size_position;
+	}
+
+	inline void end_block(uint64 size_position)
+	{
+		const uint64 end = position();
+		out_.seekp(std::streamoff(size_position));
+		write_value(end - aligned(size_position + sizeof(uint64)));
+		out_.seekp(std::streamoff(end));
+	}
+
+private:
+	std::ofstream out_;
+};
+
+class Reader
+{
+public:
+	Reader(const char* begin, const char* end) : begin_(begin), p_(begin), end_(end), valid_(true)
+	{
+	}
+
+	inline bool valid() const
+	{
+		return valid_;
+	}
+
+	inline const char* read_bytes(uint64 size)
+	{
+		if (!valid_ || uint64(end_ - p_) < size)
+		{
+			valid_ = false;
+			return nullptr;
+		}
+		const char* data = p_;
+		p_ += size;
+		return data;
+	}
+
+	template <typename T>
+	inline T read_value()
+	{
+		T value{};
+		if (const char* data = read_bytes(sizeof(T)))
+			std::memcpy(&value, data, sizeof(T));
+		return value;
+	}
+
+	inline std::string read_string()
+	{
+		const uint32 size = read_value<uint32>();
+		const char* data = read_bytes(size);
+		return data ? std::string(data, size) : std::string();
+	}
+
+	template <typename T>
+	inline std::vector<T> read_vector()
+	{
+		const uint64 size = read_value<uint64>();
+		std::vector<T> v;
+		if (valid_ && size <= uint64(end_ - p_) / sizeof(T))
+		{
+			v.resize(size);
+			std::memcpy(v.data(), read_bytes(size * sizeof(T)), size * sizeof(T));
+		}
+		else
+			valid_ = false;
+		return v;
+	}
+
+	inline void align()
+	{
+		const uint64 offset = uint64(p_ - begin_);
+		read_bytes(aligned(offset) - offset);
+	}
+
+	inline std::pair<const char*, uint64> read_block()
+	{
+		const uint64 size = read_value<uint64>();
+		align();
+		return {read_bytes(size), size};
+	}
+
+private:
+	const char* begin_;
+	const char* p_;
+	const char* end_;
+	bool valid_;
+};
+
+struct ImportContext
+{
+	std::shared_ptr<MappedFile> file_;
+	uint32 chunk_size_;
+};
+
+////////////////////////////////
+// Attributes serializers     //
+////////////////////////////////
+
+class AttributeSerializer
+{
+public:
+	explicit AttributeSerializer(const std::string& type_name) : type_name_(type_name)
+	{
+	}
+	virtual ~AttributeSerializer()
+	{
+	}
+
+	inline const std::string& type_name() const
+	{
+		return type_name_;
+	}
+
+	virtual bool handles(const AttributeGenT* attribute) const = 0;
+	virtual std::shared_ptr<AttributeGenT> add(AttributeContainer& container, const std::string& name) const = 0;
+	// the values of the indices [0, container.maximum_index()) are saved (zeroed or empty for the unused indices)
+	virtual void write(Writer& w, const AttributeGenT* attribute, const AttributeContainer& container) const = 0;
+	virtual bool read(const char* payload, uint64 size, AttributeGenT* attribute, uint32 maximum_index,
+					  const ImportContext& context) const = 0;
+
+private:
+	std::string type_name_;
+};
+
+// plain values: the payload is the sequence of the chunks of the attribute
+template <typename T>
+class ChunksSerializer : public AttributeSerializer
+{
+	static_assert(std::is_trivially_destructible_v<T> && std::is_standard_layout_v<T>,
+				  "Only plain types can be saved as raw chunks");
+
+public:
+	using AttributeSerializer::AttributeSerializer;
+
+	bool handles(const AttributeGenT* attribute) const override
+	{
+		return dynamic_cast<const ChunkArray<T>*>(attribute) != nullptr;
+	}
+
+	std::shared_ptr<AttributeGenT> add(AttributeContainer& container, const std::string& name) const override
+	{
+		return container.add_attribute<T>(name);
+	}
+
+	void write(Writer& w, const AttributeGenT* attribute, const AttributeContainer& container) const override
+	{
+		const ChunkArray<T>* ca = static_cast<const ChunkArray<T>*>(attribute);
+		const uint32 chunk_size = ChunkArray<T>::CHUNK_SIZE;
+		// the chunks that contain unused indices are written from a copy where their values are zeroed
+		// (so that the same mesh always gives the same file)
+		std::unique_ptr<T[]> buffer;
+		uint32 first = 0u;
+		for (const void* chunk : ca->chunk_pointers())
+		{
+			const T* values = static_cast<const T*>(chunk);
+			bool copied = false;
+			for (uint32 i = 0u; i < chunk_size; ++i)
+			{
+				if (!container.is_live(first + i))
+				{
+					if (!buffer)
+						buffer = std::make_unique<T[]>(chunk_size);
+					if (!copied)
+						std::copy(values, values + chunk_size, buffer.get());
+					copied = true;
+					std::memset(static_cast<void*>(&buffer[i]), 0, sizeof(T));
+				}
+			}
+			w.write_bytes(copied ? buffer.get() : chunk, sizeof(T) * chunk_size);
+			first += chunk_size;
+		}
+	}
+
+	bool read(const char* payload, uint64 size, AttributeGenT* attribute, uint32 maximum_index,
+			  const ImportContext& context) const override
+	{
+		ChunkArray<T>* ca = static_cast<ChunkArray<T>*>(attribute);
+		const uint64 chunk_bytes = sizeof(T) * context.chunk_size_;
+		if (size % chunk_bytes != 0u || size / sizeof(T) < maximum_index)
+			return false;
+		const uint32 nb_chunks = uint32(size / chunk_bytes);
+
+		if (context.chunk_size_ == ChunkArray<T>::CHUNK_SIZE)
+		{
+			// the mapping is copy on write: the adopted chunks can be modified
+			std::vector<T*> chunks(nb_chunks);
+			for (uint32 i = 0u; i < nb_chunks; ++i)
+				chunks[i] = reinterpret_cast<T*>(const_cast<char*>(payload) + i * chunk_bytes);
+			ca->adopt_chunks(chunks, context.file_, context.file_->begin(), context.file_->end());
+		}
+		else
+		{
+			const T* values = reinterpret_cast<const T*>(payload);
+			for (uint32 i = 0u; i < maximum_index; ++i)
+				(*ca)[i] = values[i];
+		}
+		return true;
+	}
+};
+
+// vectors of plain values: the payload is the sizes of the vectors followed by their concatenated elements
+template <typename T>
+class VectorsSerializer : public AttributeSerializer
+{
+	static_assert(std::is_trivially_destructible_v<T> && std::is_standard_layout_v<T>,
+				  "Only vectors of plain types can be saved");
+
+public:
+	using AttributeSerializer::AttributeSerializer;
+
+	bool handles(const AttributeGenT* attribute) const override
+	{
+		return dynamic_cast<const ChunkArray<std::vector<T>>*>(attribute) != nullptr;
+	}
+
+	std::shared_ptr<AttributeGenT> add(AttributeContainer& container, const std::string& name) const override
+	{
+		return container.add_attribute<std::vector<T>>(name);
+	}
+
+	void write(Writer& w, const AttributeGenT* attribute, const AttributeContainer& container) const override
+	{
+		const ChunkArray<std::vector<T>>& ca = *static_cast<const ChunkArray<std::vector<T>>*>(attribute);
+		const uint32 maximum_index = container.maximum_index();
+		// (the vectors of the unused indices are saved empty)
+		std::vector<uint32> sizes(maximum_index, 0u);
+		for (uint32 i = 0u; i < maximum_index; ++i)
+			if (container.is_live(i))
+				sizes[i] = uint32(ca[i].size());
+		w.write_bytes(sizes.data(), sizes.size() * sizeof(uint32));
+		for (uint32 i = 0u; i < maximum_index; ++i)
+			w.write_bytes(ca[i].data(), sizes[i] * sizeof(T));
+	}
+
+	bool read(const char* payload, uint64 size, AttributeGenT* attribute, uint32 maximum_index,
+			  const ImportContext&) const override
+	{
+		ChunkArray<std::vector<T>>& ca = *static_cast<ChunkArray<std::vector<T>>*>(attribute);
+		if (size < uint64(maximum_index) * sizeof(uint32))
+			return false;
+		const uint32* sizes = reinterpret_cast<const uint32*>(payload);
+		const char* p = payload + uint64(maximum_index) * sizeof(uint32);
+		const char* end = payload + size;
+		for (uint32 i = 0u; i < maximum_index; ++i)
+		{
+			const uint64 bytes = uint64(sizes[i]) * sizeof(T);
+			if (uint64(end - p) < bytes)
+				return false;
+			ca[i].resize(sizes[i]);
+			std::memcpy(ca[i].data(), p, bytes);
+			p += bytes;
+		}
+		return true;
+	}
+};
+
+const std::vector<std::unique_ptr<AttributeSerializer>>& attribute_serializers()
+{
+	using IG = IncidenceGraphBase;
+	static const std::vector<std::unique_ptr<AttributeSerializer>> serializers = []() {
+		std::vector<std::unique_ptr<AttributeSerializer>> s;
+		s.push_back(std::make_unique<ChunksSerializer<bool>>("bool"));
+		s.push_back(std::make_unique<ChunksSerializer<int8>>("int8"));
+		s.push_back(std::make_unique<ChunksSerializer<uint8>>("uint8"));
+		s.push_back(std::make_unique<ChunksSerializer<int16>>("int16"));
+		s.push_back(std::make_unique<ChunksSerializer<uint16>>("uint16"));
+		s.push_back(std::make_unique<ChunksSerializer<int32>>("int32"));
+		s.push_back(std::make_unique<ChunksSerializer<uint32>>("uint32"));
+		s.push_back(std::make_unique<ChunksSerializer<int64>>("int64"));
+		s.push_back(std::make_unique<ChunksSerializer<uint64>>("uint64"));
+		s.push_back(std::make_unique<ChunksSerializer<float32>>("float32"));
+		s.push_back(std::make_unique<ChunksSerializer<float64>>("float64"));
+		s.push_back(std::make_unique<ChunksSerializer<Dart>>("Dart"));
+		s.push_back(std::make_unique<ChunksSerializer<geometry::Vec2>>("Vec2"));
+		s.push_back(std::make_unique<ChunksSerializer<geometry::Vec3>>("Vec3"));
+		s.push_back(std::make_unique<ChunksSerializer<geometry::Vec4>>("Vec4"));
+		s.push_back(std::make_unique<ChunksSerializer<geometry::Vec2f>>("Vec2f"));
+		s.push_back(std::make_unique<ChunksSerializer<geometry::Vec3f>>("Vec3f"));
+		s.push_back(std::make_unique<ChunksSerializer<geometry::Vec4f>>("Vec4f"));
+		s.push_back(std::make_unique<ChunksSerializer<geometry::Vec2i>>("Vec2i"));
+		s.push_back(std::make_unique<ChunksSerializer<geometry::Vec3i>>("Vec3i"));
+		s.push_back(std::make_unique<ChunksSerializer<geometry::Vec4i>>("Vec4i"));
+		s.push_back(std::make_unique<ChunksSerializer<geometry::Mat2>>("Mat2"));
+		s.push_back(std::make_unique<ChunksSerializer<geometry::Mat3>>("Mat3"));
+		s.push_back(std::make_unique<ChunksSerializer<geometry::Mat4>>("Mat4"));
+		s.push_back(std::make_unique<ChunksSerializer<IG::Vertex>>("IncidenceGraph::Vertex"));
+		s.push_back(std::make_unique<ChunksSerializer<IG::Edge>>("IncidenceGraph::Edge"));
+		s.push_back(std::make_unique<ChunksSerializer<IG::Face>>("IncidenceGraph::Face"));
+		s.push_back(std::make_unique<ChunksSerializer<std::pair<IG::Vertex, IG::Vertex>>>(
+			"std::pair<IncidenceGraph::Vertex,IncidenceGraph::Vertex>"));
+		s.push_back(std::make_unique<VectorsSerializer<uint8>>("std::vector<uint8>"));
+		s.push_back(std::make_unique<VectorsSerializer<uint32>>("std::vector<uint32>"));
+		s.push_back(std::make_unique<VectorsSerializer<Dart>>("std::vector<Dart>"));
+		s.push_back(std::make_unique<VectorsSerializer<IG::Edge>>("std::vector<IncidenceGraph::Edge>"));
+		s.push_back(std::make_unique<VectorsSerializer<IG::Face>>("std::vector<IncidenceGraph::Face>"));
+		return s;
+	}();
+	return serializers;
+}
+
+const AttributeSerializer* attribute_serializer(const AttributeGenT* attribute)
+{
+	for (const auto& s : attribute_serializers())
+		if (s->handles(attribute))
+			return s.get();
+	return nullptr;
+}
+
+const AttributeSerializer* attribute_serializer(const std::string& type_name)
+{
+	for (const auto& s : attribute_serializers())
+		if (s->type_name() == type_name)
+			return s.get();
+	return nullptr;
+}
+
+/////////////////////////////////////
+// Mesh-wise attributes serializers //
+/////////////////////////////////////
+
+class ValueSerializer
+{
+public:
+	explicit ValueSerializer(const std::string& type_name) : type_name_(type_name)
+	{
+	}
+	virtual ~ValueSerializer()
+	{
+	}
+
+	inline const std::string& type_name() const
+	{
+		return type_name_;
+	}
+
+	virtual bool handles(const std::any& value) const = 0;
+	virtual void write(Writer& w, const std::any& value) const = 0;
+	// the existing value is overwritten in place (references to it remain valid) if it has the same type
+	virtual bool read(const char* payload, uint64 size, std::any& value) const = 0;
+
+private:
+	std::string type_name_;
+};
+
+template <typename T>
+class PlainValueSerializer : public ValueSerializer
+{
+public:
+	using ValueSerializer::ValueSerializer;
+
+	bool handles(const std::any& value) const override
+	{
+		return std::any_cast<T>(&value) != nullptr;
+	}
+
+	void write(Writer& w, const std::any& value) const override
+	{
+		w.write_value(*std::any_cast<T>(&value));
+	}
+
+	bool read(const char* payload, uint64 size, std::any& value) const override
+	{
+		if (size != sizeof(T))
+			return false;
+		if (!handles(value))
+			value = T();
+		std::memcpy(std::any_cast<T>(&value), payload, sizeof(T));
+		return true;
+	}
+};
+
+template <typename T>
+class VectorValueSerializer : public ValueSerializer
+{
+public:
+	using ValueSerializer::ValueSerializer;
+
+	bool handles(const std::any& value) const override
+	{
+		return std::any_cast<std::vector<T>>(&value) != nullptr;
+	}
+
+	void write(Writer& w, const std::any& value) const override
+	{
+		const std::vector<T>& v = *std::any_cast<std::vector<T>>(&value);
+		w.write_bytes(v.data(), v.size() * sizeof(T));
+	}
+
+	bool read(const char* payload, uint64 size, std::any& value) const override
+	{
+		if (size % sizeof(T) != 0u)
+			return false;
+		if (!handles(value))
+			value = std::vector<T>();
+		std::vector<T>& v = *std::any_cast<std::vector<T>>(&value);
+		v.resize(size / sizeof(T));
+		std::memcpy(v.data(), payload, size);
+		return true;
+	}
+};
+
+const std::vector<std::unique_ptr<ValueSerializer>>& value_serializers()
+{
+	static const std::vector<std::unique_ptr<ValueSerializer>> serializers = []() {
+		std::vector<std::unique_ptr<ValueSerializer>> s;
+		s.push_back(std::make_unique<PlainValueSerializer<bool>>("bool"));
+		s.push_back(std::make_unique<PlainValueSerializer<int32>>("int32"));
+		s.push_back(std::make_unique<PlainValueSerializer<uint32>>("uint32"));
+		s.push_back(std::make_unique<PlainValueSerializer<uint64>>("uint64"));
+		s.push_back(std::make_unique<PlainValueSerializer<float32>>("float32"));
+		s.push_back(std::make_unique<PlainValueSerializer<float64>>("float64"));
+		s.push_back(std::make_unique<VectorValueSerializer<uint32>>("std::vector<uint32>"));
+		s.push_back(std::make_unique<VectorValueSerializer<float64>>("std::vector<float64>"));
+		return s;
+	}();
+	return serializers;
+}
+
+///////////////////////////////
+// Containers & mesh sections //
+///////////////////////////////
+
+void write_header(Writer& w, const std::string& mesh_type)
+{
+	w.write_bytes(CGB_MAGIC, sizeof(CGB_MAGIC));
+	w.write_value(CGB_VERSION);
+	w.write_value(uint32(ChunkArray<uint32>::CHUNK_SIZE));
+	w.write_string(mesh_type);
+}
+
+bool read_header(Reader& r, const std::string& mesh_type, ImportContext& context, const std::string& filename)
+{
+	const char* magic = r.read_bytes(sizeof(CGB_MAGIC));
+	if (magic == nullptr || std::memcmp(magic, CGB_MAGIC, sizeof(CGB_MAGIC)) != 0)
+	{
+		std::cerr << "File \"" << filename << "\" is not a valid cgb file." << std::endl;
+		return false;
+	}
+	const uint32 version = r.read_value<uint32>();
+	if (version != CGB_VERSION)
+	{
+		std::cerr << "File \"" << filename << "\" has an unsupported cgb version (" << version << ")." << std::endl;
+		return false;
+	}
+	context.chunk_size_ = r.read_value<uint32>();
+	const std::string file_mesh_type = r.read_string();
+	if (!r.valid() || context.chunk_size_ == 0u)
+	{
+		std::cerr << "File \"" << filename << "\" is not a valid cgb file." << std::endl;
+		return false;
+	}
+	if (file_mesh_type != mesh_type)
+	{
+		std::cerr << "File \"" << filename << "\" contains a " << file_mesh_type << " (" << mesh_type << " expected)."
+				  << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void write_values(Writer& w, const std::unordered_map<std::string, std::any>& values)
+{
+	std::vector<std::pair<const ValueSerializer*, const std::pair<const std::string, std::any>*>> saved;
+	for (const auto& value : values)
+	{
+		auto it = std::find_if(value_serializers().begin(), value_serializers().end(),
+							   [&](const auto& s) { return s->handles(value.second); });
+		if (it != value_serializers().end())
+			saved.emplace_back(it->get(), &value);
+		else
+			std::cerr << "export_CGB: mesh attribute \"" << value.first << "\" of unsupported type is not saved"
+					  << std::endl;
+	}
+
+	// (sorted by name: the order of the unordered_map may differ for the same values)
+	std::sort(saved.begin(), saved.end(),
+			  [](const auto& a, const auto& b) { return a.second->first < b.second->first; });
+
+	w.write_value(uint32(saved.size()));
+	for (const auto& [s, value] : saved)
+	{
+		w.write_string(value->first);
+		w.write_string(s->type_name());
+		const uint64 block = w.begin_block();
+		s->write(w, value->second);
+		w.end_block(block);
+	}
+}
+
+bool read_values(Reader& r, std::unordered_map<std::string, std::any>& values)
+{
+	const uint32 nb_values = r.read_value<uint32>();
+	for (uint32 i = 0u; i < nb_values && r.valid(); ++i)
+	{
+		const std::string name = r.read_string();
+		const std::string type_name = r.read_string();
+		auto [payload, size] = r.read_block();
+		if (!r.valid())
+			return false;
+		auto it = std::find_if(value_serializers().begin(), value_serializers().end(),
+							   [&](const auto& s) { return s->type_name() == type_name; });
+		if (it == value_serializers().end())
+		{
+			std::cerr << "import_CGB: mesh attribute \"" << name << "\" of unknown type " << type_name
+					  << " is skipped" << std::endl;
+			continue;
+		}
+		if (!(*it)->read(payload, size, values[name]))
+			return false;
+	}
+	return r.valid();
+}
+
+void write_attribute(Writer& w, AttributeKind kind, const std::string& name, const AttributeSerializer* s,
+					 const AttributeGenT* attribute, const AttributeContainer& container)
+{
+	w.write_value(uint8(kind));
+	w.write_string(name);
+	w.write_string(s->type_name());
+	const uint64 block = w.begin_block();
+	s->write(w, attribute, container);
+	w.end_block(block);
+}
+
+void write_container(Writer& w, const AttributeContainer& container, const AttributeGenT* boundary_marker)
+{
+	const uint32 maximum_index = container.maximum_index();
+	w.write_value(container.nb_elements());
+	w.write_value(maximum_index);
+	w.write_vector(container.available_indices());
+	w.write_vector(container.live_indices());
+
+	std::vector<std::tuple<AttributeKind, std::string, const AttributeSerializer*, const AttributeGenT*>> attributes;
+	attributes.emplace_back(REF_COUNTER, "__refs", attribute_serializer(container.ref_counter()),
+							container.ref_counter());
+	if (boundary_marker != nullptr)
+		attributes.emplace_back(BOUNDARY_MARKER, "__boundary", attribute_serializer(boundary_marker), boundary_marker);
+	for (const std::shared_ptr<AttributeGenT>& attribute : container)
+	{
+		if (const AttributeSerializer* s = attribute_serializer(attribute.get()))
+			attributes.emplace_back(USER_ATTRIBUTE, attribute->name(), s, attribute.get());
+		else
+			std::cerr << "export_CGB: attribute \"" << attribute->name() << "\" of unsupported type is not saved"
+					  << std::endl;
+	}
+
+	w.write_value(uint32(attributes.size()));
+	for (const auto& [kind, name, s, attribute] : attributes)
+		write_attribute(w, kind, name, s, attribute, container);
+}
+
+bool read_container(Reader& r, AttributeContainer& container, AttributeGenT* boundary_marker,
+					const ImportContext& context)
+{
+	const uint32 nb_elements = r.read_value<uint32>();
+	const uint32 maximum_index = r.read_value<uint32>();
+	const std::vector<uint32> available_indices = r.read_vector<uint32>();
+	const std::vector<uint64> live = r.read_vector<uint64>();
+	if (!r.valid() || uint64(live.size()) * 64u < maximum_index)
+		return false;
+
+	container.restore_indices(nb_elements, maximum_index, available_indices, live);
+
+	const uint32 nb_attributes = r.read_value<uint32>();
+	for (uint32 i = 0u; i < nb_attributes && r.valid(); ++i)
+	{
+		const AttributeKind kind = AttributeKind(r.read_value<uint8>());
+		const std::string name = r.read_string();
+		const std::string type_name = r.read_string();
+		auto [payload, size] = r.read_block();
+		if (!r.valid())
+			return false;
+
+		const AttributeSerializer* s = attribute_serializer(type_name);
+		if (s == nullptr)
+		{
+			std::cerr << "import_CGB: attribute \"" << name << "\" of unknown type " << type_name << " is skipped"
+					  << std::endl;
+			continue;
+		}
+
+		AttributeGenT* attribute = nullptr;
+		if (kind == REF_COUNTER)
+			attribute = container.ref_counter();
+		else if (kind == BOUNDARY_MARKER)
+			attribute = boundary_marker;
+		else
+		{
+			// the existing attributes (e.g. topological relations) are filled
+			auto it = std::find_if(container.begin(), container.end(),
+								   [&](const std::shared_ptr<AttributeGenT>& a) { return a->name() == name; });
+			attribute = it != container.end() ? it->get() : s->add(container, name).get();
+		}
+		if (attribute == nullptr || !s->handles(attribute))
+		{
+			std::cerr << "import_CGB: attribute \"" << name << "\" does not match the existing one" << std::endl;
+			return false;
+		}
+		if (!s->read(payload, size, attribute, maximum_index, context))
+			return false;
+	}
+	return r.valid();
+}
+
+// write_data(w) & read_data(r) save & restore the data of the mesh type that are not in its containers
+template <typename MESH, typename WRITE_DATA>
+bool export_mesh(const MESH& m, const std::string& mesh_type, const std::string& filename,
+				 const WRITE_DATA& write_data)
+{
+	Writer w(filename);
+	if (!w.good())
+	{
+		std::cerr << "Unable to open file \"" << filename << "\"." << std::endl;
+		return false;
+	}
+
+	write_header(w, mesh_type);
+	write_values(w, m.attributes_);
+	if constexpr (std::is_convertible_v<const MESH&, const MapBase&>)
+		write_container(w, m.darts_, m.boundary_marker_);
+	for (const AttributeContainer& container : m.attribute_containers_)
+		write_container(w, container, nullptr);
+	write_data(w);
+
+	if (!w.good())
+	{
+		std::cerr << "Error while writing file \"" << filename << "\"." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+template <typename MESH, typename READ_DATA>
+bool import_mesh(MESH& m, const std::string& mesh_type, const std::string& filename, const READ_DATA& read_data)
+{
+	bool empty = true;
+	if constexpr (std::is_convertible_v<MESH&, MapBase&>)
+		empty = m.darts_.nb_elements() == 0u;
+	for (const AttributeContainer& container : m.attribute_containers_)
+		empty &= container.nb_elements() == 0u;
+	if (!empty)
+	{
+		std::cerr << "import_CGB: the mesh should be empty." << std::endl;
+		return false;
+	}
+
+	ImportContext context;
+	context.file_ = std::make_shared<MappedFile>();
+	if (!context.file_->open(filename, true))
+	{
+		std::cerr << "Unable to open file \"" << filename << "\"." << std::endl;
+		return false;
+	}
+
+	Reader r(context.file_->begin(), context.file_->end());
+	if (!read_header(r, mesh_type, context, filename))
+		return false;
+
+	bool valid = read_values(r, m.attributes_);
+	if constexpr (std::is_convertible_v<MESH&, MapBase&>)
+	{
+		// the cells indices are those of the file
+		for (auto& cells_indices : m.cells_indices_)
+		{
+			if (cells_indices != nullptr)
+			{
+				m.darts_.remove_attribute(cells_indices);
+				cells_indices.reset();
+			}
+		}
+		valid = valid && read_container(r, m.darts_, m.boundary_marker_, context);
+	}
+	for (AttributeContainer& container : m.attribute_containers_)
+		valid = valid && read_container(r, container, nullptr, context);
+	valid = valid && read_data(r) && r.valid();
+
+	if (!valid)
+	{
+		std::cerr << "File \"" << filename << "\" is not a valid cgb file." << std::endl;
+		return false;
+	}
+
+	if constexpr (std::is_convertible_v<MESH&, MapBase&>)
+	{
+		for (uint32 orbit = 0; orbit < NB_ORBITS; ++orbit)
+		{
+			std::ostringstream oss;
+			oss << "__index_" << orbit_name(Orbit(orbit));
+			m.cells_indices_[orbit] = m.darts_.template get_attribute<uint32>(oss.str());
+			if (m.cells_indices_[orbit] != nullptr)
+				m.cells_indices_[orbit]->set_zero_initialization(false);
+		}
+		++m.topology_version_;
+	}
+
+	return true;
+}
+
+template <typename MESH>
+bool export_mesh(const MESH& m, const std::string& mesh_type, const std::string& filename)
+{
+	return export_mesh(m, mesh_type, filename, [](Writer&) {});
+}
+
+template <typename MESH>
+bool import_mesh(MESH& m, const std::string& mesh_type, const std::string& filename)
+{
+	return import_mesh(m, mesh_type, filename, [](Reader&) { return true; });
+}
+
+} // namespace
+
+bool export_CGB(const CMap2& m, const std::string& filename)
+{
+	return export_mesh<MapBase>(m, "CMap2", filename);
+}
+
+bool export_CGB(const CMap3& m, const std::string& filename)
+{
+	return export_mesh<MapBase>(m, "CMap3", filename);
+}
+
+bool export_CGB(const GMap2& m, const std::string& filename)
+{
+	return export_mesh<MapBase>(m, "GMap2", filename);
+}
+
+bool export_CGB(const GMap3& m, const std::string& filename)
+{
+	return export_mesh<MapBase>(m, "GMap3", filename);
+}
+
+bool export_CGB(const Graph& m, const std::string& filename)
+{
+	return export_mesh<MapBase>(m, "Graph", filename);
+}
+
+// the darts levels, edges & faces ids and levels counts of a CPH3 are attributes of its CMap3
+// its current level is saved after the containers
+bool export_CGB(const CPH3& m, const std::string& filename)
+{
+	return export_mesh<MapBase>(m.m_, "CPH3", filename, [&](Writer& w) { w.write_value(m.current_level_); });
+}
+
+bool export_CGB(const IncidenceGraph& m, const std::string& filename)
+{
+	return export_mesh<IncidenceGraphBase>(m, "IncidenceGraph", filename);
+}
+
+bool import_CGB(CMap2& m, const std::string& filename)
+{
+	return import_mesh<MapBase>(m, "CMap2", filename);
+}
+
+bool import_CGB(CMap3& m, const std::string& filename)
+{
+	return import_mesh<MapBase>(m, "CMap3", filename);
+}
+
+bool import_CGB(GMap2& m, const std::string& filename)
+{
+	return import_mesh<MapBase>(m, "GMap2", filename);
+}
+
+bool import_CGB(GMap3& m, const std::string& filename)
+{
+	return import_mesh<MapBase>(m, "GMap3", filename);
+}
+
+bool import_CGB(Graph& m, const std::string& filename)
+{
+	return import_mesh<MapBase>(m, "Graph", filename);
+}
+
+bool import_CGB(CPH3& m, const std::string& filename)
+{
+	return import_mesh<MapBase>(m.m_, "CPH3", filename, [&](Reader& r) {
+		m.current_level_ = r.read_value<uint32>();
+		return m.current_level_ <= m.maximum_level_;
+	});
+}
+
+bool import_CGB(IncidenceGraph& m, const std::string& filename)
+{
+	return import_mesh<IncidenceGraphBase>(m, "IncidenceGraph", filename);
+}
+
+} // namespace io
+
+} // namespace cgogn
@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_IO_BINARY_CGB_H_
+#define CGOGN_IO_BINARY_CGB_H_
+
+#include <cgogn/io/cgogn_io_export.h>
+
+#include <string>
+
+namespace cgogn
+{
+
+struct CMap2;
+struct CMap3;
+struct GMap2;
+struct GMap3;
+struct Graph;
+struct CPH3;
+struct IncidenceGraph;
+
+namespace io
+{
+
+/*****************************************************************************
+ * CGoGN binary format (.cgb)
+ * Versioned snapshot of the attribute containers of a mesh: darts (with the
+ * topological relations, the cells indices and the boundary marker), cells
+ * and mesh-wise attributes. Nothing is rebuilt on import: the chunks of the
+ * attributes of plain types are directly adopted from the (copy on write)
+ * memory mapped file. The attributes of unsupported types are not saved.
+ * The values of the unused indices are zeroed: a mesh always gives the same
+ * file. The mesh must be empty when it is imported.
+ *****************************************************************************/
+
+bool CGOGN_IO_EXPORT export_CGB(const CMap2& m, const std::string& filename);
+bool CGOGN_IO_EXPORT export_CGB(const CMap3& m, const std::string& filename);
+bool CGOGN_IO_EXPORT export_CGB(const GMap2& m, const std::string& filename);
+bool CGOGN_IO_EXPORT export_CGB(const GMap3& m, const std::string& filename);
+bool CGOGN_IO_EXPORT export_CGB(const Graph& m, const std::string& filename);
+bool CGOGN_IO_EXPORT export_CGB(const CPH3& m, const std::string& filename);
+bool CGOGN_IO_EXPORT export_CGB(const IncidenceGraph& m, const std::string& filename);
+
+bool CGOGN_IO_EXPORT import_CGB(CMap2& m, const std::string& filename);
+bool CGOGN_IO_EXPORT import_CGB(CMap3& m, const std::string& filename);
+bool CGOGN_IO_EXPORT import_CGB(GMap2& m, const std::string& filename);
+bool CGOGN_IO_EXPORT import_CGB(GMap3& m, const std::string& filename);
+bool CGOGN_IO_EXPORT import_CGB(Graph& m, const std::string& filename);
+bool CGOGN_IO_EXPORT import_CGB(CPH3& m, const std::string& filename);
+bool CGOGN_IO_EXPORT import_CGB(IncidenceGraph& m, const std::string& filename);
+
+} // namespace io
+
+} // namespace cgogn
+
+#endif // CGOGN_IO_BINARY_CGB_H_
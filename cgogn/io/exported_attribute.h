@@ -0,0 +1,185 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_IO_EXPORTED_ATTRIBUTE_H_
+#define CGOGN_IO_EXPORTED_ATTRIBUTE_H_
+
+#include <cgogn/io/utils.h>
+
+#include <cgogn/core/types/mesh_traits.h>
+
+#include <cgogn/geometry/types/vector_traits.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cgogn
+{
+
+namespace io
+{
+
+///////////////////////////////
+// ExportedAttribute class   //
+///////////////////////////////
+
+// attribute of scalars or of vectors of scalars written by the exporters (text or binary)
+class ExportedAttribute
+{
+public:
+	ExportedAttribute(const std::string& name, const std::string& ply_type, uint32 nb_components)
+		: name_(name), ply_type_(ply_type), nb_components_(nb_components)
+	{
+	}
+	virtual ~ExportedAttribute()
+	{
+	}
+
+	inline const std::string& name() const
+	{
+		return name_;
+	}
+	// type of the components in a PLY header
+	inline const std::string& ply_type() const
+	{
+		return ply_type_;
+	}
+	inline uint32 nb_components() const
+	{
+		return nb_components_;
+	}
+
+	// components separated by spaces
+	virtual void append_text(std::string& s, uint32 index) const = 0;
+	// little endian components
+	virtual void append_binary(std::string& s, uint32 index) const = 0;
+
+private:
+	std::string name_;
+	std::string ply_type_;
+	uint32 nb_components_;
+};
+
+namespace internal
+{
+
+template <typename T>
+inline const char* ply_type_name()
+{
+	if constexpr (std::is_same_v<T, int8>)
+		return "char";
+	else if constexpr (std::is_same_v<T, uint8>)
+		return "uchar";
+	else if constexpr (std::is_same_v<T, int16>)
+		return "short";
+	else if constexpr (std::is_same_v<T, uint16>)
+		return "ushort";
+	else if constexpr (std::is_same_v<T, int32>)
+		return "int";
+	else if constexpr (std::is_same_v<T, uint32>)
+		return "uint";
+	else if constexpr (std::is_same_v<T, float32>)
+		return "float";
+	else
+		return "double";
+}
+
+template <typename T, typename ATTRIBUTE>
+class ExportedAttributeT final : public ExportedAttribute
+{
+	using Scalar = typename geometry::vector_traits<T>::Scalar;
+	static const uint32 SIZE = uint32(geometry::vector_traits<T>::SIZE);
+
+public:
+	ExportedAttributeT(const ATTRIBUTE* attribute)
+		: ExportedAttribute(attribute->name(), ply_type_name<Scalar>(), SIZE), attribute_(attribute)
+	{
+	}
+
+	void append_text(std::string& s, uint32 index) const override
+	{
+		if constexpr (SIZE == 1u)
+			append_value(s, (*attribute_)[index]);
+		else
+			append_vector(s, (*attribute_)[index]);
+	}
+
+	void append_binary(std::string& s, uint32 index) const override
+	{
+		if constexpr (SIZE == 1u)
+			io::append_binary(s, (*attribute_)[index]);
+		else
+		{
+			for (uint32 k = 0u; k < SIZE; ++k)
+				io::append_binary(s, (*attribute_)[index][k]);
+		}
+	}
+
+private:
+	const ATTRIBUTE* attribute_;
+};
+
+template <typename MESH, typename T, typename... Ts>
+std::unique_ptr<ExportedAttribute> make_exported_attribute(const typename mesh_traits<MESH>::AttributeGen* attribute)
+{
+	using AttributeT = typename mesh_traits<MESH>::template Attribute<T>;
+	if (const AttributeT* a = dynamic_cast<const AttributeT*>(attribute))
+		return std::make_unique<ExportedAttributeT<T, AttributeT>>(a);
+	if constexpr (sizeof...(Ts) > 0)
+		return make_exported_attribute<MESH, Ts...>(attribute);
+	else
+		return nullptr;
+}
+
+} // namespace internal
+
+/**
+ * @brief get the attributes of the given cell type that can be exported: scalars and Eigen vectors of scalars
+ * The internal attributes (whose name starts with "__") and the excluded attributes (e.g. the position) are ignored.
+ */
+template <typename CELL, typename MESH>
+std::vector<std::unique_ptr<ExportedAttribute>> exported_attributes(
+	const MESH& m, const std::vector<const typename mesh_traits<MESH>::AttributeGen*>& excluded)
+{
+	using AttributeGen = typename mesh_traits<MESH>::AttributeGen;
+	using namespace geometry;
+
+	std::vector<std::unique_ptr<ExportedAttribute>> attributes;
+	foreach_attribute<CELL>(m, [&](const std::shared_ptr<AttributeGen>& a) {
+		if (a->name().rfind("__", 0) == 0 || std::find(excluded.begin(), excluded.end(), a.get()) != excluded.end())
+			return;
+		std::unique_ptr<ExportedAttribute> ea =
+			internal::make_exported_attribute<MESH, float64, float32, int8, uint8, int16, uint16, int32, uint32, Vec2,
+											  Vec3, Vec4, Vec2f, Vec3f, Vec4f, Vec2i, Vec3i, Vec4i>(a.get());
+		if (ea)
+			attributes.push_back(std::move(ea));
+	});
+	return attributes;
+}
+
+} // namespace io
+
+} // namespace cgogn
+
+#endif // CGOGN_IO_EXPORTED_ATTRIBUTE_H_
@@ -25,13 +25,18 @@
 #define CGOGN_IO_GRAPH_CG_H_
 
 #include <cgogn/io/graph/graph_import.h>
+#include <cgogn/io/mapped_file.h>
 #include <cgogn/io/utils.h>
 
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/types/mesh_views/cell_cache.h>
 #include <cgogn/core/utils/numerics.h>
 
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <vector>
 
 namespace cgogn
@@ -51,12 +56,17 @@ bool import_CG(MESH& m, const std::string& filename)
 
 	GraphImportData graph_data;
 
-	std::ifstream fp(filename.c_str(), std::ios::in);
+	MappedFile file(filename);
+	if (!file.is_open())
+	{
+		std::cerr << "Unable to open file \"" << filename << "\"." << std::endl;
+		return false;
+	}
 
-	std::string line;
-	line.reserve(512);
+	const char* end = file.end();
+	const char* header_end = next_line(file.begin(), end);
 
-	getline_safe(fp, line);
+	std::string line(file.begin(), header_end);
 	if (line.rfind("# D") == std::string::npos)
 	{
 		std::cerr << "File \"" << filename << "\" is not a valid cg file." << std::endl;
@@ -84,53 +94,42 @@ bool import_CG(MESH& m, const std::string& filename)
 		return false;
 	}
 
+	// read vertices & edges (one per line, by line aligned chunks in parallel)
+	std::vector<geometry::Vec3> vertex_position(nb_vertices);
+	graph_data.edges_vertex_indices_.resize(2u * nb_edges);
+
+	bool valid = parallel_foreach_data_line(
+		split_lines(header_end, end), uint64(nb_vertices) + nb_edges,
+		[&](uint32, uint64 line, const char* p, const char* line_end) -> bool {
+			p = skip_blanks(p, line_end);
+			if (line < nb_vertices)
+			{
+				geometry::Vec3& position = vertex_position[line];
+				return *p++ == 'v' && parse_double(p, line_end, position[0]) &&
+					   parse_double(p, line_end, position[1]) && parse_double(p, line_end, position[2]);
+			}
+			uint32* edge = &graph_data.edges_vertex_indices_[2u * (line - nb_vertices)];
+			return *p++ == 'e' && parse_uint(p, line_end, edge[0]) && parse_uint(p, line_end, edge[1]) &&
+				   edge[0] < nb_vertices && edge[1] < nb_vertices;
+		});
+	if (!valid)
+	{
+		std::cerr << "File \"" << filename << "\" is not a valid cg file." << std::endl;
+		return false;
+	}
+
 	graph_data.reserve(nb_vertices);
 	auto position = add_attribute<geometry::Vec3, Vertex>(m, "position");
 
-	// read vertices
 	for (uint32 i = 0; i < nb_vertices; ++i)
 	{
-		getline_safe(fp, line);
-		std::stringstream iss(line);
-
-		std::string tag;
-		iss >> tag;
-
-		if (tag == std::string("v"))
-		{
-			float64 x, y, z;
-			iss >> x;
-			iss >> y;
-			iss >> z;
-
-			uint32 vertex_id = new_index<Vertex>(m);
-			(*position)[vertex_id] = {x, y, z};
-
-			graph_data.vertices_id_.push_back(vertex_id);
-		}
+		uint32 vertex_id = new_index<Vertex>(m);
+		(*position)[vertex_id] = vertex_position[i];
+		graph_data.vertices_id_.push_back(vertex_id);
 	}
 
-	// read edges
-	for (uint32 i = 0; i < nb_edges; ++i)
-	{
-		getline_safe(fp, line);
-		std::stringstream iss(line);
-
-		std::string tag;
-		iss >> tag;
-
-		if (tag == std::string("e"))
-		{
-			uint32 a, b;
-			iss >> a;
-			iss >> b;
-
-			// graph_data.edges_vertex_indices_.push_back(graph_data.vertices_id_[a - 1]);
-			// graph_data.edges_vertex_indices_.push_back(graph_data.vertices_id_[b - 1]);
-			graph_data.edges_vertex_indices_.push_back(graph_data.vertices_id_[a]);
-			graph_data.edges_vertex_indices_.push_back(graph_data.vertices_id_[b]);
-		}
-	}
+	for (uint32& index : graph_data.edges_vertex_indices_)
+		index = graph_data.vertices_id_[index];
 
 	import_graph_data(m, graph_data);
 
@@ -148,36 +147,38 @@ void export_CG(MESH& m, const typename mesh_traits<MESH>::template Attribute<geo
 
 	auto vertex_id = add_attribute<uint32, Vertex>(m, "__vertex_id");
 
-	uint32 nb_vertices = nb_cells<Vertex>(m);
-	uint32 nb_edges = nb_cells<Edge>(m);
-
-	std::ofstream out_file;
-	out_file.open(filename);
-	out_file << "# D:3 NV:" << nb_vertices << " NE:" << nb_edges << "\n";
-
-	uint32 id = 0;
-	// uint32 id = 1;
-	foreach_cell(m, [&](Vertex v) -> bool {
-		const geometry::Vec3& pos = value<geometry::Vec3>(m, vertex_position, v);
-		value<uint32>(m, vertex_id, v) = id++;
-		out_file << "v " << pos[0] << " " << pos[1] << " " << pos[2] << " "
-				 << "\n";
-		return true;
+	CellCache<MESH> cache(m);
+	cache.template build<Vertex>();
+	cache.template build<Edge>();
+	const std::vector<Vertex>& vertices = cache.template cell_vector<Vertex>();
+	const std::vector<Edge>& edges = cache.template cell_vector<Edge>();
+
+	for (uint32 i = 0u, nb = uint32(vertices.size()); i < nb; ++i)
+		value<uint32>(m, vertex_id, vertices[i]) = i;
+
+	std::ofstream out_file(filename, std::ios::out | std::ios::binary);
+	out_file << "# D:3 NV:" << vertices.size() << " NE:" << edges.size() << "\n";
+
+	parallel_write(out_file, uint32(vertices.size()), [&](uint32 i, std::string& s) {
+		s.append("v ");
+		append_vector(s, value<geometry::Vec3>(m, vertex_position, vertices[i]));
+		s.append(" \n");
 	});
 
-	foreach_cell(m, [&](Edge e) -> bool {
-		out_file << "e";
-		foreach_incident_vertex(m, e, [&](Vertex v) -> bool {
-			out_file << " " << value<uint32>(m, vertex_id, v);
+	parallel_write(out_file, uint32(edges.size()), [&](uint32 i, std::string& s) {
+		s.push_back('e');
+		foreach_incident_vertex(m, edges[i], [&](Vertex v) -> bool {
+			s.push_back(' ');
+			append_uint(s, value<uint32>(m, vertex_id, v));
 			return true;
 		});
-		out_file << "\n";
-		return true;
+		s.push_back('\n');
 	});
 
-	remove_attribute<Vertex>(m, vertex_id);
+	if (!out_file.good())
+		std::cerr << "Error while writing file \"" << filename << "\"." << std::endl;
 
-	out_file.close();
+	remove_attribute<Vertex>(m, vertex_id);
 }
 
 } // namespace io
@@ -0,0 +1,88 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/io/import_progress.h>
+
+namespace cgogn
+{
+
+namespace io
+{
+
+namespace
+{
+
+// progress of the imports run by the current thread (set by ImportProgressScope)
+CGOGN_TLS ImportProgress* scope_progress_ = nullptr;
+
+} // namespace
+
+const char* import_phase_name(ImportPhase phase)
+{
+	switch (phase)
+	{
+	case ImportPhase::Pending:
+		return "pending";
+	case ImportPhase::Reading:
+		return "reading";
+	case ImportPhase::Building:
+		return "building";
+	case ImportPhase::Done:
+		return "done";
+	case ImportPhase::Failed:
+		return "failed";
+	case ImportPhase::Cancelled:
+		return "cancelled";
+	}
+	return "";
+}
+
+ImportProgress::ImportProgress()
+	: phase_(ImportPhase::Pending), bytes_read_(0u), total_bytes_(0u), cancel_requested_(false)
+{
+}
+
+float32 ImportProgress::fraction() const
+{
+	const uint64 total = total_bytes();
+	return total > 0u ? float32(float64(bytes_read()) / float64(total)) : 0.0f;
+}
+
+ImportProgress* import_progress()
+{
+	return scope_progress_;
+}
+
+ImportProgressScope::ImportProgressScope(ImportProgress* progress) : previous_(scope_progress_)
+{
+	scope_progress_ = progress;
+}
+
+ImportProgressScope::~ImportProgressScope()
+{
+	scope_progress_ = previous_;
+}
+
+} // namespace io
+
+} // namespace cgogn
@@ -0,0 +1,155 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_IO_IMPORT_PROGRESS_H_
+#define CGOGN_IO_IMPORT_PROGRESS_H_
+
+#include <cgogn/io/cgogn_io_export.h>
+
+#include <cgogn/core/utils/definitions.h>
+#include <cgogn/core/utils/numerics.h>
+
+#include <atomic>
+
+namespace cgogn
+{
+
+namespace io
+{
+
+enum class ImportPhase : uint32
+{
+	Pending = 0,
+	Reading,  // parsing of the file
+	Building, // completion of the connectivity of the mesh
+	Done,
+	Failed,
+	Cancelled
+};
+
+CGOGN_IO_EXPORT const char* import_phase_name(ImportPhase phase);
+
+//////////////////////////
+// ImportProgress class //
+//////////////////////////
+
+// progress of an import: updated by the importing thread, read and cancelled from any thread
+class CGOGN_IO_EXPORT ImportProgress
+{
+public:
+	ImportProgress();
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(ImportProgress);
+
+	inline ImportPhase phase() const
+	{
+		return phase_.load(std::memory_order_acquire);
+	}
+	inline uint64 bytes_read() const
+	{
+		return bytes_read_.load(std::memory_order_relaxed);
+	}
+	// 0 if the size of the data to read is unknown
+	inline uint64 total_bytes() const
+	{
+		return total_bytes_.load(std::memory_order_relaxed);
+	}
+	// fraction of the file read (0 if unknown)
+	float32 fraction() const;
+
+	// the importers stop at their next progress report (the import fails and no mesh is produced)
+	inline void cancel()
+	{
+		cancel_requested_.store(true, std::memory_order_relaxed);
+	}
+	inline bool cancel_requested() const
+	{
+		return cancel_requested_.load(std::memory_order_relaxed);
+	}
+
+	inline void set_phase(ImportPhase phase)
+	{
+		phase_.store(phase, std::memory_order_release);
+	}
+	inline void set_bytes(uint64 bytes_read, uint64 total_bytes)
+	{
+		total_bytes_.store(total_bytes, std::memory_order_relaxed);
+		bytes_read_.store(bytes_read, std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<ImportPhase> phase_;
+	std::atomic<uint64> bytes_read_;
+	std::atomic<uint64> total_bytes_;
+	std::atomic<bool> cancel_requested_;
+};
+
+/**
+ * @brief get the progress of the imports run by the current thread (nullptr if they are not tracked)
+ */
+CGOGN_IO_EXPORT ImportProgress* import_progress();
+
+/**
+ * @brief report the imports run by the current thread to the given progress during the lifetime of the scope
+ */
+class CGOGN_IO_EXPORT ImportProgressScope final
+{
+	ImportProgress* previous_;
+
+public:
+	explicit ImportProgressScope(ImportProgress* progress);
+	~ImportProgressScope();
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(ImportProgressScope);
+};
+
+/**
+ * @brief report the phase of the current import (if tracked)
+ * @return false if the current import has been cancelled
+ */
+inline bool report_import_progress(ImportPhase phase)
+{
+	ImportProgress* progress = import_progress();
+	if (!progress)
+		return true;
+	progress->set_phase(phase);
+	return !progress->cancel_requested();
+}
+
+/**
+ * @brief report the amount of data read by the current import (if tracked)
+ * @return false if the current import has been cancelled
+ */
+inline bool report_import_progress(uint64 bytes_read, uint64 total_bytes)
+{
+	ImportProgress* progress = import_progress();
+	if (!progress)
+		return true;
+	progress->set_bytes(bytes_read, total_bytes);
+	progress->set_phase(ImportPhase::Reading);
+	return !progress->cancel_requested();
+}
+
+} // namespace io
+
+} // namespace cgogn
+
+#endif // CGOGN_IO_IMPORT_PROGRESS_H_
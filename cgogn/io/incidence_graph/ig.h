@@ -25,11 +25,14 @@
 #define CGOGN_IO_INCIDENCE_GRAPH_IG_H_
 
 #include <cgogn/io/incidence_graph/incidence_graph_import.h>
+#include <cgogn/io/mapped_file.h>
 #include <cgogn/io/utils.h>
 
 #include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/types/mesh_views/cell_cache.h>
 
 #include <fstream>
+#include <vector>
 
 namespace cgogn
 {
@@ -37,33 +40,102 @@ namespace cgogn
 namespace io
 {
 
+namespace internal
+{
+
+// parse the vertices, edges and faces that follow the header, one per line, by line aligned chunks in parallel
+inline bool parse_IG_body(const char* begin, const char* end, IncidenceGraphImportData& incidence_graph_data)
+{
+	const uint32 nb_vertices = incidence_graph_data.nb_vertices_;
+	const uint32 nb_edges = incidence_graph_data.nb_edges_;
+	const uint32 nb_faces = incidence_graph_data.nb_faces_;
+
+	incidence_graph_data.vertex_position_.resize(nb_vertices);
+	incidence_graph_data.edges_vertex_indices_.resize(2u * nb_edges);
+	incidence_graph_data.faces_nb_edges_.resize(nb_faces);
+
+	const std::vector<const char*> boundaries = split_lines(begin, end);
+	std::vector<std::vector<uint32>> faces_edge_indices(boundaries.size() - 1u);
+
+	bool valid = parallel_foreach_data_line(
+		boundaries, uint64(nb_vertices) + nb_edges + nb_faces,
+		[&](uint32 c, uint64 line, const char* p, const char* line_end) -> bool {
+			if (line < nb_vertices)
+			{
+				Vec3& position = incidence_graph_data.vertex_position_[line];
+				return parse_double(p, line_end, position[0]) && parse_double(p, line_end, position[1]) &&
+					   parse_double(p, line_end, position[2]);
+			}
+			line -= nb_vertices;
+			if (line < nb_edges)
+			{
+				uint32* edge = &incidence_graph_data.edges_vertex_indices_[2u * line];
+				return parse_uint(p, line_end, edge[0]) && parse_uint(p, line_end, edge[1]) &&
+					   edge[0] < nb_vertices && edge[1] < nb_vertices;
+			}
+			line -= nb_edges;
+			uint32 n;
+			if (!parse_uint(p, line_end, n))
+				return false;
+			incidence_graph_data.faces_nb_edges_[line] = n;
+			for (uint32 i = 0u; i < n; ++i)
+			{
+				uint32 index;
+				if (!parse_uint(p, line_end, index) || index >= nb_edges)
+					return false;
+				faces_edge_indices[c].push_back(index);
+			}
+			return true;
+		});
+	if (!valid)
+		return false;
+
+	parallel_concatenate(faces_edge_indices, incidence_graph_data.faces_edge_indices_);
+
+	return true;
+}
+
+} // namespace internal
+
 template <typename MESH>
 bool import_IG(MESH& m, const std::string& filename)
 {
 	static_assert(mesh_traits<MESH>::dimension >= 1, "MESH dimension should be at least 1");
 
-	using Vertex = typename MESH::Vertex;
-
 	Scoped_C_Locale loc;
 
 	IncidenceGraphImportData incidence_graph_data;
 
-	std::ifstream fp(filename.c_str(), std::ios::in);
+	MappedFile file(filename);
+	if (!file.is_open())
+	{
+		std::cerr << "Unable to open file \"" << filename << "\"." << std::endl;
+		return false;
+	}
 
-	std::string line;
-	line.reserve(512);
+	const char* p = file.begin();
+	const char* end = file.end();
 
-	getline_safe(fp, line);
-	if (line.rfind("IG") == std::string::npos)
+	const char* header_end = next_line(p, end);
+	if (std::string(p, header_end).rfind("IG") == std::string::npos)
 	{
 		std::cerr << "File \"" << filename << "\" is not a valid ig file." << std::endl;
 		return false;
 	}
 
 	// read number of vertices, edges, faces
-	const uint32 nb_vertices = read_uint(fp, line);
-	const uint32 nb_edges = read_uint(fp, line);
-	const uint32 nb_faces = read_uint(fp, line);
+	uint32 nb_vertices = 0u, nb_edges = 0u, nb_faces = 0u;
+	p = skip_to_data(header_end, end);
+	bool valid = parse_uint(p, end, nb_vertices);
+	p = skip_to_data(p, end);
+	valid = valid && parse_uint(p, end, nb_edges);
+	p = skip_to_data(p, end);
+	valid = valid && parse_uint(p, end, nb_faces);
+	if (!valid)
+	{
+		std::cerr << "File \"" << filename << "\" is not a valid ig file." << std::endl;
+		return false;
+	}
 
 	std::cout << "import ig: " << nb_vertices << " " << nb_edges << " " << nb_faces << std::endl;
 
@@ -75,34 +147,10 @@ bool import_IG(MESH& m, const std::string& filename)
 
 	incidence_graph_data.reserve(nb_vertices, nb_edges, nb_faces);
 
-	// read vertices position
-	for (uint32 i = 0u; i < nb_vertices; ++i)
-	{
-		float64 x = read_double(fp, line);
-		float64 y = read_double(fp, line);
-		float64 z = read_double(fp, line);
-		incidence_graph_data.vertex_position_.push_back({x, y, z});
-	}
-
-	// read edges
-	for (uint32 i = 0; i < nb_edges; ++i)
-	{
-		const uint32 a = read_uint(fp, line);
-		const uint32 b = read_uint(fp, line);
-		incidence_graph_data.edges_vertex_indices_.push_back(a);
-		incidence_graph_data.edges_vertex_indices_.push_back(b);
-	}
-
-	// read faces
-	for (uint32 i = 0; i < nb_faces; ++i)
+	if (!internal::parse_IG_body(next_line(p, end), end, incidence_graph_data))
 	{
-		const uint32 nbe = read_uint(fp, line);
-		incidence_graph_data.faces_nb_edges_.push_back(nbe);
-		for (uint32 j = 0; j < nbe; ++j)
-		{
-			const uint32 e = read_uint(fp, line);
-			incidence_graph_data.faces_edge_indices_.push_back(e);
-		}
+		std::cerr << "File \"" << filename << "\" is not a valid ig file." << std::endl;
+		return false;
 	}
 
 	import_incidence_graph_data(m, incidence_graph_data);
@@ -122,60 +170,67 @@ void export_IG(MESH& m, const typename mesh_traits<MESH>::template Attribute<geo
 	auto vertex_id = add_attribute<uint32, Vertex>(m, "__vertex_id");
 	auto edge_id = add_attribute<uint32, Edge>(m, "__edge_id");
 
-	uint32 nb_vertices = nb_cells<Vertex>(m);
-	uint32 nb_edges = nb_cells<Edge>(m);
+	CellCache<MESH> cache(m);
+	cache.template build<Vertex>();
+	cache.template build<Edge>();
+	const std::vector<Vertex>& vertices = cache.template cell_vector<Vertex>();
+	const std::vector<Edge>& edges = cache.template cell_vector<Edge>();
 
-	std::ofstream out_file;
-	out_file.open(filename);
+	for (uint32 i = 0u, nb = uint32(vertices.size()); i < nb; ++i)
+		value<uint32>(m, vertex_id, vertices[i]) = i;
+	for (uint32 i = 0u, nb = uint32(edges.size()); i < nb; ++i)
+		value<uint32>(m, edge_id, edges[i]) = i;
+
+	std::ofstream out_file(filename, std::ios::out | std::ios::binary);
 	out_file << "IG\n";
 
 	if constexpr (mesh_traits<MESH>::dimension == 2)
 	{
 		using Face = typename MESH::Face;
-		uint32 nb_faces = nb_cells<Face>(m);
-		out_file << nb_vertices << " " << nb_edges << " " << nb_faces << "\n";
+		cache.template build<Face>();
+		out_file << vertices.size() << " " << edges.size() << " " << cache.template size<Face>() << "\n";
 	}
 	else
 	{
-		out_file << nb_vertices << " " << nb_edges << " 0\n";
+		out_file << vertices.size() << " " << edges.size() << " 0\n";
 	}
 
-	uint32 id = 0;
-	foreach_cell(m, [&](Vertex v) -> bool {
-		const geometry::Vec3& pos = value<geometry::Vec3>(m, vertex_position, v);
-		value<uint32>(m, vertex_id, v) = id++;
-		out_file << pos[0] << " " << pos[1] << " " << pos[2] << "\n";
-		return true;
+	parallel_write(out_file, uint32(vertices.size()), [&](uint32 i, std::string& s) {
+		append_vector(s, value<geometry::Vec3>(m, vertex_position, vertices[i]));
+		s.push_back('\n');
 	});
 
-	id = 0;
-	foreach_cell(m, [&](Edge e) -> bool {
-		value<uint32>(m, edge_id, e) = id++;
-		foreach_incident_vertex(m, e, [&](Vertex v) -> bool {
-			out_file << value<uint32>(m, vertex_id, v) << " ";
+	parallel_write(out_file, uint32(edges.size()), [&](uint32 i, std::string& s) {
+		foreach_incident_vertex(m, edges[i], [&](Vertex v) -> bool {
+			append_uint(s, value<uint32>(m, vertex_id, v));
+			s.push_back(' ');
 			return true;
 		});
-		out_file << "\n";
-		return true;
+		s.push_back('\n');
 	});
 
 	if constexpr (mesh_traits<MESH>::dimension == 2)
 	{
 		using Face = typename MESH::Face;
-		foreach_cell(m, [&](Face f) -> bool {
-			std::vector<Edge> inc_edges = incident_edges(m, f);
-			out_file << inc_edges.size() << " ";
+		const std::vector<Face>& faces = cache.template cell_vector<Face>();
+		parallel_write(out_file, uint32(faces.size()), [&](uint32 i, std::string& s) {
+			std::vector<Edge> inc_edges = incident_edges(m, faces[i]);
+			append_uint(s, inc_edges.size());
+			s.push_back(' ');
 			for (Edge e : inc_edges)
-				out_file << value<uint32>(m, edge_id, e) << " ";
-			out_file << "\n";
-			return true;
+			{
+				append_uint(s, value<uint32>(m, edge_id, e));
+				s.push_back(' ');
+			}
+			s.push_back('\n');
 		});
 	}
 
+	if (!out_file.good())
+		std::cerr << "Error while writing file \"" << filename << "\"." << std::endl;
+
 	remove_attribute<Vertex>(m, vertex_id);
 	remove_attribute<Edge>(m, edge_id);
-
-	out_file.close();
 }
 
 } // namespace io
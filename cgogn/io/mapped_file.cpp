@@ -0,0 +1,158 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/io/mapped_file.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cgogn
+{
+
+namespace io
+{
+
+MappedFile::MappedFile()
+	: data_(nullptr), size_(0u), is_open_(false)
+#ifdef _WIN32
+	  ,
+	  file_(nullptr), mapping_(nullptr)
+#endif
+{
+}
+
+MappedFile::MappedFile(const std::string& filename, bool copy_on_write) : MappedFile()
+{
+	open(filename, copy_on_write);
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const std::string& filename, bool copy_on_write)
+{
+	close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+							  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	size_ = uint64(size.QuadPart);
+	if (size_ > 0u)
+	{
+		HANDLE mapping =
+			CreateFileMappingA(file, nullptr, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			CloseHandle(file);
+			size_ = 0u;
+			return false;
+		}
+		data_ = static_cast<char*>(MapViewOfFile(mapping, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+		if (data_ == nullptr)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			size_ = 0u;
+			return false;
+		}
+		mapping_ = mapping;
+	}
+	file_ = file;
+#else
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+	size_ = uint64(st.st_size);
+	if (size_ > 0u)
+	{
+		void* data = mmap(nullptr, size_, copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED)
+		{
+			::close(fd);
+			size_ = 0u;
+			return false;
+		}
+		// the parsed files are read front to back
+		if (!copy_on_write)
+			madvise(data, size_, MADV_SEQUENTIAL);
+		data_ = static_cast<char*>(data);
+	}
+	// the mapping stays valid after the descriptor is closed
+	::close(fd);
+#endif
+
+	is_open_ = true;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (!is_open_)
+		return;
+
+#ifdef _WIN32
+	if (data_ != nullptr)
+		UnmapViewOfFile(data_);
+	if (mapping_ != nullptr)
+		CloseHandle(mapping_);
+	CloseHandle(file_);
+	file_ = nullptr;
+	mapping_ = nullptr;
+#else
+	if (data_ != nullptr)
+		munmap(data_, size_);
+#endif
+
+	data_ = nullptr;
+	size_ = 0u;
+	is_open_ = false;
+}
+
+} // namespace io
+
+} // namespace cgogn
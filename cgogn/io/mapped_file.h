@@ -0,0 +1,89 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#ifndef CGOGN_IO_MAPPED_FILE_H_
+#define CGOGN_IO_MAPPED_FILE_H_
+
+#include <cgogn/io/cgogn_io_export.h>
+
+#include <cgogn/core/utils/definitions.h>
+#include <cgogn/core/utils/numerics.h>
+
+#include <string>
+
+namespace cgogn
+{
+
+namespace io
+{
+
+//////////////////////
+// MappedFile class //
+//////////////////////
+
+// memory mapping of a whole file
+// with copy_on_write, the mapped memory is writable: the written pages are privately copied and the file is never
+// modified (read-only otherwise)
+class CGOGN_IO_EXPORT MappedFile
+{
+public:
+	MappedFile();
+	explicit MappedFile(const std::string& filename, bool copy_on_write = false);
+	~MappedFile();
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(MappedFile);
+
+	bool open(const std::string& filename, bool copy_on_write = false);
+	void close();
+
+	inline bool is_open() const
+	{
+		return is_open_;
+	}
+	inline const char* begin() const
+	{
+		return data_;
+	}
+	inline const char* end() const
+	{
+		return data_ + size_;
+	}
+	inline uint64 size() const
+	{
+		return size_;
+	}
+
+private:
+	char* data_;
+	uint64 size_;
+	bool is_open_;
+#ifdef _WIN32
+	void* file_;
+	void* mapping_;
+#endif
+};
+
+} // namespace io
+
+} // namespace cgogn
+
+#endif // CGOGN_IO_MAPPED_FILE_H_
@@ -24,10 +24,19 @@
 #ifndef CGOGN_IO_SURFACE_OBJ_H_
 #define CGOGN_IO_SURFACE_OBJ_H_
 
+#include <cgogn/io/exported_attribute.h>
+#include <cgogn/io/mapped_file.h>
 #include <cgogn/io/surface/surface_import.h>
 #include <cgogn/io/utils.h>
 
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/types/mesh_views/cell_cache.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <algorithm>
 #include <fstream>
+#include <vector>
 
 namespace cgogn
 {
@@ -35,97 +44,263 @@ namespace cgogn
 namespace io
 {
 
-template <typename MESH>
-bool import_OBJ(MESH& m, const std::string& filename)
+namespace internal
 {
-	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
 
-	using Vertex = typename MESH::Vertex;
+struct OBJChunk
+{
+	std::vector<Vec3> vertex_position_;
+	std::vector<uint32> faces_nb_vertices_;
+	std::vector<uint32> faces_vertex_indices_;
+	// negative (relative) indices are resolved after the merge: (position in faces_vertex_indices_, index relative to
+	// the first vertex of the chunk)
+	std::vector<std::pair<uint32, int64>> relative_indices_;
+	bool valid_ = true;
+};
 
-	Scoped_C_Locale loc;
+inline void parse_OBJ_chunk(const char* begin, const char* end, OBJChunk& chunk)
+{
+	for (const char* p = begin; p < end; p = next_line(p, end))
+	{
+		p = skip_blanks(p, end);
+		if (end - p < 2 || (p[1] != ' ' && p[1] != '\t'))
+			continue;
 
-	SurfaceImportData surface_data;
+		if (p[0] == 'v')
+		{
+			++p;
+			float64 x, y, z;
+			if (!parse_double(p, end, x) || !parse_double(p, end, y) || !parse_double(p, end, z))
+			{
+				chunk.valid_ = false;
+				return;
+			}
+			chunk.vertex_position_.push_back({x, y, z});
+		}
+		else if (p[0] == 'f')
+		{
+			++p;
+			uint32 nb_vertices = 0u;
+			int64 index;
+			while (parse_int(p, end, index))
+			{
+				if (index > 0)
+					chunk.faces_vertex_indices_.push_back(uint32(index - 1));
+				else if (index < 0)
+				{
+					chunk.relative_indices_.emplace_back(uint32(chunk.faces_vertex_indices_.size()),
+														 int64(chunk.vertex_position_.size()) + index);
+					chunk.faces_vertex_indices_.push_back(0u);
+				}
+				else
+				{
+					chunk.valid_ = false;
+					return;
+				}
+				++nb_vertices;
+				// skip texture & normal indices
+				while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+					++p;
+			}
+			if (nb_vertices > 0u)
+				chunk.faces_nb_vertices_.push_back(nb_vertices);
+		}
+	}
+}
 
-	std::ifstream fp(filename.c_str(), std::ios::in);
+// the file is parsed by line aligned chunks in parallel and the vertices and faces of each batch of chunks are given
+// to the builder (see SurfaceBuilder) in order
+template <typename BUILDER>
+bool parse_OBJ(const char* begin, const char* end, BUILDER& builder)
+{
+	const std::vector<const char*> boundaries = split_lines(begin, end);
+	const uint32 nb_chunks = uint32(boundaries.size()) - 1u;
+	const uint32 batch_size = parallel_batch_size();
 
-	std::string line, tag;
-	line.reserve(512u);
+	std::vector<OBJChunk> chunks(std::min(batch_size, nb_chunks));
+	std::vector<uint32> first_vertex(chunks.size());
 
-	// read vertices position
-	do
+	for (uint32 first_chunk = 0u; first_chunk < nb_chunks; first_chunk += batch_size)
 	{
-		fp >> tag;
-		if (tag == std::string("v"))
+		const uint32 nb = std::min(batch_size, nb_chunks - first_chunk);
+		parallel_foreach_chunk(nb, [&](uint32 b) -> bool {
+			chunks[b] = OBJChunk();
+			parse_OBJ_chunk(boundaries[first_chunk + b], boundaries[first_chunk + b + 1], chunks[b]);
+			return true;
+		});
+
+		for (uint32 b = 0u; b < nb; ++b)
 		{
-			surface_data.nb_vertices_++;
-			float64 x = read_double(fp, line);
-			float64 y = read_double(fp, line);
-			float64 z = read_double(fp, line);
-			surface_data.vertex_position_.push_back({x, y, z});
+			if (!chunks[b].valid_)
+				return false;
+			first_vertex[b] = builder.add_vertices(uint32(chunks[b].vertex_position_.size()));
 		}
-		getline_safe(fp, line); // flush line
-	} while (!fp.eof());
 
-	if (surface_data.nb_vertices_ == 0u)
+		parallel_foreach_chunk(nb, [&](uint32 b) -> bool {
+			OBJChunk& chunk = chunks[b];
+			for (uint32 i = 0u, n = uint32(chunk.vertex_position_.size()); i < n; ++i)
+				builder.vertex_position(first_vertex[b] + i) = chunk.vertex_position_[i];
+			for (const auto& [position, relative_index] : chunk.relative_indices_)
+			{
+				const int64 index = first_vertex[b] + relative_index;
+				chunk.valid_ &= index >= 0;
+				chunk.faces_vertex_indices_[position] = uint32(index);
+			}
+			return true;
+		});
+
+		for (uint32 b = 0u; b < nb; ++b)
+		{
+			if (!chunks[b].valid_)
+				return false;
+			builder.add_faces(chunks[b].faces_nb_vertices_.data(), chunks[b].faces_vertex_indices_.data(),
+							  uint32(chunks[b].faces_nb_vertices_.size()));
+		}
+
+		if (!report_import_progress(uint64(boundaries[first_chunk + nb] - begin), uint64(end - begin)))
+			return false;
+	}
+
+	return true;
+}
+
+} // namespace internal
+
+template <typename MESH>
+bool import_OBJ(MESH& m, const std::string& filename)
+{
+	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
+
+	MappedFile file(filename);
+	if (!file.is_open())
 	{
-		std::cerr << "File \"" << filename << " has no vertices." << std::endl;
+		std::cerr << "Unable to open file \"" << filename << "\"." << std::endl;
 		return false;
 	}
 
-	// rewind
-	fp.clear();
-	fp.seekg(0, std::ios::beg);
+	Scoped_C_Locale loc;
+
+	SurfaceBuilder<MESH> builder(m);
 
-	// read faces (vertex indices)
-	// uint32 nb_faces = 0;
-	do
+	const bool valid = internal::parse_OBJ(file.begin(), file.end(), builder);
+	if (!valid)
+		builder.abort();
+	// finish fails (and clears the mesh) if a face references a vertex that is not in the file
+	if (!valid || !builder.finish())
 	{
-		fp >> tag;
-		getline_safe(fp, line);
-		if (tag == std::string("f"))
-		{
-			surface_data.nb_faces_++;
-			std::vector<uint32> indices;
-			std::istringstream iss(line);
-			std::string str;
-			while (!iss.eof())
-			{
-				iss >> str;
-				uint32 ind = 0;
-				while ((ind < str.length()) && (str[ind] != '/'))
-					ind++;
-				if (ind > 0)
-				{
-					uint32 index;
-					std::stringstream iss(str.substr(0, ind));
-					iss >> index;
-					indices.push_back(index - 1);
-				}
-			}
-			surface_data.faces_nb_vertices_.push_back(indices.size());
-			surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(), indices.begin(),
-													  indices.end());
-		}
-	} while (!fp.eof());
+		std::cerr << "File \"" << filename << "\" is not a valid obj file." << std::endl;
+		return false;
+	}
 
-	if (surface_data.nb_faces_ == 0u)
+	if (builder.nb_vertices() == 0u)
+	{
+		std::cerr << "File \"" << filename << " has no vertices." << std::endl;
+		builder.abort();
+		return false;
+	}
+	if (builder.nb_faces() == 0u)
 	{
 		std::cerr << "File \"" << filename << " has no faces." << std::endl;
+		builder.abort();
 		return false;
 	}
 
-	import_surface_data(m, surface_data);
-
 	return true;
 }
 
+/**
+ * @brief export the given surface in the OBJ format
+ * With export_attributes, the vertex and face attributes that can be exported (see exported_attributes) are also
+ * written: a Vec3 vertex attribute named "normal" as vertex normals (vn) and the other ones after the faces, as blocks
+ * of comments that are ignored by the OBJ readers:
+ * #@vertex_attribute <name> <PLY type of the components> <nb components>
+ * #@ <components of the first vertex>
+ * ...
+ */
 template <typename MESH>
 void export_OBJ(MESH& m, const typename mesh_traits<MESH>::template Attribute<geometry::Vec3>* vertex_position,
-				const std::string& filename)
+				const std::string& filename, bool export_attributes = false)
 {
 	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
 
-	// TODO
+	using Vertex = typename MESH::Vertex;
+	using Face = typename MESH::Face;
+
+	auto vertex_id = add_attribute<uint32, Vertex>(m, "__vertex_id");
+
+	CellCache<MESH> cache(m);
+	cache.template build<Vertex>();
+	cache.template build<Face>();
+	const std::vector<Vertex>& vertices = cache.template cell_vector<Vertex>();
+	const std::vector<Face>& faces = cache.template cell_vector<Face>();
+
+	for (uint32 i = 0u, nb = uint32(vertices.size()); i < nb; ++i)
+		value<uint32>(m, vertex_id, vertices[i]) = i + 1u;
+
+	std::shared_ptr<typename mesh_traits<MESH>::template Attribute<geometry::Vec3>> vertex_normal;
+	std::vector<std::unique_ptr<ExportedAttribute>> vertex_attributes;
+	std::vector<std::unique_ptr<ExportedAttribute>> face_attributes;
+	if (export_attributes)
+	{
+		vertex_normal = get_attribute<geometry::Vec3, Vertex>(m, "normal");
+		vertex_attributes = exported_attributes<Vertex>(m, {vertex_position, vertex_normal.get()});
+		face_attributes = exported_attributes<Face>(m, {});
+	}
+
+	std::ofstream out_file(filename, std::ios::out | std::ios::binary);
+	out_file << "# " << vertices.size() << " vertices " << faces.size() << " faces\n";
+
+	parallel_write(out_file, uint32(vertices.size()), [&](uint32 i, std::string& s) {
+		s.append("v ");
+		append_vector(s, value<geometry::Vec3>(m, vertex_position, vertices[i]));
+		s.push_back('\n');
+	});
+
+	if (vertex_normal)
+	{
+		parallel_write(out_file, uint32(vertices.size()), [&](uint32 i, std::string& s) {
+			s.append("vn ");
+			append_vector(s, value<geometry::Vec3>(m, vertex_normal, vertices[i]));
+			s.push_back('\n');
+		});
+	}
+
+	parallel_write(out_file, uint32(faces.size()), [&](uint32 i, std::string& s) {
+		s.push_back('f');
+		foreach_incident_vertex(m, faces[i], [&](Vertex v) -> bool {
+			const uint32 id = value<uint32>(m, vertex_id, v);
+			s.push_back(' ');
+			append_uint(s, id);
+			if (vertex_normal)
+			{
+				s.append("//");
+				append_uint(s, id);
+			}
+			return true;
+		});
+		s.push_back('\n');
+	});
+
+	auto write_attribute = [&](const char* cell_name, const ExportedAttribute& attribute, uint32 nb_cells,
+							   auto cell_index) {
+		out_file << "#@" << cell_name << "_attribute " << attribute.name() << " " << attribute.ply_type() << " "
+				 << attribute.nb_components() << "\n";
+		parallel_write(out_file, nb_cells, [&](uint32 i, std::string& s) {
+			s.append("#@ ");
+			attribute.append_text(s, cell_index(i));
+			s.push_back('\n');
+		});
+	};
+	for (const auto& attribute : vertex_attributes)
+		write_attribute("vertex", *attribute, uint32(vertices.size()),
+						[&](uint32 i) { return index_of(m, vertices[i]); });
+	for (const auto& attribute : face_attributes)
+		write_attribute("face", *attribute, uint32(faces.size()), [&](uint32 i) { return index_of(m, faces[i]); });
+
+	if (!out_file.good())
+		std::cerr << "Error while writing file \"" << filename << "\"." << std::endl;
+
+	remove_attribute<Vertex>(m, vertex_id);
 }
 
 } // namespace io
@@ -24,13 +24,16 @@
 #ifndef CGOGN_IO_SURFACE_OFF_H_
 #define CGOGN_IO_SURFACE_OFF_H_
 
+#include <cgogn/io/mapped_file.h>
 #include <cgogn/io/surface/surface_import.h>
 #include <cgogn/io/utils.h>
 
 #include <cgogn/core/functions/attributes.h>
 #include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/types/mesh_views/cell_cache.h>
 
 #include <fstream>
+#include <vector>
 
 namespace cgogn
 {
@@ -38,34 +41,98 @@ namespace cgogn
 namespace io
 {
 
+namespace internal
+{
+
+// parse the vertices and faces that follow the header, one per line, by line aligned chunks in parallel
+// the vertices and the faces of each batch of chunks are given to the builder (see SurfaceBuilder) in order
+template <typename BUILDER>
+bool parse_OFF_body(const char* begin, const char* end, uint32 nb_vertices, uint32 nb_faces, BUILDER& builder)
+{
+	const uint32 first_vertex = builder.add_vertices(nb_vertices);
+
+	struct FacesChunk
+	{
+		std::vector<uint32> faces_nb_vertices_;
+		std::vector<uint32> faces_vertex_indices_;
+	};
+
+	const std::vector<const char*> boundaries = split_lines(begin, end);
+	std::vector<FacesChunk> faces(boundaries.size() - 1u);
+
+	return parallel_foreach_data_line(
+		boundaries, uint64(nb_vertices) + nb_faces,
+		[&](uint32 c, uint64 line, const char* p, const char* line_end) -> bool {
+			if (line < nb_vertices)
+			{
+				Vec3& position = builder.vertex_position(first_vertex + uint32(line));
+				return parse_double(p, line_end, position[0]) && parse_double(p, line_end, position[1]) &&
+					   parse_double(p, line_end, position[2]);
+			}
+			uint32 n;
+			if (!parse_uint(p, line_end, n))
+				return false;
+			faces[c].faces_nb_vertices_.push_back(n);
+			for (uint32 i = 0u; i < n; ++i)
+			{
+				uint32 index;
+				if (!parse_uint(p, line_end, index) || index >= nb_vertices)
+					return false;
+				faces[c].faces_vertex_indices_.push_back(first_vertex + index);
+			}
+			return true;
+		},
+		[&](uint32 first_chunk, uint32 last_chunk) -> bool {
+			for (uint32 c = first_chunk; c < last_chunk; ++c)
+			{
+				builder.add_faces(faces[c].faces_nb_vertices_.data(), faces[c].faces_vertex_indices_.data(),
+								  uint32(faces[c].faces_nb_vertices_.size()));
+				faces[c] = FacesChunk();
+			}
+			return true;
+		});
+}
+
+} // namespace internal
+
 template <typename MESH>
 bool import_OFF(MESH& m, const std::string& filename)
 {
 	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
 
-	using Vertex = typename MESH::Vertex;
-
 	Scoped_C_Locale loc;
 
-	SurfaceImportData surface_data;
-
-	std::ifstream fp(filename.c_str(), std::ios::in);
+	MappedFile file(filename);
+	if (!file.is_open())
+	{
+		std::cerr << "Unable to open file \"" << filename << "\"." << std::endl;
+		return false;
+	}
 
-	std::string line;
-	line.reserve(512u);
+	const char* p = file.begin();
+	const char* end = file.end();
 
 	// read OFF header
-	getline_safe(fp, line);
-	if (line.rfind("OFF") == std::string::npos)
+	const char* header_end = next_line(p, end);
+	if (std::string(p, header_end).rfind("OFF") == std::string::npos)
 	{
 		std::cerr << "File \"" << filename << "\" is not a valid off file." << std::endl;
 		return false;
 	}
 
-	// read number of vertices, edges, faces
-	const uint32 nb_vertices = read_uint(fp, line);
-	const uint32 nb_faces = read_uint(fp, line);
-	/*const uint32 nb_edges_ =*/read_uint(fp, line);
+	// read number of vertices, faces, edges
+	uint32 nb_vertices = 0u, nb_faces = 0u, nb_edges = 0u;
+	p = skip_to_data(header_end, end);
+	bool valid = parse_uint(p, end, nb_vertices);
+	p = skip_to_data(p, end);
+	valid = valid && parse_uint(p, end, nb_faces);
+	p = skip_to_data(p, end);
+	valid = valid && parse_uint(p, end, nb_edges);
+	if (!valid)
+	{
+		std::cerr << "File \"" << filename << "\" is not a valid off file." << std::endl;
+		return false;
+	}
 
 	if (nb_vertices == 0u)
 	{
@@ -78,32 +145,17 @@ bool import_OFF(MESH& m, const std::string& filename)
 		return false;
 	}
 
-	surface_data.reserve(nb_vertices, nb_faces);
-
-	// read vertices position
-	for (uint32 i = 0u; i < nb_vertices; ++i)
-	{
-		float64 x = read_double(fp, line);
-		float64 y = read_double(fp, line);
-		float64 z = read_double(fp, line);
-		surface_data.vertex_position_.push_back({x, y, z});
-	}
+	SurfaceBuilder<MESH> builder(m);
+	builder.reserve(nb_vertices, nb_faces);
 
-	// read faces (vertex indices)
-	for (uint32 i = 0u; i < nb_faces; ++i)
+	if (!internal::parse_OFF_body(next_line(p, end), end, nb_vertices, nb_faces, builder))
 	{
-		uint32 n = read_uint(fp, line);
-
-		std::vector<uint32> indices(n);
-		for (uint32 j = 0u; j < n; ++j)
-			indices[j] = read_uint(fp, line);
-
-		surface_data.faces_nb_vertices_.push_back(n);
-		surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(), indices.begin(),
-												  indices.end());
+		std::cerr << "File \"" << filename << "\" is not a valid off file." << std::endl;
+		builder.abort();
+		return false;
 	}
 
-	import_surface_data(m, surface_data);
+	builder.finish();
 
 	return true;
 }
@@ -119,35 +171,38 @@ void export_OFF(MESH& m, const typename mesh_traits<MESH>::template Attribute<ge
 
 	auto vertex_id = add_attribute<uint32, Vertex>(m, "__vertex_id");
 
-	uint32 nb_vertices = nb_cells<Vertex>(m);
-	uint32 nb_faces = nb_cells<Face>(m);
+	CellCache<MESH> cache(m);
+	cache.template build<Vertex>();
+	cache.template build<Face>();
+	const std::vector<Vertex>& vertices = cache.template cell_vector<Vertex>();
+	const std::vector<Face>& faces = cache.template cell_vector<Face>();
 
-	std::ofstream out_file;
-	out_file.open(filename);
+	for (uint32 i = 0u, nb = uint32(vertices.size()); i < nb; ++i)
+		value<uint32>(m, vertex_id, vertices[i]) = i;
+
+	std::ofstream out_file(filename, std::ios::out | std::ios::binary);
 	out_file << "OFF\n";
-	out_file << nb_vertices << " " << nb_faces << " " << 0 << "\n";
-
-	uint32 id = 0;
-	foreach_cell(m, [&](Vertex v) -> bool {
-		const geometry::Vec3& p = value<geometry::Vec3>(m, vertex_position, v);
-		value<uint32>(m, vertex_id, v) = id++;
-		out_file << p[0] << " " << p[1] << " " << p[2] << "\n";
-		return true;
+	out_file << vertices.size() << " " << faces.size() << " " << 0 << "\n";
+
+	parallel_write(out_file, uint32(vertices.size()), [&](uint32 i, std::string& s) {
+		append_vector(s, value<geometry::Vec3>(m, vertex_position, vertices[i]));
+		s.push_back('\n');
 	});
 
-	foreach_cell(m, [&](Face f) -> bool {
-		out_file << codegree(m, f);
-		foreach_incident_vertex(m, f, [&](Vertex v) -> bool {
-			out_file << " " << value<uint32>(m, vertex_id, v);
+	parallel_write(out_file, uint32(faces.size()), [&](uint32 i, std::string& s) {
+		append_uint(s, codegree(m, faces[i]));
+		foreach_incident_vertex(m, faces[i], [&](Vertex v) -> bool {
+			s.push_back(' ');
+			append_uint(s, value<uint32>(m, vertex_id, v));
 			return true;
 		});
-		out_file << "\n";
-		return true;
+		s.push_back('\n');
 	});
 
-	remove_attribute<Vertex>(m, vertex_id);
+	if (!out_file.good())
+		std::cerr << "Error while writing file \"" << filename << "\"." << std::endl;
 
-	out_file.close();
+	remove_attribute<Vertex>(m, vertex_id);
 }
 
 } // namespace io
@@ -24,14 +24,19 @@
 #ifndef CGOGN_IO_SURFACE_PLY_H_
 #define CGOGN_IO_SURFACE_PLY_H_
 
+#include <cgogn/io/exported_attribute.h>
 #include <cgogn/io/surface/surface_import.h>
 #include <cgogn/io/utils.h>
 
 #include <cgogn/core/functions/attributes.h>
 #include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/types/mesh_views/cell_cache.h>
 
 #include <thirdparty/happly/happly.h>
 
+#include <fstream>
+#include <stdexcept>
+
 namespace cgogn
 {
 
@@ -49,9 +54,29 @@ bool import_PLY(MESH& m, const std::string& filename)
 
 	SurfaceImportData surface_data;
 
-	happly::PLYData plyData(filename);
-	std::vector<std::array<double, 3>> position = plyData.getVertexPositions();
-	std::vector<std::vector<uint32>> face_indices = plyData.getFaceIndices<uint32>();
+	std::ifstream in_file(filename, std::ios::in | std::ios::binary);
+	if (!in_file.is_open())
+	{
+		std::cerr << "Unable to open file \"" << filename << "\"." << std::endl;
+		return false;
+	}
+
+	// happly throws on a malformed header and leaves the stream in a failed state when the data is truncated
+	std::vector<std::array<double, 3>> position;
+	std::vector<std::vector<uint32>> face_indices;
+	try
+	{
+		happly::PLYData plyData(in_file);
+		if (in_file.fail())
+			throw std::runtime_error("unexpected end of file");
+		position = plyData.getVertexPositions();
+		face_indices = plyData.getFaceIndices<uint32>();
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "File \"" << filename << "\" is not a valid ply file: " << e.what() << std::endl;
+		return false;
+	}
 
 	const uint32 nb_vertices = position.size();
 	const uint32 nb_faces = face_indices.size();
@@ -66,6 +91,14 @@ bool import_PLY(MESH& m, const std::string& filename)
 
 	for (uint32 i = 0u; i < nb_faces; ++i)
 	{
+		for (uint32 index : face_indices[i])
+		{
+			if (index >= nb_vertices)
+			{
+				std::cerr << "File \"" << filename << "\" is not a valid ply file." << std::endl;
+				return false;
+			}
+		}
 		surface_data.faces_nb_vertices_.push_back(face_indices[i].size());
 		surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(), face_indices[i].begin(),
 												  face_indices[i].end());
@@ -76,13 +109,110 @@ bool import_PLY(MESH& m, const std::string& filename)
 	return true;
 }
 
+/**
+ * @brief export the given surface in the binary little endian PLY format
+ * With export_attributes, the vertex and face attributes that can be exported (see exported_attributes) are also
+ * written as properties of the vertex and face elements: "<name>" for scalars, "<name>_x", "<name>_y", ... for the
+ * components of vectors ("nx", "ny", "nz" for a vertex attribute named "normal").
+ */
 template <typename MESH>
 void export_PLY(MESH& m, const typename mesh_traits<MESH>::template Attribute<geometry::Vec3>* vertex_position,
-				const std::string& filename)
+				const std::string& filename, bool export_attributes = false)
 {
 	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
 
-	// TODO
+	using Vertex = typename MESH::Vertex;
+	using Face = typename MESH::Face;
+
+	auto vertex_id = add_attribute<uint32, Vertex>(m, "__vertex_id");
+
+	CellCache<MESH> cache(m);
+	cache.template build<Vertex>();
+	cache.template build<Face>();
+	const std::vector<Vertex>& vertices = cache.template cell_vector<Vertex>();
+	const std::vector<Face>& faces = cache.template cell_vector<Face>();
+
+	for (uint32 i = 0u, nb = uint32(vertices.size()); i < nb; ++i)
+		value<uint32>(m, vertex_id, vertices[i]) = i;
+
+	std::vector<std::unique_ptr<ExportedAttribute>> vertex_attributes;
+	std::vector<std::unique_ptr<ExportedAttribute>> face_attributes;
+	if (export_attributes)
+	{
+		vertex_attributes = exported_attributes<Vertex>(m, {vertex_position});
+		face_attributes = exported_attributes<Face>(m, {});
+	}
+
+	// the number of vertices of the faces is written on a byte when possible
+	bool small_faces = true;
+	for (Face f : faces)
+		small_faces &= codegree(m, f) <= 255u;
+
+	auto write_properties = [](std::ostream& out, const std::vector<std::unique_ptr<ExportedAttribute>>& attributes,
+							   bool is_vertex) {
+		static const char* components[4] = {"_x", "_y", "_z", "_w"};
+		static const char* normal_components[3] = {"nx", "ny", "nz"};
+		for (const auto& a : attributes)
+		{
+			for (uint32 k = 0u; k < a->nb_components(); ++k)
+			{
+				out << "property " << a->ply_type() << " ";
+				if (a->nb_components() == 1u)
+					out << a->name();
+				else if (is_vertex && a->name() == "normal" && a->nb_components() == 3u)
+					out << normal_components[k];
+				else
+					out << a->name() << components[k];
+				out << "\n";
+			}
+		}
+	};
+
+	std::ofstream out_file(filename, std::ios::out | std::ios::binary);
+	out_file << "ply\n";
+	out_file << "format binary_little_endian 1.0\n";
+	out_file << "element vertex " << vertices.size() << "\n";
+	out_file << "property double x\n";
+	out_file << "property double y\n";
+	out_file << "property double z\n";
+	write_properties(out_file, vertex_attributes, true);
+	out_file << "element face " << faces.size() << "\n";
+	out_file << "property list " << (small_faces ? "uchar" : "uint") << " uint vertex_indices\n";
+	write_properties(out_file, face_attributes, false);
+	out_file << "end_header\n";
+
+	parallel_write(out_file, uint32(vertices.size()), [&](uint32 i, std::string& s) {
+		const geometry::Vec3& p = value<geometry::Vec3>(m, vertex_position, vertices[i]);
+		append_binary(s, p[0]);
+		append_binary(s, p[1]);
+		append_binary(s, p[2]);
+		const uint32 index = index_of(m, vertices[i]);
+		for (const auto& a : vertex_attributes)
+			a->append_binary(s, index);
+	});
+
+	parallel_write(out_file, uint32(faces.size()), [&](uint32 i, std::string& s) {
+		const uint32 nbv = codegree(m, faces[i]);
+		if (small_faces)
+			append_binary(s, uint8(nbv));
+		else
+			append_binary(s, nbv);
+		foreach_incident_vertex(m, faces[i], [&](Vertex v) -> bool {
+			append_binary(s, value<uint32>(m, vertex_id, v));
+			return true;
+		});
+		if (!face_attributes.empty())
+		{
+			const uint32 index = index_of(m, faces[i]);
+			for (const auto& a : face_attributes)
+				a->append_binary(s, index);
+		}
+	});
+
+	if (!out_file.good())
+		std::cerr << "Error while writing file \"" << filename << "\"." << std::endl;
+
+	remove_attribute<Vertex>(m, vertex_id);
 }
 
 } // namespace io
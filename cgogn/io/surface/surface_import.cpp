@@ -22,6 +22,7 @@
  *******************************************************************************/
 
 #include <cgogn/io/surface/surface_import.h>
+#include <cgogn/io/utils.h>
 
 #include <cgogn/core/types/incidence_graph/incidence_graph.h>
 #include <cgogn/core/types/maps/cmap/cmap2.h>
@@ -32,7 +33,8 @@
 #include <cgogn/core/functions/mesh_info.h>
 
 #include <algorithm>
-#include <set>
+#include <atomic>
+#include <tuple>
 
 namespace cgogn
 {
@@ -40,12 +42,66 @@ namespace cgogn
 namespace io
 {
 
+namespace
+{
+
+// remove the consecutive repeated vertices of a face (including the last one if it is the first one)
+inline void remove_repeated_vertices(std::vector<uint32>& vertices)
+{
+	vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+	if (vertices.size() > 1u && vertices.front() == vertices.back())
+		vertices.pop_back();
+}
+
+// create a face with the given vertices and return the dart of its first vertex
 template <typename MESH>
-auto import_surface_data_map_tmpl(MESH& m, SurfaceImportData& surface_data)
-	-> std::enable_if_t<std::is_convertible_v<MESH&, MapBase&>>
+Dart create_face(MESH& m, const std::vector<uint32>& vertices)
 {
 	using ParentMESH = typename MESH::Parent;
+	using Vertex = typename MESH::Vertex;
+
+	typename ParentMESH::Face f = add_face(static_cast<ParentMESH&>(m), uint32(vertices.size()), false);
+	Dart d = f.dart_;
+	for (uint32 v : vertices)
+	{
+		set_index<Vertex>(m, d, v);
+		// (a GMap2 vertex has 2 darts in each face: the sewing does not have to copy the indices)
+		if constexpr (std::is_same_v<MESH, GMap2>)
+			set_index<Vertex>(m, beta1(m, d), v);
+		d = phi1(m, d);
+	}
+	return f.dart_;
+}
 
+// only write the relations of the half-edges of opposite directions d and e: unlike phi2_sew, the topology version
+// of the mesh is not modified, so it can be called concurrently for different half-edges
+template <typename MESH>
+void link_half_edges(MESH& m, Dart d, Dart e)
+{
+	if constexpr (std::is_same_v<MESH, GMap2>)
+	{
+		const Dart d0 = beta0(m, d);
+		const Dart e0 = beta0(m, e);
+		cgogn_assert(beta2(m, d) == d && beta2(m, e) == e);
+		(*m.beta2_)[d.index_] = e0;
+		(*m.beta2_)[e0.index_] = d;
+		(*m.beta2_)[d0.index_] = e;
+		(*m.beta2_)[e.index_] = d0;
+	}
+	else
+	{
+		cgogn_assert(phi2(m, d) == d && phi2(m, e) == e);
+		(*m.phi2_)[d.index_] = e;
+		(*m.phi2_)[e.index_] = d;
+	}
+}
+
+} // namespace
+
+template <typename MESH>
+auto import_surface_data_map_tmpl(MESH& m, SurfaceImportData& surface_data)
+	-> std::enable_if_t<std::is_convertible_v<MESH&, MapBase&>>
+{
 	using Vertex = typename MESH::Vertex;
 
 	auto position = get_or_add_attribute<geometry::Vec3, Vertex>(m, surface_data.vertex_position_attribute_name_);
@@ -57,7 +113,12 @@ auto import_surface_data_map_tmpl(MESH& m, SurfaceImportData& surface_data)
 		surface_data.vertex_id_after_import_.push_back(vertex_id);
 	}
 
-	auto darts_per_vertex = add_attribute<std::vector<Dart>, Vertex>(m, "__darts_per_vertex");
+	// first dart and index of the first half-edge of each created face
+	std::vector<Dart> faces;
+	faces.reserve(surface_data.nb_faces_);
+	std::vector<uint32> faces_first_half_edge;
+	faces_first_half_edge.reserve(surface_data.nb_faces_ + 1u);
+	faces_first_half_edge.push_back(0u);
 
 	uint32 faces_vertex_index = 0u;
 	std::vector<uint32> vertices_buffer;
@@ -65,80 +126,88 @@ auto import_surface_data_map_tmpl(MESH& m, SurfaceImportData& surface_data)
 
 	for (uint32 i = 0u; i < surface_data.nb_faces_; ++i)
 	{
-		uint32 nbv = surface_data.faces_nb_vertices_[i];
+		const uint32 nbv = surface_data.faces_nb_vertices_[i];
 
 		vertices_buffer.clear();
-		uint32 prev = std::numeric_limits<uint32>::max();
-
 		for (uint32 j = 0u; j < nbv; ++j)
-		{
-			uint32 idx = surface_data.vertex_id_after_import_[surface_data.faces_vertex_indices_[faces_vertex_index++]];
-			if (idx != prev)
-			{
-				prev = idx;
-				vertices_buffer.push_back(idx);
-			}
-		}
-		if (vertices_buffer.front() == vertices_buffer.back())
-			vertices_buffer.pop_back();
+			vertices_buffer.push_back(
+				surface_data.vertex_id_after_import_[surface_data.faces_vertex_indices_[faces_vertex_index++]]);
+		remove_repeated_vertices(vertices_buffer);
 
-		nbv = uint32(vertices_buffer.size());
-		if (nbv > 2u)
+		if (vertices_buffer.size() > 2u)
 		{
-			typename ParentMESH::Face f = add_face(static_cast<ParentMESH&>(m), nbv, false);
-			Dart d = f.dart_;
-			for (uint32 j = 0u; j < nbv; ++j)
-			{
-				const uint32 vertex_index = vertices_buffer[j];
-				set_index<Vertex>(m, d, vertex_index);
-				(*darts_per_vertex)[vertex_index].push_back(d);
-				d = phi1(m, d);
-			}
+			faces.push_back(create_face(m, vertices_buffer));
+			faces_first_half_edge.push_back(faces_first_half_edge.back() + uint32(vertices_buffer.size()));
 		}
 	}
 
-	bool need_vertex_unicity_check = false;
-	uint32 nb_boundary_edges = 0u;
-
-	for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+	// phi2 sewing: the half-edges are grouped by their (min vertex, max vertex) key and each half-edge of a group is
+	// sewn with a half-edge of opposite direction of the same group (the remaining ones are boundary edges)
+	struct HalfEdgeKey
 	{
-		if (phi2(m, d) == d)
+		uint32 min_vertex_;
+		uint32 max_vertex_;
+		bool reversed_; // the half-edge goes from max_vertex_ to min_vertex_
+		Dart dart_;
+	};
+
+	std::vector<HalfEdgeKey> half_edges(faces_first_half_edge.back());
+	const uint32 nb_chunks = (uint32(faces.size()) + SORTING_CHUNK_SIZE - 1u) / SORTING_CHUNK_SIZE;
+	parallel_foreach_chunk(nb_chunks, [&](uint32 c) -> bool {
+		for (uint32 i = c * SORTING_CHUNK_SIZE, end = std::min(uint32(faces.size()), i + SORTING_CHUNK_SIZE); i < end;
+			 ++i)
 		{
-			uint32 vertex_index = index_of(m, Vertex(d));
-
-			const std::vector<Dart>& next_vertex_darts =
-				value<std::vector<Dart>>(m, darts_per_vertex, Vertex(phi1(m, d)));
-			bool phi2_found = false;
-			bool first_OK = true;
-
-			for (auto it = next_vertex_darts.begin(); it != next_vertex_darts.end() && !phi2_found; ++it)
+			uint32 he = faces_first_half_edge[i];
+			Dart d = faces[i];
+			uint32 v1 = index_of(m, Vertex(d));
+			do
 			{
-				if (index_of(m, Vertex(phi1(m, *it))) == vertex_index)
-				{
-					if (phi2(m, *it) == *it)
-					{
-						phi2_sew(m, d, *it);
-						phi2_found = true;
-
-						if constexpr (std::is_same_v<MESH, GMap2>)
-						{
-							copy_index<Vertex>(m, beta2(m, d), d);
-							Dart dd = beta0(m, d);
-							copy_index<Vertex>(m, dd, beta2(m, dd));
-						}
-					}
-					else
-						first_OK = false;
-				}
-			}
-
-			if (!phi2_found)
-				++nb_boundary_edges;
-
-			if (!first_OK)
-				need_vertex_unicity_check = true;
+				const Dart next = phi1(m, d);
+				const uint32 v2 = index_of(m, Vertex(next));
+				half_edges[he++] = {std::min(v1, v2), std::max(v1, v2), v1 > v2, d};
+				d = next;
+				v1 = v2;
+			} while (d != faces[i]);
 		}
-	}
+		return true;
+	});
+
+	const uint32 nb_vertex_indices =
+		surface_data.vertex_id_after_import_.empty()
+			? 0u
+			: *std::max_element(surface_data.vertex_id_after_import_.begin(),
+								surface_data.vertex_id_after_import_.end()) +
+				  1u;
+	const std::vector<uint32> offsets = parallel_bucket_sort(
+		half_edges, nb_vertex_indices, [](const HalfEdgeKey& he) { return he.min_vertex_; },
+		[](const HalfEdgeKey& he1, const HalfEdgeKey& he2) {
+			return std::tie(he1.max_vertex_, he1.reversed_, he1.dart_.index_) <
+				   std::tie(he2.max_vertex_, he2.reversed_, he2.dart_.index_);
+		});
+
+	std::atomic<uint32> nb_boundary_edges(0u);
+	parallel_foreach_bucket(offsets, [&](uint32 first, uint32 last) {
+		uint32 nb_unsewn = 0u;
+		for (uint32 group_end = first; first < last; first = group_end)
+		{
+			// [first, middle) go from min to max, [middle, group_end) go from max to min
+			uint32 middle = first;
+			while (middle < last && half_edges[middle].max_vertex_ == half_edges[first].max_vertex_ &&
+				   !half_edges[middle].reversed_)
+				++middle;
+			group_end = middle;
+			while (group_end < last && half_edges[group_end].max_vertex_ == half_edges[first].max_vertex_)
+				++group_end;
+
+			const uint32 nb_pairs = std::min(middle - first, group_end - middle);
+			for (uint32 k = 0u; k < nb_pairs; ++k)
+				link_half_edges(m, half_edges[first + k].dart_, half_edges[middle + k].dart_);
+			nb_unsewn += (group_end - first) - 2u * nb_pairs;
+		}
+		nb_boundary_edges.fetch_add(nb_unsewn, std::memory_order_relaxed);
+	});
+
+	++m.topology_version_;
 
 	if (nb_boundary_edges > 0u)
 	{
@@ -146,14 +215,23 @@ auto import_surface_data_map_tmpl(MESH& m, SurfaceImportData& surface_data)
 		std::cout << nb_holes << " hole(s) have been closed" << std::endl;
 		std::cout << nb_boundary_edges << " boundary edges" << std::endl;
 	}
+}
 
-	// if (need_vertex_unicity_check)
-	// {
-	// 	map_.template enforce_unique_orbit_embedding<Vertex::ORBIT>();
-	// 	cgogn_log_warning("create_map") << "Import Surface: non manifold vertices detected and corrected";
-	// }
+template <typename MESH>
+void import_surface_data_builder_tmpl(MESH& m, SurfaceImportData& surface_data)
+{
+	SurfaceBuilder<MESH> builder(m, surface_data.vertex_position_attribute_name_);
+	builder.reserve(surface_data.nb_vertices_, surface_data.nb_faces_);
 
-	remove_attribute<Vertex>(m, darts_per_vertex);
+	for (uint32 i = 0u; i < surface_data.nb_vertices_; ++i)
+	{
+		const uint32 v = builder.add_vertex(surface_data.vertex_position_[i]);
+		surface_data.vertex_id_after_import_.push_back(builder.vertex_index(v));
+	}
+
+	builder.add_faces(surface_data.faces_nb_vertices_.data(), surface_data.faces_vertex_indices_.data(),
+					  surface_data.nb_faces_);
+	builder.finish();
 }
 
 void import_surface_data(CMap2& m, SurfaceImportData& surface_data)
@@ -168,116 +246,325 @@ void import_surface_data(GMap2& m, SurfaceImportData& surface_data)
 
 void import_surface_data(IncidenceGraph& ig, SurfaceImportData& surface_data)
 {
-	using Vertex = IncidenceGraph::Vertex;
-	using Edge = IncidenceGraph::Edge;
-	using Face = IncidenceGraph::Face;
+	import_surface_data_builder_tmpl(ig, surface_data);
+}
 
-	auto position = get_or_add_attribute<geometry::Vec3, Vertex>(ig, surface_data.vertex_position_attribute_name_);
+void import_surface_data(TriangleSoup& ts, SurfaceImportData& surface_data)
+{
+	import_surface_data_builder_tmpl(ts, surface_data);
+}
 
-	for (uint32 i = 0u; i < surface_data.nb_vertices_; ++i)
-	{
-		Vertex v = add_vertex(ig);
-		(*position)[v.index_] = surface_data.vertex_position_[i];
-		surface_data.vertex_id_after_import_.push_back(v.index_);
-	}
+/////////////////////////////////////////////////////////////////////////////
+// SurfaceBuilder                                                          //
+/////////////////////////////////////////////////////////////////////////////
 
-	uint32 faces_vertex_index = 0u;
-	std::vector<uint32> vertices_buffer;
-	vertices_buffer.reserve(16u);
-	std::vector<Edge> face_edges;
-	face_edges.reserve(16u);
+template <typename MESH>
+struct SurfaceBuilder<MESH>::Impl
+{
+	using Vertex = typename MESH::Vertex;
 
-	std::set<std::pair<uint32, uint32>> edges;
+	static const bool is_map = std::is_convertible_v<MESH&, MapBase&>;
+	static const bool is_incidence_graph = std::is_same_v<MESH, IncidenceGraph>;
 
-	for (uint32 i = 0u; i < surface_data.nb_faces_; ++i)
+	// element of the list of a vertex: a pending half-edge (for maps) or an edge (for incidence graphs)
+	// between the vertex of the list and other_vertex_ (which has a greater index)
+	struct Link
 	{
-		uint32 nbv = surface_data.faces_nb_vertices_[i];
-
-		face_edges.clear();
+		uint32 other_vertex_;
+		uint32 element_; // dart or edge index
+		uint32 next_;
+		bool reversed_; // the half-edge goes from other_vertex_ to the vertex of the list
+	};
+
+	Impl(MESH& m, const std::string& vertex_position_attribute_name)
+		: m_(m), position_(get_or_add_attribute<Vec3, Vertex>(m, vertex_position_attribute_name))
+	{
+	}
 
-		vertices_buffer.clear();
-		uint32 prev = std::numeric_limits<uint32>::max();
+	void push_link(uint32 v, const Link& link)
+	{
+		uint32 l = free_link_;
+		if (l != INVALID_INDEX)
+		{
+			free_link_ = links_[l].next_;
+			links_[l] = link;
+		}
+		else
+		{
+			l = uint32(links_.size());
+			links_.push_back(link);
+		}
+		links_[l].next_ = first_link_[v];
+		first_link_[v] = l;
+	}
 
-		for (uint32 j = 0u; j < nbv; ++j)
+	// sew the half-edge d (from vertex a to vertex b) with a pending half-edge of opposite direction if any
+	void add_half_edge(uint32 a, uint32 b, Dart d)
+	{
+		const uint32 v = std::min(a, b);
+		const uint32 other = std::max(a, b);
+		const bool reversed = a > b;
+		uint32 prev = INVALID_INDEX;
+		for (uint32 l = first_link_[v]; l != INVALID_INDEX; prev = l, l = links_[l].next_)
 		{
-			uint32 idx = surface_data.vertex_id_after_import_[surface_data.faces_vertex_indices_[faces_vertex_index++]];
-			if (idx != prev)
+			Link& link = links_[l];
+			if (link.other_vertex_ == other && link.reversed_ != reversed)
 			{
-				prev = idx;
-				vertices_buffer.push_back(idx);
+				if constexpr (is_map)
+					phi2_sew(m_, Dart(link.element_), d);
+				(prev == INVALID_INDEX ? first_link_[v] : links_[prev].next_) = link.next_;
+				link.next_ = free_link_;
+				free_link_ = l;
+				--nb_pending_;
+				return;
 			}
 		}
-		if (vertices_buffer.front() == vertices_buffer.back())
-			vertices_buffer.pop_back();
+		push_link(v, {other, d.index_, INVALID_INDEX, reversed});
+		++nb_pending_;
+	}
+
+	// existing edge between vertices a and b or new edge
+	uint32 edge(uint32 a, uint32 b)
+	{
+		const uint32 v = std::min(a, b);
+		const uint32 other = std::max(a, b);
+		for (uint32 l = first_link_[v]; l != INVALID_INDEX; l = links_[l].next_)
+		{
+			if (links_[l].other_vertex_ == other)
+				return links_[l].element_;
+		}
+		uint32 e = INVALID_INDEX;
+		if constexpr (is_incidence_graph)
+			e = add_edge(m_, Vertex(a), Vertex(b)).index_;
+		push_link(v, {other, e, INVALID_INDEX, false});
+		return e;
+	}
+
+	// face_vertices_ holds the mesh indices of the vertices of the face
+	void build_face()
+	{
+		remove_repeated_vertices(face_vertices_);
+		const uint32 nbv = uint32(face_vertices_.size());
+		if (nbv < 3u)
+			return;
+		++nb_faces_;
 
-		nbv = uint32(vertices_buffer.size());
-		if (nbv > 2u)
+		if constexpr (is_map)
 		{
+			Dart d = create_face(m_, face_vertices_);
 			for (uint32 j = 0u; j < nbv; ++j)
 			{
-				uint32 vertex_index_1 = vertices_buffer[j];
-				uint32 vertex_index_2 = vertices_buffer[(j + 1) % nbv];
-
-				if (vertex_index_1 > vertex_index_2)
-					std::swap(vertex_index_1, vertex_index_2);
-
-				std::pair<uint32, uint32> e(vertex_index_1, vertex_index_2);
-				if (edges.find(e) == edges.end())
-				{
-					Edge edge = add_edge(ig, e.first, e.second);
-					face_edges.push_back(edge);
-				}
+				const Dart next = phi1(m_, d);
+				add_half_edge(face_vertices_[j], face_vertices_[(j + 1u) % nbv], d);
+				d = next;
 			}
-
-			add_face(ig, face_edges);
+		}
+		else if constexpr (is_incidence_graph)
+		{
+			face_edges_.clear();
+			for (uint32 j = 0u; j < nbv; ++j)
+				face_edges_.push_back(IncidenceGraph::Edge(edge(face_vertices_[j], face_vertices_[(j + 1u) % nbv])));
+			cgogn::add_face(m_, face_edges_);
+		}
+		else
+		{
+			for (uint32 j = 1u; j < nbv - 1u; ++j)
+				cgogn::add_face(m_, face_vertices_[0], face_vertices_[j], face_vertices_[j + 1]);
 		}
 	}
+
+	MESH& m_;
+	std::shared_ptr<typename mesh_traits<MESH>::template Attribute<Vec3>> position_;
+
+	std::vector<uint32> vertex_id_; // mesh index of the added vertices
+
+	// lists indexed by the mesh index of the vertices
+	std::vector<uint32> first_link_;
+	std::vector<Link> links_;
+	uint32 free_link_ = INVALID_INDEX;
+	uint32 nb_pending_ = 0u;
+
+	uint32 nb_faces_ = 0u;
+
+	// faces that reference vertices that are not added yet
+	std::vector<uint32> deferred_faces_nb_vertices_;
+	std::vector<uint32> deferred_faces_vertex_indices_;
+
+	std::vector<uint32> face_vertices_;
+	std::conditional_t<is_incidence_graph, std::vector<IncidenceGraph::Edge>, std::vector<uint32>> face_edges_;
+};
+
+template <typename MESH>
+SurfaceBuilder<MESH>::SurfaceBuilder(MESH& m, const std::string& vertex_position_attribute_name)
+	: impl_(std::make_unique<Impl>(m, vertex_position_attribute_name))
+{
 }
 
-void import_surface_data(TriangleSoup& ts, SurfaceImportData& surface_data)
+template <typename MESH>
+SurfaceBuilder<MESH>::~SurfaceBuilder()
 {
-	using Vertex = TriangleSoup::Vertex;
-	using Face = TriangleSoup::Face;
+}
 
-	auto position = get_or_add_attribute<geometry::Vec3, Vertex>(ts, surface_data.vertex_position_attribute_name_);
+template <typename MESH>
+void SurfaceBuilder<MESH>::reserve(uint32 nb_vertices, uint32 nb_faces)
+{
+	impl_->vertex_id_.reserve(nb_vertices);
+	if constexpr (Impl::is_map || Impl::is_incidence_graph)
+		impl_->first_link_.reserve(nb_vertices);
+	(void)nb_faces;
+}
 
-	for (uint32 i = 0u; i < surface_data.nb_vertices_; ++i)
+template <typename MESH>
+uint32 SurfaceBuilder<MESH>::add_vertices(uint32 nb)
+{
+	using Vertex = typename MESH::Vertex;
+
+	const uint32 first = uint32(impl_->vertex_id_.size());
+	for (uint32 i = 0u; i < nb; ++i)
 	{
-		uint32 vertex_id = new_index<Vertex>(ts);
-		(*position)[vertex_id] = surface_data.vertex_position_[i];
-		surface_data.vertex_id_after_import_.push_back(vertex_id);
+		uint32 vertex_id;
+		if constexpr (Impl::is_incidence_graph)
+			vertex_id = cgogn::add_vertex(impl_->m_).index_;
+		else
+			vertex_id = new_index<Vertex>(impl_->m_);
+		impl_->vertex_id_.push_back(vertex_id);
+		if constexpr (Impl::is_map || Impl::is_incidence_graph)
+		{
+			if (vertex_id >= impl_->first_link_.size())
+				impl_->first_link_.resize(vertex_id + 1u, INVALID_INDEX);
+		}
 	}
+	return first;
+}
 
-	uint32 faces_vertex_index = 0u;
-	std::vector<uint32> vertices_buffer;
-	vertices_buffer.reserve(8u);
+template <typename MESH>
+uint32 SurfaceBuilder<MESH>::add_vertex(const Vec3& position)
+{
+	const uint32 v = add_vertices(1u);
+	vertex_position(v) = position;
+	return v;
+}
 
-	for (uint32 i = 0u; i < surface_data.nb_faces_; ++i)
+template <typename MESH>
+Vec3& SurfaceBuilder<MESH>::vertex_position(uint32 v)
+{
+	return (*impl_->position_)[impl_->vertex_id_[v]];
+}
+
+template <typename MESH>
+uint32 SurfaceBuilder<MESH>::nb_vertices() const
+{
+	return uint32(impl_->vertex_id_.size());
+}
+
+template <typename MESH>
+uint32 SurfaceBuilder<MESH>::vertex_index(uint32 v) const
+{
+	return impl_->vertex_id_[v];
+}
+
+template <typename MESH>
+uint32 SurfaceBuilder<MESH>::nb_faces() const
+{
+	return impl_->nb_faces_;
+}
+
+template <typename MESH>
+void SurfaceBuilder<MESH>::add_face(const uint32* vertex_indices, uint32 nb_vertices)
+{
+	Impl& impl = *impl_;
+	impl.face_vertices_.clear();
+	for (uint32 i = 0u; i < nb_vertices; ++i)
 	{
-		uint32 nbv = surface_data.faces_nb_vertices_[i];
-		vertices_buffer.clear();
-		uint32 prev = std::numeric_limits<uint32>::max();
-		for (uint32 j = 0u; j < nbv; ++j)
+		if (vertex_indices[i] >= impl.vertex_id_.size())
 		{
-			uint32 idx = surface_data.vertex_id_after_import_[surface_data.faces_vertex_indices_[faces_vertex_index++]];
-			if (idx != prev)
-			{
-				prev = idx;
-				vertices_buffer.push_back(idx);
-			}
+			impl.deferred_faces_nb_vertices_.push_back(nb_vertices);
+			impl.deferred_faces_vertex_indices_.insert(impl.deferred_faces_vertex_indices_.end(), vertex_indices,
+													   vertex_indices + nb_vertices);
+			return;
 		}
-		if (vertices_buffer.front() == vertices_buffer.back())
-			vertices_buffer.pop_back();
+		impl.face_vertices_.push_back(impl.vertex_id_[vertex_indices[i]]);
+	}
+	impl.build_face();
+}
+
+template <typename MESH>
+void SurfaceBuilder<MESH>::add_faces(const uint32* faces_nb_vertices, const uint32* faces_vertex_indices,
+									 uint32 nb_faces)
+{
+	for (uint32 i = 0u; i < nb_faces; ++i)
+	{
+		add_face(faces_vertex_indices, faces_nb_vertices[i]);
+		faces_vertex_indices += faces_nb_vertices[i];
+	}
+}
+
+template <typename MESH>
+bool SurfaceBuilder<MESH>::finish()
+{
+	Impl& impl = *impl_;
+
+	// the map is always completed (even if the import is cancelled)
+	report_import_progress(ImportPhase::Building);
 
-		nbv = uint32(vertices_buffer.size());
-		if (nbv > 2u)
+	// a face that still references an unknown vertex invalidates the whole mesh
+	const uint32 nb_vertices = uint32(impl.vertex_id_.size());
+	if (std::any_of(impl.deferred_faces_vertex_indices_.begin(), impl.deferred_faces_vertex_indices_.end(),
+					[&](uint32 v) { return v >= nb_vertices; }))
+	{
+		abort();
+		return false;
+	}
+
+	const uint32* indices = impl.deferred_faces_vertex_indices_.data();
+	for (uint32 nbv : impl.deferred_faces_nb_vertices_)
+	{
+		add_face(indices, nbv);
+		indices += nbv;
+	}
+	impl.deferred_faces_nb_vertices_ = std::vector<uint32>();
+	impl.deferred_faces_vertex_indices_ = std::vector<uint32>();
+
+	impl.first_link_ = std::vector<uint32>();
+	impl.links_ = std::vector<typename Impl::Link>();
+	impl.free_link_ = INVALID_INDEX;
+
+	if constexpr (Impl::is_map)
+	{
+		if (impl.nb_pending_ > 0u)
 		{
-			for (uint32 j = 1u; j < nbv - 1u; ++j)
-				add_face(ts, vertices_buffer[0], vertices_buffer[j], vertices_buffer[j + 1]);
+			uint32 nb_holes = close(impl.m_);
+			std::cout << nb_holes << " hole(s) have been closed" << std::endl;
+			std::cout << impl.nb_pending_ << " boundary edges" << std::endl;
+			impl.nb_pending_ = 0u;
 		}
 	}
+
+	return true;
 }
 
+template <typename MESH>
+void SurfaceBuilder<MESH>::abort()
+{
+	Impl& impl = *impl_;
+
+	impl.vertex_id_ = std::vector<uint32>();
+	impl.first_link_ = std::vector<uint32>();
+	impl.links_ = std::vector<typename Impl::Link>();
+	impl.free_link_ = INVALID_INDEX;
+	impl.nb_pending_ = 0u;
+	impl.nb_faces_ = 0u;
+	impl.deferred_faces_nb_vertices_ = std::vector<uint32>();
+	impl.deferred_faces_vertex_indices_ = std::vector<uint32>();
+
+	clear(impl.m_);
+}
+
+template class SurfaceBuilder<CMap2>;
+template class SurfaceBuilder<GMap2>;
+template class SurfaceBuilder<IncidenceGraph>;
+template class SurfaceBuilder<TriangleSoup>;
+
 } // namespace io
 
 } // namespace cgogn
@@ -29,6 +29,8 @@
 #include <cgogn/core/utils/numerics.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace cgogn
@@ -66,6 +68,32 @@ struct SurfaceImportData
 		faces_vertex_indices_.reserve(nb_faces * 4u);
 		vertex_id_after_import_.reserve(nb_vertices);
 	}
+
+	// same interface as SurfaceBuilder (used by the readers)
+
+	inline uint32 add_vertices(uint32 nb)
+	{
+		const uint32 first = uint32(vertex_position_.size());
+		vertex_position_.resize(first + nb);
+		nb_vertices_ = uint32(vertex_position_.size());
+		return first;
+	}
+
+	inline Vec3& vertex_position(uint32 v)
+	{
+		return vertex_position_[v];
+	}
+
+	inline void add_faces(const uint32* faces_nb_vertices, const uint32* faces_vertex_indices, uint32 nb_faces)
+	{
+		uint64 nb_indices = 0u;
+		for (uint32 i = 0u; i < nb_faces; ++i)
+			nb_indices += faces_nb_vertices[i];
+		faces_nb_vertices_.insert(faces_nb_vertices_.end(), faces_nb_vertices, faces_nb_vertices + nb_faces);
+		faces_vertex_indices_.insert(faces_vertex_indices_.end(), faces_vertex_indices,
+									 faces_vertex_indices + nb_indices);
+		nb_faces_ = uint32(faces_nb_vertices_.size());
+	}
 };
 
 void CGOGN_IO_EXPORT import_surface_data(CMap2& m, SurfaceImportData& surface_data);
@@ -73,6 +101,66 @@ void CGOGN_IO_EXPORT import_surface_data(GMap2& m, SurfaceImportData& surface_da
 void CGOGN_IO_EXPORT import_surface_data(IncidenceGraph& m, SurfaceImportData& surface_data);
 void CGOGN_IO_EXPORT import_surface_data(TriangleSoup& m, SurfaceImportData& surface_data);
 
+/////////////////////////////////////////////////////////////////////////////
+// SurfaceBuilder                                                          //
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief incremental construction of a surface mesh from batches of vertices and faces
+ * Unlike SurfaceImportData, nothing is buffered: the vertices and faces are created in the mesh as soon as they are
+ * given. The half-edges that are not sewn yet are kept in per vertex pending lists and each new half-edge is sewn with
+ * a pending half-edge of opposite direction, so the extra memory is proportional to the current boundary of the
+ * mesh. A face that references a vertex that is not given yet is deferred until finish().
+ */
+template <typename MESH>
+class SurfaceBuilder
+{
+public:
+	SurfaceBuilder(MESH& m, const std::string& vertex_position_attribute_name = "position");
+	~SurfaceBuilder();
+
+	SurfaceBuilder(const SurfaceBuilder&) = delete;
+	SurfaceBuilder& operator=(const SurfaceBuilder&) = delete;
+
+	void reserve(uint32 nb_vertices, uint32 nb_faces);
+
+	/**
+	 * @brief add nb vertices (their positions are then set with vertex_position)
+	 * @return the index of the first added vertex (the vertices are numbered in the order they are added)
+	 */
+	uint32 add_vertices(uint32 nb);
+	uint32 add_vertex(const Vec3& position);
+
+	// can be called concurrently for different vertices
+	Vec3& vertex_position(uint32 v);
+	uint32 nb_vertices() const;
+	// index of the given vertex in the mesh
+	uint32 vertex_index(uint32 v) const;
+	// number of faces built so far (the degenerated faces are ignored)
+	uint32 nb_faces() const;
+
+	void add_face(const uint32* vertex_indices, uint32 nb_vertices);
+	void add_faces(const uint32* faces_nb_vertices, const uint32* faces_vertex_indices, uint32 nb_faces);
+
+	/**
+	 * @brief build the deferred faces and close the boundary of the mesh
+	 * @return false if a face references a vertex that has not been added (the mesh is then cleared, see abort)
+	 */
+	bool finish();
+
+	// discard the building (after an invalid or cancelled import): the mesh is cleared and nothing is sewn or closed
+	void abort();
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> impl_;
+};
+
+extern template class CGOGN_IO_EXPORT SurfaceBuilder<CMap2>;
+extern template class CGOGN_IO_EXPORT SurfaceBuilder<GMap2>;
+extern template class CGOGN_IO_EXPORT SurfaceBuilder<IncidenceGraph>;
+extern template class CGOGN_IO_EXPORT SurfaceBuilder<TriangleSoup>;
+
 } // namespace io
 
 } // namespace cgogn
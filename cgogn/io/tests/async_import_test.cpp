@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/types/cell_marker.h>
+#include <cgogn/core/utils/thread.h>
+#include <cgogn/io/async_import.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace cgogn
+{
+
+TEST(AsyncImportTest, ThreadIndices)
+{
+	// the imports wait for each other so that they run at the same time
+	std::atomic<uint32> nb_started(0u);
+	std::vector<uint32> indices(2u, 0u);
+	auto import = [&](uint32 i) {
+		return [&, i](CMap2& m, const std::string&) -> bool {
+			indices[i] = current_thread_index();
+			++nb_started;
+			while (nb_started < 2u)
+				std::this_thread::yield();
+			for (uint32 j = 0u; j < 100u; ++j)
+				add_face(m, 3u + j % 3u);
+			CellMarker<CMap2, CMap2::Face> cm(m);
+			foreach_cell(m, [&](CMap2::Face f) -> bool {
+				cm.mark(f);
+				return true;
+			});
+			return true;
+		};
+	};
+
+	auto import0 = io::import_async<CMap2>("0", import(0u));
+	auto import1 = io::import_async<CMap2>("1", import(1u));
+	std::unique_ptr<CMap2> m0 = import0->get();
+	std::unique_ptr<CMap2> m1 = import1->get();
+	ASSERT_TRUE(m0 != nullptr);
+	ASSERT_TRUE(m1 != nullptr);
+	EXPECT_EQ(nb_cells<CMap2::Face>(*m0), 100u);
+
+	// the index 0 is the one of the main thread
+	EXPECT_NE(indices[0], 0u);
+	EXPECT_NE(indices[1], 0u);
+	EXPECT_NE(indices[0], indices[1]);
+}
+
+} // namespace cgogn
@@ -0,0 +1,298 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+#include <cgogn/core/types/maps/cmap/cmap3.h>
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/types/cell_marker.h>
+#include <cgogn/io/surface/obj.h>
+#include <cgogn/io/surface/off.h>
+#include <cgogn/io/surface/surface_import.h>
+#include <cgogn/io/volume/volume_import.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace cgogn
+{
+
+class BuilderTest : public ::testing::Test
+{
+protected:
+	// grid of n x n quads, with a triangle on the bottom edge of every 7th cell if fins is set
+	// (a fin makes its edge non-manifold, or adds a boundary edge on the first row)
+	static io::SurfaceImportData surface_data(uint32 n, bool fins)
+	{
+		io::SurfaceImportData surface_data;
+		std::vector<uint32> fins_cells;
+		for (uint32 c = 0u; fins && c < n * n; c += 7u)
+			fins_cells.push_back(c);
+		const uint32 nb_grid_vertices = (n + 1u) * (n + 1u);
+		surface_data.reserve(nb_grid_vertices + uint32(fins_cells.size()), n * n + uint32(fins_cells.size()));
+		for (uint32 j = 0u; j <= n; ++j)
+			for (uint32 i = 0u; i <= n; ++i)
+				surface_data.vertex_position_.emplace_back(float64(i), float64(j), 0.0);
+		for (uint32 j = 0u; j < n; ++j)
+		{
+			for (uint32 i = 0u; i < n; ++i)
+			{
+				const uint32 v = j * (n + 1u) + i;
+				surface_data.faces_nb_vertices_.push_back(4u);
+				surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(),
+														  {v, v + 1u, v + n + 2u, v + n + 1u});
+			}
+		}
+		for (uint32 k = 0u, nb = uint32(fins_cells.size()); k < nb; ++k)
+		{
+			const uint32 c = fins_cells[k];
+			const uint32 v = (c / n) * (n + 1u) + c % n;
+			surface_data.vertex_position_.emplace_back(float64(c % n) + 0.5, float64(c / n), 1.0);
+			surface_data.faces_nb_vertices_.push_back(3u);
+			surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(),
+													  {v, v + 1u, nb_grid_vertices + k});
+		}
+		return surface_data;
+	}
+
+	// grid of n x n x n hexahedra
+	static io::VolumeImportData volume_data(uint32 n)
+	{
+		io::VolumeImportData volume_data;
+		volume_data.reserve((n + 1u) * (n + 1u) * (n + 1u), n * n * n);
+		for (uint32 k = 0u; k <= n; ++k)
+			for (uint32 j = 0u; j <= n; ++j)
+				for (uint32 i = 0u; i <= n; ++i)
+					volume_data.vertex_position_.emplace_back(float64(i), float64(j), float64(k));
+		const uint32 dj = n + 1u;
+		const uint32 dk = (n + 1u) * (n + 1u);
+		for (uint32 k = 0u; k < n; ++k)
+		{
+			for (uint32 j = 0u; j < n; ++j)
+			{
+				for (uint32 i = 0u; i < n; ++i)
+				{
+					const uint32 v = k * dk + j * dj + i;
+					volume_data.volumes_types_.push_back(io::Hexa);
+					volume_data.volumes_vertex_indices_.insert(
+						volume_data.volumes_vertex_indices_.end(),
+						{v, v + 1u, v + dj + 1u, v + dj, v + dk, v + dk + 1u, v + dk + dj + 1u, v + dk + dj});
+				}
+			}
+		}
+		return volume_data;
+	}
+
+	template <typename MESH>
+	static uint32 nb_boundary_darts(const MESH& m)
+	{
+		uint32 nb = 0u;
+		for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+		{
+			if (is_boundary(m, d))
+				++nb;
+		}
+		return nb;
+	}
+
+	std::string write_file(const std::string& extension, const std::string& content)
+	{
+		const std::string filename = ::testing::TempDir() + "cgogn_builder_test." + extension;
+		std::ofstream file(filename, std::ios::out | std::ios::binary);
+		file << content;
+		filenames_.push_back(filename);
+		return filename;
+	}
+
+	~BuilderTest() override
+	{
+		for (const std::string& filename : filenames_)
+			std::remove(filename.c_str());
+	}
+
+	std::vector<std::string> filenames_;
+};
+
+TEST_F(BuilderTest, DeferredFaces)
+{
+	CMap2 m;
+	io::SurfaceBuilder<CMap2> builder(m);
+	const uint32 f1[3] = {0u, 1u, 2u};
+	const uint32 f2[3] = {0u, 2u, 3u};
+
+	builder.add_vertices(3u);
+	builder.add_face(f2, 3u);
+	EXPECT_EQ(builder.nb_faces(), 0u);
+	builder.add_face(f1, 3u);
+	EXPECT_EQ(builder.nb_faces(), 1u);
+	EXPECT_EQ(builder.add_vertex(geometry::Vec3(0.0, 1.0, 0.0)), 3u);
+	EXPECT_EQ(builder.nb_faces(), 1u);
+
+	ASSERT_TRUE(builder.finish());
+	EXPECT_EQ(builder.nb_faces(), 2u);
+	EXPECT_EQ(nb_cells<CMap2::Vertex>(m), 4u);
+	EXPECT_EQ(nb_cells<CMap2::Edge>(m), 5u);
+	EXPECT_EQ(nb_cells<CMap2::Face>(m), 2u);
+	EXPECT_EQ(nb_boundary_darts(m), 4u);
+	EXPECT_TRUE(check_integrity(m, false));
+
+	auto vertex_position = get_attribute<geometry::Vec3, CMap2::Vertex>(m, "position");
+	ASSERT_TRUE(vertex_position != nullptr);
+	EXPECT_EQ((*vertex_position)[builder.vertex_index(3u)], geometry::Vec3(0.0, 1.0, 0.0));
+}
+
+// half of the faces are given before their vertices
+TEST_F(BuilderTest, SurfaceSameAsImportData)
+{
+	const uint32 n = 60u;
+	const uint32 nb_fins = (n * n + 6u) / 7u;
+
+	for (bool fins : {false, true})
+	{
+		io::SurfaceImportData data = surface_data(n, fins);
+
+		CMap2 m;
+		io::SurfaceBuilder<CMap2> builder(m);
+		const uint32 nb_vertices = uint32(data.vertex_position_.size());
+		const uint32 nb_first_vertices = nb_vertices / 2u;
+		builder.add_vertices(nb_first_vertices);
+		builder.add_faces(data.faces_nb_vertices_.data(), data.faces_vertex_indices_.data(),
+						  uint32(data.faces_nb_vertices_.size()));
+		EXPECT_LT(builder.nb_faces(), uint32(data.faces_nb_vertices_.size()));
+		builder.add_vertices(nb_vertices - nb_first_vertices);
+		for (uint32 v = 0u; v < nb_vertices; ++v)
+			builder.vertex_position(v) = data.vertex_position_[v];
+		ASSERT_TRUE(builder.finish());
+		EXPECT_EQ(builder.nb_faces(), uint32(data.faces_nb_vertices_.size()));
+
+		CMap2 m2;
+		io::import_surface_data(m2, data);
+
+		EXPECT_EQ(nb_cells<CMap2::Vertex>(m), nb_cells<CMap2::Vertex>(m2));
+		EXPECT_EQ(nb_cells<CMap2::Edge>(m), nb_cells<CMap2::Edge>(m2));
+		EXPECT_EQ(nb_cells<CMap2::Face>(m), nb_cells<CMap2::Face>(m2));
+		EXPECT_EQ(nb_darts(m), nb_darts(m2));
+		// the 3 half-edges of a non-manifold edge (or the 2 half-edges of the same direction of a fin of the first
+		// row) are sewn at most once
+		EXPECT_EQ(nb_boundary_darts(m), 4u * n + (fins ? 3u * nb_fins : 0u));
+		EXPECT_EQ(nb_boundary_darts(m2), nb_boundary_darts(m));
+		for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+		{
+			EXPECT_NE(phi2(m, d), d);
+			EXPECT_EQ(phi2(m, phi2(m, d)), d);
+		}
+		// (the vertices of the non-manifold edges are split in several orbits that share their index)
+		if (!fins)
+		{
+			EXPECT_TRUE(check_integrity(m, false));
+			EXPECT_TRUE(check_integrity(m2, false));
+		}
+	}
+}
+
+// the last volumes are given before their vertices
+TEST_F(BuilderTest, VolumeSameAsImportData)
+{
+	const uint32 n = 8u;
+	io::VolumeImportData data = volume_data(n);
+
+	CMap3 m;
+	io::VolumeBuilder<CMap3> builder(m);
+	const uint32 nb_vertices = uint32(data.vertex_position_.size());
+	builder.add_vertices(nb_vertices / 2u);
+	for (uint32 i = 0u, nb = uint32(data.volumes_types_.size()); i < nb; ++i)
+		builder.add_volume(data.volumes_types_[i], &data.volumes_vertex_indices_[8u * i]);
+	builder.add_vertices(nb_vertices - nb_vertices / 2u);
+	for (uint32 v = 0u; v < nb_vertices; ++v)
+		builder.vertex_position(v) = data.vertex_position_[v];
+	ASSERT_TRUE(builder.finish());
+
+	CMap3 m2;
+	io::import_volume_data(m2, data);
+
+	EXPECT_EQ(nb_cells<CMap3::Vertex>(m), (n + 1u) * (n + 1u) * (n + 1u));
+	EXPECT_EQ(nb_cells<CMap3::Vertex>(m), nb_cells<CMap3::Vertex>(m2));
+	EXPECT_EQ(nb_cells<CMap3::Edge>(m), nb_cells<CMap3::Edge>(m2));
+	EXPECT_EQ(nb_cells<CMap3::Face>(m), nb_cells<CMap3::Face>(m2));
+	EXPECT_EQ(nb_cells<CMap3::Volume>(m), nb_cells<CMap3::Volume>(m2));
+	EXPECT_EQ(nb_darts(m), nb_darts(m2));
+	EXPECT_TRUE(check_integrity(m, false));
+	EXPECT_TRUE(check_integrity(m2, false));
+}
+
+// a failed build leaves the mesh empty
+TEST_F(BuilderTest, Failure)
+{
+	const uint32 faces[7] = {0u, 1u, 2u, 0u, 2u, 3u, 9u};
+
+	CMap2 m;
+	io::SurfaceBuilder<CMap2> builder(m);
+	builder.add_vertices(4u);
+	builder.add_face(faces, 3u);
+	builder.add_face(faces + 3u, 4u);
+	EXPECT_FALSE(builder.finish());
+	EXPECT_EQ(nb_darts(m), 0u);
+	EXPECT_EQ(nb_cells<CMap2::Vertex>(m), 0u);
+
+	CMap2 m2;
+	io::SurfaceBuilder<CMap2> builder2(m2);
+	builder2.add_vertices(4u);
+	builder2.add_face(faces, 3u);
+	builder2.abort();
+	EXPECT_EQ(nb_darts(m2), 0u);
+	EXPECT_EQ(nb_cells<CMap2::Vertex>(m2), 0u);
+	EXPECT_EQ(builder2.nb_vertices(), 0u);
+
+	io::VolumeImportData data = volume_data(2u);
+	data.volumes_vertex_indices_.back() = 100u;
+	CMap3 m3;
+	io::VolumeBuilder<CMap3> builder3(m3);
+	builder3.add_vertices(uint32(data.vertex_position_.size()));
+	for (uint32 i = 0u, nb = uint32(data.volumes_types_.size()); i < nb; ++i)
+		builder3.add_volume(data.volumes_types_[i], &data.volumes_vertex_indices_[8u * i]);
+	EXPECT_FALSE(builder3.finish());
+	EXPECT_EQ(nb_darts(m3), 0u);
+	EXPECT_EQ(nb_cells<CMap3::Vertex>(m3), 0u);
+
+	// invalid files
+	const std::string vertices = "0 0 0\n1 0 0\n1 1 0\n0 1 0\n";
+	CMap2 m4;
+	EXPECT_FALSE(io::import_OFF(m4, write_file("off", "OFF\n4 2 0\n" + vertices + "3 0 1 2\n3 0 2 4\n")));
+	EXPECT_EQ(nb_darts(m4), 0u);
+	EXPECT_EQ(nb_cells<CMap2::Vertex>(m4), 0u);
+	CMap2 m5;
+	EXPECT_FALSE(io::import_OBJ(m5, write_file("obj", "v " + vertices.substr(0u, 6u) + "v 1 0 0\nv 1 1 0\n"
+																					   "f 1 2 3\nf 1 3 4\n")));
+	EXPECT_EQ(nb_darts(m5), 0u);
+	EXPECT_EQ(nb_cells<CMap2::Vertex>(m5), 0u);
+	CMap2 m6;
+	EXPECT_FALSE(io::import_OBJ(m6, write_file("obj", "v 0 0 0\nv 1 0 0\nv 1 1 0\n")));
+	EXPECT_EQ(nb_cells<CMap2::Vertex>(m6), 0u);
+}
+
+} // namespace cgogn
@@ -0,0 +1,192 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+#include <cgogn/core/types/maps/cmap/cmap3.h>
+#include <cgogn/core/types/maps/cmap/cph3.h>
+
+#include <cgogn/core/types/cell_marker.h>
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/traversals/global.h>
+#include <cgogn/io/binary/cgb.h>
+#include <cgogn/io/volume/volume_import.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace cgogn
+{
+
+std::string file_content(const std::string& filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+class CGBTest : public ::testing::Test
+{
+protected:
+	CGBTest() : filename_(::testing::TempDir() + "cgogn_cgb_test.cgb")
+	{
+	}
+
+	~CGBTest() override
+	{
+		std::remove(filename_.c_str());
+	}
+
+	// prisms of which every other one is removed (the unused indices keep the values given by removed_value)
+	static void build_surface(CMap2& m, float64 removed_value)
+	{
+		auto vertex_position = add_attribute<geometry::Vec3, CMap2::Vertex>(m, "position");
+		auto face_value = add_attribute<float64, CMap2::Face>(m, "value");
+		m.get_attribute<uint32>("nb_prisms") = 100u;
+		std::vector<CMap2::Volume> removed;
+		for (uint32 i = 0u; i < 200u; ++i)
+		{
+			CMap2::Volume v = add_prism(m, 3u + i % 4u);
+			const float64 prism_value = i % 2u == 0u ? float64(i) : removed_value;
+			foreach_incident_face(m, v, [&](CMap2::Face f) -> bool {
+				value<float64>(m, face_value, f) = prism_value;
+				return true;
+			});
+			foreach_incident_vertex(m, v, [&](CMap2::Vertex w) -> bool {
+				value<geometry::Vec3>(m, vertex_position, w) =
+					geometry::Vec3(prism_value, float64(index_of(m, w)), 0.0);
+				return true;
+			});
+			if (i % 2u == 1u)
+				removed.push_back(v);
+		}
+		for (CMap2::Volume v : removed)
+			remove_volume(m, v);
+	}
+
+	std::string filename_;
+};
+
+TEST_F(CGBTest, DeterministicFiles)
+{
+	CMap2 m1;
+	build_surface(m1, 1.0);
+	CMap2 m2;
+	build_surface(m2, 2.0);
+
+	ASSERT_TRUE(io::export_CGB(m1, filename_));
+	const std::string content1 = file_content(filename_);
+	ASSERT_TRUE(io::export_CGB(m2, filename_));
+	const std::string content2 = file_content(filename_);
+	EXPECT_FALSE(content1.empty());
+	EXPECT_TRUE(content1 == content2);
+}
+
+TEST_F(CGBTest, SurfaceRoundTrip)
+{
+	CMap2 m;
+	build_surface(m, 1.0);
+	ASSERT_TRUE(io::export_CGB(m, filename_));
+
+	CMap2 m2;
+	ASSERT_TRUE(io::import_CGB(m2, filename_));
+
+	EXPECT_EQ(m2.get_attribute<uint32>("nb_prisms"), 100u);
+	EXPECT_EQ(nb_darts(m2), nb_darts(m));
+	EXPECT_EQ(nb_cells<CMap2::Vertex>(m2), nb_cells<CMap2::Vertex>(m));
+	EXPECT_EQ(nb_cells<CMap2::Face>(m2), nb_cells<CMap2::Face>(m));
+	EXPECT_EQ(nb_cells<CMap2::Volume>(m2), 100u);
+	EXPECT_TRUE(check_integrity(m2, false));
+
+	auto vertex_position = get_attribute<geometry::Vec3, CMap2::Vertex>(m, "position");
+	auto vertex_position2 = get_attribute<geometry::Vec3, CMap2::Vertex>(m2, "position");
+	auto face_value = get_attribute<float64, CMap2::Face>(m, "value");
+	auto face_value2 = get_attribute<float64, CMap2::Face>(m2, "value");
+	ASSERT_TRUE(vertex_position2 != nullptr);
+	ASSERT_TRUE(face_value2 != nullptr);
+	for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+	{
+		EXPECT_EQ(phi1(m2, d), phi1(m, d));
+		EXPECT_EQ(phi2(m2, d), phi2(m, d));
+		EXPECT_EQ(value<geometry::Vec3>(m2, vertex_position2, CMap2::Vertex(d)),
+				  value<geometry::Vec3>(m, vertex_position, CMap2::Vertex(d)));
+		EXPECT_EQ(value<float64>(m2, face_value2, CMap2::Face(d)), value<float64>(m, face_value, CMap2::Face(d)));
+	}
+
+	// the imported mesh can still be modified
+	add_prism(m2, 5u);
+	EXPECT_EQ(nb_cells<CMap2::Volume>(m2), 101u);
+	EXPECT_TRUE(check_integrity(m2, false));
+}
+
+TEST_F(CGBTest, CPH3RoundTrip)
+{
+	// 2 tetrahedra sharing a face
+	io::VolumeImportData volume_data;
+	volume_data.reserve(5u, 2u);
+	volume_data.vertex_position_ = {
+		{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, 1.0, 1.0},
+	};
+	volume_data.volumes_types_ = {io::Tetra, io::Tetra};
+	volume_data.volumes_vertex_indices_ = {0u, 1u, 2u, 3u, 1u, 2u, 3u, 4u};
+
+	CMap3 m;
+	io::import_volume_data(m, volume_data);
+	CPH3 cph(m);
+	cph.maximum_level_ = 2u;
+	cph.current_level_ = 1u;
+	cph.nb_darts_per_level_ = {nb_darts(m), 0u, 0u};
+	for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+	{
+		(*cph.dart_level_)[d.index_] = 0u;
+		(*cph.edge_id_)[d.index_] = d.index_ / 2u;
+		(*cph.face_id_)[d.index_] = d.index_ / 3u;
+	}
+	ASSERT_TRUE(io::export_CGB(cph, filename_));
+
+	// a CPH3 file is not a CMap3 file
+	CMap3 m2;
+	EXPECT_FALSE(io::import_CGB(m2, filename_));
+
+	CMap3 m3;
+	CPH3 cph3(m3);
+	ASSERT_TRUE(io::import_CGB(cph3, filename_));
+	EXPECT_EQ(cph3.maximum_level_, 2u);
+	EXPECT_EQ(cph3.current_level_, 1u);
+	EXPECT_EQ(cph3.nb_darts_per_level_, cph.nb_darts_per_level_);
+	EXPECT_EQ(nb_darts(m3), nb_darts(m));
+	EXPECT_EQ(nb_cells<CMap3::Volume>(m3), nb_cells<CMap3::Volume>(m));
+	for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+	{
+		EXPECT_EQ(phi3(m3, d), phi3(m, d));
+		EXPECT_EQ((*cph3.dart_level_)[d.index_], 0u);
+		EXPECT_EQ((*cph3.edge_id_)[d.index_], d.index_ / 2u);
+		EXPECT_EQ((*cph3.face_id_)[d.index_], d.index_ / 3u);
+	}
+}
+
+} // namespace cgogn
@@ -0,0 +1,188 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+#include <cgogn/core/types/maps/cmap/cmap3.h>
+#include <cgogn/core/types/maps/gmap/gmap2.h>
+
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/types/cell_marker.h>
+#include <cgogn/core/utils/thread_pool.h>
+#include <cgogn/io/surface/surface_import.h>
+#include <cgogn/io/utils.h>
+#include <cgogn/io/volume/volume_import.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace cgogn
+{
+
+// the meshes have more vertices than a sorting chunk, so that the sewing runs on several chunks & threads
+class ImportTest : public ::testing::Test
+{
+protected:
+	static const uint32 NB_WORKERS = 4u;
+
+	ImportTest() : pool_(NB_WORKERS), scope_(&pool_)
+	{
+	}
+
+	// grid of n x n quads
+	static io::SurfaceImportData grid_surface(uint32 n)
+	{
+		io::SurfaceImportData surface_data;
+		surface_data.reserve((n + 1u) * (n + 1u), n * n);
+		for (uint32 j = 0u; j <= n; ++j)
+			for (uint32 i = 0u; i <= n; ++i)
+				surface_data.vertex_position_.emplace_back(float64(i), float64(j), 0.0);
+		for (uint32 j = 0u; j < n; ++j)
+		{
+			for (uint32 i = 0u; i < n; ++i)
+			{
+				const uint32 v = j * (n + 1u) + i;
+				surface_data.faces_nb_vertices_.push_back(4u);
+				surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(),
+														  {v, v + 1u, v + n + 2u, v + n + 1u});
+			}
+		}
+		return surface_data;
+	}
+
+	// grid of n x n x n hexahedra
+	static io::VolumeImportData grid_volume(uint32 n)
+	{
+		io::VolumeImportData volume_data;
+		volume_data.reserve((n + 1u) * (n + 1u) * (n + 1u), n * n * n);
+		for (uint32 k = 0u; k <= n; ++k)
+			for (uint32 j = 0u; j <= n; ++j)
+				for (uint32 i = 0u; i <= n; ++i)
+					volume_data.vertex_position_.emplace_back(float64(i), float64(j), float64(k));
+		const uint32 dj = n + 1u;
+		const uint32 dk = (n + 1u) * (n + 1u);
+		for (uint32 k = 0u; k < n; ++k)
+		{
+			for (uint32 j = 0u; j < n; ++j)
+			{
+				for (uint32 i = 0u; i < n; ++i)
+				{
+					const uint32 v = k * dk + j * dj + i;
+					volume_data.volumes_types_.push_back(io::Hexa);
+					volume_data.volumes_vertex_indices_.insert(
+						volume_data.volumes_vertex_indices_.end(),
+						{v, v + 1u, v + dj + 1u, v + dj, v + dk, v + dk + 1u, v + dk + dj + 1u, v + dk + dj});
+				}
+			}
+		}
+		return volume_data;
+	}
+
+	// each index is referenced by the darts of its cell (+1 while it is used)
+	// (the boundary darts have the index of their cell, except in a GMap2 where they are not indexed)
+	template <typename CELL, typename MESH>
+	static void check_ref_counts(const MESH& m)
+	{
+		const auto& container = m.attribute_containers_[CELL::ORBIT];
+		std::vector<uint32> nb_darts(container.maximum_index(), 0u);
+		for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+		{
+			const uint32 index = index_of(m, CELL(d));
+			if (index != INVALID_INDEX)
+				++nb_darts[index];
+		}
+		for (uint32 i = 0u; i < container.maximum_index(); ++i)
+		{
+			if (nb_darts[i] > 0u)
+				EXPECT_EQ((*container.ref_counter())[i], nb_darts[i] + 1u);
+		}
+	}
+
+	ThreadPool pool_;
+	ThreadPoolScope scope_;
+};
+
+TEST_F(ImportTest, CMap2)
+{
+	const uint32 n = 300u;
+	io::SurfaceImportData surface_data = grid_surface(n);
+	ASSERT_GT(surface_data.vertex_position_.size(), io::SORTING_CHUNK_SIZE);
+
+	CMap2 m;
+	io::import_surface_data(m, surface_data);
+
+	EXPECT_EQ(nb_cells<CMap2::Vertex>(m), (n + 1u) * (n + 1u));
+	EXPECT_EQ(nb_cells<CMap2::Edge>(m), 2u * n * (n + 1u));
+	for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+	{
+		EXPECT_NE(phi2(m, d), d);
+		EXPECT_EQ(phi2(m, phi2(m, d)), d);
+	}
+	check_ref_counts<CMap2::Vertex>(m);
+	EXPECT_TRUE(check_integrity(m, false));
+}
+
+TEST_F(ImportTest, GMap2)
+{
+	const uint32 n = 300u;
+	io::SurfaceImportData surface_data = grid_surface(n);
+
+	GMap2 m;
+	io::import_surface_data(m, surface_data);
+
+	EXPECT_EQ(nb_cells<GMap2::Vertex>(m), (n + 1u) * (n + 1u));
+	EXPECT_EQ(nb_cells<GMap2::Edge>(m), 2u * n * (n + 1u));
+	for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+	{
+		EXPECT_NE(beta2(m, d), d);
+		EXPECT_EQ(beta2(m, beta2(m, d)), d);
+		EXPECT_EQ(phi2(m, phi2(m, d)), d);
+		// the darts of a vertex have the same index on both sides of the inner edges
+		// (the boundary faces closed by the import of a GMap2 are not indexed)
+		if (!is_boundary(m, d) && !is_boundary(m, beta2(m, d)))
+			EXPECT_EQ(index_of(m, GMap2::Vertex(beta2(m, d))), index_of(m, GMap2::Vertex(d)));
+	}
+	check_ref_counts<GMap2::Vertex>(m);
+}
+
+TEST_F(ImportTest, CMap3)
+{
+	const uint32 n = 40u;
+	io::VolumeImportData volume_data = grid_volume(n);
+	ASSERT_GT(volume_data.vertex_position_.size(), io::SORTING_CHUNK_SIZE);
+
+	CMap3 m;
+	io::import_volume_data(m, volume_data);
+
+	EXPECT_EQ(nb_cells<CMap3::Vertex>(m), (n + 1u) * (n + 1u) * (n + 1u));
+	EXPECT_EQ(nb_cells<CMap3::Face>(m), 3u * n * n * (n + 1u));
+	for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+	{
+		EXPECT_NE(phi3(m, d), d);
+		EXPECT_EQ(phi3(m, phi3(m, d)), d);
+	}
+	check_ref_counts<CMap3::Vertex>(m);
+	EXPECT_TRUE(check_integrity(m, false));
+}
+
+} // namespace cgogn
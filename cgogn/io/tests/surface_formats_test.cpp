@@ -0,0 +1,283 @@
+/*******************************************************************************
+ * CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+ * Copyright (C), IGG Group, ICube, University of Strasbourg, France            *
+ *                                                                              *
+ * This library is free software; you can redistribute it and/or modify it      *
+ * under the terms of the GNU Lesser General Public License as published by the *
+ * Free Software Foundation; either version 2.1 of the License, or (at your     *
+ * option) any later version.                                                   *
+ *                                                                              *
+ * This library is distributed in the hope that it will be useful, but WITHOUT  *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+ * for more details.                                                            *
+ *                                                                              *
+ * You should have received a copy of the GNU Lesser General Public License     *
+ * along with this library; if not, write to the Free Software Foundation,      *
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+ *                                                                              *
+ * Web site: http://cgogn.unistra.fr/                                           *
+ * Contact information: cgogn@unistra.fr                                        *
+ *                                                                              *
+ *******************************************************************************/
+
+#include <cgogn/core/types/maps/cmap/cmap2.h>
+
+#include <cgogn/core/functions/attributes.h>
+#include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/types/cell_marker.h>
+#include <cgogn/core/utils/thread_pool.h>
+#include <cgogn/io/surface/obj.h>
+#include <cgogn/io/surface/off.h>
+#include <cgogn/io/surface/ply.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace cgogn
+{
+
+class SurfaceFormatsTest : public ::testing::Test
+{
+protected:
+	static const uint32 NB_WORKERS = 4u;
+
+	SurfaceFormatsTest() : pool_(NB_WORKERS), scope_(&pool_)
+	{
+	}
+
+	~SurfaceFormatsTest() override
+	{
+		for (const std::string& filename : filenames_)
+			std::remove(filename.c_str());
+	}
+
+	std::string filename(const std::string& extension)
+	{
+		filenames_.push_back(::testing::TempDir() + "cgogn_surface_formats_test." + extension);
+		return filenames_.back();
+	}
+
+	static std::string file_content(const std::string& name)
+	{
+		std::ifstream file(name, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	std::string write_file(const std::string& extension, const std::string& content)
+	{
+		const std::string name = filename(extension);
+		std::ofstream file(name, std::ios::out | std::ios::binary);
+		file << content;
+		return name;
+	}
+
+	// grid of n x n cells, alternately split in two triangles, with coordinates that have no short decimal form
+	// (the grid is larger than a parsing and a formatting chunk, so that the files are read & written in parallel)
+	static void build_surface(CMap2& m, uint32 n)
+	{
+		io::SurfaceImportData surface_data;
+		surface_data.reserve((n + 1u) * (n + 1u), n * n + n * n / 2u);
+		for (uint32 j = 0u; j <= n; ++j)
+			for (uint32 i = 0u; i <= n; ++i)
+				surface_data.vertex_position_.emplace_back(i / 3.0, j / 7.0, std::sin(float64(i * j)) * 1e-5);
+		for (uint32 j = 0u; j < n; ++j)
+		{
+			for (uint32 i = 0u; i < n; ++i)
+			{
+				const uint32 v = j * (n + 1u) + i;
+				if ((i + j) % 2u == 0u)
+				{
+					surface_data.faces_nb_vertices_.push_back(4u);
+					surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(),
+															  {v, v + 1u, v + n + 2u, v + n + 1u});
+				}
+				else
+				{
+					surface_data.faces_nb_vertices_.insert(surface_data.faces_nb_vertices_.end(), {3u, 3u});
+					surface_data.faces_vertex_indices_.insert(surface_data.faces_vertex_indices_.end(),
+															  {v, v + 1u, v + n + 2u, v, v + n + 2u, v + n + 1u});
+				}
+			}
+		}
+		io::import_surface_data(m, surface_data);
+	}
+
+	static std::vector<geometry::Vec3> sorted_positions(CMap2& m)
+	{
+		auto vertex_position = get_attribute<geometry::Vec3, CMap2::Vertex>(m, "position");
+		std::vector<geometry::Vec3> positions;
+		foreach_cell(m, [&](CMap2::Vertex v) -> bool {
+			positions.push_back(value<geometry::Vec3>(m, vertex_position, v));
+			return true;
+		});
+		std::sort(positions.begin(), positions.end(), [](const geometry::Vec3& a, const geometry::Vec3& b) {
+			return std::lexicographical_compare(a.data(), a.data() + 3, b.data(), b.data() + 3);
+		});
+		return positions;
+	}
+
+	// the positions are written in their shortest exact form, so they must be read back unchanged
+	static void check_same_surface(CMap2& m, CMap2& m2)
+	{
+		EXPECT_EQ(nb_cells<CMap2::Vertex>(m2), nb_cells<CMap2::Vertex>(m));
+		EXPECT_EQ(nb_cells<CMap2::Edge>(m2), nb_cells<CMap2::Edge>(m));
+		EXPECT_EQ(nb_cells<CMap2::Face>(m2), nb_cells<CMap2::Face>(m));
+		EXPECT_EQ(nb_darts(m2), nb_darts(m));
+		EXPECT_TRUE(check_integrity(m2, false));
+		EXPECT_TRUE(sorted_positions(m2) == sorted_positions(m));
+	}
+
+	ThreadPool pool_;
+	ThreadPoolScope scope_;
+	std::vector<std::string> filenames_;
+};
+
+TEST_F(SurfaceFormatsTest, MalformedOFF)
+{
+	const std::string header = "OFF\n# comment\n4 2 0\n";
+	const std::string vertices = "0 0 0\n1 0 0\n1 1 0\n0 1 0\n";
+
+	CMap2 m;
+	ASSERT_TRUE(io::import_OFF(m, write_file("off", header + vertices + "3 0 1 2\n3 0 2 3\n")));
+	EXPECT_EQ(nb_cells<CMap2::Vertex>(m), 4u);
+	EXPECT_EQ(nb_cells<CMap2::Face>(m), 2u);
+
+	// missing file, bad header, bad counts
+	CMap2 m1;
+	EXPECT_FALSE(io::import_OFF(m1, ::testing::TempDir() + "cgogn_surface_formats_test.missing.off"));
+	EXPECT_FALSE(io::import_OFF(m1, write_file("off", "ply\n4 2 0\n" + vertices + "3 0 1 2\n3 0 2 3\n")));
+	EXPECT_FALSE(io::import_OFF(m1, write_file("off", "OFF\n4 two 0\n" + vertices + "3 0 1 2\n3 0 2 3\n")));
+	// bad coordinate
+	EXPECT_FALSE(io::import_OFF(m1, write_file("off", header + "0 0 0\n1 x 0\n1 1 0\n0 1 0\n3 0 1 2\n3 0 2 3\n")));
+	// out of range index, missing index
+	CMap2 m2;
+	EXPECT_FALSE(io::import_OFF(m2, write_file("off", header + vertices + "3 0 1 2\n3 0 2 4\n")));
+	CMap2 m3;
+	EXPECT_FALSE(io::import_OFF(m3, write_file("off", header + vertices + "3 0 1 2\n3 0 2\n")));
+	// truncated file
+	CMap2 m4;
+	EXPECT_FALSE(io::import_OFF(m4, write_file("off", header + vertices + "3 0 1 2\n")));
+}
+
+TEST_F(SurfaceFormatsTest, MalformedOBJ)
+{
+	const std::string vertices = "# comment\nv 0 0 0\nv 1 0 0\nvt 0.5 0.5\nv 1 1 0\nvn 0 0 1\nv 0 1 0\n";
+
+	// absolute & relative indices, texture & normal indices
+	CMap2 m;
+	ASSERT_TRUE(io::import_OBJ(m, write_file("obj", vertices + "f 1/1/1 2/1/1 3/1/1\nf -4 -2 -1\n")));
+	EXPECT_EQ(nb_cells<CMap2::Vertex>(m), 4u);
+	EXPECT_EQ(nb_cells<CMap2::Face>(m), 2u);
+
+	// missing file, no face
+	CMap2 m1;
+	EXPECT_FALSE(io::import_OBJ(m1, ::testing::TempDir() + "cgogn_surface_formats_test.missing.obj"));
+	EXPECT_FALSE(io::import_OBJ(m1, write_file("obj", vertices)));
+	// bad coordinate
+	CMap2 m2;
+	EXPECT_FALSE(io::import_OBJ(m2, write_file("obj", "v 0 0 0\nv 1 0 0\nv 1 y 0\nf 1 2 3\n")));
+	// null index, index of a vertex that is not in the file, relative index before the first vertex
+	CMap2 m3;
+	EXPECT_FALSE(io::import_OBJ(m3, write_file("obj", vertices + "f 1 2 3\nf 0 3 4\n")));
+	CMap2 m4;
+	EXPECT_FALSE(io::import_OBJ(m4, write_file("obj", vertices + "f 1 2 3\nf 1 3 5\n")));
+	CMap2 m5;
+	EXPECT_FALSE(io::import_OBJ(m5, write_file("obj", vertices + "f 1 2 3\nf -5 -2 -1\n")));
+}
+
+TEST_F(SurfaceFormatsTest, OFFRoundTrip)
+{
+	CMap2 m;
+	build_surface(m, 300u);
+	const std::string name = filename("off");
+	io::export_OFF(m, get_attribute<geometry::Vec3, CMap2::Vertex>(m, "position").get(), name);
+
+	CMap2 m2;
+	ASSERT_TRUE(io::import_OFF(m2, name));
+	check_same_surface(m, m2);
+}
+
+TEST_F(SurfaceFormatsTest, OBJRoundTrip)
+{
+	CMap2 m;
+	build_surface(m, 300u);
+	auto vertex_position = get_attribute<geometry::Vec3, CMap2::Vertex>(m, "position");
+	auto vertex_normal = add_attribute<geometry::Vec3, CMap2::Vertex>(m, "normal");
+	auto face_value = add_attribute<float64, CMap2::Face>(m, "value");
+	vertex_normal->fill(geometry::Vec3(0.0, 0.0, 1.0));
+	face_value->fill(0.5);
+
+	// the normals & the attribute comment blocks are ignored by the import
+	for (bool export_attributes : {false, true})
+	{
+		const std::string name = filename("obj");
+		io::export_OBJ(m, vertex_position.get(), name, export_attributes);
+
+		CMap2 m2;
+		ASSERT_TRUE(io::import_OBJ(m2, name));
+		check_same_surface(m, m2);
+	}
+}
+
+TEST_F(SurfaceFormatsTest, PLYRoundTrip)
+{
+	CMap2 m;
+	build_surface(m, 300u);
+	auto vertex_position = get_attribute<geometry::Vec3, CMap2::Vertex>(m, "position");
+	auto face_value = add_attribute<float64, CMap2::Face>(m, "value");
+	face_value->fill(0.5);
+
+	for (bool export_attributes : {false, true})
+	{
+		const std::string name = filename("ply");
+		io::export_PLY(m, vertex_position.get(), name, export_attributes);
+
+		CMap2 m2;
+		ASSERT_TRUE(io::import_PLY(m2, name));
+		check_same_surface(m, m2);
+
+		// the same file in the ASCII format
+		const std::string ascii_name = filename("ascii.ply");
+		happly::PLYData(name).write(ascii_name, happly::DataFormat::ASCII);
+
+		CMap2 m3;
+		ASSERT_TRUE(io::import_PLY(m3, ascii_name));
+		check_same_surface(m, m3);
+	}
+}
+
+TEST_F(SurfaceFormatsTest, MalformedPLY)
+{
+	const std::string header = "ply\nformat ascii 1.0\nelement vertex 4\nproperty double x\nproperty double y\n"
+							   "property double z\nelement face 2\nproperty list uchar uint vertex_indices\nend_header\n";
+	const std::string vertices = "0 0 0\n1 0 0\n1 1 0\n0 1 0\n";
+
+	CMap2 m;
+	ASSERT_TRUE(io::import_PLY(m, write_file("ply", header + vertices + "3 0 1 2\n3 0 2 3\n")));
+	EXPECT_EQ(nb_cells<CMap2::Vertex>(m), 4u);
+	EXPECT_EQ(nb_cells<CMap2::Face>(m), 2u);
+
+	// missing file, bad header, out of range index
+	CMap2 m1;
+	EXPECT_FALSE(io::import_PLY(m1, ::testing::TempDir() + "cgogn_surface_formats_test.missing.ply"));
+	EXPECT_FALSE(io::import_PLY(m1, write_file("ply", "OFF\n4 2 0\n" + vertices + "3 0 1 2\n3 0 2 3\n")));
+	EXPECT_FALSE(io::import_PLY(m1, write_file("ply", header + vertices + "3 0 1 2\n3 0 2 4\n")));
+
+	// truncated binary file
+	build_surface(m1, 10u);
+	const std::string name = filename("ply");
+	io::export_PLY(m1, get_attribute<geometry::Vec3, CMap2::Vertex>(m1, "position").get(), name);
+	const std::string content = file_content(name);
+	CMap2 m2;
+	EXPECT_FALSE(io::import_PLY(m2, write_file("ply", content.substr(0u, content.size() / 2u))));
+}
+
+} // namespace cgogn
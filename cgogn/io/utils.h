@@ -24,10 +24,24 @@
 #ifndef CGOGN_IO_UTILS_H_
 #define CGOGN_IO_UTILS_H_
 
+#include <cgogn/io/import_progress.h>
+
 #include <cgogn/core/utils/numerics.h>
+#include <cgogn/core/utils/thread_pool.h>
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 namespace cgogn
 {
@@ -35,24 +49,45 @@ namespace cgogn
 namespace io
 {
 
+// the numeric locale is process wide: it is set to C by the first of the concurrent imports and restored by the last
 struct Scoped_C_Locale
 {
 	// set numeric locale to C after saving current locale
 	inline Scoped_C_Locale()
 	{
-		current_locale_ = std::string(std::setlocale(LC_NUMERIC, nullptr));
-		setlocale(LC_NUMERIC, "C");
+		std::lock_guard<std::mutex> lock(mutex());
+		if (nb_scopes()++ == 0u)
+		{
+			saved_locale() = std::string(std::setlocale(LC_NUMERIC, nullptr));
+			setlocale(LC_NUMERIC, "C");
+		}
 	}
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(Scoped_C_Locale);
 
 	// restore locale
 	inline ~Scoped_C_Locale()
 	{
-		std::setlocale(LC_NUMERIC, current_locale_.c_str());
+		std::lock_guard<std::mutex> lock(mutex());
+		if (--nb_scopes() == 0u)
+			std::setlocale(LC_NUMERIC, saved_locale().c_str());
 	}
 
 private:
-	std::string current_locale_;
+	static std::mutex& mutex()
+	{
+		static std::mutex m;
+		return m;
+	}
+	static uint32& nb_scopes()
+	{
+		static uint32 n = 0u;
+		return n;
+	}
+	static std::string& saved_locale()
+	{
+		static std::string locale;
+		return locale;
+	}
 };
 
 inline std::istream& getline_safe(std::istream& is, std::string& str)
@@ -104,6 +139,501 @@ inline uint32 read_uint(std::istream& fp, std::string& line)
 	return uint32((std::stoul(line)));
 }
 
+/*****************************************************************************
+ * Locale independent parsing of text buffers (e.g. memory mapped files).
+ * The parse functions skip the blanks (spaces, tabs and '\r') that precede
+ * the value, never cross a line end and advance p past what they read.
+ *****************************************************************************/
+
+// size of the blocks of text that are parsed in parallel
+const uint64 PARSING_CHUNK_SIZE = 1u << 20;
+
+inline const char* skip_blanks(const char* p, const char* end)
+{
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+		++p;
+	return p;
+}
+
+inline const char* next_line(const char* p, const char* end)
+{
+	p = static_cast<const char*>(std::memchr(p, '\n', std::size_t(end - p)));
+	return p != nullptr ? p + 1 : end;
+}
+
+// skip blanks, line ends and comment lines
+inline const char* skip_to_data(const char* p, const char* end)
+{
+	while (p < end)
+	{
+		if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+			++p;
+		else if (*p == '#')
+			p = next_line(p, end);
+		else
+			break;
+	}
+	return p;
+}
+
+// a data line is neither empty nor a comment
+inline bool is_data_line(const char* p, const char* end)
+{
+	p = skip_blanks(p, end);
+	return p < end && *p != '\n' && *p != '#';
+}
+
+inline bool parse_uint(const char*& p, const char* end, uint32& v)
+{
+	const char* q = skip_blanks(p, end);
+	if (q == end || uint32(*q - '0') > 9u)
+		return false;
+	uint64 r = 0u;
+	for (; q < end && uint32(*q - '0') <= 9u; ++q)
+	{
+		r = r * 10u + uint32(*q - '0');
+		if (r > std::numeric_limits<uint32>::max())
+			return false;
+	}
+	v = uint32(r);
+	p = q;
+	return true;
+}
+
+inline bool parse_int(const char*& p, const char* end, int64& v)
+{
+	const char* q = skip_blanks(p, end);
+	bool negative = false;
+	if (q < end && (*q == '-' || *q == '+'))
+		negative = *q++ == '-';
+	uint32 r;
+	if (q == end || uint32(*q - '0') > 9u || !parse_uint(q, end, r))
+		return false;
+	v = negative ? -int64(r) : int64(r);
+	p = q;
+	return true;
+}
+
+namespace internal
+{
+
+inline bool parse_double_slow(const char* begin, const char* end, float64& v)
+{
+	if (begin < end && *begin == '+')
+		++begin;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	return std::from_chars(begin, end, v).ec == std::errc();
+#else
+	// strtod depends on the numeric locale: the callers set it to C with Scoped_C_Locale
+	const std::string token(begin, end);
+	char* token_end;
+	v = std::strtod(token.c_str(), &token_end);
+	return token_end != token.c_str();
+#endif
+}
+
+} // namespace internal
+
+// exact when the decimal value has at most 19 significant digits, fits the 53 bits of a double mantissa and has a
+// decimal exponent in [-22, 22] (the product or quotient of two exact doubles is then correctly rounded)
+// the other values are given to the standard (correctly rounded) conversion
+inline bool parse_double(const char*& p, const char* end, float64& v)
+{
+	static const float64 powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+											1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+	const char* q = skip_blanks(p, end);
+	const char* begin = q;
+
+	bool negative = false;
+	if (q < end && (*q == '-' || *q == '+'))
+		negative = *q++ == '-';
+
+	uint64 mantissa = 0u;
+	int32 nb_digits = 0;
+	int32 exponent = 0;
+	bool has_digits = false;
+	bool truncated = false;
+	for (; q < end && uint32(*q - '0') <= 9u; ++q)
+	{
+		has_digits = true;
+		if (nb_digits < 19)
+		{
+			mantissa = mantissa * 10u + uint32(*q - '0');
+			if (mantissa != 0u)
+				++nb_digits;
+		}
+		else
+		{
+			truncated |= *q != '0';
+			++exponent;
+		}
+	}
+	if (q < end && *q == '.')
+	{
+		for (++q; q < end && uint32(*q - '0') <= 9u; ++q)
+		{
+			has_digits = true;
+			if (nb_digits < 19)
+			{
+				mantissa = mantissa * 10u + uint32(*q - '0');
+				if (mantissa != 0u)
+					++nb_digits;
+				--exponent;
+			}
+			else
+				truncated |= *q != '0';
+		}
+	}
+	if (has_digits && q < end && (*q == 'e' || *q == 'E'))
+	{
+		const char* e = q + 1;
+		bool negative_exponent = false;
+		if (e < end && (*e == '-' || *e == '+'))
+			negative_exponent = *e++ == '-';
+		if (e < end && uint32(*e - '0') <= 9u)
+		{
+			int32 exp = 0;
+			for (; e < end && uint32(*e - '0') <= 9u; ++e)
+				exp = std::min(exp * 10 + int32(*e - '0'), 100000);
+			exponent += negative_exponent ? -exp : exp;
+			q = e;
+		}
+	}
+
+	if (has_digits && !truncated && mantissa <= (uint64(1u) << 53) && exponent >= -22 && exponent <= 22)
+	{
+		float64 r = float64(mantissa);
+		r = exponent < 0 ? r / powers_of_ten[-exponent] : r * powers_of_ten[exponent];
+		v = negative ? -r : r;
+		p = q;
+		return true;
+	}
+
+	// not a plain decimal number (inf, nan), or out of the exact range
+	if (!has_digits)
+		while (q < end && *q != ' ' && *q != '\t' && *q != '\r' && *q != '\n')
+			++q;
+	if (q == begin || !internal::parse_double_slow(begin, q, v))
+		return false;
+	p = q;
+	return true;
+}
+
+/**
+ * @brief split [begin, end) into ranges of about chunk_size bytes that start at the beginning of a line
+ * @return the nb_chunks + 1 boundaries of the ranges
+ */
+inline std::vector<const char*> split_lines(const char* begin, const char* end, uint64 chunk_size = PARSING_CHUNK_SIZE)
+{
+	std::vector<const char*> boundaries;
+	boundaries.push_back(begin);
+	const char* p = begin;
+	while (uint64(end - p) > chunk_size)
+	{
+		p = next_line(p + chunk_size, end);
+		boundaries.push_back(p);
+	}
+	if (p < end)
+		boundaries.push_back(end);
+	return boundaries;
+}
+
+/**
+ * @brief count in parallel the data lines of the given ranges
+ * @return for each range, the index of its first data line (the last element is the total number of data lines)
+ */
+inline std::vector<uint64> first_data_lines(const std::vector<const char*>& boundaries)
+{
+	const uint32 nb_chunks = uint32(boundaries.size()) - 1u;
+	std::vector<uint64> first_lines(boundaries.size(), 0u);
+	parallel_foreach_chunk(nb_chunks, [&](uint32 c) -> bool {
+		uint64 nb = 0u;
+		for (const char* p = boundaries[c]; p < boundaries[c + 1]; p = next_line(p, boundaries[c + 1]))
+			nb += is_data_line(p, boundaries[c + 1]);
+		first_lines[c + 1] = nb;
+		return true;
+	});
+	for (uint32 c = 0u; c < nb_chunks; ++c)
+		first_lines[c + 1] += first_lines[c];
+	return first_lines;
+}
+
+// number of ranges (or chunks) processed at once by the operations that consume their results in order
+inline uint32 parallel_batch_size()
+{
+	return 4u * (thread_pool()->nb_workers() + 1u);
+}
+
+/**
+ * @brief call in parallel the given function on each of the nb_lines first data lines of the given ranges
+ * The ranges are processed by batches: after each batch, batch_end is called with the [first, last) ranges of the
+ * batch, so that the data produced for these ranges can be consumed in order (and released) before the next batch.
+ * @param boundaries ranges of lines given by split_lines
+ * @param nb_lines number of data lines to process
+ * @param f function taking the range index, the data line index and the [begin, end) range of the line
+ * @param batch_end function taking the indices of the first and last (excluded) ranges of a processed batch
+ * @return false if there are less than nb_lines data lines, if a function returned false or if the current import
+ * has been cancelled (see ImportProgress)
+ */
+template <typename FUNC, typename BATCH_FUNC>
+bool parallel_foreach_data_line(const std::vector<const char*>& boundaries, uint64 nb_lines, const FUNC& f,
+								const BATCH_FUNC& batch_end)
+{
+	const std::vector<uint64> first_lines = first_data_lines(boundaries);
+	if (first_lines.back() < nb_lines)
+		return false;
+
+	const uint32 nb_ranges = uint32(boundaries.size()) - 1u;
+	const uint32 batch_size = parallel_batch_size();
+	std::atomic<bool> valid(true);
+	for (uint32 first_range = 0u; first_range < nb_ranges && valid.load(); first_range += batch_size)
+	{
+		const uint32 nb = std::min(batch_size, nb_ranges - first_range);
+		parallel_foreach_chunk(nb, [&](uint32 b) -> bool {
+			const uint32 c = first_range + b;
+			uint64 line = first_lines[c];
+			for (const char* p = boundaries[c]; p < boundaries[c + 1] && line < nb_lines;)
+			{
+				const char* line_end = next_line(p, boundaries[c + 1]);
+				if (is_data_line(p, line_end))
+				{
+					if (!f(c, line, p, line_end))
+					{
+						valid.store(false);
+						return false;
+					}
+					++line;
+				}
+				p = line_end;
+			}
+			return true;
+		});
+		if (valid.load() && !batch_end(first_range, first_range + nb))
+			valid.store(false);
+		if (valid.load() && !report_import_progress(uint64(boundaries[first_range + nb] - boundaries[0]),
+													uint64(boundaries[nb_ranges] - boundaries[0])))
+			valid.store(false);
+	}
+	return valid.load();
+}
+
+template <typename FUNC>
+bool parallel_foreach_data_line(const std::vector<const char*>& boundaries, uint64 nb_lines, const FUNC& f)
+{
+	return parallel_foreach_data_line(boundaries, nb_lines, f, [](uint32, uint32) { return true; });
+}
+
+/**
+ * @brief concatenate in parallel the given vectors at the end of result
+ */
+template <typename T>
+void parallel_concatenate(const std::vector<std::vector<T>>& parts, std::vector<T>& result)
+{
+	std::vector<uint64> offsets(parts.size() + 1u, result.size());
+	for (uint32 i = 0u; i < uint32(parts.size()); ++i)
+		offsets[i + 1] = offsets[i] + parts[i].size();
+	result.resize(offsets.back());
+	parallel_foreach_chunk(uint32(parts.size()), [&](uint32 i) -> bool {
+		std::copy(parts[i].begin(), parts[i].end(), result.begin() + offsets[i]);
+		return true;
+	});
+}
+
+/*****************************************************************************
+ * Locale independent formatting into text buffers (e.g. the buffers that
+ * are filled in parallel by the exporters). The floating point values are
+ * written with the shortest representation that reads back exactly.
+ *****************************************************************************/
+
+// number of items (e.g. vertices or faces) formatted by a task
+const uint32 FORMATTING_CHUNK_SIZE = 1u << 14;
+
+inline void append_uint(std::string& s, uint64 v)
+{
+	char buffer[24];
+	char* p = buffer + sizeof(buffer);
+	do
+	{
+		*--p = char('0' + v % 10u);
+		v /= 10u;
+	} while (v != 0u);
+	s.append(p, buffer + sizeof(buffer));
+}
+
+inline void append_int(std::string& s, int64 v)
+{
+	if (v < 0)
+	{
+		s.push_back('-');
+		append_uint(s, uint64(0u) - uint64(v));
+	}
+	else
+		append_uint(s, uint64(v));
+}
+
+template <typename T>
+inline void append_real(std::string& s, T v)
+{
+	static_assert(std::is_floating_point_v<T>, "append_real expects a floating point value");
+	char buffer[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	char* end = std::to_chars(buffer, buffer + sizeof(buffer), v).ptr;
+#else
+	// snprintf depends on the numeric locale: the callers set it to C with Scoped_C_Locale
+	char* end = buffer + std::snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<T>::max_digits10,
+									   float64(v));
+#endif
+	s.append(buffer, std::size_t(end - buffer));
+}
+
+template <typename T>
+inline void append_value(std::string& s, T v)
+{
+	if constexpr (std::is_floating_point_v<T>)
+		append_real(s, v);
+	else if constexpr (std::is_signed_v<T>)
+		append_int(s, int64(v));
+	else
+		append_uint(s, uint64(v));
+}
+
+// appends the components of the given (Eigen) vector separated by spaces
+template <typename VEC>
+inline void append_vector(std::string& s, const VEC& v)
+{
+	for (int32 k = 0; k < int32(v.size()); ++k)
+	{
+		if (k > 0)
+			s.push_back(' ');
+		append_value(s, v[k]);
+	}
+}
+
+inline bool is_little_endian()
+{
+	const uint16 one = 1u;
+	uint8 first_byte;
+	std::memcpy(&first_byte, &one, 1u);
+	return first_byte == 1u;
+}
+
+// little endian binary encoding (e.g. for binary PLY files)
+template <typename T>
+inline void append_binary(std::string& s, T v)
+{
+	static_assert(std::is_arithmetic_v<T>, "append_binary expects an arithmetic value");
+	char bytes[sizeof(T)];
+	std::memcpy(bytes, &v, sizeof(T));
+	if (!is_little_endian())
+		std::reverse(bytes, bytes + sizeof(T));
+	s.append(bytes, sizeof(T));
+}
+
+/**
+ * @brief format in parallel nb_items items and write them in order to the given stream
+ * The items are formatted by chunks into independent buffers. The buffers of a batch of chunks are written with
+ * large sequential writes, so the memory used does not depend on the number of items.
+ * @param f function taking the item index and the buffer to which the item is appended
+ * @return false if a write failed
+ */
+template <typename FUNC>
+bool parallel_write(std::ostream& out, uint32 nb_items, const FUNC& f)
+{
+	const uint32 nb_chunks = (nb_items + FORMATTING_CHUNK_SIZE - 1u) / FORMATTING_CHUNK_SIZE;
+	const uint32 batch_size = parallel_batch_size();
+	std::vector<std::string> buffers(std::min(batch_size, nb_chunks));
+
+	for (uint32 first_chunk = 0u; first_chunk < nb_chunks && out.good(); first_chunk += batch_size)
+	{
+		const uint32 nb = std::min(batch_size, nb_chunks - first_chunk);
+		parallel_foreach_chunk(nb, [&](uint32 b) -> bool {
+			std::string& buffer = buffers[b];
+			buffer.clear();
+			const uint32 first = (first_chunk + b) * FORMATTING_CHUNK_SIZE;
+			for (uint32 i = first, end = std::min(nb_items, first + FORMATTING_CHUNK_SIZE); i < end; ++i)
+				f(i, buffer);
+			return true;
+		});
+		for (uint32 b = 0u; b < nb; ++b)
+			out.write(buffers[b].data(), std::streamsize(buffers[b].size()));
+	}
+	return out.good();
+}
+
+/*****************************************************************************
+ * Parallel grouping of keyed elements (e.g. the half-edges or faces that
+ * have to be sewn after the import of the cells of a mesh).
+ *****************************************************************************/
+
+// number of elements / buckets processed by a task
+const uint32 SORTING_CHUNK_SIZE = 1u << 16;
+
+/**
+ * @brief call in parallel the given function on each non empty bucket
+ * @param offsets the nb_buckets + 1 offsets of the buckets
+ * @param f function taking the [first, last) range of indices of the bucket
+ */
+template <typename FUNC>
+void parallel_foreach_bucket(const std::vector<uint32>& offsets, const FUNC& f)
+{
+	const uint32 nb_buckets = uint32(offsets.size()) - 1u;
+	parallel_foreach_chunk((nb_buckets + SORTING_CHUNK_SIZE - 1u) / SORTING_CHUNK_SIZE, [&](uint32 c) -> bool {
+		for (uint32 b = c * SORTING_CHUNK_SIZE, end = std::min(nb_buckets, b + SORTING_CHUNK_SIZE); b < end; ++b)
+		{
+			if (offsets[b] < offsets[b + 1])
+				f(offsets[b], offsets[b + 1]);
+		}
+		return true;
+	});
+}
+
+/**
+ * @brief sort in parallel the given elements by bucket and then by the given order inside each bucket
+ * Counting sort on the buckets followed by the sort of each bucket: suited to keys whose first component is a
+ * vertex index (small buckets). With a total order, the result does not depend on the number of threads.
+ * @param nb_buckets number of buckets
+ * @param bucket function returning the bucket of an element (in [0, nb_buckets))
+ * @param less strict weak ordering of the elements of a bucket
+ * @return the nb_buckets + 1 offsets of the buckets in the sorted elements
+ */
+template <typename T, typename BUCKET, typename LESS>
+std::vector<uint32> parallel_bucket_sort(std::vector<T>& elements, uint32 nb_buckets, const BUCKET& bucket,
+										 const LESS& less)
+{
+	const uint32 nb_elements = uint32(elements.size());
+	const uint32 nb_chunks = (nb_elements + SORTING_CHUNK_SIZE - 1u) / SORTING_CHUNK_SIZE;
+
+	std::vector<std::atomic<uint32>> next(nb_buckets);
+	parallel_foreach_chunk(nb_chunks, [&](uint32 c) -> bool {
+		for (uint32 i = c * SORTING_CHUNK_SIZE, end = std::min(nb_elements, i + SORTING_CHUNK_SIZE); i < end; ++i)
+			next[bucket(elements[i])].fetch_add(1u, std::memory_order_relaxed);
+		return true;
+	});
+
+	std::vector<uint32> offsets(nb_buckets + 1u);
+	offsets[0] = 0u;
+	for (uint32 b = 0u; b < nb_buckets; ++b)
+	{
+		offsets[b + 1] = offsets[b] + next[b].load(std::memory_order_relaxed);
+		next[b].store(offsets[b], std::memory_order_relaxed);
+	}
+
+	std::vector<T> sorted(nb_elements);
+	parallel_foreach_chunk(nb_chunks, [&](uint32 c) -> bool {
+		for (uint32 i = c * SORTING_CHUNK_SIZE, end = std::min(nb_elements, i + SORTING_CHUNK_SIZE); i < end; ++i)
+			sorted[next[bucket(elements[i])].fetch_add(1u, std::memory_order_relaxed)] = elements[i];
+		return true;
+	});
+	elements.swap(sorted);
+
+	parallel_foreach_bucket(offsets, [&](uint32 first, uint32 last) {
+		std::sort(elements.begin() + first, elements.begin() + last, less);
+	});
+
+	return offsets;
+}
+
 } // namespace io
 
 } // namespace cgogn
@@ -29,6 +29,7 @@
 
 #include <cgogn/core/functions/attributes.h>
 #include <cgogn/core/functions/mesh_info.h>
+#include <cgogn/core/types/mesh_views/cell_cache.h>
 
 #include <fstream>
 
@@ -121,56 +122,59 @@ void export_MESH(MESH& m, const typename mesh_traits<MESH>::template Attribute<g
 
 	auto vertex_id = add_attribute<uint32, Vertex>(m, "__vertex_id");
 
-	uint32 nb_vertices = nb_cells<Vertex>(m);
-	uint32 nb_faces = nb_cells<Face>(m);
-	uint32 nb_volumes = nb_cells<Volume>(m);
+	CellCache<MESH> cache(m);
+	cache.template build<Vertex>();
+	cache.template build<Face>();
+	cache.template build<Volume>();
+	const std::vector<Vertex>& vertices = cache.template cell_vector<Vertex>();
+	const std::vector<Face>& faces = cache.template cell_vector<Face>();
+	const std::vector<Volume>& volumes = cache.template cell_vector<Volume>();
 
-	std::ofstream out_file;
-	out_file.open(filename);
+	for (uint32 i = 0u, nb = uint32(vertices.size()); i < nb; ++i)
+		value<uint32>(m, vertex_id, vertices[i]) = i + 1u;
+
+	std::ofstream out_file(filename, std::ios::out | std::ios::binary);
 	out_file << "MeshVersionFormatted 1\n";
 	out_file << "Dimension\n";
 	out_file << "3\n";
 	out_file << "Vertices\n";
-	out_file << nb_vertices << "\n";
-
-	uint32 id = 1;
-	foreach_cell(m, [&](Vertex v) -> bool {
-		const geometry::Vec3& p = value<geometry::Vec3>(m, vertex_position, v);
-		value<uint32>(m, vertex_id, v) = id++;
-		out_file << p[0] << " " << p[1] << " " << p[2] << " 0\n";
-		return true;
+	out_file << vertices.size() << "\n";
+
+	parallel_write(out_file, uint32(vertices.size()), [&](uint32 i, std::string& s) {
+		append_vector(s, value<geometry::Vec3>(m, vertex_position, vertices[i]));
+		s.append(" 0\n");
 	});
 
 	out_file << "Quads\n";
-	out_file << nb_faces << "\n";
+	out_file << faces.size() << "\n";
 
-	foreach_cell(m, [&](Face f) -> bool {
-		foreach_incident_vertex(m, f, [&](Vertex v) -> bool {
-			out_file << value<uint32>(m, vertex_id, v) << " ";
+	parallel_write(out_file, uint32(faces.size()), [&](uint32 i, std::string& s) {
+		foreach_incident_vertex(m, faces[i], [&](Vertex v) -> bool {
+			append_uint(s, value<uint32>(m, vertex_id, v));
+			s.push_back(' ');
 			return true;
 		});
-		out_file << "0\n";
-		return true;
+		s.append("0\n");
 	});
 
 	out_file << "Hexahedra\n";
-	out_file << nb_volumes << "\n";
-
-	foreach_cell(m, [&](Volume v) -> bool {
-		std::vector<uint32> indices = hexahedra_vertex_indices(m, vertex_id.get(), v);
-
-		for (uint32 i : indices)
-			out_file << i << " ";
-
-		out_file << "0\n";
-		return true;
+	out_file << volumes.size() << "\n";
+
+	parallel_write(out_file, uint32(volumes.size()), [&](uint32 i, std::string& s) {
+		for (uint32 id : hexahedra_vertex_indices(m, vertex_id.get(), volumes[i]))
+		{
+			append_uint(s, id);
+			s.push_back(' ');
+		}
+		s.append("0\n");
 	});
 
 	out_file << "End\n";
 
-	remove_attribute<Vertex>(m, vertex_id);
+	if (!out_file.good())
+		std::cerr << "Error while writing file \"" << filename << "\"." << std::endl;
 
-	out_file.close();
+	remove_attribute<Vertex>(m, vertex_id);
 }
 
 } // namespace io
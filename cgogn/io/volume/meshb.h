@@ -29,12 +29,19 @@ extern "C"
 #include <thirdparty/libMeshb/libmeshb.h>
 }
 
+#include <cgogn/io/surface/surface_import.h>
 #include <cgogn/io/utils.h>
 #include <cgogn/io/volume/volume_import.h>
 
+#include <cgogn/core/functions/attributes.h>
+
 #include <cgogn/geometry/functions/orientation.h>
 
-#include <fstream>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
 
 namespace cgogn
 {
@@ -42,150 +49,487 @@ namespace cgogn
 namespace io
 {
 
-template <typename MESH>
-bool import_MESHB(MESH& m, const std::string& filename)
+struct MESHBImportOptions
 {
-	static_assert(mesh_traits<MESH>::dimension == 3, "MESH dimension should be 3");
+	// element types to import: the blocks of the other types are not read
+	bool tetrahedra_ = true;
+	bool pyramids_ = true;
+	bool prisms_ = true;
+	bool hexahedra_ = true;
 
-	using Vertex = typename MESH::Vertex;
+	std::string vertex_position_attribute_name_ = "position";
+	// vertex attribute (int32) that receives the references of the vertices (not imported if empty)
+	std::string vertex_reference_attribute_name_;
 
-	Scoped_C_Locale loc;
+	// print the amount of data read and skipped
+	bool report_ = false;
+};
 
-	VolumeImportData volume_data;
+namespace internal
+{
 
-	int32 version, dimension;
-	int64 mesh_index = GmfOpenMesh(filename.c_str(), GmfRead, &version, &dimension);
-	if (mesh_index == 0)
-		return false;
+struct MESHBVolumeBlock
+{
+	int keyword_;
+	VolumeType type_;
+	uint32 nb_vertices_;
+	bool MESHBImportOptions::*selected_;
+};
 
-	bool use_floats = (version == GmfFloat);
+inline const std::array<MESHBVolumeBlock, 4>& MESHB_volume_blocks()
+{
+	static const std::array<MESHBVolumeBlock, 4> blocks = {
+		MESHBVolumeBlock{GmfTetrahedra, VolumeType::Tetra, 4u, &MESHBImportOptions::tetrahedra_},
+		MESHBVolumeBlock{GmfHexahedra, VolumeType::Hexa, 8u, &MESHBImportOptions::hexahedra_},
+		MESHBVolumeBlock{GmfPrisms, VolumeType::TriangularPrism, 6u, &MESHBImportOptions::prisms_},
+		MESHBVolumeBlock{GmfPyramids, VolumeType::Pyramid, 5u, &MESHBImportOptions::pyramids_}};
+	return blocks;
+}
 
-	const uint32 number_of_vertices = uint32(GmfStatKwd(mesh_index, GmfVertices));
-	const uint32 number_of_tetras = uint32(GmfStatKwd(mesh_index, GmfTetrahedra));
-	const uint32 number_of_hexas = uint32(GmfStatKwd(mesh_index, GmfHexahedra));
-	const uint32 number_of_prisms = uint32(GmfStatKwd(mesh_index, GmfPrisms));
-	const uint32 number_of_pyramids = uint32(GmfStatKwd(mesh_index, GmfPyramids));
+// size of a block in a binary file (the reals are floats in version 1, the integers are 64 bits from version 4)
+inline uint64 MESHB_block_size(int32 version, uint64 nb_lines, uint32 nb_reals, uint32 nb_integers)
+{
+	return nb_lines * (nb_reals * (version <= 1 ? 4u : 8u) + nb_integers * (version <= 3 ? 4u : 8u));
+}
 
-	uint32 nb_volumes = number_of_tetras + number_of_hexas + number_of_prisms + number_of_pyramids;
+// read the next line of the given volume block: the (0 based) vertex indices are written in ids
+inline void read_MESHB_volume(int64 mesh_index, const MESHBVolumeBlock& block, std::array<int32, 8>& ids)
+{
+	int32 ref;
+	switch (block.nb_vertices_)
+	{
+	case 4u:
+		(void)GmfGetLin(mesh_index, block.keyword_, &ids[0], &ids[1], &ids[2], &ids[3], &ref);
+		break;
+	case 5u:
+		(void)GmfGetLin(mesh_index, block.keyword_, &ids[0], &ids[1], &ids[2], &ids[3], &ids[4], &ref);
+		break;
+	case 6u:
+		(void)GmfGetLin(mesh_index, block.keyword_, &ids[0], &ids[1], &ids[2], &ids[3], &ids[4], &ids[5], &ref);
+		break;
+	default:
+		(void)GmfGetLin(mesh_index, block.keyword_, &ids[0], &ids[1], &ids[2], &ids[3], &ids[4], &ids[5], &ids[6],
+						&ids[7], &ref);
+		break;
+	}
+	for (uint32 i = 0u; i < block.nb_vertices_; ++i)
+		--ids[i];
+}
 
-	if (number_of_vertices == 0u || nb_volumes == 0u)
+// read the next line of the vertex block
+inline Vec3 read_MESHB_vertex(int64 mesh_index, bool use_floats, int32& ref)
+{
+	if (use_floats)
 	{
-		std::cerr << "Error while reading the file \"" << filename << "\".";
-		GmfCloseMesh(mesh_index);
-		return false;
+		std::array<float32, 3> v;
+		(void)GmfGetLin(mesh_index, GmfVertices, &v[0], &v[1], &v[2], &ref);
+		return {v[0], v[1], v[2]};
 	}
+	std::array<float64, 3> v;
+	(void)GmfGetLin(mesh_index, GmfVertices, &v[0], &v[1], &v[2], &ref);
+	return {v[0], v[1], v[2]};
+}
 
-	volume_data.reserve(number_of_vertices, nb_volumes);
-	GmfGotoKwd(mesh_index, GmfVertices);
-	int32 ref;
+// reorder the vertices of a volume so that it has the orientation expected by VolumeBuilder
+template <typename POSITION>
+void orient_MESHB_volume(VolumeType type, std::array<uint32, 8>& ids, const POSITION& position)
+{
+	switch (type)
+	{
+	case VolumeType::Tetra:
+		if (geometry::test_orientation_3D(position(ids[0]), position(ids[1]), position(ids[2]), position(ids[3])) ==
+			geometry::Orientation3D::UNDER)
+			std::swap(ids[1], ids[2]);
+		break;
+	case VolumeType::Pyramid:
+		if (geometry::test_orientation_3D(position(ids[4]), position(ids[0]), position(ids[1]), position(ids[2])) ==
+			geometry::Orientation3D::OVER)
+			std::swap(ids[1], ids[3]);
+		break;
+	case VolumeType::TriangularPrism:
+		if (geometry::test_orientation_3D(position(ids[3]), position(ids[0]), position(ids[1]), position(ids[2])) ==
+			geometry::Orientation3D::OVER)
+		{
+			std::swap(ids[1], ids[2]);
+			std::swap(ids[4], ids[5]);
+		}
+		break;
+	case VolumeType::Hexa:
+		if (geometry::test_orientation_3D(position(ids[4]), position(ids[0]), position(ids[1]), position(ids[2])) ==
+			geometry::Orientation3D::OVER)
+		{
+			std::swap(ids[0], ids[3]);
+			std::swap(ids[1], ids[2]);
+			std::swap(ids[4], ids[7]);
+			std::swap(ids[5], ids[6]);
+		}
+		break;
+	default:
+		break;
+	}
+}
 
-	// read vertices position
-	if (use_floats)
-		for (uint32 i = 0u; i < number_of_vertices; ++i)
+// faces of the oriented volumes (see orient_MESHB_volume), oriented outward
+inline const std::vector<std::vector<uint32>>& MESHB_volume_faces(VolumeType type)
+{
+	static const std::vector<std::vector<uint32>> tetra = {{0, 1, 2}, {1, 0, 3}, {2, 1, 3}, {0, 2, 3}};
+	static const std::vector<std::vector<uint32>> pyramid = {{0, 1, 2, 3}, {1, 0, 4}, {2, 1, 4}, {3, 2, 4}, {0, 3, 4}};
+	static const std::vector<std::vector<uint32>> prism = {{0, 1, 2},	 {1, 0, 3, 4}, {2, 1, 4, 5},
+														   {0, 2, 5, 3}, {4, 3, 5}};
+	static const std::vector<std::vector<uint32>> hexa = {{0, 1, 2, 3}, {1, 0, 4, 5}, {2, 1, 5, 6},
+														  {3, 2, 6, 7}, {0, 3, 7, 4}, {5, 4, 7, 6}};
+	switch (type)
+	{
+	case VolumeType::Pyramid:
+		return pyramid;
+	case VolumeType::TriangularPrism:
+		return prism;
+	case VolumeType::Hexa:
+		return hexa;
+	default:
+		return tetra;
+	}
+}
+
+// per import data read from the header of the file and reported at the end of the import
+struct MESHBImport
+{
+	int64 mesh_index_ = 0;
+	int32 version_ = 0;
+	bool use_floats_ = false;
+	uint32 nb_vertices_ = 0u;
+	std::array<uint32, 4> nb_volumes_ = {0u, 0u, 0u, 0u}; // by block
+	uint32 nb_selected_volumes_ = 0u;
+	bool all_volumes_selected_ = true;
+	uint32 nb_invalid_volumes_ = 0u;
+	// (estimated) amount of data to read for the import progress
+	uint64 bytes_read_ = 0u;
+	uint64 total_bytes_ = 0u;
+	std::chrono::high_resolution_clock::time_point start_;
+
+	bool open(const std::string& filename, const MESHBImportOptions& options)
+	{
+		start_ = std::chrono::high_resolution_clock::now();
+		int32 dimension;
+		mesh_index_ = GmfOpenMesh(filename.c_str(), GmfRead, &version_, &dimension);
+		if (mesh_index_ == 0)
+		{
+			std::cerr << "Unable to open file \"" << filename << "\"." << std::endl;
+			return false;
+		}
+		use_floats_ = version_ == GmfFloat;
+		nb_vertices_ = uint32(GmfStatKwd(mesh_index_, GmfVertices));
+		for (uint32 b = 0u; b < 4u; ++b)
 		{
-			std::array<float32, 3> v;
-			(void)GmfGetLin(mesh_index, GmfVertices, &v[0], &v[1], &v[2], &ref);
-			volume_data.vertex_position_.push_back({v[0], v[1], v[2]});
+			const MESHBVolumeBlock& block = MESHB_volume_blocks()[b];
+			nb_volumes_[b] = uint32(GmfStatKwd(mesh_index_, block.keyword_));
+			if (options.*block.selected_)
+				nb_selected_volumes_ += nb_volumes_[b];
+			else if (nb_volumes_[b] > 0u)
+				all_volumes_selected_ = false;
 		}
-	else
-		for (uint32 i = 0u; i < number_of_vertices; ++i)
+		if (nb_vertices_ == 0u || nb_selected_volumes_ == 0u)
 		{
-			std::array<float64, 3> v;
-			(void)GmfGetLin(mesh_index, GmfVertices, &v[0], &v[1], &v[2], &ref);
-			volume_data.vertex_position_.push_back({v[0], v[1], v[2]});
+			std::cerr << "Error while reading the file \"" << filename << "\" (no vertices or no selected volumes)."
+					  << std::endl;
+			close();
+			return false;
 		}
 
-	// read volumes
-	if (number_of_tetras > 0)
+		total_bytes_ = MESHB_block_size(version_, nb_vertices_, 3u, 1u);
+		for (uint32 b = 0u; b < 4u; ++b)
+		{
+			const MESHBVolumeBlock& block = MESHB_volume_blocks()[b];
+			if (options.*block.selected_)
+				total_bytes_ += (all_volumes_selected_ ? 1u : 2u) *
+								MESHB_block_size(version_, nb_volumes_[b], 0u, block.nb_vertices_ + 1u);
+		}
+		return true;
+	}
+
+	// report the progress every 2^16 lines: return false if the import has been cancelled
+	inline bool progress(uint32 line, uint64 line_size)
 	{
-		GmfGotoKwd(mesh_index, GmfTetrahedra);
-		std::array<int, 4> ids;
-		for (uint32 i = 0; i < number_of_tetras; ++i)
+		if (line % (1u << 16) != 0u)
+			return true;
+		if (line > 0u)
+			bytes_read_ += (1u << 16) * line_size;
+		return report_import_progress(std::min(bytes_read_, total_bytes_), total_bytes_);
+	}
+
+	// call f(i, position, ref) on each vertex
+	template <typename FUNC>
+	bool foreach_vertex(const FUNC& f)
+	{
+		const uint64 line_size = MESHB_block_size(version_, 1u, 3u, 1u);
+		GmfGotoKwd(mesh_index_, GmfVertices);
+		for (uint32 i = 0u; i < nb_vertices_; ++i)
 		{
-			(void)GmfGetLin(mesh_index, GmfTetrahedra, &ids[0], &ids[1], &ids[2], &ids[3], &ref);
-			for (auto& id : ids)
-				--id;
-			if (geometry::test_orientation_3D(volume_data.vertex_position_[ids[0]],
-											  volume_data.vertex_position_[ids[1]],
-											  volume_data.vertex_position_[ids[2]],
-											  volume_data.vertex_position_[ids[3]]) == geometry::Orientation3D::UNDER)
-				std::swap(ids[1], ids[2]);
-			volume_data.volumes_types_.push_back(VolumeType::Tetra);
-			volume_data.volumes_vertex_indices_.insert(volume_data.volumes_vertex_indices_.end(), ids.begin(),
-													   ids.end());
+			if (!progress(i, line_size))
+				return false;
+			int32 ref;
+			const Vec3 position = read_MESHB_vertex(mesh_index_, use_floats_, ref);
+			f(i, position, ref);
 		}
+		return true;
+	}
+
+	void close()
+	{
+		if (mesh_index_ != 0)
+			GmfCloseMesh(mesh_index_);
+		mesh_index_ = 0;
 	}
 
-	if (number_of_hexas > 0)
+	// call f(block, ids) on each selected volume with valid vertex indices
+	template <typename FUNC>
+	bool foreach_selected_volume(const MESHBImportOptions& options, const FUNC& f)
 	{
-		GmfGotoKwd(mesh_index, GmfHexahedra);
-		std::array<int, 8> ids;
-		for (uint32 i = 0; i < number_of_hexas; ++i)
+		nb_invalid_volumes_ = 0u;
+		std::array<int32, 8> ids;
+		for (uint32 b = 0u; b < 4u; ++b)
 		{
-			(void)GmfGetLin(mesh_index, GmfHexahedra, &ids[0], &ids[1], &ids[2], &ids[3], &ids[4], &ids[5], &ids[6],
-							&ids[7], &ref);
-			for (auto& id : ids)
-				--id;
-			if (geometry::test_orientation_3D(volume_data.vertex_position_[ids[4]],
-											  volume_data.vertex_position_[ids[0]],
-											  volume_data.vertex_position_[ids[1]],
-											  volume_data.vertex_position_[ids[2]]) == geometry::Orientation3D::OVER)
+			const MESHBVolumeBlock& block = MESHB_volume_blocks()[b];
+			if (!(options.*block.selected_) || nb_volumes_[b] == 0u)
+				continue;
+			const uint64 line_size = MESHB_block_size(version_, 1u, 0u, block.nb_vertices_ + 1u);
+			GmfGotoKwd(mesh_index_, block.keyword_);
+			for (uint32 i = 0u; i < nb_volumes_[b]; ++i)
 			{
-				std::swap(ids[0], ids[3]);
-				std::swap(ids[1], ids[2]);
-				std::swap(ids[4], ids[7]);
-				std::swap(ids[5], ids[6]);
+				if (!progress(i, line_size))
+					return false;
+				read_MESHB_volume(mesh_index_, block, ids);
+				if (std::all_of(ids.begin(), ids.begin() + block.nb_vertices_,
+								[&](int32 id) { return id >= 0 && uint32(id) < nb_vertices_; }))
+					f(block, ids);
+				else
+					++nb_invalid_volumes_;
 			}
-			volume_data.volumes_types_.push_back(VolumeType::Hexa);
-			volume_data.volumes_vertex_indices_.insert(volume_data.volumes_vertex_indices_.end(), ids.begin(),
-													   ids.end());
 		}
+		return true;
 	}
 
-	if (number_of_prisms > 0)
+	void report(const std::string& filename, const MESHBImportOptions& options)
 	{
-		GmfGotoKwd(mesh_index, GmfPrisms);
-		std::array<int, 6> ids;
-		for (uint32 i = 0; i < number_of_prisms; ++i)
+		if (nb_invalid_volumes_ > 0u)
+			std::cerr << "import_MESHB: " << nb_invalid_volumes_ << " volume(s) with invalid vertex indices ignored."
+					  << std::endl;
+		if (!options.report_)
+			return;
+
+		uint64 read = MESHB_block_size(version_, nb_vertices_, 3u, 1u);
+		uint64 skipped = 0u;
+		for (uint32 b = 0u; b < 4u; ++b)
 		{
-			(void)GmfGetLin(mesh_index, GmfPrisms, &ids[0], &ids[1], &ids[2], &ids[3], &ids[4], &ids[5], &ref);
-			for (auto& id : ids)
-				--id;
-			if (geometry::test_orientation_3D(volume_data.vertex_position_[ids[3]],
-											  volume_data.vertex_position_[ids[0]],
-											  volume_data.vertex_position_[ids[1]],
-											  volume_data.vertex_position_[ids[2]]) == geometry::Orientation3D::OVER)
+			const MESHBVolumeBlock& block = MESHB_volume_blocks()[b];
+			(options.*block.selected_ ? read : skipped) +=
+				MESHB_block_size(version_, nb_volumes_[b], 0u, block.nb_vertices_ + 1u);
+		}
+		const float64 mb = 1024.0 * 1024.0;
+		std::cout << "import_MESHB: " << filename << ": " << nb_selected_volumes_ << " volumes read, "
+				  << float64(read) / mb << " MB read, " << float64(skipped) / mb << " MB skipped, "
+				  << std::chrono::duration<float64>(std::chrono::high_resolution_clock::now() - start_).count() << " s"
+				  << std::endl;
+	}
+};
+
+} // namespace internal
+
+/**
+ * @brief import the selected volumes of a libMeshb (.mesh / .meshb) file
+ * The blocks of the element types that are not selected are never read: the file is directly positioned on the
+ * selected blocks. When some element types are skipped, only the vertices of the selected volumes are created.
+ */
+template <typename MESH>
+bool import_MESHB(MESH& m, const std::string& filename, const MESHBImportOptions& options = {})
+{
+	static_assert(mesh_traits<MESH>::dimension == 3, "MESH dimension should be 3");
+
+	using Vertex = typename MESH::Vertex;
+
+	Scoped_C_Locale loc;
+
+	internal::MESHBImport file;
+	if (!file.open(filename, options))
+		return false;
+
+	// builder index of the vertices of the file (only the vertices of the selected volumes are created)
+	// (the reading stops if the import is cancelled)
+	bool valid = true;
+	std::vector<uint32> vertex_ids(file.nb_vertices_, file.all_volumes_selected_ ? 0u : INVALID_INDEX);
+	if (!file.all_volumes_selected_)
+	{
+		valid = file.foreach_selected_volume(
+			options, [&](const internal::MESHBVolumeBlock& block, const std::array<int32, 8>& ids) {
+				for (uint32 i = 0u; i < block.nb_vertices_; ++i)
+					vertex_ids[ids[i]] = 0u;
+			});
+	}
+
+	VolumeBuilder<MESH> builder(m, options.vertex_position_attribute_name_);
+	builder.reserve(file.nb_vertices_, file.nb_selected_volumes_);
+
+	std::shared_ptr<typename mesh_traits<MESH>::template Attribute<int32>> vertex_reference;
+	if (!options.vertex_reference_attribute_name_.empty())
+		vertex_reference = get_or_add_attribute<int32, Vertex>(m, options.vertex_reference_attribute_name_);
+
+	valid = valid && file.foreach_vertex([&](uint32 i, const Vec3& position, int32 ref) {
+		if (vertex_ids[i] == INVALID_INDEX)
+			return;
+		vertex_ids[i] = builder.add_vertex(position);
+		if (vertex_reference)
+			(*vertex_reference)[builder.vertex_index(vertex_ids[i])] = ref;
+	});
+
+	std::array<uint32, 8> volume_vertices;
+	valid = valid && file.foreach_selected_volume(
+						 options, [&](const internal::MESHBVolumeBlock& block, const std::array<int32, 8>& ids) {
+							 for (uint32 i = 0u; i < block.nb_vertices_; ++i)
+								 volume_vertices[i] = vertex_ids[ids[i]];
+							 internal::orient_MESHB_volume(
+								 block.type_, volume_vertices,
+								 [&](uint32 v) -> const Vec3& { return builder.vertex_position(v); });
+							 builder.add_volume(block.type_, volume_vertices.data());
+						 });
+
+	file.close();
+	if (!valid)
+	{
+		builder.abort();
+		return false;
+	}
+	builder.finish();
+	file.report(filename, options);
+
+	return true;
+}
+
+/**
+ * @brief import the boundary surface of the selected volumes of a libMeshb (.mesh / .meshb) file
+ * No volume is built: the faces of the selected volumes are sorted to find the faces that belong to a single volume
+ * and only these faces and their vertices are created in the surface mesh (oriented outward).
+ */
+template <typename MESH>
+bool import_MESHB_boundary(MESH& m, const std::string& filename, const MESHBImportOptions& options = {})
+{
+	static_assert(mesh_traits<MESH>::dimension == 2, "MESH dimension should be 2");
+
+	using Vertex = typename MESH::Vertex;
+
+	Scoped_C_Locale loc;
+
+	internal::MESHBImport file;
+	if (!file.open(filename, options))
+		return false;
+
+	// the positions are needed to orient the volumes before their faces are known
+	std::vector<Vec3> positions(file.nb_vertices_);
+	std::vector<int32> references;
+	if (!options.vertex_reference_attribute_name_.empty())
+		references.resize(file.nb_vertices_);
+	bool valid = file.foreach_vertex([&](uint32 i, const Vec3& position, int32 ref) {
+		positions[i] = position;
+		if (!references.empty())
+			references[i] = ref;
+	});
+
+	// faces of the volumes: the boundary faces are the faces whose (sorted) vertices appear once
+	struct VolumeFace
+	{
+		std::array<uint32, 4> key_;		 // sorted vertices (INVALID_INDEX for the 4th vertex of triangles)
+		std::array<uint32, 4> vertices_; // oriented vertices
+	};
+	std::vector<VolumeFace> faces;
+
+	std::array<uint32, 8> volume_vertices;
+	valid = valid && file.foreach_selected_volume(
+						 options, [&](const internal::MESHBVolumeBlock& block, const std::array<int32, 8>& ids) {
+							 std::copy(ids.begin(), ids.begin() + block.nb_vertices_, volume_vertices.begin());
+							 internal::orient_MESHB_volume(block.type_, volume_vertices,
+														   [&](uint32 v) -> const Vec3& { return positions[v]; });
+							 for (const std::vector<uint32>& face : internal::MESHB_volume_faces(block.type_))
+							 {
+								 VolumeFace f;
+								 f.vertices_.fill(INVALID_INDEX);
+								 for (uint32 i = 0u; i < uint32(face.size()); ++i)
+									 f.vertices_[i] = volume_vertices[face[i]];
+								 f.key_ = f.vertices_;
+								 std::sort(f.key_.begin(), f.key_.end());
+								 faces.push_back(f);
+							 }
+						 });
+	file.close();
+	if (!valid)
+		return false;
+
+	report_import_progress(ImportPhase::Building);
+	const std::vector<uint32> offsets = parallel_bucket_sort(
+		faces, file.nb_vertices_, [](const VolumeFace& f) { return f.key_[0]; },
+		[](const VolumeFace& f1, const VolumeFace& f2) { return f1.key_ < f2.key_; });
+
+	// mark the boundary faces by invalidating the key of the others
+	parallel_foreach_bucket(offsets, [&](uint32 first, uint32 last) {
+		for (uint32 group_end = first; first < last; first = group_end)
+		{
+			group_end = first + 1u;
+			while (group_end < last && faces[group_end].key_ == faces[first].key_)
+				++group_end;
+			if (group_end - first > 1u)
 			{
-				std::swap(ids[1], ids[2]);
-				std::swap(ids[4], ids[5]);
+				for (uint32 i = first; i < group_end; ++i)
+					faces[i].key_[0] = INVALID_INDEX;
 			}
-			volume_data.volumes_types_.push_back(VolumeType::TriangularPrism);
-			volume_data.volumes_vertex_indices_.insert(volume_data.volumes_vertex_indices_.end(), ids.begin(),
-													   ids.end());
 		}
+	});
+
+	// builder index of the vertices of the boundary faces
+	std::vector<uint32> vertex_ids(file.nb_vertices_, INVALID_INDEX);
+	uint32 nb_boundary_faces = 0u;
+	for (const VolumeFace& f : faces)
+	{
+		if (f.key_[0] == INVALID_INDEX)
+			continue;
+		++nb_boundary_faces;
+		for (uint32 v : f.vertices_)
+		{
+			if (v != INVALID_INDEX)
+				vertex_ids[v] = 0u;
+		}
+	}
+
+	SurfaceBuilder<MESH> builder(m, options.vertex_position_attribute_name_);
+	builder.reserve(file.nb_vertices_, nb_boundary_faces);
+
+	std::shared_ptr<typename mesh_traits<MESH>::template Attribute<int32>> vertex_reference;
+	if (!references.empty())
+		vertex_reference = get_or_add_attribute<int32, Vertex>(m, options.vertex_reference_attribute_name_);
+
+	for (uint32 i = 0u; i < file.nb_vertices_; ++i)
+	{
+		if (vertex_ids[i] == INVALID_INDEX)
+			continue;
+		vertex_ids[i] = builder.add_vertex(positions[i]);
+		if (vertex_reference)
+			(*vertex_reference)[builder.vertex_index(vertex_ids[i])] = references[i];
 	}
+	positions = std::vector<Vec3>();
 
-	if (number_of_pyramids > 0)
+	std::array<uint32, 4> face_vertices;
+	for (const VolumeFace& f : faces)
 	{
-		GmfGotoKwd(mesh_index, GmfPyramids);
-		std::array<int, 5> ids;
-		for (uint32 i = 0; i < number_of_pyramids; ++i)
+		if (f.key_[0] == INVALID_INDEX)
+			continue;
+		uint32 nbv = 0u;
+		for (uint32 v : f.vertices_)
 		{
-			(void)GmfGetLin(mesh_index, GmfPyramids, &ids[0], &ids[1], &ids[2], &ids[3], &ids[4], &ref);
-			for (auto& id : ids)
-				--id;
-			if (geometry::test_orientation_3D(volume_data.vertex_position_[ids[4]],
-											  volume_data.vertex_position_[ids[0]],
-											  volume_data.vertex_position_[ids[1]],
-											  volume_data.vertex_position_[ids[2]]) == geometry::Orientation3D::OVER)
-				std::swap(ids[1], ids[3]);
-			volume_data.volumes_types_.push_back(VolumeType::Pyramid);
-			volume_data.volumes_vertex_indices_.insert(volume_data.volumes_vertex_indices_.end(), ids.begin(),
-													   ids.end());
+			if (v != INVALID_INDEX)
+				face_vertices[nbv++] = vertex_ids[v];
 		}
+		builder.add_face(face_vertices.data(), nbv);
 	}
 
-	import_volume_data(m, volume_data);
+	builder.finish();
+	file.report(filename, options);
 
 	return true;
 }
@@ -46,9 +46,10 @@ bool import_TET(MESH& m, const std::string& filename)
 
 	Scoped_C_Locale loc;
 
-	VolumeImportData volume_data;
-
 	std::ifstream fp(filename, std::ios::in);
+	fp.seekg(0, std::ios::end);
+	const uint64 file_size = uint64(fp.tellg());
+	fp.seekg(0, std::ios::beg);
 
 	std::string line;
 	line.reserve(512u);
@@ -66,77 +67,88 @@ bool import_TET(MESH& m, const std::string& filename)
 		return false;
 	}
 
-	volume_data.reserve(nb_vertices, nb_volumes);
+	VolumeBuilder<MESH> builder(m);
+	builder.reserve(nb_vertices, nb_volumes);
 
 	// read vertices position
 	for (uint32 i = 0u; i < nb_vertices; ++i)
 	{
+		if (i % (1u << 16) == 0u && !report_import_progress(uint64(fp.tellg()), file_size))
+		{
+			builder.abort();
+			return false;
+		}
+
 		float64 x = read_double(fp, line);
 		float64 y = read_double(fp, line);
 		float64 z = read_double(fp, line);
-		volume_data.vertex_position_.push_back({x, y, z});
+		builder.add_vertex({x, y, z});
 	}
 
 	// read volumes
 	for (uint32 i = 0u; i < nb_volumes; ++i)
 	{
+		if (i % (1u << 16) == 0u && !report_import_progress(uint64(fp.tellg()), file_size))
+		{
+			builder.abort();
+			return false;
+		}
+
 		uint32 n = read_uint(fp, line);
 		std::vector<uint32> ids(n);
 		for (uint32 j = 0u; j < n; ++j)
 			ids[j] = read_uint(fp, line);
+		if (std::any_of(ids.begin(), ids.end(), [&](uint32 id) { return id >= nb_vertices; }))
+		{
+			std::cerr << "File \"" << filename << "\" is not a valid tet file." << std::endl;
+			builder.abort();
+			return false;
+		}
 
 		switch (n)
 		{
 		case 4: {
-			if (geometry::test_orientation_3D(volume_data.vertex_position_[ids[0]],
-											  volume_data.vertex_position_[ids[1]],
-											  volume_data.vertex_position_[ids[2]],
-											  volume_data.vertex_position_[ids[3]]) == geometry::Orientation3D::UNDER)
+			if (geometry::test_orientation_3D(builder.vertex_position(ids[0]),
+											  builder.vertex_position(ids[1]),
+											  builder.vertex_position(ids[2]),
+											  builder.vertex_position(ids[3])) == geometry::Orientation3D::UNDER)
 				std::swap(ids[1], ids[2]);
-			volume_data.volumes_types_.push_back(VolumeType::Tetra);
-			volume_data.volumes_vertex_indices_.insert(volume_data.volumes_vertex_indices_.end(), ids.begin(),
-													   ids.end());
+			builder.add_volume(VolumeType::Tetra, ids.data());
 			break;
 		}
 		case 5: {
-			if (geometry::test_orientation_3D(volume_data.vertex_position_[ids[4]],
-											  volume_data.vertex_position_[ids[0]],
-											  volume_data.vertex_position_[ids[1]],
-											  volume_data.vertex_position_[ids[2]]) == geometry::Orientation3D::OVER)
+			if (geometry::test_orientation_3D(builder.vertex_position(ids[4]),
+											  builder.vertex_position(ids[0]),
+											  builder.vertex_position(ids[1]),
+											  builder.vertex_position(ids[2])) == geometry::Orientation3D::OVER)
 				std::swap(ids[1], ids[3]);
-			volume_data.volumes_types_.push_back(VolumeType::Pyramid);
-			volume_data.volumes_vertex_indices_.insert(volume_data.volumes_vertex_indices_.end(), ids.begin(),
-													   ids.end());
+			builder.add_volume(VolumeType::Pyramid, ids.data());
 			break;
 		}
 		case 6: {
-			if (geometry::test_orientation_3D(volume_data.vertex_position_[ids[3]],
-											  volume_data.vertex_position_[ids[0]],
-											  volume_data.vertex_position_[ids[1]],
-											  volume_data.vertex_position_[ids[2]]) == geometry::Orientation3D::OVER)
+			if (geometry::test_orientation_3D(builder.vertex_position(ids[3]),
+											  builder.vertex_position(ids[0]),
+											  builder.vertex_position(ids[1]),
+											  builder.vertex_position(ids[2])) == geometry::Orientation3D::OVER)
 			{
 				std::swap(ids[1], ids[2]);
 				std::swap(ids[4], ids[5]);
 			}
-			volume_data.volumes_types_.push_back(VolumeType::TriangularPrism);
-			volume_data.volumes_vertex_indices_.insert(volume_data.volumes_vertex_indices_.end(), ids.begin(),
-													   ids.end());
+			builder.add_volume(VolumeType::TriangularPrism, ids.data());
 			break;
 		}
 		case 8: {
-			if (geometry::test_orientation_3D(volume_data.vertex_position_[ids[4]],
-											  volume_data.vertex_position_[ids[0]],
-											  volume_data.vertex_position_[ids[1]],
-											  volume_data.vertex_position_[ids[2]]) == geometry::Orientation3D::OVER)
+			if (geometry::test_orientation_3D(builder.vertex_position(ids[4]),
+											  builder.vertex_position(ids[0]),
+											  builder.vertex_position(ids[1]),
+											  builder.vertex_position(ids[2])) == geometry::Orientation3D::OVER)
 			{
 				std::swap(ids[0], ids[3]);
 				std::swap(ids[1], ids[2]);
 				std::swap(ids[4], ids[7]);
 				std::swap(ids[5], ids[6]);
 			}
-			volume_data.volumes_types_.push_back(VolumeType::Hexa);
-			volume_data.volumes_vertex_indices_.insert(volume_data.volumes_vertex_indices_.end(), ids.begin(),
-													   ids.end());
+			builder.add_volume(VolumeType::Hexa, ids.data());
 			break;
 		}
 		default:
@@ -145,7 +157,7 @@ bool import_TET(MESH& m, const std::string& filename)
 		}
 	}
 
-	import_volume_data(m, volume_data);
+	builder.finish();
 
 	return true;
 }
@@ -22,6 +22,7 @@
  *******************************************************************************/
 
 #include <cgogn/io/volume/volume_import.h>
+#include <cgogn/io/utils.h>
 
 #include <cgogn/core/types/maps/cmap/cmap3.h>
 #include <cgogn/core/types/maps/gmap/gmap3.h>
@@ -30,7 +31,9 @@
 #include <cgogn/core/functions/mesh_info.h>
 
 #include <algorithm>
-#include <set>
+#include <array>
+#include <atomic>
+#include <tuple>
 
 namespace cgogn
 {
@@ -38,19 +41,200 @@ namespace cgogn
 namespace io
 {
 
+namespace
+{
+
+// create a volume of the given type with the given vertices and return its first dart (nil for connectors)
 template <typename MESH>
-auto import_volume_data_map_tmpl(MESH& m, VolumeImportData& volume_data)
-	-> std::enable_if_t<std::is_convertible_v<MESH&, MapBase&>>
+Dart create_volume(MESH& m, VolumeType type, const uint32* vertices)
 {
 	using Vertex = typename MESH::Vertex;
-	using Edge = typename MESH::Edge;
-	using Face = typename MESH::Face;
 	using Volume = typename MESH::Volume;
 	using Vertex2 = typename MESH::Vertex2;
-	using Face2 = typename MESH::Face2;
 
 	using ParentMESH = typename MESH::Parent;
 
+	Dart d;
+	std::array<Dart, 8> vertex_darts;
+	uint32 nb_vertices = 0u;
+
+	switch (type)
+	{
+	case VolumeType::Tetra:
+		d = add_pyramid(static_cast<ParentMESH&>(m), 3u, false).dart_;
+		vertex_darts = {d, phi1(m, d), phi_1(m, d), phi<-1, 2, -1>(m, d)};
+		nb_vertices = 4u;
+		break;
+	case VolumeType::Pyramid:
+		d = add_pyramid(static_cast<ParentMESH&>(m), 4u, false).dart_;
+		vertex_darts = {d, phi1(m, d), phi<1, 1>(m, d), phi_1(m, d), phi<-1, 2, -1>(m, d)};
+		nb_vertices = 5u;
+		break;
+	case VolumeType::TriangularPrism:
+		d = add_prism(static_cast<ParentMESH&>(m), 3u, false).dart_;
+		vertex_darts = {d,
+						phi1(m, d),
+						phi_1(m, d),
+						phi<-1, 2, 1, 1, 2>(m, d),
+						phi<2, 1, 1, 2>(m, d),
+						phi<1, 2, 1, 1, 2>(m, d)};
+		nb_vertices = 6u;
+		break;
+	case VolumeType::Hexa:
+		d = add_prism(static_cast<ParentMESH&>(m), 4u, false).dart_;
+		vertex_darts = {d,
+						phi1(m, d),
+						phi<1, 1>(m, d),
+						phi_1(m, d),
+						phi<-1, 2, 1, 1, 2>(m, d),
+						phi<2, 1, 1, 2>(m, d),
+						phi<1, 2, 1, 1, 2>(m, d),
+						phi<1, 1, 2, 1, 1, 2>(m, d)};
+		nb_vertices = 8u;
+		break;
+	default:
+		// the connectors are generated by the sewing
+		return d;
+	}
+
+	for (uint32 i = 0u; i < nb_vertices; ++i)
+	{
+		foreach_dart_of_orbit(m, Vertex2(vertex_darts[i]), [&](Dart dv) -> bool {
+			set_index<Vertex>(m, dv, vertices[i]);
+			return true;
+		});
+	}
+
+	if (is_indexed<Volume>(m))
+		set_index(m, Volume(d), new_index<Volume>(m));
+
+	return d;
+}
+
+inline uint32 nb_vertices_of_volume(VolumeType type)
+{
+	switch (type)
+	{
+	case VolumeType::Pyramid:
+		return 5u;
+	case VolumeType::TriangularPrism:
+		return 6u;
+	case VolumeType::Hexa:
+		return 8u;
+	default:
+		return 4u;
+	}
+}
+
+// each face is keyed by its minimal vertex and the two neighbors of this vertex in the face: it is sewn with a face of
+// opposite orientation with the same key
+struct FaceKey
+{
+	uint32 min_vertex_;
+	uint32 neighbor1_; // smallest neighbor of min_vertex_ in the face
+	uint32 neighbor2_;
+	uint32 degree_;
+	bool reversed_; // phi1 goes from min_vertex_ to neighbor2_
+	Dart dart_;		// dart of min_vertex_
+};
+
+inline bool same_face(const FaceKey& f1, const FaceKey& f2)
+{
+	return f1.neighbor1_ == f2.neighbor1_ && f1.neighbor2_ == f2.neighbor2_ && f1.degree_ == f2.degree_;
+}
+
+// call f on the key of each face of the volume of the given dart
+template <typename MESH, typename FUNC>
+void foreach_face_key(MESH& m, Dart volume, std::vector<Dart>& volume_darts, const FUNC& f)
+{
+	using Vertex = typename MESH::Vertex;
+
+	// (phi1, phi2) traversal of the volume without marker (the created volumes have at most 24 darts)
+	volume_darts.clear();
+	volume_darts.push_back(volume);
+	for (uint32 k = 0u; k < uint32(volume_darts.size()); ++k)
+	{
+		for (Dart e : {phi1(m, volume_darts[k]), phi2(m, volume_darts[k])})
+		{
+			if (std::find(volume_darts.begin(), volume_darts.end(), e) == volume_darts.end())
+				volume_darts.push_back(e);
+		}
+	}
+
+	for (Dart d : volume_darts)
+	{
+		const uint32 v = index_of(m, Vertex(d));
+		uint32 degree = 0u;
+		bool is_min = true;
+		Dart it = d;
+		do
+		{
+			const uint32 w = index_of(m, Vertex(it));
+			is_min &= w > v || (w == v && it.index_ >= d.index_);
+			++degree;
+			it = phi1(m, it);
+		} while (it != d);
+
+		if (is_min)
+		{
+			const uint32 next = index_of(m, Vertex(phi1(m, d)));
+			const uint32 prev = index_of(m, Vertex(phi_1(m, d)));
+			f(FaceKey{v, std::min(next, prev), std::max(next, prev), degree, next > prev, d});
+		}
+	}
+}
+
+// phi3 sewing of two faces of opposite orientations with the same key
+template <typename MESH>
+void sew_faces(MESH& m, const FaceKey& f, const FaceKey& reversed)
+{
+	// it2 is opposite to it1: it goes from the vertex of phi1(it1) to min_vertex_
+	Dart it1 = f.dart_;
+	Dart it2 = phi_1(m, reversed.dart_);
+	for (uint32 j = 0u; j < f.degree_; ++j)
+	{
+		phi3_sew(m, it1, it2);
+		it1 = phi1(m, it1);
+		it2 = phi_1(m, it2);
+	}
+}
+
+// only write the phi3 relations of two faces of opposite orientations with the same key: unlike sew_faces, the
+// topology version of the mesh is not modified, so it can be called concurrently for different faces
+template <typename MESH>
+void link_faces(MESH& m, const FaceKey& f, const FaceKey& reversed)
+{
+	Dart it1 = f.dart_;
+	Dart it2 = phi_1(m, reversed.dart_);
+	for (uint32 j = 0u; j < f.degree_; ++j)
+	{
+		if constexpr (std::is_same_v<MESH, GMap3>)
+		{
+			const Dart it1_0 = beta0(m, it1);
+			const Dart it2_0 = beta0(m, it2);
+			(*m.beta3_)[it1.index_] = it2_0;
+			(*m.beta3_)[it2_0.index_] = it1;
+			(*m.beta3_)[it1_0.index_] = it2;
+			(*m.beta3_)[it2.index_] = it1_0;
+		}
+		else
+		{
+			(*m.phi3_)[it1.index_] = it2;
+			(*m.phi3_)[it2.index_] = it1;
+		}
+		it1 = phi1(m, it1);
+		it2 = phi_1(m, it2);
+	}
+}
+
+} // namespace
+
+template <typename MESH>
+auto import_volume_data_map_tmpl(MESH& m, VolumeImportData& volume_data)
+	-> std::enable_if_t<std::is_convertible_v<MESH&, MapBase&>>
+{
+	using Vertex = typename MESH::Vertex;
+
 	auto position = get_or_add_attribute<geometry::Vec3, Vertex>(m, volume_data.vertex_position_attribute_name_);
 
 	for (uint32 i = 0u; i < volume_data.nb_vertices_; ++i)
@@ -60,224 +244,314 @@ auto import_volume_data_map_tmpl(MESH& m, VolumeImportData& volume_data)
 		volume_data.vertex_id_after_import_.push_back(vertex_id);
 	}
 
-	auto darts_per_vertex = add_attribute<std::vector<Dart>, Vertex>(m, "__darts_per_vertex");
+	// first dart of each created volume
+	std::vector<Dart> volumes;
+	volumes.reserve(volume_data.nb_volumes_);
 
 	uint32 index = 0u;
-	DartMarker dart_marker(m);
-	uint32 vol_emb = 0u;
+	std::array<uint32, 8> vertices;
 
-	auto mark_n_store = [&](Dart dv, const uint32 vertex_index) {
-		foreach_dart_of_orbit(m, Vertex2(dv), [&](Dart dd) {
-			dart_marker.mark(dd);
-			(*darts_per_vertex)[vertex_index].push_back(dd);
-			return true;
-		});
-	};
-
-	// for each volume of table
 	for (uint32 i = 0u; i < volume_data.nb_volumes_; ++i)
 	{
-		Volume vol;
 		const VolumeType vol_type = volume_data.volumes_types_[i];
+		const uint32 nb_vertices = nb_vertices_of_volume(vol_type);
+		for (uint32 j = 0u; j < nb_vertices; ++j)
+			vertices[j] = volume_data.vertex_id_after_import_[volume_data.volumes_vertex_indices_[index++]];
 
-		if (vol_type == VolumeType::Tetra) // tetrahedral case
-		{
-			vol = add_pyramid(static_cast<ParentMESH&>(m), 3u, false);
+		Dart d = create_volume(m, vol_type, vertices.data());
+		if (!d.is_nil())
+			volumes.push_back(d);
+	}
 
-			const std::array<Dart, 4> vertices_of_tetra = {vol.dart_, phi1(m, vol.dart_), phi_1(m, vol.dart_),
-														   phi<-1, 2, -1>(m, vol.dart_)};
+	// reconstruct neighbourhood
+	// phi3 sewing: the faces are grouped by their key and each face of a group is sewn with a face of opposite
+	// orientation of the same group (the remaining ones are boundary faces)
+	std::vector<std::vector<FaceKey>> chunks_faces((uint32(volumes.size()) + SORTING_CHUNK_SIZE - 1u) /
+												   SORTING_CHUNK_SIZE);
+	parallel_foreach_chunk(uint32(chunks_faces.size()), [&](uint32 c) -> bool {
+		std::vector<FaceKey>& faces = chunks_faces[c];
+		std::vector<Dart> volume_darts;
+		volume_darts.reserve(32u);
+		for (uint32 i = c * SORTING_CHUNK_SIZE, end = std::min(uint32(volumes.size()), i + SORTING_CHUNK_SIZE);
+			 i < end; ++i)
+			foreach_face_key(m, volumes[i], volume_darts, [&](const FaceKey& f) { faces.push_back(f); });
+		return true;
+	});
+	std::vector<FaceKey> faces;
+	parallel_concatenate(chunks_faces, faces);
+	chunks_faces.clear();
+
+	const uint32 nb_vertex_indices =
+		volume_data.vertex_id_after_import_.empty()
+			? 0u
+			: *std::max_element(volume_data.vertex_id_after_import_.begin(),
+								volume_data.vertex_id_after_import_.end()) +
+				  1u;
+	const std::vector<uint32> offsets = parallel_bucket_sort(
+		faces, nb_vertex_indices, [](const FaceKey& f) { return f.min_vertex_; },
+		[](const FaceKey& f1, const FaceKey& f2) {
+			return std::tie(f1.neighbor1_, f1.neighbor2_, f1.degree_, f1.reversed_, f1.dart_.index_) <
+				   std::tie(f2.neighbor1_, f2.neighbor2_, f2.degree_, f2.reversed_, f2.dart_.index_);
+		});
 
-			for (Dart dv : vertices_of_tetra)
-			{
-				const uint32 vertex_index =
-					volume_data.vertex_id_after_import_[volume_data.volumes_vertex_indices_[index++]];
-				foreach_dart_of_orbit(m, Vertex2(dv), [&](Dart d) -> bool {
-					set_index<Vertex>(m, d, vertex_index);
-					return true;
-				});
-				mark_n_store(dv, vertex_index);
-			}
-		}
-		else if (vol_type == VolumeType::Pyramid) // pyramidal case
+	std::atomic<uint32> nb_boundary_faces(0u);
+	parallel_foreach_bucket(offsets, [&](uint32 first, uint32 last) {
+		uint32 nb_unsewn = 0u;
+		for (uint32 group_end = first; first < last; first = group_end)
 		{
-			vol = add_pyramid(static_cast<ParentMESH&>(m), 4u, false);
+			// [first, middle) and [middle, group_end) have opposite orientations
+			uint32 middle = first;
+			while (middle < last && same_face(faces[middle], faces[first]) && !faces[middle].reversed_)
+				++middle;
+			group_end = middle;
+			while (group_end < last && same_face(faces[group_end], faces[first]))
+				++group_end;
+
+			const uint32 nb_pairs = std::min(middle - first, group_end - middle);
+			for (uint32 k = 0u; k < nb_pairs; ++k)
+				link_faces(m, faces[first + k], faces[middle + k]);
+			nb_unsewn += (group_end - first) - 2u * nb_pairs;
+		}
+		nb_boundary_faces.fetch_add(nb_unsewn, std::memory_order_relaxed);
+	});
+	++m.topology_version_;
 
-			const std::array<Dart, 5> vertices_of_pyramid = {vol.dart_, phi1(m, vol.dart_), phi<1, 1>(m, vol.dart_),
-															 phi_1(m, vol.dart_), phi<-1, 2, -1>(m, vol.dart_)};
+	if (nb_boundary_faces > 0u)
+	{
+		uint32 nb_holes = close(m);
+		std::cout << nb_holes << " hole(s) have been closed" << std::endl;
+		std::cout << nb_boundary_faces << " boundary faces" << std::endl;
+	}
+}
 
-			for (Dart dv : vertices_of_pyramid)
-			{
-				const uint32 vertex_index =
-					volume_data.vertex_id_after_import_[volume_data.volumes_vertex_indices_[index++]];
-				foreach_dart_of_orbit(m, Vertex2(dv), [&](Dart d) -> bool {
-					set_index<Vertex>(m, d, vertex_index);
-					return true;
-				});
-				mark_n_store(dv, vertex_index);
-			}
-		}
-		else if (vol_type == VolumeType::TriangularPrism) // prism case
-		{
-			vol = add_prism(static_cast<ParentMESH&>(m), 3u, false);
+void import_volume_data(CMap3& m, VolumeImportData& volume_data)
+{
+	import_volume_data_map_tmpl<CMap3>(m, volume_data);
+}
+
+void import_volume_data(GMap3& m, VolumeImportData& volume_data)
+{
+	import_volume_data_map_tmpl<GMap3>(m, volume_data);
+}
 
-			const std::array<Dart, 6> vertices_of_prism = {vol.dart_,
-														   phi1(m, vol.dart_),
-														   phi_1(m, vol.dart_),
-														   phi<-1, 2, 1, 1, 2>(m, vol.dart_),
-														   phi<2, 1, 1, 2>(m, vol.dart_),
-														   phi<1, 2, 1, 1, 2>(m, vol.dart_)};
+/////////////////////////////////////////////////////////////////////////////
+// VolumeBuilder                                                           //
+/////////////////////////////////////////////////////////////////////////////
 
-			for (Dart dv : vertices_of_prism)
-			{
-				const uint32 vertex_index =
-					volume_data.vertex_id_after_import_[volume_data.volumes_vertex_indices_[index++]];
-				foreach_dart_of_orbit(m, Vertex2(dv), [&](Dart d) -> bool {
-					set_index<Vertex>(m, d, vertex_index);
-					return true;
-				});
-				mark_n_store(dv, vertex_index);
-			}
-		}
-		else if (vol_type == VolumeType::Hexa) // hexahedral case
+template <typename MESH>
+struct VolumeBuilder<MESH>::Impl
+{
+	using Vertex = typename MESH::Vertex;
+
+	// element of the list of pending faces of a vertex (the min_vertex_ of the faces)
+	struct Link
+	{
+		FaceKey face_;
+		uint32 next_;
+	};
+
+	Impl(MESH& m, const std::string& vertex_position_attribute_name)
+		: m_(m), position_(get_or_add_attribute<Vec3, Vertex>(m, vertex_position_attribute_name))
+	{
+	}
+
+	// sew the given face with a pending face of opposite orientation if any
+	void add_face(const FaceKey& f)
+	{
+		uint32 prev = INVALID_INDEX;
+		for (uint32 l = first_link_[f.min_vertex_]; l != INVALID_INDEX; prev = l, l = links_[l].next_)
 		{
-			vol = add_prism(static_cast<ParentMESH&>(m), 4u, false);
-
-			const std::array<Dart, 8> vertices_of_hexa = {vol.dart_,
-														  phi1(m, vol.dart_),
-														  phi<1, 1>(m, vol.dart_),
-														  phi_1(m, vol.dart_),
-														  phi<-1, 2, 1, 1, 2>(m, vol.dart_),
-														  phi<2, 1, 1, 2>(m, vol.dart_),
-														  phi<1, 2, 1, 1, 2>(m, vol.dart_),
-														  phi<1, 1, 2, 1, 1, 2>(m, vol.dart_)};
-
-			for (Dart dv : vertices_of_hexa)
+			Link& link = links_[l];
+			if (same_face(link.face_, f) && link.face_.reversed_ != f.reversed_)
 			{
-				const uint32 vertex_index =
-					volume_data.vertex_id_after_import_[volume_data.volumes_vertex_indices_[index++]];
-				foreach_dart_of_orbit(m, Vertex2(dv), [&](Dart d) -> bool {
-					set_index<Vertex>(m, d, vertex_index);
-					return true;
-				});
-				mark_n_store(dv, vertex_index);
+				if (f.reversed_)
+					sew_faces(m_, link.face_, f);
+				else
+					sew_faces(m_, f, link.face_);
+				(prev == INVALID_INDEX ? first_link_[f.min_vertex_] : links_[prev].next_) = link.next_;
+				link.next_ = free_link_;
+				free_link_ = l;
+				--nb_pending_;
+				return;
 			}
 		}
-		else // end of hexa
+
+		uint32 l = free_link_;
+		if (l != INVALID_INDEX)
+			free_link_ = links_[l].next_;
+		else
 		{
-			if (vol_type == VolumeType::Connector)
-			{
-				index += 4u;
-				// The second part of the code generates connectors automatically. We don't have to do anything here.
-			}
+			l = uint32(links_.size());
+			links_.emplace_back();
 		}
+		links_[l] = {f, first_link_[f.min_vertex_]};
+		first_link_[f.min_vertex_] = l;
+		++nb_pending_;
+	}
+
+	MESH& m_;
+	std::shared_ptr<typename mesh_traits<MESH>::template Attribute<Vec3>> position_;
+
+	std::vector<uint32> vertex_id_; // mesh index of the added vertices
 
-		if (is_indexed<Volume>(m))
-			set_index(m, vol, vol_emb++);
+	// lists indexed by the mesh index of the vertices
+	std::vector<uint32> first_link_;
+	std::vector<Link> links_;
+	uint32 free_link_ = INVALID_INDEX;
+	uint32 nb_pending_ = 0u;
+
+	// volumes that reference vertices that are not added yet
+	std::vector<VolumeType> deferred_volumes_types_;
+	std::vector<uint32> deferred_volumes_vertex_indices_;
+
+	std::vector<Dart> volume_darts_;
+};
+
+template <typename MESH>
+VolumeBuilder<MESH>::VolumeBuilder(MESH& m, const std::string& vertex_position_attribute_name)
+	: impl_(std::make_unique<Impl>(m, vertex_position_attribute_name))
+{
+}
+
+template <typename MESH>
+VolumeBuilder<MESH>::~VolumeBuilder()
+{
+}
+
+template <typename MESH>
+void VolumeBuilder<MESH>::reserve(uint32 nb_vertices, uint32 nb_volumes)
+{
+	impl_->vertex_id_.reserve(nb_vertices);
+	impl_->first_link_.reserve(nb_vertices);
+	(void)nb_volumes;
+}
+
+template <typename MESH>
+uint32 VolumeBuilder<MESH>::add_vertices(uint32 nb)
+{
+	using Vertex = typename MESH::Vertex;
+
+	const uint32 first = uint32(impl_->vertex_id_.size());
+	for (uint32 i = 0u; i < nb; ++i)
+	{
+		const uint32 vertex_id = new_index<Vertex>(impl_->m_);
+		impl_->vertex_id_.push_back(vertex_id);
+		if (vertex_id >= impl_->first_link_.size())
+			impl_->first_link_.resize(vertex_id + 1u, INVALID_INDEX);
 	}
+	return first;
+}
 
-	// reconstruct neighbourhood
-	uint32 nb_boundary_faces = 0u;
-	DartMarkerStore marker(m);
+template <typename MESH>
+uint32 VolumeBuilder<MESH>::add_vertex(const Vec3& position)
+{
+	const uint32 v = add_vertices(1u);
+	vertex_position(v) = position;
+	return v;
+}
+
+template <typename MESH>
+Vec3& VolumeBuilder<MESH>::vertex_position(uint32 v)
+{
+	return (*impl_->position_)[impl_->vertex_id_[v]];
+}
 
-	for (Dart d = m.begin(), end = m.end(); d != end; d = m.next(d))
+template <typename MESH>
+uint32 VolumeBuilder<MESH>::nb_vertices() const
+{
+	return uint32(impl_->vertex_id_.size());
+}
+
+template <typename MESH>
+uint32 VolumeBuilder<MESH>::vertex_index(uint32 v) const
+{
+	return impl_->vertex_id_[v];
+}
+
+template <typename MESH>
+void VolumeBuilder<MESH>::add_volume(VolumeType type, const uint32* vertex_indices)
+{
+	Impl& impl = *impl_;
+
+	const uint32 nb_vertices = nb_vertices_of_volume(type);
+	std::array<uint32, 8> vertices;
+	for (uint32 i = 0u; i < nb_vertices; ++i)
 	{
-		if (phi3(m, d) == d && !marker.is_marked(d))
+		if (vertex_indices[i] >= impl.vertex_id_.size())
 		{
-			foreach_dart_of_orbit(m, Face2(d), [&](Dart fd) -> bool {
-				marker.mark(fd);
-				return true;
-			});
+			impl.deferred_volumes_types_.push_back(type);
+			impl.deferred_volumes_vertex_indices_.insert(impl.deferred_volumes_vertex_indices_.end(), vertex_indices,
+														 vertex_indices + nb_vertices);
+			return;
+		}
+		vertices[i] = impl.vertex_id_[vertex_indices[i]];
+	}
 
-			Dart good_dart;
+	Dart d = create_volume(impl.m_, type, vertices.data());
+	if (!d.is_nil())
+		foreach_face_key(impl.m_, d, impl.volume_darts_, [&](const FaceKey& f) { impl.add_face(f); });
+}
 
-			// 1st step : for every dart of the face we try to find a valid phi3 candidate.
-			// If we can't it's a boundary face.
-			Dart d_it = d;
-			do
-			{
-				uint32 vindex1 = index_of(m, Vertex(d_it));
-				uint32 vindex2 = index_of(m, Vertex(phi1(m, phi1(m, d_it))));
-				const std::vector<Dart>& vec = value<std::vector<Dart>>(m, darts_per_vertex, Vertex(phi1(m, d_it)));
-				for (auto it = vec.begin(); it != vec.end() && good_dart.is_nil(); ++it)
-					if (index_of(m, Vertex(phi1(m, *it))) == vindex1 && index_of(m, Vertex(phi_1(m, *it))) == vindex2)
-						good_dart = *it;
-				d_it = phi1(m, d_it);
-			} while (good_dart.is_nil() && (d_it != d));
-			d = phi_1(m, d_it);
-
-			if (!good_dart.is_nil())
-			{
-				// const uint32 degD = codegree(m, MESH::Face(d));
-				// const uint32 degGD = codegree(m, MESH::Face(good_dart));
-
-				// if (degD == degGD) // normal case : the two opposite faces have the same degree
-				//{
-				//	Dart it1 = d;
-				//	Dart it2 = good_dart;
-				//	do
-				//	{
-				//		phi3_sew(m, it1, it2);
-				//		it1 = phi1(m, it1);
-				//		it2 = phi_1(m, it2);
-				//	} while (it1 != d);
-				// }
-				// else
-				//{
-				//	// there is one face of degree 4 and one face of degree 3
-				//	// -> stamp volume
-				// }
-
-				std::vector<std::pair<Dart, Dart>> vd;
-				vd.reserve(32);
-				Dart it1 = d;
-				Dart it2 = good_dart;
-				bool stop1 = false;
-				bool stop2 = false;
-				do
-				{
-					vd.push_back(std::make_pair(it1, it2));
-					it1 = phi1(m, it1);
-					stop1 = (it1 == d);
-					it2 = phi_1(m, it2);
-					stop2 = (it2 == good_dart);
-				} while (stop1 || stop2);
-
-				if (stop1 && stop2) // normal case : the two opposite faces have the same degree
-				{
-					for (const auto& p : vd)
-						phi3_sew(m, p.first, p.second);
-				}
-				else
-				{
-					// there is one face of degree 4 and one face of degree 3
-					// -> stamp volume
-				}
-			}
-			else
-				++nb_boundary_faces;
-		}
+template <typename MESH>
+bool VolumeBuilder<MESH>::finish()
+{
+	Impl& impl = *impl_;
+
+	// the map is always completed (even if the import is cancelled)
+	report_import_progress(ImportPhase::Building);
+
+	// a volume that still references an unknown vertex invalidates the whole mesh
+	const uint32 nb_vertices = uint32(impl.vertex_id_.size());
+	if (std::any_of(impl.deferred_volumes_vertex_indices_.begin(), impl.deferred_volumes_vertex_indices_.end(),
+					[&](uint32 v) { return v >= nb_vertices; }))
+	{
+		abort();
+		return false;
 	}
 
-	if (nb_boundary_faces > 0u)
+	const uint32* indices = impl.deferred_volumes_vertex_indices_.data();
+	for (VolumeType type : impl.deferred_volumes_types_)
 	{
-		uint32 nb_holes = close(m);
+		add_volume(type, indices);
+		indices += nb_vertices_of_volume(type);
+	}
+	impl.deferred_volumes_types_ = std::vector<VolumeType>();
+	impl.deferred_volumes_vertex_indices_ = std::vector<uint32>();
+
+	impl.first_link_ = std::vector<uint32>();
+	impl.links_ = std::vector<typename Impl::Link>();
+	impl.free_link_ = INVALID_INDEX;
+
+	if (impl.nb_pending_ > 0u)
+	{
+		uint32 nb_holes = close(impl.m_);
 		std::cout << nb_holes << " hole(s) have been closed" << std::endl;
-		std::cout << nb_boundary_faces << " boundary faces" << std::endl;
+		std::cout << impl.nb_pending_ << " boundary faces" << std::endl;
+		impl.nb_pending_ = 0u;
 	}
 
-	remove_attribute<Vertex>(m, darts_per_vertex);
+	return true;
 }
 
-void import_volume_data(CMap3& m, VolumeImportData& volume_data)
+template <typename MESH>
+void VolumeBuilder<MESH>::abort()
 {
-	import_volume_data_map_tmpl<CMap3>(m, volume_data);
-}
+	Impl& impl = *impl_;
 
-void import_volume_data(GMap3& m, VolumeImportData& volume_data)
-{
-	import_volume_data_map_tmpl<GMap3>(m, volume_data);
+	impl.vertex_id_ = std::vector<uint32>();
+	impl.first_link_ = std::vector<uint32>();
+	impl.links_ = std::vector<typename Impl::Link>();
+	impl.free_link_ = INVALID_INDEX;
+	impl.nb_pending_ = 0u;
+	impl.deferred_volumes_types_ = std::vector<VolumeType>();
+	impl.deferred_volumes_vertex_indices_ = std::vector<uint32>();
+
+	clear(impl.m_);
 }
 
+template class VolumeBuilder<CMap3>;
+template class VolumeBuilder<GMap3>;
+
 } // namespace io
 
 } // namespace cgogn
@@ -29,6 +29,8 @@
 #include <cgogn/core/utils/numerics.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace cgogn
@@ -78,6 +80,62 @@ struct VolumeImportData
 void CGOGN_IO_EXPORT import_volume_data(CMap3& m, VolumeImportData& volume_data);
 void CGOGN_IO_EXPORT import_volume_data(GMap3& m, VolumeImportData& volume_data);
 
+/////////////////////////////////////////////////////////////////////////////
+// VolumeBuilder                                                           //
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief incremental construction of a volume mesh from batches of vertices and volumes
+ * Unlike VolumeImportData, nothing is buffered: the vertices and volumes are created in the mesh as soon as they are
+ * given. The faces that are not sewn yet are kept in per vertex pending lists and each new face is sewn with a pending
+ * face of opposite orientation, so the extra memory is proportional to the current boundary of the mesh. A volume
+ * that references a vertex that is not given yet is deferred until finish().
+ */
+template <typename MESH>
+class VolumeBuilder
+{
+public:
+	VolumeBuilder(MESH& m, const std::string& vertex_position_attribute_name = "position");
+	~VolumeBuilder();
+
+	VolumeBuilder(const VolumeBuilder&) = delete;
+	VolumeBuilder& operator=(const VolumeBuilder&) = delete;
+
+	void reserve(uint32 nb_vertices, uint32 nb_volumes);
+
+	/**
+	 * @brief add nb vertices (their positions are then set with vertex_position)
+	 * @return the index of the first added vertex (the vertices are numbered in the order they are added)
+	 */
+	uint32 add_vertices(uint32 nb);
+	uint32 add_vertex(const Vec3& position);
+
+	// can be called concurrently for different vertices
+	Vec3& vertex_position(uint32 v);
+	uint32 nb_vertices() const;
+	// index of the given vertex in the mesh
+	uint32 vertex_index(uint32 v) const;
+
+	// the number of vertex indices depends on the type (4, 5, 6, 8 or 4 for connectors that are ignored)
+	void add_volume(VolumeType type, const uint32* vertex_indices);
+
+	/**
+	 * @brief build the deferred volumes and close the boundary of the mesh
+	 * @return false if a volume references a vertex that has not been added (the mesh is then cleared, see abort)
+	 */
+	bool finish();
+
+	// discard the building (after an invalid or cancelled import): the mesh is cleared and nothing is sewn or closed
+	void abort();
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> impl_;
+};
+
+extern template class CGOGN_IO_EXPORT VolumeBuilder<CMap3>;
+extern template class CGOGN_IO_EXPORT VolumeBuilder<GMap3>;
+
 } // namespace io
 
 } // namespace cgogn
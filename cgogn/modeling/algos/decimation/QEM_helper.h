@@ -55,19 +55,26 @@ struct DecimationQEM_Helper
 	DecimationQEM_Helper(MESH& m, const Attribute<Vec3>* vertex_position) : m_(m), vertex_position_(vertex_position)
 	{
 		vertex_quadric_ = add_attribute<Quadric, Vertex>(m, "__vertex_quadric");
-		parallel_foreach_cell(m_, [&](Vertex v) -> bool {
-			value<Quadric>(m_, vertex_quadric_, v).zero();
+		// the quadric of each face is computed once, then each vertex gathers the quadrics of its incident faces
+		// (no concurrent writes on the vertex quadrics)
+		auto face_quadric = add_attribute<Quadric, Face>(m, "__face_quadric");
+		parallel_foreach_cell(m_, [&](Face f) -> bool {
+			auto iv = incident_vertices<3>(m_, f);
+			value<Quadric>(m_, face_quadric, f) =
+				Quadric(value<Vec3>(m_, vertex_position_, iv[0]), value<Vec3>(m_, vertex_position_, iv[1]),
+						value<Vec3>(m_, vertex_position_, iv[2]));
 			return true;
 		});
-		parallel_foreach_cell(m_, [&](Face f) -> bool {
-			std::vector<Vertex> iv = incident_vertices(m_, f);
-			Quadric q(value<Vec3>(m_, vertex_position_, iv[0]), value<Vec3>(m_, vertex_position_, iv[1]),
-					  value<Vec3>(m_, vertex_position_, iv[2]));
-			value<Quadric>(m_, vertex_quadric_, iv[0]) += q;
-			value<Quadric>(m_, vertex_quadric_, iv[1]) += q;
-			value<Quadric>(m_, vertex_quadric_, iv[2]) += q;
+		parallel_foreach_cell(m_, [&](Vertex v) -> bool {
+			Quadric& q = value<Quadric>(m_, vertex_quadric_, v);
+			q.zero();
+			foreach_incident_face(m_, v, [&](Face f) -> bool {
+				q += value<Quadric>(m_, face_quadric, f);
+				return true;
+			});
 			return true;
 		});
+		remove_attribute<Face>(m_, face_quadric);
 	}
 	~DecimationQEM_Helper()
 	{
@@ -76,7 +83,7 @@ struct DecimationQEM_Helper
 
 	Scalar edge_cost(Edge e, const Vec3& p)
 	{
-		std::vector<Vertex> iv = incident_vertices(m_, e);
+		auto iv = incident_vertices<2>(m_, e);
 		Quadric q;
 		q += value<Quadric>(m_, vertex_quadric_, iv[0]);
 		q += value<Quadric>(m_, vertex_quadric_, iv[1]);
@@ -85,7 +92,7 @@ struct DecimationQEM_Helper
 
 	Vec3 edge_optimal(Edge e)
 	{
-		std::vector<Vertex> iv = incident_vertices(m_, e);
+		auto iv = incident_vertices<2>(m_, e);
 		Quadric q;
 		q += value<Quadric>(m_, vertex_quadric_, iv[0]);
 		q += value<Quadric>(m_, vertex_quadric_, iv[1]);
@@ -98,7 +105,7 @@ struct DecimationQEM_Helper
 
 	void before_collapse(Edge e)
 	{
-		std::vector<Vertex> iv = incident_vertices(m_, e);
+		auto iv = incident_vertices<2>(m_, e);
 		q_.zero();
 		q_ += value<Quadric>(m_, vertex_quadric_, iv[0]);
 		q_ += value<Quadric>(m_, vertex_quadric_, iv[1]);
@@ -71,7 +71,7 @@ inline bool edge_should_flip(MESH& m, typename MESH::Edge e)
 {
 	using Vertex = typename mesh_traits<MESH>::Vertex;
 
-	std::vector<Vertex> iv = incident_vertices(m, e);
+	auto iv = incident_vertices<2>(m, e);
 	const int32 w = degree(m, iv[0]);
 	const int32 x = degree(m, iv[1]);
 	const int32 y = degree(m, Vertex(phi<1, 1>(m, iv[0].dart_)));
@@ -146,7 +146,7 @@ struct PliantRemeshing_Helper
 		geometry::compute_normal<Vertex>(m_, vertex_position_.get(), vertex_normal.get());
 		auto vertex_medial_point = add_attribute<Vec3, Vertex>(m_, "__vertex_medial_point");
 		auto vertex_medial_point_radius = add_attribute<Scalar, Vertex>(m_, "__vertex_medial_point_radius");
-		geometry::shrinking_ball_centers(m_, vertex_position_.get(), vertex_normal.get(), vertex_medial_point.get(),
+		geometry::shrinking_ball_centers(m_, vertex_position_, vertex_normal.get(), vertex_medial_point.get(),
 										 vertex_medial_point_radius.get());
 
 		vertex_lfs_ = get_or_add_attribute<Scalar, Vertex>(m_, "__vertex_lfs");
@@ -193,7 +193,7 @@ struct PliantRemeshing_Helper
 			if (std::fabs(geometry::angle(m_, e, vertex_position_.get())) > angle_threshold)
 			{
 				value<bool>(m_, feature_edge_, e) = true;
-				std::vector<Vertex> iv = incident_vertices(m_, e);
+				auto iv = incident_vertices<2>(m_, e);
 				value<bool>(m_, feature_vertex_, iv[0]) = true;
 				value<bool>(m_, feature_vertex_, iv[1]) = true;
 			}
@@ -261,7 +261,7 @@ void pliant_remeshing(MESH& m, std::shared_ptr<typename mesh_traits<MESH>::templ
 			cache.template build<Edge>();
 			has_long_edge = false;
 			foreach_cell(cache, [&](Edge e) -> bool {
-				std::vector<Vertex> iv = incident_vertices(m, e);
+				auto iv = incident_vertices<2>(m, e);
 				Scalar lfs = 0.0; // init to zero for warning remove
 				Scalar coeff = 1.0;
 				if (lfs_adaptive)
@@ -310,7 +310,7 @@ void pliant_remeshing(MESH& m, std::shared_ptr<typename mesh_traits<MESH>::templ
 		{
 			has_short_edge = false;
 			foreach_cell(m, [&](Edge e) -> bool {
-				std::vector<Vertex> iv = incident_vertices(m, e);
+				auto iv = incident_vertices<2>(m, e);
 				Scalar lfs;
 				Scalar coeff = 1.0;
 				if (lfs_adaptive)
@@ -370,7 +370,7 @@ void pliant_remeshing(MESH& m, std::shared_ptr<typename mesh_traits<MESH>::templ
 			else
 			{
 				// Delaunay flips
-				std::vector<Vertex> iv = incident_vertices(m, e);
+				auto iv = incident_vertices<2>(m, e);
 				if (degree(m, iv[0]) > 4 && degree(m, iv[1]) > 4)
 				{
 					std::vector<Scalar> op_angles = geometry::opposite_angles(m, e, vertex_position.get());
@@ -72,7 +72,7 @@ struct MeanCurvatureSkeleton_Helper
 
 		vertex_medial_point_ = add_attribute<Vec3, Vertex>(m_, "__vertex_medial_point");
 		vertex_medial_point_radius_ = add_attribute<Scalar, Vertex>(m_, "__vertex_medial_point_radius");
-		geometry::shrinking_ball_centers(m_, vertex_position_.get(), vertex_normal_.get(), vertex_medial_point_.get(),
+		geometry::shrinking_ball_centers(m_, vertex_position_, vertex_normal_.get(), vertex_medial_point_.get(),
 										 vertex_medial_point_radius_.get());
 
 		// TODO: regularize medial axis ?
@@ -87,7 +87,8 @@ public:
 	{
 	}
 
-	void medial_axis(SURFACE& s, SurfaceAttribute<Vec3>* vertex_position, SurfaceAttribute<Vec3>* vertex_normal)
+	void medial_axis(SURFACE& s, const std::shared_ptr<SurfaceAttribute<Vec3>>& vertex_position,
+					 SurfaceAttribute<Vec3>* vertex_normal)
 	{
 		auto sbc = get_or_add_attribute<Vec3, SurfaceVertex>(s, "shrinking_ball_centers");
 		auto sbr = get_or_add_attribute<Scalar, SurfaceVertex>(s, "shrinking_ball_radius");
@@ -264,7 +265,7 @@ protected:
 				if (selected_surface_vertex_normal_)
 				{
 					if (ImGui::Button("Medial axis"))
-						medial_axis(*selected_surface_, selected_surface_vertex_position_.get(),
+						medial_axis(*selected_surface_, selected_surface_vertex_position_,
 									selected_surface_vertex_normal_.get());
 				}
 			}
@@ -33,6 +33,7 @@
 
 #include <cgogn/geometry/algos/angle.h>
 #include <cgogn/geometry/algos/laplacian.h>
+#include <cgogn/geometry/algos/sparse_assembler.h>
 #include <cgogn/geometry/types/vector_traits.h>
 
 #include <GLFW/glfw3.h>
@@ -297,30 +298,20 @@ private:
 			});
 
 			// init laplacian matrix
-			p.working_LAPL_ = geometry::cotan_laplacian_matrix(*p.working_cells_, p.vertex_index_.get(),
-															   p.vertex_area_.get(), p.edge_weight_.get());
+			geometry::SparseAssembler<CellCache<MESH>> assembler(*p.working_cells_, p.vertex_index_.get());
+			assembler.fill(p.working_LAPL_, [&](Edge e) -> Scalar { return value<Scalar>(m, p.edge_weight_, e); });
+			assembler.scale_rows(p.working_LAPL_,
+								 [&](Vertex v) -> Scalar { return 1.0 / value<Scalar>(m, p.vertex_area_, v); });
 
 			// init bi-laplacian matrix
-			p.working_BILAPL_.setZero();
-			p.working_BILAPL_.resize(nb_vertices, nb_vertices);
 			p.working_BILAPL_ = p.working_LAPL_ * p.working_LAPL_;
-
-			// set constrained vertices
-			foreach_cell(*p.working_cells_, [&](Vertex v) -> bool {
-				if (!p.selected_free_vertices_set_->contains(v))
-				{
-					int idx = int(value<uint32>(m, p.vertex_index_, v));
-					p.working_LAPL_.prune([&](int i, int, Scalar) { return i != idx; });
-					p.working_LAPL_.coeffRef(idx, idx) = 1.0;
-					p.working_BILAPL_.prune([&](int i, int, Scalar) { return i != idx; });
-					p.working_BILAPL_.coeffRef(idx, idx) = 1.0;
-				}
-				return true;
-			});
-
-			p.working_LAPL_.makeCompressed();
 			p.working_BILAPL_.makeCompressed();
 
+			// set constrained vertices (in one pass over the coefficients, the patterns are kept)
+			auto constrained = [&](Vertex v) -> bool { return !p.selected_free_vertices_set_->contains(v); };
+			assembler.set_identity_rows(p.working_LAPL_, constrained);
+			assembler.set_identity_rows(p.working_BILAPL_, constrained);
+
 			if (p.solver_)
 				delete p.solver_;
 			p.solver_ = new Eigen::SparseLU<Eigen::SparseMatrix<Scalar, Eigen::ColMajor>>(p.working_BILAPL_);
@@ -656,6 +656,8 @@ public:
 		if (!volume_skin_)
 			volume_skin_ = surface_provider_->add_mesh("volume_skin");
 
+		// the non-rigid registration state of the previous skin is outdated
+		geometry::release_non_rigid_register_mesh(*volume_skin_);
 		surface_provider_->clear_mesh(*volume_skin_);
 
 		volume_skin_vertex_position_ = get_or_add_attribute<Vec3, SurfaceVertex>(*volume_skin_, "position");
@@ -1101,8 +1103,16 @@ public:
 				[&](uint32 idx) { frozen_positions.push_back((*volume_vertex_position_)[idx]); });
 		}
 
-		geometry::rigid_register_mesh(*volume_, volume_vertex_position_.get(), *surface_,
-									  surface_vertex_position_.get());
+		// the skin is registered onto the surface and its transform is applied to the whole volume
+		geometry::SurfaceRegistration<SURFACE> registration(*surface_, surface_vertex_position_);
+		const geometry::Mat4 t = registration.rigid_register(*volume_skin_, volume_skin_vertex_position_.get());
+		const Mat3 R = t.topLeftCorner<3, 3>();
+		const Vec3 T = t.topRightCorner<3, 1>();
+		parallel_foreach_cell(*volume_, [&](VolumeVertex v) -> bool {
+			Vec3& p = value<Vec3>(*volume_, volume_vertex_position_, v);
+			p = R * p + T;
+			return true;
+		});
 
 		if (selected_frozen_vertices_set_)
 		{